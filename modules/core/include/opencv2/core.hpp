@@ -518,10 +518,13 @@ are taken from the input array. That is, the function processes each element of
 \f[\texttt{dst} (I)  \leftarrow \texttt{lut(src(I) + d)}\f]
 where
 \f[d =  \fork{0}{if \texttt{src} has depth \texttt{CV\_8U}}{128}{if \texttt{src} has depth \texttt{CV\_8S}}\f]
-@param src input array of 8-bit elements.
-@param lut look-up table of 256 elements; in case of multi-channel input array, the table should
-either have a single channel (in this case the same table is used for all channels) or the same
-number of channels as in the input array.
+16-bit input arrays (CV_16U or CV_16S) are processed the same way, with the table of 65536
+elements; CV_16S values are used as the corresponding unsigned 16-bit indices. Large arrays are
+processed in parallel.
+@param src input array of 8-bit or 16-bit elements.
+@param lut look-up table of 256 elements (65536 elements for 16-bit src); in case of multi-channel
+input array, the table should either have a single channel (in this case the same table is used
+for all channels) or the same number of channels as in the input array.
 @param dst output array of the same size and number of channels as src, and the same depth as lut.
 @sa  convertScaleAbs, Mat::convertTo
 */
@@ -1417,6 +1420,24 @@ input matrices.
 CV_EXPORTS_W void gemm(InputArray src1, InputArray src2, double alpha,
                        InputArray src3, double beta, OutputArray dst, int flags = 0);
 
+/** @overload
+@brief Multiplies sparse and dense matrices.
+
+The function computes \f$\texttt{dst} = \texttt{alpha} \cdot \texttt{src1} \cdot \texttt{src2} + \texttt{beta} \cdot \texttt{src3}\f$
+where src1 is a 2D single-channel CV_32F or CV_64F sparse matrix and src2, src3 are dense matrices of
+the same type. Passing a single column src2 computes the sparse matrix-vector product. The sparse
+matrix is converted to the CSR format (see SparseMat::convertToCSR) and the rows of the result are
+computed in parallel.
+@param src1 first multiplied input sparse matrix.
+@param src2 second multiplied input dense matrix with src1.size(1) rows.
+@param alpha weight of the matrix product.
+@param src3 third optional delta matrix added to the matrix product; it is not used when beta is 0.
+@param beta weight of src3.
+@param dst output matrix of src1.size(0) x src2.cols size.
+*/
+CV_EXPORTS void gemm(const SparseMat& src1, InputArray src2, double alpha,
+                     InputArray src3, double beta, OutputArray dst);
+
 /** @brief Calculates the product of a matrix and its transposition.
 
 The function mulTransposed calculates the product of src and its
@@ -1427,6 +1448,9 @@ if aTa=true , and
 otherwise. The function is used to calculate the covariance matrix. With
 zero delta, it can be used as a faster substitute for general matrix
 product A\*B when B=A'
+
+Only the upper triangle of the symmetric product is computed, in parallel; with aTa=true the rows of
+src (e.g. millions of samples) are accumulated in blocks, in double precision.
 @param src input single-channel matrix. Note that unlike gemm, the
 function can multiply not only floating-point matrices.
 @param dst output square matrix.
@@ -1763,6 +1787,17 @@ the invert function (preferably using the cv::DECOMP_SVD method, as the most acc
 */
 CV_EXPORTS_W double Mahalanobis(InputArray v1, InputArray v2, InputArray icovar);
 
+/** @brief Calculates the Mahalanobis distances between many vectors and the mean vector.
+
+The function computes the distance (see cv::Mahalanobis) from each row of samples to mean.
+The rows are processed in parallel, in blocks.
+@param samples matrix of CV_32FC1 or CV_64FC1 type; each row is a query vector.
+@param mean mean vector with samples.cols elements, of the same type as samples.
+@param icovar inverse covariance matrix of the same type as samples.
+@param dst output column of samples.rows distances, of the same type as samples.
+*/
+CV_EXPORTS_W void MahalanobisBatch(InputArray samples, InputArray mean, InputArray icovar, OutputArray dst);
+
 /** @brief Performs a forward or inverse Discrete Fourier transform of a 1D or 2D floating-point array.
 
 The function performs one of the following:
@@ -2311,8 +2311,10 @@ protected:
 Such a sparse array can store elements of any type that Mat can store. *Sparse* means that only
 non-zero elements are stored (though, as a result of operations on a sparse matrix, some of its
 stored elements can actually become 0. It is up to you to detect such elements and delete them
-using SparseMat::erase ). The non-zero elements are stored in a hash table that grows when it is
-filled so that the search time is O(1) in average (regardless of whether element is there or not).
+using SparseMat::erase ). The non-zero elements are stored in an open-addressing hash table that
+grows when it is half-filled so that the search time is O(1) in average (regardless of whether element
+is there or not). The nodes are allocated from a single contiguous pool and only store as many
+indices as the matrix has dimensions.
 Elements can be accessed using the following methods:
 -   Query operations (SparseMat::ptr and the higher-level SparseMat::ref, SparseMat::value and
     SparseMat::find), for example:
@@ -2413,10 +2415,15 @@ public:
     {
         //! hash value
         size_t hashval;
-        //! index of the next node in the same hash table entry
+        //! index of the next free node; always 0 for the nodes stored in the hash table
         size_t next;
-        //! index of the matrix element
+        //! index of the matrix element (only the first dims() elements are allocated)
         int idx[MAX_DIM];
+
+    private:
+        // the nodes are smaller than sizeof(Node) and only live in the pool, so they are never copied
+        Node(const Node&);
+        Node& operator = (const Node&);
     };
 
     /** @brief Various SparseMat constructors.
@@ -2483,6 +2490,27 @@ public:
     void create(int dims, const int* _sizes, int _type);
     //! sets all the sparse matrix elements to 0, which means clearing the hash table.
     void clear();
+    //! preallocates the hash table and the node pool for the specified number of non-zero elements
+    void reserve(size_t nzcount);
+    /** @brief Inserts many elements at once.
+
+    @param idx Element indices, CV_32S continuous array of dims() values per element, e.g. N x dims()
+        single-channel matrix or std::vector<Point> for 2D matrices.
+    @param values Element values, continuous array of the same depth as the sparse matrix with
+        channels() values per element.
+    @param accumulate If true, the values are added to the existing elements, otherwise they replace
+        them.
+     */
+    void insert(InputArray idx, InputArray values, bool accumulate=false);
+    /** @brief Converts 2D sparse matrix to the compressed sparse row (CSR) format.
+
+    @param values 1 x nzcount() output array of the non-zero elements, ordered by rows and, within each
+        row, by columns. It has the same type as the sparse matrix.
+    @param colIdx 1 x nzcount() CV_32S output array of the column indices of the elements.
+    @param rowPtr 1 x (size(0)+1) CV_32S output array; elements of the i-th row occupy the
+        [rowPtr[i], rowPtr[i+1]) range of values and colIdx.
+     */
+    void convertToCSR(OutputArray values, OutputArray colIdx, OutputArray rowPtr) const;
     //! manually increments the reference counter to the header.
     void addref();
     // decrements the header reference counter. When the counter reaches 0, the header and all the underlying data are deallocated.
@@ -386,6 +386,91 @@ public:
 */
 CV_EXPORTS void parallel_for_(const Range& range, const ParallelLoopBody& body, double nstripes=-1.);
 
+/** @brief Base class for tasks executed asynchronously with cv::async_
+
+Results are passed back through the members of the derived class, the same way as it is done for
+ParallelLoopBody. Exceptions thrown from operator() are captured and re-thrown by AsyncFuture::get.
+*/
+class CV_EXPORTS AsyncTask
+{
+public:
+    virtual ~AsyncTask();
+    virtual void operator() () = 0;
+};
+
+/** @brief Handle of a task submitted with cv::async_
+
+Copies of a future refer to the same task. Default-constructed future is not valid.
+*/
+class CV_EXPORTS AsyncFuture
+{
+public:
+    enum State
+    {
+        PENDING   = 0, //!< the task is queued and has not started yet
+        RUNNING   = 1, //!< the task is being executed
+        DONE      = 2, //!< the task has finished successfully
+        FAILED    = 3, //!< the task (or the task it depends on) has thrown an exception
+        CANCELLED = 4  //!< the task (or the task it depends on) has been cancelled
+    };
+
+    AsyncFuture();
+
+    //! returns true if the future refers to a task
+    bool valid() const;
+    //! returns the current state of the task, see AsyncFuture::State
+    int state() const;
+    //! returns true if the task is DONE, FAILED or CANCELLED
+    bool isReady() const;
+
+    /** @brief Waits for the task to finish.
+    @param timeoutMs maximal time to wait, in milliseconds. Negative value means infinite wait.
+    @return true if the task is finished (see isReady) before the timeout expired.
+    */
+    bool wait(double timeoutMs = -1) const;
+
+    /** @brief Waits for the task to finish and re-throws the exception if the task has failed.
+
+    Throws cv::Exception with code cv::Error::StsObjectNotFound if the task has been cancelled.
+    */
+    void get() const;
+
+    /** @brief Cancels the task if it has not started yet.
+
+    All continuations attached with then() are cancelled as well. A task that is already running is
+    not interrupted.
+    @return true if the task has been cancelled by this call.
+    */
+    bool cancel();
+
+    /** @brief Schedules another task to run after this one has finished successfully.
+
+    If this task fails or is cancelled, the continuation does not run and takes the same state.
+    @param continuation the task to execute.
+    @return the future of the continuation.
+    */
+    AsyncFuture then(const Ptr<AsyncTask>& continuation) const;
+
+    struct Impl;
+    explicit AsyncFuture(const Ptr<Impl>& impl);
+protected:
+    Ptr<Impl> p;
+};
+
+/** @brief Executes the task asynchronously.
+
+The task is queued to the thread pool of the parallel framework OpenCV is built with (TBB, GCD,
+Concurrency). With other frameworks, or without any, OpenCV runs the tasks on its own worker threads,
+the number of which follows setNumThreads. If the number of threads is set to 0, the task is executed
+synchronously, before the function returns.
+
+Tasks should not block waiting for other asynchronous tasks; use AsyncFuture::then to express
+dependencies instead.
+@param task the task to execute.
+@return the future that can be used to wait for the task or to cancel it.
+ */
+CV_EXPORTS AsyncFuture async_(const Ptr<AsyncTask>& task);
+
 /////////////////////////////// forEach method of cv::Mat ////////////////////////////
 template<typename _Tp, typename Functor> inline
 void Mat::forEach_impl(const Functor& operation) {
@@ -5632,6 +5632,71 @@ LUT8u_( const uchar* src, const T* lut, T* dst, int len, int cn, int lutcn )
     }
 }
 
+template<typename T> static void
+LUT16u_( const ushort* src, const T* lut, T* dst, int len, int cn, int lutcn )
+{
+    if( lutcn == 1 )
+    {
+        for( int i = 0; i < len*cn; i++ )
+            dst[i] = lut[src[i]];
+    }
+    else
+    {
+        for( int i = 0; i < len*cn; i += cn )
+            for( int k = 0; k < cn; k++ )
+                dst[i+k] = lut[src[i+k]*cn+k];
+    }
+}
+
+#if CV_AVX2
+// gathers 8 table elements at once; only used for 4-byte tables,
+// since a wider gather could read past the end of the table
+static int LUT32_AVX2( const uchar* src, const int* lut, int* dst, int n )
+{
+    int i = 0;
+    for( ; i <= n - 8; i += 8 )
+    {
+        __m256i v_idx = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(src + i)));
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_i32gather_epi32(lut, v_idx, 4));
+    }
+    return i;
+}
+
+static int LUT32_AVX2( const ushort* src, const int* lut, int* dst, int n )
+{
+    int i = 0;
+    for( ; i <= n - 16; i += 16 )
+    {
+        __m256i v_idx0 = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(src + i)));
+        __m256i v_idx1 = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(src + i + 8)));
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_i32gather_epi32(lut, v_idx0, 4));
+        _mm256_storeu_si256((__m256i*)(dst + i + 8), _mm256_i32gather_epi32(lut, v_idx1, 4));
+    }
+    return i;
+}
+#endif
+
+template<typename ST> static void
+LUT32_( const ST* src, const int* lut, int* dst, int len, int cn, int lutcn )
+{
+    if( lutcn == 1 )
+    {
+        int i = 0, n = len*cn;
+#if CV_AVX2
+        if( USE_AVX2 )
+            i = LUT32_AVX2(src, lut, dst, n);
+#endif
+        for( ; i < n; i++ )
+            dst[i] = lut[src[i]];
+    }
+    else
+    {
+        for( int i = 0; i < len*cn; i += cn )
+            for( int k = 0; k < cn; k++ )
+                dst[i+k] = lut[src[i+k]*cn+k];
+    }
+}
+
 static void LUT8u_8u( const uchar* src, const uchar* lut, uchar* dst, int len, int cn, int lutcn )
 {
     LUT8u_( src, lut, dst, len, cn, lutcn );
@@ -5654,12 +5719,12 @@ static void LUT8u_16s( const uchar* src, const short* lut, short* dst, int len,
 
 static void LUT8u_32s( const uchar* src, const int* lut, int* dst, int len, int cn, int lutcn )
 {
-    LUT8u_( src, lut, dst, len, cn, lutcn );
+    LUT32_( src, lut, dst, len, cn, lutcn );
 }
 
 static void LUT8u_32f( const uchar* src, const float* lut, float* dst, int len, int cn, int lutcn )
 {
-    LUT8u_( src, lut, dst, len, cn, lutcn );
+    LUT32_( src, (const int*)lut, (int*)dst, len, cn, lutcn );
 }
 
 static void LUT8u_64f( const uchar* src, const double* lut, double* dst, int len, int cn, int lutcn )
@@ -5667,6 +5732,41 @@ static void LUT8u_64f( const uchar* src, const double* lut, double* dst, int len
     LUT8u_( src, lut, dst, len, cn, lutcn );
 }
 
+static void LUT16u_8u( const ushort* src, const uchar* lut, uchar* dst, int len, int cn, int lutcn )
+{
+    LUT16u_( src, lut, dst, len, cn, lutcn );
+}
+
+static void LUT16u_8s( const ushort* src, const schar* lut, schar* dst, int len, int cn, int lutcn )
+{
+    LUT16u_( src, lut, dst, len, cn, lutcn );
+}
+
+static void LUT16u_16u( const ushort* src, const ushort* lut, ushort* dst, int len, int cn, int lutcn )
+{
+    LUT16u_( src, lut, dst, len, cn, lutcn );
+}
+
+static void LUT16u_16s( const ushort* src, const short* lut, short* dst, int len, int cn, int lutcn )
+{
+    LUT16u_( src, lut, dst, len, cn, lutcn );
+}
+
+static void LUT16u_32s( const ushort* src, const int* lut, int* dst, int len, int cn, int lutcn )
+{
+    LUT32_( src, lut, dst, len, cn, lutcn );
+}
+
+static void LUT16u_32f( const ushort* src, const float* lut, float* dst, int len, int cn, int lutcn )
+{
+    LUT32_( src, (const int*)lut, (int*)dst, len, cn, lutcn );
+}
+
+static void LUT16u_64f( const ushort* src, const double* lut, double* dst, int len, int cn, int lutcn )
+{
+    LUT16u_( src, lut, dst, len, cn, lutcn );
+}
+
 typedef void (*LUTFunc)( const uchar* src, const uchar* lut, uchar* dst, int len, int cn, int lutcn );
 
 static LUTFunc lutTab[] =
@@ -5675,6 +5775,17 @@ static LUTFunc lutTab[] =
     (LUTFunc)LUT8u_32s, (LUTFunc)LUT8u_32f, (LUTFunc)LUT8u_64f, 0
 };
 
+static LUTFunc lutTab16u[] =
+{
+    (LUTFunc)LUT16u_8u, (LUTFunc)LUT16u_8s, (LUTFunc)LUT16u_16u, (LUTFunc)LUT16u_16s,
+    (LUTFunc)LUT16u_32s, (LUTFunc)LUT16u_32f, (LUTFunc)LUT16u_64f, 0
+};
+
+static LUTFunc getLUTFunc( int srcDepth, int lutDepth )
+{
+    return (srcDepth == CV_8U || srcDepth == CV_8S ? lutTab : lutTab16u)[lutDepth];
+}
+
 #ifdef HAVE_OPENCL
 
 static bool ocl_LUT(InputArray _src, InputArray _lut, OutputArray _dst)
@@ -5875,7 +5986,7 @@ public:
     LUTParallelBody(const Mat& src, const Mat& lut, Mat& dst, bool* _ok)
         : ok(_ok), src_(src), lut_(lut), dst_(dst)
     {
-        func = lutTab[lut.depth()];
+        func = getLUTFunc(src.depth(), lut.depth());
         *ok = (func != NULL);
     }
 
@@ -5912,18 +6023,30 @@ void cv::LUT( InputArray _src, InputArray _lut, OutputArray _dst )
     int cn = _src.channels(), depth = _src.depth();
     int lutcn = _lut.channels();
 
+    bool is8bit = depth == CV_8U || depth == CV_8S;
+
     CV_Assert( (lutcn == cn || lutcn == 1) &&
-        _lut.total() == 256 && _lut.isContinuous() &&
-        (depth == CV_8U || depth == CV_8S) );
+        _lut.total() == (is8bit ? (size_t)256 : (size_t)65536) && _lut.isContinuous() &&
+        (is8bit || depth == CV_16U || depth == CV_16S) );
 
-    CV_OCL_RUN(_dst.isUMat() && _src.dims() <= 2,
+    CV_OCL_RUN(_dst.isUMat() && _src.dims() <= 2 && is8bit,
                ocl_LUT(_src, _lut, _dst))
 
     Mat src = _src.getMat(), lut = _lut.getMat();
     _dst.create(src.dims, src.size, CV_MAKETYPE(_lut.depth(), cn));
     Mat dst = _dst.getMat();
+    if( src.empty() )
+        return;
+
+    // continuous n-dimensional arrays are processed as 2D ones, so that they can be split by rows too
+    if( src.dims > 2 && src.isContinuous() && dst.isContinuous() )
+    {
+        int cols = src.size[src.dims-1], rows = (int)(src.total()/cols);
+        src = Mat(rows, cols, src.type(), src.data);
+        dst = Mat(rows, cols, dst.type(), dst.data);
+    }
 
-    if (_src.dims() <= 2)
+    if (src.dims <= 2)
     {
         bool ok = false;
         Ptr<ParallelLoopBody> body;
@@ -5939,7 +6062,7 @@ void cv::LUT( InputArray _src, InputArray _lut, OutputArray _dst )
             }
             else
 #endif
-            if ((lutcn == 3 || lutcn == 4) && elemSize1 == 1)
+            if ((lutcn == 3 || lutcn == 4) && elemSize1 == 1 && is8bit)
             {
                 ParallelLoopBody* p = new ipp::IppLUTParallelBody_LUTCN(src, lut, dst, &ok);
                 body.reset(p);
@@ -5964,7 +6087,7 @@ void cv::LUT( InputArray _src, InputArray _lut, OutputArray _dst )
         }
     }
 
-    LUTFunc func = lutTab[lut.depth()];
+    LUTFunc func = getLUTFunc(depth, lut.depth());
     CV_Assert( func != 0 );
 
     const Mat* arrays[] = {&src, &dst, 0};
@@ -2571,134 +2571,181 @@ double cv::Mahalanobis( InputArray _v1, InputArray _v2, InputArray _icovar )
     return std::sqrt(result);
 }
 
-/****************************************************************************************\
-*                                        MulTransposed                                   *
-\****************************************************************************************/
-
 namespace cv
 {
 
-template<typename sT, typename dT> static void
-MulTransposedR( const Mat& srcmat, Mat& dstmat, const Mat& deltamat, double scale )
+class MahalanobisInvoker : public ParallelLoopBody
 {
-    int i, j, k;
-    const sT* src = srcmat.ptr<sT>();
-    dT* dst = dstmat.ptr<dT>();
-    const dT* delta = deltamat.ptr<dT>();
-    size_t srcstep = srcmat.step/sizeof(src[0]);
-    size_t dststep = dstmat.step/sizeof(dst[0]);
-    size_t deltastep = deltamat.rows > 1 ? deltamat.step/sizeof(delta[0]) : 0;
-    int delta_cols = deltamat.cols;
-    Size size = srcmat.size();
-    dT* tdst = dst;
-    dT* col_buf = 0;
-    dT* delta_buf = 0;
-    int buf_size = size.height*sizeof(dT);
-    AutoBuffer<uchar> buf;
+public:
+    MahalanobisInvoker( const Mat& _samples, const Mat& _mean, const Mat& _icovar, Mat& _dst )
+        : samples(&_samples), mean(&_mean), icovar(&_icovar), dst(&_dst) {}
 
-    if( delta && delta_cols < size.width )
+    void operator()( const Range& range ) const
     {
-        assert( delta_cols == 1 );
-        buf_size *= 5;
-    }
-    buf.allocate(buf_size);
-    col_buf = (dT*)(uchar*)buf;
+        int len = samples->cols;
+        Mat diff, t;
 
-    if( delta && delta_cols < size.width )
-    {
-        delta_buf = col_buf + size.height;
-        for( i = 0; i < size.height; i++ )
-            delta_buf[i*4] = delta_buf[i*4+1] =
-                delta_buf[i*4+2] = delta_buf[i*4+3] = delta[i*deltastep];
-        delta = delta_buf;
-        deltastep = deltastep ? 4 : 0;
-    }
-
-    if( !delta )
-        for( i = 0; i < size.width; i++, tdst += dststep )
+        for( int y0 = range.start; y0 < range.end; y0 += BLOCK_SIZE )
         {
-            for( k = 0; k < size.height; k++ )
-                col_buf[k] = src[k*srcstep+i];
+            int y1 = std::min(y0 + BLOCK_SIZE, range.end);
+            samples->rowRange(y0, y1).convertTo(diff, CV_64F);
+            for( int i = 0; i < diff.rows; i++ )
+            {
+                double* d = diff.ptr<double>(i);
+                const double* m = mean->ptr<double>();
+                for( int j = 0; j < len; j++ )
+                    d[j] -= m[j];
+            }
+            gemm(diff, *icovar, 1, noArray(), 0, t);
 
-            for( j = i; j <= size.width - 4; j += 4 )
+            for( int i = 0; i < diff.rows; i++ )
             {
-                double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
-                const sT *tsrc = src + j;
+                const double* d = diff.ptr<double>(i);
+                const double* ti = t.ptr<double>(i);
+                double s = 0;
+                for( int j = 0; j < len; j++ )
+                    s += d[j]*ti[j];
+                s = std::sqrt(s);
+                if( dst->depth() == CV_32F )
+                    dst->at<float>(y0 + i) = (float)s;
+                else
+                    dst->at<double>(y0 + i) = s;
+            }
+        }
+    }
 
-                for( k = 0; k < size.height; k++, tsrc += srcstep )
-                {
-                    double a = col_buf[k];
-                    s0 += a * tsrc[0];
-                    s1 += a * tsrc[1];
-                    s2 += a * tsrc[2];
-                    s3 += a * tsrc[3];
-                }
+private:
+    enum { BLOCK_SIZE = 64 };
 
-                tdst[j] = (dT)(s0*scale);
-                tdst[j+1] = (dT)(s1*scale);
-                tdst[j+2] = (dT)(s2*scale);
-                tdst[j+3] = (dT)(s3*scale);
-            }
+    const Mat* samples;
+    const Mat* mean;
+    const Mat* icovar;
+    Mat* dst;
+};
 
-            for( ; j < size.width; j++ )
-            {
-                double s0 = 0;
-                const sT *tsrc = src + j;
+}
 
-                for( k = 0; k < size.height; k++, tsrc += srcstep )
-                    s0 += (double)col_buf[k] * tsrc[0];
+void cv::MahalanobisBatch( InputArray _samples, InputArray _mean, InputArray _icovar, OutputArray _dst )
+{
+    Mat samples = _samples.getMat(), mean = _mean.getMat(), icovar = _icovar.getMat();
+    int type = samples.type(), depth = samples.depth();
+    int len = samples.cols;
 
-                tdst[j] = (dT)(s0*scale);
-            }
-        }
-    else
-        for( i = 0; i < size.width; i++, tdst += dststep )
+    CV_Assert( (depth == CV_32F || depth == CV_64F) && samples.channels() == 1 &&
+        type == mean.type() && type == icovar.type() &&
+        mean.total() == (size_t)len && icovar.rows == len && icovar.cols == len );
+
+    _dst.create(samples.rows, 1, depth);
+    Mat dst = _dst.getMat();
+    if( samples.rows == 0 )
+        return;
+
+    Mat mean64f, icovar64f;
+    mean.reshape(1, 1).convertTo(mean64f, CV_64F);
+    icovar.convertTo(icovar64f, CV_64F);
+
+    MahalanobisInvoker invoker(samples, mean64f, icovar64f, dst);
+    parallel_for_(Range(0, samples.rows), invoker,
+                  (double)samples.rows*len*len/(1 << 16));
+}
+
+/****************************************************************************************\
+*                                        MulTransposed                                   *
+\****************************************************************************************/
+
+namespace cv
+{
+
+// The samples (rows of src) are split into a fixed number of blocks; every block accumulates
+// the upper triangle of its own (src - delta)^T*(src - delta) in double precision and the partial
+// sums are then added in the block order, so the result does not depend on the number of threads.
+enum { MULTRANS_MIN_BLOCK = 1024, MULTRANS_MAX_BLOCKS = 64, MULTRANS_MAX_BUF = 1 << 23 };
+
+template<typename sT, typename dT> class MulTransposedRInvoker : public ParallelLoopBody
+{
+public:
+    MulTransposedRInvoker( const Mat& _src, const Mat& _delta, Mat* _partial, int _blockSize )
+        : src(&_src), delta(&_delta), partial(_partial), blockSize(_blockSize) {}
+
+    void operator()( const Range& range ) const
+    {
+        int i, j, k, n = src->cols;
+        bool deltaRow = delta->cols == n;
+        AutoBuffer<double> _buf(n);
+        double* buf = _buf;
+
+        for( int p = range.start; p < range.end; p++ )
         {
-            if( !delta_buf )
-                for( k = 0; k < size.height; k++ )
-                    col_buf[k] = src[k*srcstep+i] - delta[k*deltastep+i];
-            else
-                for( k = 0; k < size.height; k++ )
-                    col_buf[k] = src[k*srcstep+i] - delta_buf[k*deltastep];
+            Mat& acc = partial[p];
+            acc = Mat::zeros(n, n, CV_64F);
+            int k1 = std::min((p + 1)*blockSize, src->rows);
 
-            for( j = i; j <= size.width - 4; j += 4 )
+            for( k = p*blockSize; k < k1; k++ )
             {
-                double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
-                const sT *tsrc = src + j;
-                const dT *d = delta_buf ? delta_buf : delta + j;
-
-                for( k = 0; k < size.height; k++, tsrc+=srcstep, d+=deltastep )
+                const sT* s = src->ptr<sT>(k);
+                if( delta->empty() )
+                    for( j = 0; j < n; j++ )
+                        buf[j] = s[j];
+                else
                 {
-                    double a = col_buf[k];
-                    s0 += a * (tsrc[0] - d[0]);
-                    s1 += a * (tsrc[1] - d[1]);
-                    s2 += a * (tsrc[2] - d[2]);
-                    s3 += a * (tsrc[3] - d[3]);
+                    const dT* d = delta->ptr<dT>(delta->rows > 1 ? k : 0);
+                    if( deltaRow )
+                        for( j = 0; j < n; j++ )
+                            buf[j] = (double)s[j] - d[j];
+                    else
+                        for( j = 0; j < n; j++ )
+                            buf[j] = (double)s[j] - d[0];
                 }
 
-                tdst[j] = (dT)(s0*scale);
-                tdst[j+1] = (dT)(s1*scale);
-                tdst[j+2] = (dT)(s2*scale);
-                tdst[j+3] = (dT)(s3*scale);
+                // rank-1 update of the upper triangle
+                for( i = 0; i < n; i++ )
+                {
+                    double a = buf[i];
+                    double* arow = acc.ptr<double>(i);
+                    for( j = i; j < n; j++ )
+                        arow[j] += a*buf[j];
+                }
             }
+        }
+    }
 
-            for( ; j < size.width; j++ )
-            {
-                double s0 = 0;
-                const sT *tsrc = src + j;
-                const dT *d = delta_buf ? delta_buf : delta + j;
+private:
+    const Mat* src;
+    const Mat* delta;
+    Mat* partial;
+    int blockSize;
+};
 
-                for( k = 0; k < size.height; k++, tsrc+=srcstep, d+=deltastep )
-                    s0 += (double)col_buf[k] * (tsrc[0] - d[0]);
+template<typename sT, typename dT> static void
+MulTransposedR( const Mat& srcmat, Mat& dstmat, const Mat& deltamat, double scale )
+{
+    int i, j, n = srcmat.cols, nsamples = srcmat.rows;
+    int maxBlocks = (int)std::max(std::min((double)MULTRANS_MAX_BLOCKS,
+                                           (double)MULTRANS_MAX_BUF/((double)n*n)), 1.);
+    int nblocks = std::max(std::min((nsamples + MULTRANS_MIN_BLOCK - 1)/MULTRANS_MIN_BLOCK, maxBlocks), 1);
+    int blockSize = (nsamples + nblocks - 1)/nblocks;
+    nblocks = (nsamples + blockSize - 1)/blockSize;
 
-                tdst[j] = (dT)(s0*scale);
-            }
-        }
+    std::vector<Mat> partial(nblocks);
+    MulTransposedRInvoker<sT, dT> invoker(srcmat, deltamat, &partial[0], blockSize);
+    parallel_for_(Range(0, nblocks), invoker, nblocks);
+
+    Mat& sum = partial[0];
+    for( int p = 1; p < nblocks; p++ )
+        sum += partial[p];
+
+    for( i = 0; i < n; i++ )
+    {
+        const double* srow = sum.ptr<double>(i);
+        dT* drow = dstmat.ptr<dT>(i);
+        for( j = i; j < n; j++ )
+            drow[j] = (dT)(srow[j]*scale);
+    }
 }
 
 
 template<typename sT, typename dT> static void
-MulTransposedL( const Mat& srcmat, Mat& dstmat, const Mat& deltamat, double scale )
+MulTransposedL_( const Mat& srcmat, Mat& dstmat, const Mat& deltamat, double scale, const Range& range )
 {
     int i, j, k;
     const sT* src = srcmat.ptr<sT>();
@@ -2709,10 +2756,10 @@ MulTransposedL( const Mat& srcmat, Mat& dstmat, const Mat& deltamat, double scal
     size_t deltastep = deltamat.rows > 1 ? deltamat.step/sizeof(delta[0]) : 0;
     int delta_cols = deltamat.cols;
     Size size = srcmat.size();
-    dT* tdst = dst;
+    dT* tdst = dst + range.start*dststep;
 
     if( !delta )
-        for( i = 0; i < size.height; i++, tdst += dststep )
+        for( i = range.start; i < range.end; i++, tdst += dststep )
             for( j = i; j < size.height; j++ )
             {
                 double s = 0;
@@ -2733,7 +2780,7 @@ MulTransposedL( const Mat& srcmat, Mat& dstmat, const Mat& deltamat, double scal
         AutoBuffer<uchar> buf(size.width*sizeof(dT));
         dT* row_buf = (dT*)(uchar*)buf;
 
-        for( i = 0; i < size.height; i++, tdst += dststep )
+        for( i = range.start; i < range.end; i++, tdst += dststep )
         {
             const sT *tsrc1 = src + i*srcstep;
             const dT *tdelta1 = delta + i*deltastep;
@@ -2769,6 +2816,37 @@ MulTransposedL( const Mat& srcmat, Mat& dstmat, const Mat& deltamat, double scal
     }
 }
 
+template<typename sT, typename dT> class MulTransposedLInvoker : public ParallelLoopBody
+{
+public:
+    MulTransposedLInvoker( const Mat& _src, Mat& _dst, const Mat& _delta, double _scale )
+        : src(&_src), dst(&_dst), delta(&_delta), scale(_scale) {}
+
+    void operator()( const Range& range ) const
+    {
+        MulTransposedL_<sT, dT>(*src, *dst, *delta, scale, range);
+    }
+
+private:
+    const Mat* src;
+    Mat* dst;
+    const Mat* delta;
+    double scale;
+};
+
+template<typename sT, typename dT> static void
+MulTransposedL( const Mat& srcmat, Mat& dstmat, const Mat& deltamat, double scale )
+{
+    // only the upper triangle is computed, so the row i takes (rows - i) dot products;
+    // the rows are processed in many small stripes to balance the load
+    MulTransposedLInvoker<sT, dT> invoker(srcmat, dstmat, deltamat, scale);
+    double work = (double)srcmat.rows*srcmat.rows*srcmat.cols*0.5;
+    if( work < (double)(1 << 18) )
+        invoker(Range(0, srcmat.rows));
+    else
+        parallel_for_(Range(0, srcmat.rows), invoker, std::min((double)srcmat.rows, work/(1 << 16)));
+}
+
 typedef void (*MulTransposedFunc)(const Mat& src, Mat& dst, const Mat& delta, double scale);
 
 }
@@ -2795,6 +2873,13 @@ void cv::mulTransposed( InputArray _src, OutputArray _dst, bool ata,
     _dst.create( dsize, dsize, dtype );
     Mat dst = _dst.getMat();
 
+    if( src.rows == 0 || src.cols == 0 )
+    {
+        // no samples or no features: the sum of products is empty
+        dst = Scalar::all(0);
+        return;
+    }
+
     if( src.data == dst.data || (stype == dtype &&
         (dst.cols >= gemm_level && dst.rows >= gemm_level &&
          src.cols >= gemm_level && src.rows >= gemm_level)))
@@ -4547,6 +4547,18 @@ convertData_(const void* _from, void* _to, int cn)
             to[i] = saturate_cast<T2>(from[i]);
 }
 
+template<typename T> void
+addData_(const void* _from, void* _to, int cn)
+{
+    const T* from = (const T*)_from;
+    T* to = (T*)_to;
+    if( cn == 1 )
+        *to = saturate_cast<T>(*to + *from);
+    else
+        for( int i = 0; i < cn; i++ )
+            to[i] = saturate_cast<T>(to[i] + from[i]);
+}
+
 template<typename T1, typename T2> void
 convertScaleData_(const void* _from, void* _to, int cn, double alpha, double beta)
 {
@@ -4607,6 +4619,19 @@ static ConvertData getConvertElem(int fromType, int toType)
     return func;
 }
 
+static ConvertData getAddElem(int type)
+{
+    static ConvertData tab[] =
+    {
+        addData_<uchar>, addData_<schar>, addData_<ushort>, addData_<short>,
+        addData_<int>, addData_<float>, addData_<double>, 0
+    };
+
+    ConvertData func = tab[CV_MAT_DEPTH(type)];
+    CV_Assert( func != 0 );
+    return func;
+}
+
 static ConvertScaleData getConvertScaleElem(int fromType, int toType)
 {
     static ConvertScaleData tab[][8] =
@@ -4654,6 +4679,9 @@ static ConvertScaleData getConvertScaleElem(int fromType, int toType)
 
 enum { HASH_SIZE0 = 8 };
 
+// the maximal fill factor of the sparse matrix hash table
+enum { HASH_MAX_FILL_NUM = 1, HASH_MAX_FILL_DEN = 2 };
+
 static inline void copyElem(const uchar* from, uchar* to, size_t elemSize)
 {
     size_t i;
@@ -4680,8 +4708,10 @@ SparseMat::Hdr::Hdr( int _dims, const int* _sizes, int _type )
     refcount = 1;
 
     dims = _dims;
-    valueOffset = (int)alignSize(sizeof(SparseMat::Node) +
-        sizeof(int)*std::max(dims - CV_MAX_DIM, 0), CV_ELEM_SIZE1(_type));
+    // only the first dims elements of Node::idx are stored (at least 2, since 1D matrices
+    // are converted to dense Nx1 matrices), so the nodes are tightly packed in the pool
+    valueOffset = (int)alignSize(offsetof(SparseMat::Node, idx) + sizeof(int)*std::max(dims, 2),
+                                 CV_ELEM_SIZE1(_type));
     nodeSize = alignSize(valueOffset +
         CV_ELEM_SIZE(_type), (int)sizeof(size_t));
 
@@ -4882,18 +4912,30 @@ void SparseMat::clear()
         hdr->clear();
 }
 
+// The hash table uses open addressing with linear probing: each entry keeps the pool offset of
+// a single node (0 for an empty entry) and Node::next of the stored nodes is always 0.
+// Since the hash values of neighbor elements differ only in the lowest bits, they are scrambled
+// before taking the entry index to avoid long clusters of occupied entries.
+static inline size_t hashIndex(size_t h, size_t mask)
+{
+    h ^= h >> 16;
+    h *= (size_t)0x45d9f3b;
+    h ^= h >> 16;
+    return h & mask;
+}
+
 uchar* SparseMat::ptr(int i0, bool createMissing, size_t* hashval)
 {
     CV_Assert( hdr && hdr->dims == 1 );
     size_t h = hashval ? *hashval : hash(i0);
-    size_t hidx = h & (hdr->hashtab.size() - 1), nidx = hdr->hashtab[hidx];
+    size_t hmask = hdr->hashtab.size() - 1, hidx = hashIndex(h, hmask), nidx;
+    const size_t* htab = &hdr->hashtab[0];
     uchar* pool = &hdr->pool[0];
-    while( nidx != 0 )
+    for( ; (nidx = htab[hidx]) != 0; hidx = (hidx + 1) & hmask )
     {
         Node* elem = (Node*)(pool + nidx);
         if( elem->hashval == h && elem->idx[0] == i0 )
             return &value<uchar>(elem);
-        nidx = elem->next;
     }
 
     if( createMissing )
@@ -4908,14 +4950,14 @@ uchar* SparseMat::ptr(int i0, int i1, bool createMissing, size_t* hashval)
 {
     CV_Assert( hdr && hdr->dims == 2 );
     size_t h = hashval ? *hashval : hash(i0, i1);
-    size_t hidx = h & (hdr->hashtab.size() - 1), nidx = hdr->hashtab[hidx];
+    size_t hmask = hdr->hashtab.size() - 1, hidx = hashIndex(h, hmask), nidx;
+    const size_t* htab = &hdr->hashtab[0];
     uchar* pool = &hdr->pool[0];
-    while( nidx != 0 )
+    for( ; (nidx = htab[hidx]) != 0; hidx = (hidx + 1) & hmask )
     {
         Node* elem = (Node*)(pool + nidx);
         if( elem->hashval == h && elem->idx[0] == i0 && elem->idx[1] == i1 )
             return &value<uchar>(elem);
-        nidx = elem->next;
     }
 
     if( createMissing )
@@ -4930,15 +4972,15 @@ uchar* SparseMat::ptr(int i0, int i1, int i2, bool createMissing, size_t* hashva
 {
     CV_Assert( hdr && hdr->dims == 3 );
     size_t h = hashval ? *hashval : hash(i0, i1, i2);
-    size_t hidx = h & (hdr->hashtab.size() - 1), nidx = hdr->hashtab[hidx];
+    size_t hmask = hdr->hashtab.size() - 1, hidx = hashIndex(h, hmask), nidx;
+    const size_t* htab = &hdr->hashtab[0];
     uchar* pool = &hdr->pool[0];
-    while( nidx != 0 )
+    for( ; (nidx = htab[hidx]) != 0; hidx = (hidx + 1) & hmask )
     {
         Node* elem = (Node*)(pool + nidx);
         if( elem->hashval == h && elem->idx[0] == i0 &&
             elem->idx[1] == i1 && elem->idx[2] == i2 )
             return &value<uchar>(elem);
-        nidx = elem->next;
     }
 
     if( createMissing )
@@ -4954,9 +4996,10 @@ uchar* SparseMat::ptr(const int* idx, bool createMissing, size_t* hashval)
     CV_Assert( hdr );
     int i, d = hdr->dims;
     size_t h = hashval ? *hashval : hash(idx);
-    size_t hidx = h & (hdr->hashtab.size() - 1), nidx = hdr->hashtab[hidx];
+    size_t hmask = hdr->hashtab.size() - 1, hidx = hashIndex(h, hmask), nidx;
+    const size_t* htab = &hdr->hashtab[0];
     uchar* pool = &hdr->pool[0];
-    while( nidx != 0 )
+    for( ; (nidx = htab[hidx]) != 0; hidx = (hidx + 1) & hmask )
     {
         Node* elem = (Node*)(pool + nidx);
         if( elem->hashval == h )
@@ -4967,7 +5010,6 @@ uchar* SparseMat::ptr(const int* idx, bool createMissing, size_t* hashval)
             if( i == d )
                 return &value<uchar>(elem);
         }
-        nidx = elem->next;
     }
 
     return createMissing ? newNode(idx, h) : 0;
@@ -4977,39 +5019,35 @@ void SparseMat::erase(int i0, int i1, size_t* hashval)
 {
     CV_Assert( hdr && hdr->dims == 2 );
     size_t h = hashval ? *hashval : hash(i0, i1);
-    size_t hidx = h & (hdr->hashtab.size() - 1), nidx = hdr->hashtab[hidx], previdx=0;
+    size_t hmask = hdr->hashtab.size() - 1, hidx = hashIndex(h, hmask), nidx;
     uchar* pool = &hdr->pool[0];
-    while( nidx != 0 )
+    for( ; (nidx = hdr->hashtab[hidx]) != 0; hidx = (hidx + 1) & hmask )
     {
         Node* elem = (Node*)(pool + nidx);
         if( elem->hashval == h && elem->idx[0] == i0 && elem->idx[1] == i1 )
             break;
-        previdx = nidx;
-        nidx = elem->next;
     }
 
     if( nidx )
-        removeNode(hidx, nidx, previdx);
+        removeNode(hidx, nidx, 0);
 }
 
 void SparseMat::erase(int i0, int i1, int i2, size_t* hashval)
 {
     CV_Assert( hdr && hdr->dims == 3 );
     size_t h = hashval ? *hashval : hash(i0, i1, i2);
-    size_t hidx = h & (hdr->hashtab.size() - 1), nidx = hdr->hashtab[hidx], previdx=0;
+    size_t hmask = hdr->hashtab.size() - 1, hidx = hashIndex(h, hmask), nidx;
     uchar* pool = &hdr->pool[0];
-    while( nidx != 0 )
+    for( ; (nidx = hdr->hashtab[hidx]) != 0; hidx = (hidx + 1) & hmask )
     {
         Node* elem = (Node*)(pool + nidx);
         if( elem->hashval == h && elem->idx[0] == i0 &&
             elem->idx[1] == i1 && elem->idx[2] == i2 )
             break;
-        previdx = nidx;
-        nidx = elem->next;
     }
 
     if( nidx )
-        removeNode(hidx, nidx, previdx);
+        removeNode(hidx, nidx, 0);
 }
 
 void SparseMat::erase(const int* idx, size_t* hashval)
@@ -5017,9 +5055,9 @@ void SparseMat::erase(const int* idx, size_t* hashval)
     CV_Assert( hdr );
     int i, d = hdr->dims;
     size_t h = hashval ? *hashval : hash(idx);
-    size_t hidx = h & (hdr->hashtab.size() - 1), nidx = hdr->hashtab[hidx], previdx=0;
+    size_t hmask = hdr->hashtab.size() - 1, hidx = hashIndex(h, hmask), nidx;
     uchar* pool = &hdr->pool[0];
-    while( nidx != 0 )
+    for( ; (nidx = hdr->hashtab[hidx]) != 0; hidx = (hidx + 1) & hmask )
     {
         Node* elem = (Node*)(pool + nidx);
         if( elem->hashval == h )
@@ -5030,12 +5068,10 @@ void SparseMat::erase(const int* idx, size_t* hashval)
             if( i == d )
                 break;
         }
-        previdx = nidx;
-        nidx = elem->next;
     }
 
     if( nidx )
-        removeNode(hidx, nidx, previdx);
+        removeNode(hidx, nidx, 0);
 }
 
 void SparseMat::resizeHashTab(size_t newsize)
@@ -5043,35 +5079,53 @@ void SparseMat::resizeHashTab(size_t newsize)
     newsize = std::max(newsize, (size_t)8);
     if((newsize & (newsize-1)) != 0)
         newsize = (size_t)1 << cvCeil(std::log((double)newsize)/CV_LOG2);
+    // the table can not be filled completely, since empty entries terminate the search
+    CV_Assert( newsize > hdr->nodeCount );
 
-    size_t i, hsize = hdr->hashtab.size();
-    std::vector<size_t> _newh(newsize);
+    size_t i, hsize = hdr->hashtab.size(), newmask = newsize - 1;
+    std::vector<size_t> _newh(newsize, (size_t)0);
     size_t* newh = &_newh[0];
-    for( i = 0; i < newsize; i++ )
-        newh[i] = 0;
-    uchar* pool = &hdr->pool[0];
+    const uchar* pool = &hdr->pool[0];
     for( i = 0; i < hsize; i++ )
     {
         size_t nidx = hdr->hashtab[i];
-        while( nidx )
+        if( nidx )
         {
-            Node* elem = (Node*)(pool + nidx);
-            size_t next = elem->next;
-            size_t newhidx = elem->hashval & (newsize - 1);
-            elem->next = newh[newhidx];
+            size_t newhidx = hashIndex(((const Node*)(pool + nidx))->hashval, newmask);
+            while( newh[newhidx] )
+                newhidx = (newhidx + 1) & newmask;
             newh[newhidx] = nidx;
-            nidx = next;
         }
     }
-    hdr->hashtab = _newh;
+    hdr->hashtab.swap(_newh);
+}
+
+void SparseMat::reserve(size_t nz)
+{
+    CV_Assert( hdr );
+    size_t hsize = hdr->hashtab.size(), nsz = hdr->nodeSize;
+    if( nz*HASH_MAX_FILL_DEN > hsize*HASH_MAX_FILL_NUM )
+        resizeHashTab(nz*HASH_MAX_FILL_DEN/HASH_MAX_FILL_NUM + 1);
+
+    size_t psize = hdr->pool.size(), newpsize = (nz + 1)*nsz;
+    if( newpsize <= psize )
+        return;
+
+    // append the new nodes to the free list
+    hdr->pool.resize(newpsize);
+    uchar* pool = &hdr->pool[0];
+    size_t i, first = std::max(psize, nsz);
+    for( i = first; i < newpsize - nsz; i += nsz )
+        ((Node*)(pool + i))->next = i + nsz;
+    ((Node*)(pool + i))->next = hdr->freeList;
+    hdr->freeList = first;
 }
 
 uchar* SparseMat::newNode(const int* idx, size_t hashval)
 {
-    const int HASH_MAX_FILL_FACTOR=3;
     assert(hdr);
     size_t hsize = hdr->hashtab.size();
-    if( ++hdr->nodeCount > hsize*HASH_MAX_FILL_FACTOR )
+    if( ++hdr->nodeCount*HASH_MAX_FILL_DEN > hsize*HASH_MAX_FILL_NUM )
     {
         resizeHashTab(std::max(hsize*2, (size_t)8));
         hsize = hdr->hashtab.size();
@@ -5092,13 +5146,18 @@ uchar* SparseMat::newNode(const int* idx, size_t hashval)
     Node* elem = (Node*)&hdr->pool[nidx];
     hdr->freeList = elem->next;
     elem->hashval = hashval;
-    size_t hidx = hashval & (hsize - 1);
-    elem->next = hdr->hashtab[hidx];
-    hdr->hashtab[hidx] = nidx;
+    elem->next = 0;
+    size_t hmask = hsize - 1, hidx = hashIndex(hashval, hmask);
+    size_t* htab = &hdr->hashtab[0];
+    while( htab[hidx] )
+        hidx = (hidx + 1) & hmask;
+    htab[hidx] = nidx;
 
     int i, d = hdr->dims;
     for( i = 0; i < d; i++ )
         elem->idx[i] = idx[i];
+    if( d == 1 )
+        elem->idx[1] = 0;
     size_t esz = elemSize();
     uchar* p = &value<uchar>(elem);
     if( esz == sizeof(float) )
@@ -5112,19 +5171,152 @@ uchar* SparseMat::newNode(const int* idx, size_t hashval)
 }
 
 
-void SparseMat::removeNode(size_t hidx, size_t nidx, size_t previdx)
+void SparseMat::removeNode(size_t hidx, size_t nidx, size_t)
 {
     Node* n = node(nidx);
-    if( previdx )
-    {
-        Node* prev = node(previdx);
-        prev->next = n->next;
-    }
-    else
-        hdr->hashtab[hidx] = n->next;
     n->next = hdr->freeList;
     hdr->freeList = nidx;
     --hdr->nodeCount;
+
+    // shift back the following entries of the cluster that can not be found
+    // anymore when the hidx-th entry becomes empty
+    size_t* htab = &hdr->hashtab[0];
+    size_t hmask = hdr->hashtab.size() - 1, j = hidx;
+    for(;;)
+    {
+        htab[hidx] = 0;
+        for(;;)
+        {
+            j = (j + 1) & hmask;
+            size_t jidx = htab[j];
+            if( !jidx )
+                return;
+            size_t k = hashIndex(node(jidx)->hashval, hmask);
+            // move the entry if its home position k is not cyclically within (hidx, j]
+            if( hidx <= j ? (hidx < k && k <= j) : (hidx < k || k <= j) )
+                continue;
+            htab[hidx] = jidx;
+            hidx = j;
+            break;
+        }
+    }
+}
+
+
+void SparseMat::insert(InputArray _idx, InputArray _values, bool accumulate)
+{
+    CV_Assert( hdr );
+    Mat idx = _idx.getMat(), values = _values.getMat();
+    int d = hdr->dims, cn = channels();
+    size_t i, N = idx.total()*idx.channels()/d, esz = elemSize();
+    CV_Assert( idx.depth() == CV_32S && idx.isContinuous() && N*d == idx.total()*idx.channels() );
+    CV_Assert( values.depth() == depth() && values.isContinuous() &&
+               values.total()*values.channels() == N*cn );
+
+    reserve(hdr->nodeCount + N);
+
+    const int* iptr = idx.ptr<int>();
+    const uchar* vptr = values.ptr();
+    ConvertData addfunc = accumulate ? getAddElem(type()) : 0;
+
+    for( i = 0; i < N; i++, iptr += d, vptr += esz )
+    {
+        uchar* to = ptr(iptr, true);
+        if( addfunc )
+            addfunc( vptr, to, cn );
+        else
+            copyElem( vptr, to, esz );
+    }
+}
+
+namespace
+{
+
+struct SparseNodeColLess
+{
+    SparseNodeColLess(const uchar* _pool) : pool(_pool) {}
+    bool operator()(size_t a, size_t b) const
+    {
+        return ((const SparseMat::Node*)(pool + a))->idx[1] < ((const SparseMat::Node*)(pool + b))->idx[1];
+    }
+    const uchar* pool;
+};
+
+class SparseToCSRInvoker : public ParallelLoopBody
+{
+public:
+    SparseToCSRInvoker(const SparseMat& _src, size_t* _order, const int* _rowPtr,
+                       int* _colIdx, uchar* _values)
+        : src(&_src), order(_order), rowPtr(_rowPtr), colIdx(_colIdx), values(_values) {}
+
+    void operator()(const Range& range) const
+    {
+        const uchar* pool = &src->hdr->pool[0];
+        size_t esz = src->elemSize(), valueOffset = src->hdr->valueOffset;
+        SparseNodeColLess cmp(pool);
+
+        for( int i = range.start; i < range.end; i++ )
+        {
+            int k, k0 = rowPtr[i], k1 = rowPtr[i+1];
+            std::sort(order + k0, order + k1, cmp);
+            for( k = k0; k < k1; k++ )
+            {
+                const uchar* n = pool + order[k];
+                colIdx[k] = ((const SparseMat::Node*)n)->idx[1];
+                copyElem( n + valueOffset, values + k*esz, esz );
+            }
+        }
+    }
+
+private:
+    const SparseMat* src;
+    size_t* order;
+    const int* rowPtr;
+    int* colIdx;
+    uchar* values;
+};
+
+}
+
+void SparseMat::convertToCSR(OutputArray _values, OutputArray _colIdx, OutputArray _rowPtr) const
+{
+    CV_Assert( hdr && hdr->dims == 2 );
+    int i, rows = hdr->size[0];
+    size_t k, nz = nzcount();
+
+    _rowPtr.create(1, rows + 1, CV_32S);
+    _colIdx.create(1, (int)nz, CV_32S);
+    _values.create(1, (int)nz, type());
+    Mat rowPtr = _rowPtr.getMat(), colIdx = _colIdx.getMat(), values = _values.getMat();
+    int* rptr = rowPtr.ptr<int>();
+    if( nz == 0 )
+    {
+        memset(rptr, 0, (rows + 1)*sizeof(int));
+        return;
+    }
+
+    // counting sort of the nodes by the row index
+    AutoBuffer<int> _pos(rows + 1);
+    int* pos = _pos;
+    memset(pos, 0, (rows + 1)*sizeof(int));
+    SparseMatConstIterator from = begin();
+    for( k = 0; k < nz; k++, ++from )
+        pos[from.node()->idx[0] + 1]++;
+    for( i = 0; i < rows; i++ )
+        pos[i+1] += pos[i];
+    memcpy(rptr, pos, (rows + 1)*sizeof(int));
+
+    std::vector<size_t> order(nz);
+    const uchar* pool = &hdr->pool[0];
+    from = begin();
+    for( k = 0; k < nz; k++, ++from )
+    {
+        const Node* n = from.node();
+        order[pos[n->idx[0]]++] = (const uchar*)n - pool;
+    }
+
+    parallel_for_(Range(0, rows), SparseToCSRInvoker(*this, &order[0], rptr,
+                  colIdx.ptr<int>(), values.ptr()), nz/(double)(1<<16));
 }
 
 
@@ -5302,6 +5494,95 @@ void normalize( const SparseMat& src, SparseMat& dst, double a, int norm_type )
     src.convertTo( dst, -1, scale );
 }
 
+namespace
+{
+
+template<typename T> class SparseGemmInvoker : public ParallelLoopBody
+{
+public:
+    SparseGemmInvoker(const Mat& _values, const Mat& _colIdx, const Mat& _rowPtr,
+                      const Mat& _src2, double _alpha, const Mat& _src3, double _beta, Mat& _dst)
+        : values(_values.ptr<T>()), colIdx(_colIdx.ptr<int>()), rowPtr(_rowPtr.ptr<int>()),
+          src2(&_src2), src3(&_src3), dst(&_dst), alpha(_alpha), beta(_beta) {}
+
+    void operator()(const Range& range) const
+    {
+        int j, n = dst->cols;
+        for( int i = range.start; i < range.end; i++ )
+        {
+            T* d = dst->ptr<T>(i);
+            if( beta != 0 )
+            {
+                const T* c = src3->ptr<T>(i);
+                for( j = 0; j < n; j++ )
+                    d[j] = (T)(c[j]*beta);
+            }
+            else
+                for( j = 0; j < n; j++ )
+                    d[j] = 0;
+
+            for( int k = rowPtr[i]; k < rowPtr[i+1]; k++ )
+            {
+                T a = (T)(values[k]*alpha);
+                const T* b = src2->ptr<T>(colIdx[k]);
+                for( j = 0; j <= n - 4; j += 4 )
+                {
+                    T t0 = d[j] + a*b[j], t1 = d[j+1] + a*b[j+1];
+                    d[j] = t0; d[j+1] = t1;
+                    t0 = d[j+2] + a*b[j+2]; t1 = d[j+3] + a*b[j+3];
+                    d[j+2] = t0; d[j+3] = t1;
+                }
+                for( ; j < n; j++ )
+                    d[j] += a*b[j];
+            }
+        }
+    }
+
+private:
+    const T* values;
+    const int* colIdx;
+    const int* rowPtr;
+    const Mat* src2;
+    const Mat* src3;
+    Mat* dst;
+    double alpha, beta;
+};
+
+}
+
+void gemm( const SparseMat& src1, InputArray _src2, double alpha, InputArray _src3, double beta, OutputArray _dst )
+{
+    int type = src1.type();
+    CV_Assert( src1.dims() == 2 && (type == CV_32F || type == CV_64F) );
+
+    Mat src2 = _src2.getMat(), src3;
+    CV_Assert( src2.type() == type && src2.rows == src1.size(1) );
+    Size dsize(src2.cols, src1.size(0));
+    if( beta != 0 )
+    {
+        src3 = _src3.getMat();
+        CV_Assert( src3.type() == type && src3.size() == dsize );
+    }
+
+    Mat values, colIdx, rowPtr;
+    src1.convertToCSR(values, colIdx, rowPtr);
+
+    _dst.create(dsize, type);
+    // the rows of src2 are read while dst is written, so in-place operation needs a separate buffer
+    Mat dst = _dst.getMat(), buf = dst.data == src2.data ? Mat(dsize, type) : dst;
+
+    double nstripes = (double)(values.total() + dsize.height)*dsize.width/(1<<16);
+    if( type == CV_32F )
+        parallel_for_(Range(0, dsize.height), SparseGemmInvoker<float>(values, colIdx, rowPtr,
+                      src2, alpha, src3, beta, buf), nstripes);
+    else
+        parallel_for_(Range(0, dsize.height), SparseGemmInvoker<double>(values, colIdx, rowPtr,
+                      src2, alpha, src3, beta, buf), nstripes);
+
+    if( buf.data != dst.data )
+        buf.copyTo(dst);
+}
+
 ////////////////////// RotatedRect //////////////////////
 
 RotatedRect::RotatedRect(const Point2f& _point1, const Point2f& _point2, const Point2f& _point3)
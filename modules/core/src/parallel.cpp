@@ -42,6 +42,8 @@
 
 #include "precomp.hpp"
 
+#include <deque>
+
 #if defined WIN32 || defined WINCE
     #include <windows.h>
     #undef small
@@ -61,6 +63,12 @@
     #endif
 #endif
 
+#if !(defined WIN32 || defined _WIN32 || defined WINCE)
+    #include <pthread.h>
+    #include <errno.h>
+    #include <sys/time.h>
+#endif
+
 #ifdef _OPENMP
     #define HAVE_OPENMP
 #endif
@@ -228,6 +236,16 @@ static SchedPtr pplScheduler;
 
 #endif // CV_PARALLEL_FRAMEWORK
 
+// the number of threads requested for cv::async_ tasks, see setNumThreads;
+// written and read only under getAsyncMutex() since tasks can be enqueued from any thread
+static int asyncNumThreads = -1;
+
+static cv::Mutex& getAsyncMutex()
+{
+    static cv::Mutex m;
+    return m;
+}
+
 } //namespace
 
 /* ================================   parallel_for_  ================================ */
@@ -349,6 +367,10 @@ void cv::setNumThreads( int threads )
 #ifdef CV_PARALLEL_FRAMEWORK
     numThreads = threads;
 #endif
+    {
+        cv::AutoLock lock(getAsyncMutex());
+        asyncNumThreads = threads;
+    }
 
 #ifdef HAVE_TBB
 
@@ -505,6 +527,483 @@ const char* cv::currentParallelFramework() {
 #endif
 }
 
+/* ================================   async_  ================================ */
+
+namespace
+{
+
+#if defined WIN32 || defined _WIN32 || defined WINCE
+
+class AsyncEvent
+{
+public:
+    AsyncEvent()
+    {
+#ifdef HAVE_WINRT
+        handle = CreateEventEx(NULL, NULL, CREATE_EVENT_MANUAL_RESET, EVENT_ALL_ACCESS);
+#else
+        handle = CreateEvent(NULL, TRUE, FALSE, NULL);
+#endif
+    }
+    ~AsyncEvent() { CloseHandle(handle); }
+
+    void set() { SetEvent(handle); }
+    bool wait(double timeoutMs)
+    {
+        DWORD ms = timeoutMs < 0 ? INFINITE : (DWORD)cvCeil(timeoutMs);
+        return WaitForSingleObjectEx(handle, ms, FALSE) == WAIT_OBJECT_0;
+    }
+
+private:
+    HANDLE handle;
+};
+
+#else
+
+class AsyncEvent
+{
+public:
+    AsyncEvent() : signaled(false)
+    {
+        pthread_mutex_init(&mt, 0);
+        pthread_cond_init(&cond, 0);
+    }
+    ~AsyncEvent()
+    {
+        pthread_cond_destroy(&cond);
+        pthread_mutex_destroy(&mt);
+    }
+
+    void set()
+    {
+        pthread_mutex_lock(&mt);
+        signaled = true;
+        pthread_cond_broadcast(&cond);
+        pthread_mutex_unlock(&mt);
+    }
+
+    bool wait(double timeoutMs)
+    {
+        pthread_mutex_lock(&mt);
+        if( timeoutMs < 0 )
+        {
+            while( !signaled )
+                pthread_cond_wait(&cond, &mt);
+        }
+        else
+        {
+            struct timeval now;
+            gettimeofday(&now, 0);
+            int64 nsec = (int64)now.tv_usec*1000 + (int64)(timeoutMs*1e6);
+            struct timespec deadline;
+            deadline.tv_sec = now.tv_sec + (time_t)(nsec / 1000000000);
+            deadline.tv_nsec = (long)(nsec % 1000000000);
+            int errcode = 0;
+            while( !signaled && errcode != ETIMEDOUT )
+                errcode = pthread_cond_timedwait(&cond, &mt, &deadline);
+        }
+        bool result = signaled;
+        pthread_mutex_unlock(&mt);
+        return result;
+    }
+
+private:
+    pthread_mutex_t mt;
+    pthread_cond_t cond;
+    bool signaled;
+};
+
+#endif
+
+} // namespace
+
+#if defined HAVE_TBB && TBB_INTERFACE_VERSION >= 5000
+#  define CV_ASYNC_TBB
+#elif defined HAVE_GCD
+#  define CV_ASYNC_GCD
+#elif defined HAVE_CONCURRENCY && !defined HAVE_CSTRIPES && !defined HAVE_OPENMP
+#  define CV_ASYNC_CONCURRENCY
+#elif !defined HAVE_WINRT
+#  define CV_ASYNC_WORKERS
+#endif
+
+namespace cv
+{
+
+AsyncTask::~AsyncTask() {}
+
+struct AsyncFuture::Impl
+{
+    Impl(const Ptr<AsyncTask>& _task) : task(_task), state(AsyncFuture::PENDING), error() {}
+
+    static bool isFinal(int s) { return s == AsyncFuture::DONE || s == AsyncFuture::FAILED || s == AsyncFuture::CANCELLED; }
+
+    // moves the task to the final state and releases (or propagates the state to) the continuations
+    bool complete(int newState, const Exception& err);
+    void run();
+
+    Ptr<AsyncTask> task;
+    Mutex mutex;
+    int state;
+    Exception error;
+    std::vector<Ptr<Impl> > continuations;
+    AsyncEvent finished;
+};
+
+static void enqueueAsyncTask(const Ptr<AsyncFuture::Impl>& impl);
+
+bool AsyncFuture::Impl::complete(int newState, const Exception& err)
+{
+    std::vector<Ptr<Impl> > next;
+    {
+        AutoLock lock(mutex);
+        if( isFinal(state) || (newState == AsyncFuture::CANCELLED && state != AsyncFuture::PENDING) )
+            return false;
+        state = newState;
+        error = err;
+        task.release();
+        next.swap(continuations);
+    }
+    finished.set();
+
+    for( size_t i = 0; i < next.size(); i++ )
+    {
+        if( newState == AsyncFuture::DONE )
+            enqueueAsyncTask(next[i]);
+        else
+            next[i]->complete(newState, err);
+    }
+    return true;
+}
+
+void AsyncFuture::Impl::run()
+{
+    Ptr<AsyncTask> t;
+    {
+        AutoLock lock(mutex);
+        if( state != AsyncFuture::PENDING )
+            return; // cancelled before it is started
+        state = AsyncFuture::RUNNING;
+        t = task;
+    }
+
+    int newState = AsyncFuture::DONE;
+    Exception err;
+    try
+    {
+        (*t)();
+    }
+    catch (const Exception& e)
+    {
+        err = e;
+        newState = AsyncFuture::FAILED;
+    }
+    catch (const std::exception& e)
+    {
+        err = Exception(Error::StsError, e.what(), "cv::async_", __FILE__, __LINE__);
+        newState = AsyncFuture::FAILED;
+    }
+    catch (...)
+    {
+        err = Exception(Error::StsError, "Unknown exception", "cv::async_", __FILE__, __LINE__);
+        newState = AsyncFuture::FAILED;
+    }
+    complete(newState, err);
+}
+
+AsyncFuture::AsyncFuture() {}
+
+AsyncFuture::AsyncFuture(const Ptr<Impl>& impl) : p(impl) {}
+
+bool AsyncFuture::valid() const
+{
+    return !p.empty();
+}
+
+int AsyncFuture::state() const
+{
+    CV_Assert( valid() );
+    AutoLock lock(p->mutex);
+    return p->state;
+}
+
+bool AsyncFuture::isReady() const
+{
+    return Impl::isFinal(state());
+}
+
+bool AsyncFuture::wait(double timeoutMs) const
+{
+    CV_Assert( valid() );
+    return p->finished.wait(timeoutMs);
+}
+
+void AsyncFuture::get() const
+{
+    wait();
+    AutoLock lock(p->mutex);
+    if( p->state == FAILED )
+        throw p->error;
+    if( p->state == CANCELLED )
+        CV_Error(Error::StsObjectNotFound, "The asynchronous task has been cancelled");
+}
+
+bool AsyncFuture::cancel()
+{
+    CV_Assert( valid() );
+    return p->complete(CANCELLED, Exception());
+}
+
+AsyncFuture AsyncFuture::then(const Ptr<AsyncTask>& continuation) const
+{
+    CV_Assert( valid() && !continuation.empty() );
+    Ptr<Impl> next = makePtr<Impl>(continuation);
+    int s;
+    Exception err;
+    {
+        AutoLock lock(p->mutex);
+        s = p->state;
+        if( !Impl::isFinal(s) )
+            p->continuations.push_back(next);
+        else
+            err = p->error;
+    }
+
+    if( s == DONE )
+        enqueueAsyncTask(next);
+    else if( Impl::isFinal(s) )
+        next->complete(s, err);
+    return AsyncFuture(next);
+}
+
+AsyncFuture async_(const Ptr<AsyncTask>& task)
+{
+    CV_Assert( !task.empty() );
+    Ptr<AsyncFuture::Impl> impl = makePtr<AsyncFuture::Impl>(task);
+    enqueueAsyncTask(impl);
+    return AsyncFuture(impl);
+}
+
+} // namespace cv
+
+namespace
+{
+
+#if defined CV_ASYNC_TBB
+
+class AsyncTbbTask : public tbb::task
+{
+public:
+    AsyncTbbTask(const cv::Ptr<cv::AsyncFuture::Impl>& _impl) : impl(_impl) {}
+    tbb::task* execute()
+    {
+        impl->run();
+        return NULL;
+    }
+protected:
+    cv::Ptr<cv::AsyncFuture::Impl> impl;
+};
+
+#elif defined CV_ASYNC_GCD || defined CV_ASYNC_CONCURRENCY
+
+static void async_function(void* context)
+{
+    cv::Ptr<cv::AsyncFuture::Impl>* impl = static_cast<cv::Ptr<cv::AsyncFuture::Impl>*>(context);
+    (*impl)->run();
+    delete impl;
+}
+
+#elif defined CV_ASYNC_WORKERS
+
+// Worker threads for the frameworks that have no task queue of their own (OpenMP, C=) or for
+// the builds without any parallel framework. Threads are started on demand and never stopped.
+class AsyncWorkerPool
+{
+public:
+    AsyncWorkerPool() : numWorkers(0), numIdle(0)
+    {
+#if defined WIN32 || defined _WIN32 || defined WINCE
+        semaphore = CreateSemaphore(NULL, 0, INT_MAX, NULL);
+#else
+        pthread_mutex_init(&mt, 0);
+        pthread_cond_init(&cond, 0);
+        signals = 0;
+#endif
+    }
+
+    static AsyncWorkerPool& getInstance()
+    {
+        static AsyncWorkerPool* instance = 0;
+        if( !instance )
+        {
+            cv::AutoLock lock(getInitMutex());
+            if( !instance )
+                instance = new AsyncWorkerPool;
+        }
+        return *instance;
+    }
+
+    void push(const cv::Ptr<cv::AsyncFuture::Impl>& impl, int maxWorkers)
+    {
+        bool wakeWorker = false, startWorker = false;
+        {
+            cv::AutoLock lock(queueMutex);
+            queue.push_back(impl);
+            if( numIdle > 0 )
+            {
+                numIdle--;
+                wakeWorker = true;
+            }
+            else if( numWorkers < maxWorkers )
+            {
+                numWorkers++;
+                startWorker = true;
+            }
+            // otherwise one of the busy workers will take the task when it is done with the current one
+        }
+
+        if( wakeWorker )
+            post();
+        else if( startWorker )
+            start();
+    }
+
+private:
+    static cv::Mutex& getInitMutex()
+    {
+        static cv::Mutex m;
+        return m;
+    }
+
+    void work()
+    {
+        for(;;)
+        {
+            cv::Ptr<cv::AsyncFuture::Impl> impl;
+            {
+                cv::AutoLock lock(queueMutex);
+                if( !queue.empty() )
+                {
+                    impl = queue.front();
+                    queue.pop_front();
+                }
+                else
+                    numIdle++;
+            }
+
+            if( !impl.empty() )
+                impl->run();
+            else
+                pend();
+        }
+    }
+
+#if defined WIN32 || defined _WIN32 || defined WINCE
+    static DWORD WINAPI threadFunc(LPVOID arg)
+    {
+        static_cast<AsyncWorkerPool*>(arg)->work();
+        return 0;
+    }
+
+    void start()
+    {
+        HANDLE thread = CreateThread(NULL, 0, threadFunc, this, 0, NULL);
+        CV_Assert( thread != NULL );
+        CloseHandle(thread);
+    }
+    void post() { ReleaseSemaphore(semaphore, 1, NULL); }
+    void pend() { WaitForSingleObjectEx(semaphore, INFINITE, FALSE); }
+
+    HANDLE semaphore;
+#else
+    static void* threadFunc(void* arg)
+    {
+        static_cast<AsyncWorkerPool*>(arg)->work();
+        return 0;
+    }
+
+    void start()
+    {
+        pthread_t thread;
+        CV_Assert( pthread_create(&thread, 0, threadFunc, this) == 0 );
+        pthread_detach(thread);
+    }
+    void post()
+    {
+        pthread_mutex_lock(&mt);
+        signals++;
+        pthread_cond_signal(&cond);
+        pthread_mutex_unlock(&mt);
+    }
+    void pend()
+    {
+        pthread_mutex_lock(&mt);
+        while( signals == 0 )
+            pthread_cond_wait(&cond, &mt);
+        signals--;
+        pthread_mutex_unlock(&mt);
+    }
+
+    pthread_mutex_t mt;
+    pthread_cond_t cond;
+    int signals;
+#endif
+
+    cv::Mutex queueMutex;
+    std::deque<cv::Ptr<cv::AsyncFuture::Impl> > queue;
+    int numWorkers, numIdle;
+};
+
+#endif
+
+} // namespace
+
+namespace cv
+{
+
+static void enqueueAsyncTask(const Ptr<AsyncFuture::Impl>& impl)
+{
+    int nthreads;
+    {
+        cv::AutoLock lock(getAsyncMutex());
+        nthreads = asyncNumThreads;
+    }
+
+    if( nthreads == 0 )
+    {
+        impl->run();
+        return;
+    }
+
+#if defined CV_ASYNC_TBB
+
+    tbb::task::enqueue(*new(tbb::task::allocate_root()) AsyncTbbTask(impl));
+
+#elif defined CV_ASYNC_GCD
+
+    dispatch_queue_t concurrent_queue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+    dispatch_async_f(concurrent_queue, new Ptr<AsyncFuture::Impl>(impl), async_function);
+
+#elif defined CV_ASYNC_CONCURRENCY
+
+    if( pplScheduler )
+        pplScheduler->ScheduleTask(async_function, new Ptr<AsyncFuture::Impl>(impl));
+    else
+        Concurrency::CurrentScheduler::ScheduleTask(async_function, new Ptr<AsyncFuture::Impl>(impl));
+
+#elif defined CV_ASYNC_WORKERS
+
+    AsyncWorkerPool::getInstance().push(impl, nthreads > 0 ? nthreads : getNumberOfCPUs());
+
+#else
+
+    impl->run();
+
+#endif
+}
+
+} // namespace cv
+
 CV_IMPL void cvSetNumThreads(int nt)
 {
     cv::setNumThreads(nt);
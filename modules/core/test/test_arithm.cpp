@@ -1791,3 +1791,53 @@ INSTANTIATE_TEST_CASE_P(Arithm, SubtractOutputMatNotEmpty, testing::Combine(
     testing::Values(perf::MatType(CV_8UC1), CV_8UC3, CV_8UC4, CV_16SC1, CV_16SC3),
     testing::Values(-1, CV_16S, CV_32S, CV_32F),
     testing::Bool()));
+
+TEST(Core_LUT, 16bit)
+{
+    RNG& rng = theRNG();
+    const int lutDepths[] = { CV_8U, CV_16S, CV_32S, CV_32F, CV_64F };
+
+    for( int iter = 0; iter < 10; iter++ )
+    {
+        int cn = rng.uniform(1, 4), lutcn = rng.uniform(0, 2) ? cn : 1;
+        int sdepth = rng.uniform(0, 2) ? CV_16U : CV_16S;
+        int ldepth = lutDepths[rng.uniform(0, 5)];
+
+        Mat src(rng.uniform(1, 700), rng.uniform(1, 700), CV_MAKETYPE(sdepth, cn));
+        Mat lut(1, 65536, CV_MAKETYPE(ldepth, lutcn)), dst;
+        rng.fill(src, RNG::UNIFORM, -32768, 65536);
+        rng.fill(lut, RNG::UNIFORM, -100, 100);
+
+        cv::LUT(src, lut, dst);
+
+        ASSERT_EQ(CV_MAKETYPE(ldepth, cn), dst.type());
+        ASSERT_EQ(src.size(), dst.size());
+
+        Mat lut64f, dst64f;
+        lut.convertTo(lut64f, CV_64F);
+        dst.convertTo(dst64f, CV_64F);
+        const double* ltab = lut64f.ptr<double>();
+        for( int y = 0; y < src.rows; y++ )
+            for( int x = 0; x < src.cols*cn; x++ )
+            {
+                int k = x % cn;
+                int idx = sdepth == CV_16U ? src.ptr<ushort>(y)[x] : (ushort)src.ptr<short>(y)[x];
+                ASSERT_EQ(ltab[idx*lutcn + (lutcn > 1 ? k : 0)], dst64f.ptr<double>(y)[x]);
+            }
+    }
+}
+
+TEST(Core_LUT, multidimensional)
+{
+    int sz[] = { 5, 7, 300 };
+    Mat src(3, sz, CV_8U), lut(1, 256, CV_32F), dst;
+    randu(src, 0, 256);
+    for( int i = 0; i < 256; i++ )
+        lut.at<float>(i) = i*0.5f;
+
+    cv::LUT(src, lut, dst);
+
+    Mat ref;
+    src.convertTo(ref, CV_32F, 0.5);
+    ASSERT_EQ(0, cvtest::norm(dst, ref, NORM_INF));
+}
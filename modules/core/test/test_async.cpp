@@ -0,0 +1,159 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2015, Itseez Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+#include "test_precomp.hpp"
+
+using namespace cv;
+
+namespace {
+
+class SumTask : public AsyncTask
+{
+public:
+    SumTask(const Mat& _src) : src(_src), result(0) {}
+    void operator() () { result = sum(src)[0]; }
+
+    Mat src;
+    double result;
+};
+
+class AppendTask : public AsyncTask
+{
+public:
+    AppendTask(std::vector<int>* _log, int _id) : log(_log), id(_id) {}
+    void operator() () { log->push_back(id); }
+
+    std::vector<int>* log;
+    int id;
+};
+
+class FailingTask : public AsyncTask
+{
+public:
+    void operator() () { CV_Error(Error::StsBadArg, "failure"); }
+};
+
+// blocks the worker until the mutex is released by the test
+class WaitingTask : public AsyncTask
+{
+public:
+    WaitingTask(Mutex* _gate) : gate(_gate) {}
+    void operator() () { AutoLock lock(*gate); }
+
+    Mutex* gate;
+};
+
+}
+
+TEST(Core_Async, runs_tasks)
+{
+    std::vector<Ptr<SumTask> > tasks;
+    std::vector<AsyncFuture> futures;
+    for( int i = 0; i < 8; i++ )
+    {
+        tasks.push_back(makePtr<SumTask>(Mat(100, 100, CV_32S, Scalar(i))));
+        futures.push_back(async_(tasks.back()));
+    }
+
+    for( int i = 0; i < 8; i++ )
+    {
+        ASSERT_NO_THROW(futures[i].get());
+        EXPECT_EQ(AsyncFuture::DONE, futures[i].state());
+        EXPECT_EQ(100*100*i, tasks[i]->result);
+    }
+}
+
+TEST(Core_Async, continuations_run_in_order)
+{
+    std::vector<int> log;
+    AsyncFuture f = async_(makePtr<AppendTask>(&log, 0));
+    for( int i = 1; i < 10; i++ )
+        f = f.then(makePtr<AppendTask>(&log, i));
+    f.get();
+
+    ASSERT_EQ(10u, log.size());
+    for( int i = 0; i < 10; i++ )
+        EXPECT_EQ(i, log[i]);
+}
+
+TEST(Core_Async, exception_is_propagated)
+{
+    std::vector<int> log;
+    AsyncFuture f = async_(makePtr<FailingTask>());
+    AsyncFuture next = f.then(makePtr<AppendTask>(&log, 1));
+
+    EXPECT_THROW(f.get(), cv::Exception);
+    EXPECT_THROW(next.get(), cv::Exception);
+    EXPECT_EQ(AsyncFuture::FAILED, next.state());
+    EXPECT_TRUE(log.empty());
+}
+
+TEST(Core_Async, cancel_pending_continuation)
+{
+    std::vector<int> log;
+    Mutex gate;
+    gate.lock();
+    AsyncFuture blocker = async_(makePtr<WaitingTask>(&gate));
+    AsyncFuture pending = blocker.then(makePtr<AppendTask>(&log, 1));
+    AsyncFuture tail = pending.then(makePtr<AppendTask>(&log, 2));
+
+    EXPECT_TRUE(pending.cancel());
+    EXPECT_FALSE(pending.cancel());
+    EXPECT_EQ(AsyncFuture::CANCELLED, tail.state());
+    gate.unlock();
+
+    blocker.get();
+    EXPECT_THROW(tail.get(), cv::Exception);
+    EXPECT_TRUE(log.empty());
+}
+
+TEST(Core_Async, synchronous_without_threads)
+{
+    int nthreads = getNumThreads();
+    setNumThreads(0);
+
+    Ptr<SumTask> task = makePtr<SumTask>(Mat(10, 10, CV_8U, Scalar(1)));
+    AsyncFuture f = async_(task);
+    EXPECT_TRUE(f.isReady());
+    EXPECT_EQ(100, task->result);
+
+    setNumThreads(nthreads);
+}
@@ -1209,3 +1209,88 @@ TEST(Core_Mat, copyNx1ToVector)
 
     ASSERT_PRED_FORMAT2(cvtest::MatComparator(0, 0), ref_dst16, cv::Mat_<ushort>(dst16));
 }
+
+TEST(Core_SparseMat, bulkInsert)
+{
+    int sz[] = { 50, 70 };
+    SparseMat M(2, sz, CV_32F), M2(2, sz, CV_32F);
+    std::vector<Point> idx;
+    std::vector<float> values;
+    RNG& rng = theRNG();
+
+    for( int i = 0; i < 1000; i++ )
+    {
+        idx.push_back(Point(rng.uniform(0, sz[0]), rng.uniform(0, sz[1])));
+        values.push_back((float)rng.uniform(-10, 10));
+        M2.ref<float>(idx.back().x, idx.back().y) += values.back();
+    }
+
+    M.insert(idx, values, true);
+    ASSERT_EQ(M2.nzcount(), M.nzcount());
+    Mat dense, dense2;
+    M.copyTo(dense);
+    M2.copyTo(dense2);
+    EXPECT_EQ(0, cvtest::norm(dense, dense2, NORM_INF));
+
+    // the last of the duplicated elements wins
+    M.insert(idx, values, false);
+    M2.clear();
+    for( size_t i = 0; i < idx.size(); i++ )
+        M2.ref<float>(idx[i].x, idx[i].y) = values[i];
+    M.copyTo(dense);
+    M2.copyTo(dense2);
+    EXPECT_EQ(0, cvtest::norm(dense, dense2, NORM_INF));
+}
+
+TEST(Core_SparseMat, convertToCSR)
+{
+    Mat dense(30, 40, CV_64F, Scalar(0));
+    RNG& rng = theRNG();
+    for( int i = 0; i < 200; i++ )
+        dense.at<double>(rng.uniform(0, dense.rows), rng.uniform(0, dense.cols)) = rng.uniform(1., 2.);
+    dense.row(5) = Scalar(0);
+
+    SparseMat M(dense);
+    Mat values, colIdx, rowPtr;
+    M.convertToCSR(values, colIdx, rowPtr);
+
+    ASSERT_EQ(countNonZero(dense), (int)values.total());
+    ASSERT_EQ(dense.rows + 1, (int)rowPtr.total());
+    Mat restored(dense.size(), CV_64F, Scalar(0));
+    for( int i = 0; i < dense.rows; i++ )
+        for( int k = rowPtr.at<int>(i); k < rowPtr.at<int>(i + 1); k++ )
+        {
+            if( k > rowPtr.at<int>(i) )
+                ASSERT_LT(colIdx.at<int>(k - 1), colIdx.at<int>(k));
+            restored.at<double>(i, colIdx.at<int>(k)) = values.at<double>(k);
+        }
+    EXPECT_EQ(0, cvtest::norm(dense, restored, NORM_INF));
+}
+
+TEST(Core_SparseMat, gemm)
+{
+    Mat dense(100, 80, CV_32F, Scalar(0)), B(80, 7, CV_32F), C(100, 7, CV_32F), v(80, 1, CV_32F);
+    RNG& rng = theRNG();
+    for( int i = 0; i < 500; i++ )
+        dense.at<float>(rng.uniform(0, dense.rows), rng.uniform(0, dense.cols)) = (float)rng.uniform(-1., 1.);
+    rng.fill(B, RNG::UNIFORM, -1, 1);
+    rng.fill(C, RNG::UNIFORM, -1, 1);
+    rng.fill(v, RNG::UNIFORM, -1, 1);
+    SparseMat M(dense);
+
+    Mat dst, ref;
+    gemm(M, B, 2, C, 0.5, dst);
+    gemm(dense, B, 2, C, 0.5, ref);
+    EXPECT_LE(cvtest::norm(dst, ref, NORM_INF), 1e-4);
+
+    gemm(M, v, 1, noArray(), 0, dst);
+    gemm(dense, v, 1, noArray(), 0, ref);
+    EXPECT_LE(cvtest::norm(dst, ref, NORM_INF), 1e-4);
+
+    // in-place multiplication by a square matrix
+    Mat square = dense.rowRange(0, 80), X = B.clone();
+    SparseMat S(square);
+    gemm(square, B, 1, noArray(), 0, ref);
+    gemm(S, X, 1, noArray(), 0, X);
+    EXPECT_LE(cvtest::norm(X, ref, NORM_INF), 1e-4);
+}
@@ -2822,4 +2822,68 @@ TEST(CovariationMatrixVectorOfMatWithMean, accuracy)
     ASSERT_EQ(sDiff.dot(sDiff), 0.0);
 }
 
+TEST(Core_MulTransposed, manySamples)
+{
+    const int types[] = { CV_8U, CV_16S, CV_32F, CV_64F };
+    for( int t = 0; t < 4; t++ )
+    {
+        Mat src(20000, 13, types[t]), delta(1, 13, CV_64F), ref, dst;
+        randu(src, 0, 100);
+        randu(delta, 0, 100);
+
+        Mat src64f;
+        src.convertTo(src64f, CV_64F);
+        Mat diff = src64f - repeat(delta, src.rows, 1);
+        gemm(diff, diff, 1./src.rows, noArray(), 0, ref, GEMM_1_T);
+
+        mulTransposed(src, dst, true, delta, 1./src.rows, CV_64F);
+        ASSERT_EQ(CV_64F, dst.type());
+        EXPECT_LE(cvtest::norm(dst, ref, NORM_INF), 1e-9*cvtest::norm(ref, NORM_INF));
+        EXPECT_EQ(0, cvtest::norm(dst, dst.t(), NORM_INF));
+
+        // the product of rows
+        Mat refL;
+        mulTransposed(src.rowRange(0, 300), dst, false, noArray(), 1, CV_64F);
+        gemm(src64f.rowRange(0, 300), src64f.rowRange(0, 300), 1, noArray(), 0, refL, GEMM_2_T);
+        EXPECT_LE(cvtest::norm(dst, refL, NORM_INF), 1e-9*cvtest::norm(refL, NORM_INF));
+    }
+}
+
+TEST(Core_MulTransposed, noSamples)
+{
+    Mat src(0, 5, CV_32F), dst;
+    mulTransposed(src, dst, true);
+    ASSERT_EQ(5, dst.rows);
+    ASSERT_EQ(5, dst.cols);
+    EXPECT_EQ(0, cvtest::norm(dst, NORM_INF));
+
+    mulTransposed(src, dst, false);
+    EXPECT_TRUE(dst.empty());
+}
+
+TEST(Core_Mahalanobis, batch)
+{
+    for( int depth = CV_32F; depth <= CV_64F; depth++ )
+    {
+        Mat samples(300, 7, depth), mean(1, 7, depth), a(7, 7, depth), icovar, dst;
+        randu(samples, -10, 10);
+        randu(mean, -10, 10);
+        randu(a, -1, 1);
+        mulTransposed(a, icovar, true, noArray(), 1, depth);
+        icovar += Mat::eye(7, 7, depth);
+
+        MahalanobisBatch(samples, mean, icovar, dst);
+        ASSERT_EQ(samples.rows, dst.rows);
+        ASSERT_EQ(1, dst.cols);
+        ASSERT_EQ(depth, dst.type());
+
+        for( int i = 0; i < samples.rows; i++ )
+        {
+            double ref = Mahalanobis(samples.row(i), mean, icovar);
+            double val = depth == CV_32F ? dst.at<float>(i) : dst.at<double>(i);
+            ASSERT_NEAR(ref, val, 1e-4*std::max(ref, 1.));
+        }
+    }
+}
+
 /* End of file. */
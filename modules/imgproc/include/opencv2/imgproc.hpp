@@ -229,6 +229,13 @@ enum MorphTypes{
                         //!< \f[\texttt{dst} = \mathrm{blackhat} ( \texttt{src} , \texttt{element} )= \mathrm{close} ( \texttt{src} , \texttt{element} )- \texttt{src}\f]
 };
 
+//! Gaussian smoothing algorithm, see cv::GaussianBlur
+enum GaussianBlurAlgorithms {
+    GAUSSIAN_BLUR_AUTO      = 0, //!< the recursive filter for large sigmas, the kernel otherwise
+    GAUSSIAN_BLUR_KERNEL    = 1, //!< convolution with the separable Gaussian kernel
+    GAUSSIAN_BLUR_RECURSIVE = 2  //!< the recursive (IIR) approximation of the Gaussian
+};
+
 //! shape of the structuring element
 enum MorphShapes {
     MORPH_RECT    = 0, //!< a rectangular structuring element:  \f[E_{ij}=1\f]
@@ -1129,7 +1136,8 @@ The function smoothes an image using the median filter with the \f$\texttt{ksize
 In-place operation is supported.
 
 @param src input 1-, 3-, or 4-channel image; when ksize is 3 or 5, the image depth should be
-CV_8U, CV_16U, or CV_32F, for larger aperture sizes, it can only be CV_8U.
+CV_8U, CV_16U, CV_16S or CV_32F, for larger aperture sizes, it can be CV_8U, or, when ksize is not
+greater than 255, CV_16U, CV_16S or CV_32F.
 @param dst destination array of the same size and type as src.
 @param ksize aperture linear size; it must be odd and greater than 1, for example: 3, 5, 7 ...
 @sa  bilateralFilter, blur, boxFilter, GaussianBlur
@@ -1153,12 +1161,25 @@ respectively (see cv::getGaussianKernel for details); to fully control the resul
 possible future modifications of all this semantics, it is recommended to specify all of ksize,
 sigmaX, and sigmaY.
 @param borderType pixel extrapolation method, see cv::BorderTypes
+@param algorithm smoothing algorithm, see cv::GaussianBlurAlgorithms
+
+The cost of the convolution with the kernel grows linearly with the kernel size. For large sigmas
+the 4th order recursive filter by Deriche can be requested instead, whose cost per pixel does not
+depend on sigma. By default the kernel is always used. With GAUSSIAN_BLUR_AUTO the recursive filter
+is chosen when both sigmas are 10 or larger, the kernel size is either zero or at least
+\f$6\sigma+1\f$, the source image is not a ROI of a larger image (or BORDER_ISOLATED is set) and
+dst is not a UMat. The recursive filter approximates the
+infinite Gaussian: the difference from the exact result is within 0.05% of the input dynamic range,
+so the 8-bit results are rounded within 1 level of the exact ones, while the fixed-point 8-bit
+kernel for large sigmas may deviate by several levels. The recursive filter handles CV_8U, CV_16U,
+CV_16S and CV_32F images; the other depths always use the kernel.
 
 @sa  sepFilter2D, filter2D, blur, boxFilter, bilateralFilter, medianBlur
  */
 CV_EXPORTS_W void GaussianBlur( InputArray src, OutputArray dst, Size ksize,
                                 double sigmaX, double sigmaY = 0,
-                                int borderType = BORDER_DEFAULT );
+                                int borderType = BORDER_DEFAULT,
+                                int algorithm = GAUSSIAN_BLUR_KERNEL );
 
 /** @brief Applies the bilateral filter to an image.
 
@@ -2350,6 +2371,27 @@ floating-point.
 CV_EXPORTS_W void accumulateWeighted( InputArray src, InputOutputArray dst,
                                       double alpha, InputArray mask = noArray() );
 
+/** @brief Updates a running average and a running average of squares.
+
+The function updates both accumulators in a single pass over src:
+
+\f[\begin{array}{l} \texttt{dst} (x,y)  \leftarrow (1- \texttt{alpha} )  \cdot \texttt{dst} (x,y) +  \texttt{alpha} \cdot \texttt{src} (x,y) \\ \texttt{dstSqr} (x,y)  \leftarrow (1- \texttt{alpha} )  \cdot \texttt{dstSqr} (x,y) +  \texttt{alpha} \cdot \texttt{src} (x,y)^2 \end{array} \quad \text{if} \quad \texttt{mask} (x,y)  \ne 0\f]
+
+The per-pixel variance of the frame sequence can then be estimated as dstSqr - dst\*dst.
+The function supports multi-channel images. Each channel is processed independently.
+
+@param src Input image as 1- or 3-channel, 8-bit, 16-bit or 32-bit floating point.
+@param dst %Accumulator image with the same number of channels as input image, 32-bit or 64-bit
+floating-point.
+@param dstSqr %Accumulator of the squared input image of the same size and type as dst.
+@param alpha Weight of the input image.
+@param mask Optional operation mask.
+
+@sa  accumulateWeighted, accumulateSquare
+ */
+CV_EXPORTS_W void accumulateWeightedMeanSqr( InputArray src, InputOutputArray dst, InputOutputArray dstSqr,
+                                             double alpha, InputArray mask = noArray() );
+
 /** @brief The function is used to detect translational shifts that occur between two images.
 
 The operation takes advantage of the Fourier shift theorem for detecting the translational shift in
@@ -2405,6 +2447,57 @@ An example is shown below:
  */
 CV_EXPORTS_W void createHanningWindow(OutputArray dst, Size winSize, int type);
 
+/** @brief Phase correlation against a fixed reference image.
+
+The class computes the same shift as phaseCorrelate(ref, src, window, response), where window is
+the Hanning window created by createHanningWindow, but the windowed spectrum of the reference image
+is computed only once, by the first correlate call after setReference, and the DFT buffers are
+reused by the subsequent calls.
+
+With levels > 1, the shift is first found on the coarsest level of the image pyramids (see
+pyrDown), and then refined on each finer level after the input image has been translated by the
+doubled shift of the coarser level. This finds the shifts that are too large for the overlap of
+the full-resolution images to produce a clear peak. Levels smaller than 32 pixels are not used.
+
+@sa phaseCorrelate, createPhaseCorrelator
+ */
+class CV_EXPORTS_W PhaseCorrelator : public Algorithm
+{
+public:
+    /** @brief Sets the reference image.
+
+    @param ref Single-channel reference image. CV_64F images are processed in double precision,
+    the others are converted to CV_32F.
+     */
+    CV_WRAP virtual void setReference(InputArray ref) = 0;
+
+    /** @brief Finds the shift of the image relative to the reference.
+
+    @param src Single-channel image of the same size as the reference.
+    @param response Signal power within the 5x5 centroid around the peak on the finest level,
+    between 0 and 1 (optional).
+    @returns detected phase shift (sub-pixel), see phaseCorrelate.
+     */
+    CV_WRAP virtual Point2d correlate(InputArray src, CV_OUT double* response = 0) = 0;
+
+    CV_WRAP virtual void setUseWindow(bool useWindow) = 0;
+    CV_WRAP virtual bool getUseWindow() const = 0;
+
+    CV_WRAP virtual void setLevels(int levels) = 0;
+    CV_WRAP virtual int getLevels() const = 0;
+
+    //! releases the buffers that are reused by correlate, but not the reference spectra
+    CV_WRAP virtual void collectGarbage() = 0;
+};
+
+/** @brief Creates a PhaseCorrelator.
+
+@param useWindow If true, the images are multiplied by a Hanning window to reduce edge effects.
+@param levels Number of the pyramid levels used for the coarse-to-fine search, 1 means only the
+full-resolution images.
+ */
+CV_EXPORTS_W Ptr<PhaseCorrelator> createPhaseCorrelator(bool useWindow = true, int levels = 1);
+
 //! @} imgproc_motion
 
 //! @addtogroup imgproc_misc
@@ -2683,6 +2776,17 @@ CV_EXPORTS_W void undistortPoints( InputArray src, OutputArray dst,
                                    InputArray cameraMatrix, InputArray distCoeffs,
                                    InputArray R = noArray(), InputArray P = noArray());
 
+/** @overload
+
+The distortion is compensated iteratively until the criteria are satisfied: either criteria.maxCount
+iterations are done (TermCriteria::COUNT), or the normalized coordinates of the point change by not
+more than criteria.epsilon in the last iteration (TermCriteria::EPS). With EPS alone, at most 100
+iterations are done. The version above does 5 iterations. The points are processed in parallel.
+ */
+CV_EXPORTS void undistortPoints( InputArray src, OutputArray dst,
+                                 InputArray cameraMatrix, InputArray distCoeffs,
+                                 InputArray R, InputArray P, TermCriteria criteria );
+
 //! @} imgproc_transform
 
 //! @addtogroup imgproc_hist
@@ -3205,6 +3309,37 @@ CV_EXPORTS_W int floodFill( InputOutputArray image, InputOutputArray mask,
                             Scalar loDiff = Scalar(), Scalar upDiff = Scalar(),
                             int flags = 4 );
 
+/** @brief Fills the connected components of several seed points.
+
+The function is equivalent to calling floodFill for every seed in turn, but the parameters are
+checked, the mask is bordered and the work buffers are allocated only once, so the cost depends on
+the number of filled pixels rather than on the number of seeds. A seed that lies in an already
+filled component of the same value, or in a pixel set in the mask, does not fill anything.
+
+When no mask is given, the temporary mask is reset between the seeds within the bounding rectangle
+of the previous fill only, so each seed behaves like a separate call without the mask. When the
+mask is given, it is shared by all the seeds, as it would be by a sequence of calls with that mask.
+
+@param image Input/output 1- or 3-channel, 8-bit, 32-bit integer or floating-point image.
+@param mask Optional operation mask, see floodFill.
+@param seedPoints Starting points, filled in this order.
+@param newVals New values of the repainted domains: either one value for all the seeds, or one
+per seed (for example, the labels of the regions in a 32-bit integer image).
+@param rects Output bounding rectangles of the repainted domains, one per seed.
+@param areas Output numbers of the repainted pixels, one per seed.
+@param loDiff Maximal lower brightness/color difference, see floodFill.
+@param upDiff Maximal upper brightness/color difference, see floodFill.
+@param flags Operation flags, see floodFill.
+@return The total number of the repainted pixels.
+
+@sa floodFill
+ */
+CV_EXPORTS int floodFillBatch( InputOutputArray image, InputOutputArray mask,
+                               const std::vector<Point>& seedPoints, const std::vector<Scalar>& newVals,
+                               CV_OUT std::vector<Rect>& rects, CV_OUT std::vector<int>& areas,
+                               Scalar loDiff = Scalar(), Scalar upDiff = Scalar(),
+                               int flags = 4 );
+
 /** @brief Converts an image from one color space to another.
 
 The function converts an input image from one color space to another. In case of a transformation
@@ -3271,6 +3406,22 @@ used for images only.
  */
 CV_EXPORTS_W Moments moments( InputArray array, bool binaryImage = false );
 
+/** @brief Calculates the moments of all the regions of a label image in one pass.
+
+The function computes moments, up to the 3rd order, of every region of the label image, where a
+region is formed by all the pixels with the same label. For every region the result is the same as
+the result of moments called for the binary mask of the region, but the image is scanned only once.
+
+@param labels Label image (single-channel 32-bit signed, 16-bit unsigned or 8-bit unsigned 2D array),
+for example, the output of connectedComponents.
+@param moments Output vector of moments, moments[i] are the moments of the region with label i.
+@param nlabels Number of labels; the pixels with labels outside of [0, nlabels) are ignored. If it is
+not positive, the maximum label plus one is used.
+
+@sa  moments, connectedComponentsWithStats
+ */
+CV_EXPORTS void labelMoments( InputArray labels, std::vector<Moments>& moments, int nlabels = -1 );
+
 /** @brief Calculates seven Hu invariants.
 
 The function calculates seven Hu invariants (introduced in @cite Hu62; see also
@@ -3338,6 +3489,40 @@ not set by default.
 CV_EXPORTS_W void matchTemplate( InputArray image, InputArray templ,
                                  OutputArray result, int method, InputArray mask = noArray() );
 
+/** @brief Compares several templates against overlapped image regions.
+
+The function computes the same result maps as matchTemplate called for every template, but the work
+that depends on the image only is done once: the image spectra used by the DFT-based correlation
+are shared by all the templates of the same size, and the integral images used for the
+normalization are shared by all the templates. The templates are then processed in parallel.
+
+@param image Image where the search is running. It must be 8-bit or 32-bit floating-point.
+@param templs Searched templates. Each of them must be not greater than the source image and have
+the same data type. The templates may have different sizes.
+@param results Output maps of comparison results, one per template, see matchTemplate.
+@param method Parameter specifying the comparison method, see cv::TemplateMatchModes
+ */
+CV_EXPORTS void matchTemplateBatch( InputArray image, InputArrayOfArrays templs,
+                                    OutputArrayOfArrays results, int method );
+
+/** @overload
+
+Instead of the dense result maps, only the best local extrema of each map are returned: maximums,
+or minimums for TM_SQDIFF and TM_SQDIFF_NORMED. A local extremum is a point that is not worse than
+any of its 8 neighbors. The result maps are not kept, so the memory needed does not depend on the
+number of templates.
+
+@param image Image where the search is running. It must be 8-bit or 32-bit floating-point.
+@param templs Searched templates, see above.
+@param method Parameter specifying the comparison method, see cv::TemplateMatchModes
+@param topK Maximum number of the extrema reported per template.
+@param locations Output top-left corners of the best matches of each template, best first.
+@param scores Output values of the result map at the locations.
+ */
+CV_EXPORTS void matchTemplateBatch( InputArray image, InputArrayOfArrays templs, int method, int topK,
+                                    CV_OUT std::vector<std::vector<Point> >& locations,
+                                    CV_OUT std::vector<std::vector<float> >& scores );
+
 //! @}
 
 //! @addtogroup imgproc_shape
@@ -3426,6 +3611,22 @@ CV_EXPORTS_W void approxPolyDP( InputArray curve,
                                 OutputArray approxCurve,
                                 double epsilon, bool closed );
 
+/** @brief Approximates many polygonal curves with the specified precision.
+
+The function computes the same approximations as approxPolyDP called for every curve, in parallel.
+The results are packed one after another into a single array: the approximation of the i-th curve
+occupies the elements offsets[i] to offsets[i+1]-1 of approxCurves.
+
+@param curves Input curves, for example the output of findContours. All the non-empty curves must
+have the same depth, CV_32S or CV_32F.
+@param approxCurves Output packed approximations, of the same type as the input curves.
+@param offsets Output vector of curves.size()+1 integer offsets of the approximations.
+@param epsilon Approximation accuracy, see approxPolyDP.
+@param closed Flag indicating whether the curves are closed, see approxPolyDP.
+ */
+CV_EXPORTS void approxPolyDPBatch( InputArrayOfArrays curves, OutputArray approxCurves,
+                                   OutputArray offsets, double epsilon, bool closed );
+
 /** @brief Calculates a contour perimeter or a curve length.
 
 The function computes a curve length or a closed contour perimeter.
@@ -3443,6 +3644,14 @@ The function calculates and returns the minimal up-right bounding rectangle for
  */
 CV_EXPORTS_W Rect boundingRect( InputArray points );
 
+/** @brief Calculates the up-right bounding rectangles of many point sets in parallel.
+
+@param contours Input point sets. All the non-empty sets must have the same depth, CV_32S or CV_32F.
+@param rects Output N x 4 CV_32S matrix, where N is the number of point sets. The row i contains
+the x, y, width and height of the rectangle that boundingRect returns for the i-th set.
+ */
+CV_EXPORTS void boundingRectBatch( InputArrayOfArrays contours, OutputArray rects );
+
 /** @brief Calculates a contour area.
 
 The function computes a contour area. Similarly to moments , the area is computed using the Green
@@ -3475,6 +3684,14 @@ false, which means that the absolute value is returned.
  */
 CV_EXPORTS_W double contourArea( InputArray contour, bool oriented = false );
 
+/** @brief Calculates the areas of many contours in parallel.
+
+@param contours Input contours. All the non-empty contours must have the same depth, CV_32S or CV_32F.
+@param areas Output N x 1 CV_64F matrix of the areas, as computed by contourArea.
+@param oriented Oriented area flag, see contourArea.
+ */
+CV_EXPORTS void contourAreaBatch( InputArrayOfArrays contours, OutputArray areas, bool oriented = false );
+
 /** @brief Finds a rotated rectangle of the minimum area enclosing the input 2D point set.
 
 The function calculates and returns the minimum-area bounding rectangle (possibly rotated) for a
@@ -3486,6 +3703,17 @@ boundary.
  */
 CV_EXPORTS_W RotatedRect minAreaRect( InputArray points );
 
+/** @brief Finds the minimum-area rotated rectangles enclosing many 2D point sets.
+
+The function computes the same rectangles as minAreaRect called for every point set, in parallel
+and without the intermediate convex hull arrays.
+
+@param contours Input point sets. All the non-empty sets must have the same depth, CV_32S or CV_32F.
+@param boxes Output N x 5 CV_32F matrix, where N is the number of point sets. The row i contains
+the center x, center y, width, height and angle of the i-th rectangle.
+ */
+CV_EXPORTS void minAreaRectBatch( InputArrayOfArrays contours, OutputArray boxes );
+
 /** @brief Finds the four vertices of a rotated rect. Useful to draw the rotated rectangle.
 
 The function finds the four vertices of a rotated rectangle. This function is useful to draw the
@@ -3574,6 +3802,21 @@ returnPoints=false.
 CV_EXPORTS_W void convexHull( InputArray points, OutputArray hull,
                               bool clockwise = false, bool returnPoints = true );
 
+/** @brief Finds the convex hulls of many point sets in parallel.
+
+The hulls are the same as convexHull computes. They are packed one after another into a single
+array: the hull of the i-th point set occupies the elements offsets[i] to offsets[i+1]-1 of hulls.
+
+@param contours Input point sets. All the non-empty sets must have the same depth, CV_32S or CV_32F.
+@param hulls Output packed hulls: the hull points, of the same type as the input, or the CV_32S
+indices of the hull points within their point sets.
+@param offsets Output vector of contours.size()+1 integer offsets of the hulls.
+@param clockwise Orientation flag, see convexHull.
+@param returnPoints If true, the hull points are returned, otherwise their indices.
+ */
+CV_EXPORTS void convexHullBatch( InputArrayOfArrays contours, OutputArray hulls, OutputArray offsets,
+                                 bool clockwise = false, bool returnPoints = true );
+
 /** @brief Finds the convexity defects of a contour.
 
 The figure below displays convexity defects of a hand contour:
@@ -3622,6 +3865,16 @@ border of the containing Mat element.
  */
 CV_EXPORTS_W RotatedRect fitEllipse( InputArray points );
 
+/** @brief Fits ellipses around many 2D point sets in parallel.
+
+@param contours Input point sets, each of at least 5 points. All of them must have the same
+depth, CV_32S or CV_32F.
+@param boxes Output N x 5 CV_32F matrix, where N is the number of point sets. The row i contains
+the center x, center y, width, height and angle of the rectangle that fitEllipse returns for the
+i-th set.
+ */
+CV_EXPORTS void fitEllipseBatch( InputArrayOfArrays contours, OutputArray boxes );
+
 /** @brief Fits a line to a 2D or 3D point set.
 
 The function fitLine fits a line to a 2D or 3D point set by minimizing \f$\sum_i \rho(r_i)\f$ where
@@ -55,6 +55,36 @@ CV_INLINE  float  icvDistanceL2_32f( CvPoint2D32f pt1, CvPoint2D32f pt2 )
 /* curvature: 0 - 1-curvature, 1 - k-cosine curvature. */
 CvSeq* icvApproximateChainTC89( CvChain* chain, int header_size, CvMemStorage* storage, int method );
 
+namespace cv
+{
+
+// Point sets passed to the batch geometry functions (approxPolyDPBatch, convexHullBatch etc.)
+struct ContourBatch
+{
+    ContourBatch( InputArrayOfArrays contours, int minPoints = 0 );
+
+    int size() const { return (int)counts.size(); }
+
+    // the points of the contour i; CV_32F contours are stored as Point2f
+    std::vector<const Point*> ptrs;
+    std::vector<int> counts;
+    // the position of the contour i in the concatenation of all the contours
+    std::vector<int> starts;
+    int total, maxCount, depth;
+};
+
+// Copies the variable-length per-contour results stored in buf at the positions batch.starts
+// to the packed output array, and stores the (batch.size()+1) offsets of the results.
+void packContourBatch( const ContourBatch& batch, const Mat& buf, const std::vector<int>& nout,
+                       OutputArray dst, OutputArray offsets );
+
+// Finds the convex hull of the n points, in the same order as convexHull does.
+// The buffers must have room for n, n + 2 and n elements. Returns the number of hull vertices.
+int convexHullIndices( const Point* points, int n, bool is_float, bool clockwise,
+                       Point** pointer, int* stack, int* hull );
+
+}
+
 #endif /*_IPCVGEOM_H_*/
 
 /* End of file. */
@@ -83,6 +83,15 @@ struct AccW_SIMD
     }
 };
 
+template <typename T, typename AT>
+struct AccWMeanSqr_SIMD
+{
+    int operator() (const T *, AT *, AT *, const uchar *, int, int, AT) const
+    {
+        return 0;
+    }
+};
+
 #if CV_NEON
 
 template <>
@@ -468,11 +477,391 @@ struct AccW_SIMD<float, float>
     }
 };
 
+#elif CV_SSE2
+
+// eight accumulator elements, which is one iteration of the loops below
+struct v_acc32f
+{
+    __m128 v0, v1;
+};
+
+struct v_acc64f
+{
+    __m128d v0, v1, v2, v3;
+};
+
+template <typename AT> struct AccVec {};
+template <> struct AccVec<float> { typedef v_acc32f vec_type; };
+template <> struct AccVec<double> { typedef v_acc64f vec_type; };
+
+inline void v_acc_expand(const uchar * src, __m128i & v0, __m128i & v1)
+{
+    __m128i v_zero = _mm_setzero_si128();
+    __m128i v_src = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)src), v_zero);
+    v0 = _mm_unpacklo_epi16(v_src, v_zero);
+    v1 = _mm_unpackhi_epi16(v_src, v_zero);
+}
+
+inline void v_acc_expand(const ushort * src, __m128i & v0, __m128i & v1)
+{
+    __m128i v_zero = _mm_setzero_si128(), v_src = _mm_loadu_si128((const __m128i *)src);
+    v0 = _mm_unpacklo_epi16(v_src, v_zero);
+    v1 = _mm_unpackhi_epi16(v_src, v_zero);
+}
+
+// all bits are set in the 32-bit lanes where the mask is zero
+inline void v_acc_expand_zmask(const uchar * mask, __m128i & v0, __m128i & v1)
+{
+    __m128i v_mask = _mm_cmpeq_epi8(_mm_loadl_epi64((const __m128i *)mask), _mm_setzero_si128());
+    v_mask = _mm_unpacklo_epi8(v_mask, v_mask);
+    v0 = _mm_unpacklo_epi16(v_mask, v_mask);
+    v1 = _mm_unpackhi_epi16(v_mask, v_mask);
+}
+
+inline void v_acc_load(const uchar * src, v_acc32f & v)
+{
+    __m128i v0, v1;
+    v_acc_expand(src, v0, v1);
+    v.v0 = _mm_cvtepi32_ps(v0);
+    v.v1 = _mm_cvtepi32_ps(v1);
+}
+
+inline void v_acc_load(const ushort * src, v_acc32f & v)
+{
+    __m128i v0, v1;
+    v_acc_expand(src, v0, v1);
+    v.v0 = _mm_cvtepi32_ps(v0);
+    v.v1 = _mm_cvtepi32_ps(v1);
+}
+
+inline void v_acc_load(const float * src, v_acc32f & v)
+{
+    v.v0 = _mm_loadu_ps(src);
+    v.v1 = _mm_loadu_ps(src + 4);
+}
+
+inline void v_acc_store(float * dst, const v_acc32f & v)
+{
+    _mm_storeu_ps(dst, v.v0);
+    _mm_storeu_ps(dst + 4, v.v1);
+}
+
+inline v_acc32f v_acc_setall(float a)
+{
+    v_acc32f v;
+    v.v0 = v.v1 = _mm_set1_ps(a);
+    return v;
+}
+
+inline v_acc32f v_acc_add(const v_acc32f & a, const v_acc32f & b)
+{
+    v_acc32f v;
+    v.v0 = _mm_add_ps(a.v0, b.v0);
+    v.v1 = _mm_add_ps(a.v1, b.v1);
+    return v;
+}
+
+inline v_acc32f v_acc_mul(const v_acc32f & a, const v_acc32f & b)
+{
+    v_acc32f v;
+    v.v0 = _mm_mul_ps(a.v0, b.v0);
+    v.v1 = _mm_mul_ps(a.v1, b.v1);
+    return v;
+}
+
+// keeps the old accumulator values where the mask is zero
+inline v_acc32f v_acc_masked(const uchar * mask, const v_acc32f & a, const v_acc32f & b)
+{
+    __m128i v0, v1;
+    v_acc_expand_zmask(mask, v0, v1);
+    __m128 v_zmask0 = _mm_castsi128_ps(v0), v_zmask1 = _mm_castsi128_ps(v1);
+    v_acc32f v;
+    v.v0 = _mm_or_ps(_mm_and_ps(v_zmask0, a.v0), _mm_andnot_ps(v_zmask0, b.v0));
+    v.v1 = _mm_or_ps(_mm_and_ps(v_zmask1, a.v1), _mm_andnot_ps(v_zmask1, b.v1));
+    return v;
+}
+
+inline void v_acc_cvt(const __m128i & v0, const __m128i & v1, v_acc64f & v)
+{
+    v.v0 = _mm_cvtepi32_pd(v0);
+    v.v1 = _mm_cvtepi32_pd(_mm_srli_si128(v0, 8));
+    v.v2 = _mm_cvtepi32_pd(v1);
+    v.v3 = _mm_cvtepi32_pd(_mm_srli_si128(v1, 8));
+}
+
+inline void v_acc_load(const uchar * src, v_acc64f & v)
+{
+    __m128i v0, v1;
+    v_acc_expand(src, v0, v1);
+    v_acc_cvt(v0, v1, v);
+}
+
+inline void v_acc_load(const ushort * src, v_acc64f & v)
+{
+    __m128i v0, v1;
+    v_acc_expand(src, v0, v1);
+    v_acc_cvt(v0, v1, v);
+}
+
+inline void v_acc_load(const float * src, v_acc64f & v)
+{
+    __m128 v_src0 = _mm_loadu_ps(src), v_src1 = _mm_loadu_ps(src + 4);
+    v.v0 = _mm_cvtps_pd(v_src0);
+    v.v1 = _mm_cvtps_pd(_mm_movehl_ps(v_src0, v_src0));
+    v.v2 = _mm_cvtps_pd(v_src1);
+    v.v3 = _mm_cvtps_pd(_mm_movehl_ps(v_src1, v_src1));
+}
+
+inline void v_acc_load(const double * src, v_acc64f & v)
+{
+    v.v0 = _mm_loadu_pd(src);
+    v.v1 = _mm_loadu_pd(src + 2);
+    v.v2 = _mm_loadu_pd(src + 4);
+    v.v3 = _mm_loadu_pd(src + 6);
+}
+
+inline void v_acc_store(double * dst, const v_acc64f & v)
+{
+    _mm_storeu_pd(dst, v.v0);
+    _mm_storeu_pd(dst + 2, v.v1);
+    _mm_storeu_pd(dst + 4, v.v2);
+    _mm_storeu_pd(dst + 6, v.v3);
+}
+
+inline v_acc64f v_acc_setall(double a)
+{
+    v_acc64f v;
+    v.v0 = v.v1 = v.v2 = v.v3 = _mm_set1_pd(a);
+    return v;
+}
+
+inline v_acc64f v_acc_add(const v_acc64f & a, const v_acc64f & b)
+{
+    v_acc64f v;
+    v.v0 = _mm_add_pd(a.v0, b.v0);
+    v.v1 = _mm_add_pd(a.v1, b.v1);
+    v.v2 = _mm_add_pd(a.v2, b.v2);
+    v.v3 = _mm_add_pd(a.v3, b.v3);
+    return v;
+}
+
+inline v_acc64f v_acc_mul(const v_acc64f & a, const v_acc64f & b)
+{
+    v_acc64f v;
+    v.v0 = _mm_mul_pd(a.v0, b.v0);
+    v.v1 = _mm_mul_pd(a.v1, b.v1);
+    v.v2 = _mm_mul_pd(a.v2, b.v2);
+    v.v3 = _mm_mul_pd(a.v3, b.v3);
+    return v;
+}
+
+inline v_acc64f v_acc_masked(const uchar * mask, const v_acc64f & a, const v_acc64f & b)
+{
+    __m128i v0, v1;
+    v_acc_expand_zmask(mask, v0, v1);
+    __m128d v_zmask0 = _mm_castsi128_pd(_mm_unpacklo_epi32(v0, v0)), v_zmask1 = _mm_castsi128_pd(_mm_unpackhi_epi32(v0, v0));
+    __m128d v_zmask2 = _mm_castsi128_pd(_mm_unpacklo_epi32(v1, v1)), v_zmask3 = _mm_castsi128_pd(_mm_unpackhi_epi32(v1, v1));
+    v_acc64f v;
+    v.v0 = _mm_or_pd(_mm_and_pd(v_zmask0, a.v0), _mm_andnot_pd(v_zmask0, b.v0));
+    v.v1 = _mm_or_pd(_mm_and_pd(v_zmask1, a.v1), _mm_andnot_pd(v_zmask1, b.v1));
+    v.v2 = _mm_or_pd(_mm_and_pd(v_zmask2, a.v2), _mm_andnot_pd(v_zmask2, b.v2));
+    v.v3 = _mm_or_pd(_mm_and_pd(v_zmask3, a.v3), _mm_andnot_pd(v_zmask3, b.v3));
+    return v;
+}
+
+// The functors below compute exactly what the scalar loops do, eight elements at a time.
+// The masked rows come with a single channel, see acc_ and the other functions.
+
+template <typename T, typename AT>
+struct Acc_SSE2
+{
+    int operator() (const T * src, AT * dst, const uchar * mask, int len, int cn) const
+    {
+        typedef typename AccVec<AT>::vec_type VT;
+        int x = 0;
+
+        if (!checkHardwareSupport(CV_CPU_SSE2) || (mask && cn != 1))
+            return 0;
+
+        len *= cn;
+        for ( ; x <= len - 8; x += 8)
+        {
+            VT v_src, v_dst;
+            v_acc_load(src + x, v_src);
+            v_acc_load(dst + x, v_dst);
+            VT v_res = v_acc_add(v_src, v_dst);
+            if (mask)
+                v_res = v_acc_masked(mask + x, v_dst, v_res);
+            v_acc_store(dst + x, v_res);
+        }
+
+        return x;
+    }
+};
+
+template <typename T, typename AT>
+struct AccSqr_SSE2
+{
+    int operator() (const T * src, AT * dst, const uchar * mask, int len, int cn) const
+    {
+        typedef typename AccVec<AT>::vec_type VT;
+        int x = 0;
+
+        if (!checkHardwareSupport(CV_CPU_SSE2) || (mask && cn != 1))
+            return 0;
+
+        len *= cn;
+        for ( ; x <= len - 8; x += 8)
+        {
+            VT v_src, v_dst;
+            v_acc_load(src + x, v_src);
+            v_acc_load(dst + x, v_dst);
+            VT v_res = v_acc_add(v_acc_mul(v_src, v_src), v_dst);
+            if (mask)
+                v_res = v_acc_masked(mask + x, v_dst, v_res);
+            v_acc_store(dst + x, v_res);
+        }
+
+        return x;
+    }
+};
+
+template <typename T, typename AT>
+struct AccProd_SSE2
+{
+    int operator() (const T * src1, const T * src2, AT * dst, const uchar * mask, int len, int cn) const
+    {
+        typedef typename AccVec<AT>::vec_type VT;
+        int x = 0;
+
+        if (!checkHardwareSupport(CV_CPU_SSE2) || (mask && cn != 1))
+            return 0;
+
+        len *= cn;
+        for ( ; x <= len - 8; x += 8)
+        {
+            VT v_src1, v_src2, v_dst;
+            v_acc_load(src1 + x, v_src1);
+            v_acc_load(src2 + x, v_src2);
+            v_acc_load(dst + x, v_dst);
+            VT v_res = v_acc_add(v_acc_mul(v_src1, v_src2), v_dst);
+            if (mask)
+                v_res = v_acc_masked(mask + x, v_dst, v_res);
+            v_acc_store(dst + x, v_res);
+        }
+
+        return x;
+    }
+};
+
+template <typename T, typename AT>
+struct AccW_SSE2
+{
+    int operator() (const T * src, AT * dst, const uchar * mask, int len, int cn, AT alpha) const
+    {
+        typedef typename AccVec<AT>::vec_type VT;
+        int x = 0;
+
+        if (!checkHardwareSupport(CV_CPU_SSE2) || (mask && cn != 1))
+            return 0;
+
+        VT v_alpha = v_acc_setall(alpha), v_beta = v_acc_setall(1 - alpha);
+
+        len *= cn;
+        for ( ; x <= len - 8; x += 8)
+        {
+            VT v_src, v_dst;
+            v_acc_load(src + x, v_src);
+            v_acc_load(dst + x, v_dst);
+            VT v_res = v_acc_add(v_acc_mul(v_src, v_alpha), v_acc_mul(v_dst, v_beta));
+            if (mask)
+                v_res = v_acc_masked(mask + x, v_dst, v_res);
+            v_acc_store(dst + x, v_res);
+        }
+
+        return x;
+    }
+};
+
+template <typename T, typename AT>
+struct AccWMeanSqr_SSE2
+{
+    int operator() (const T * src, AT * dst, AT * dstSqr, const uchar * mask, int len, int cn, AT alpha) const
+    {
+        typedef typename AccVec<AT>::vec_type VT;
+        int x = 0;
+
+        if (!checkHardwareSupport(CV_CPU_SSE2) || (mask && cn != 1))
+            return 0;
+
+        VT v_alpha = v_acc_setall(alpha), v_beta = v_acc_setall(1 - alpha);
+
+        len *= cn;
+        for ( ; x <= len - 8; x += 8)
+        {
+            VT v_src, v_dst, v_dstSqr;
+            v_acc_load(src + x, v_src);
+            v_acc_load(dst + x, v_dst);
+            v_acc_load(dstSqr + x, v_dstSqr);
+            VT v_res = v_acc_add(v_acc_mul(v_src, v_alpha), v_acc_mul(v_dst, v_beta));
+            VT v_resSqr = v_acc_add(v_acc_mul(v_acc_mul(v_src, v_src), v_alpha), v_acc_mul(v_dstSqr, v_beta));
+            if (mask)
+            {
+                v_res = v_acc_masked(mask + x, v_dst, v_res);
+                v_resSqr = v_acc_masked(mask + x, v_dstSqr, v_resSqr);
+            }
+            v_acc_store(dst + x, v_res);
+            v_acc_store(dstSqr + x, v_resSqr);
+        }
+
+        return x;
+    }
+};
+
+#define DEF_ACC_SSE2(type, acctype) \
+template <> struct Acc_SIMD<type, acctype> : Acc_SSE2<type, acctype> {}; \
+template <> struct AccSqr_SIMD<type, acctype> : AccSqr_SSE2<type, acctype> {}; \
+template <> struct AccProd_SIMD<type, acctype> : AccProd_SSE2<type, acctype> {}; \
+template <> struct AccW_SIMD<type, acctype> : AccW_SSE2<type, acctype> {}; \
+template <> struct AccWMeanSqr_SIMD<type, acctype> : AccWMeanSqr_SSE2<type, acctype> {};
+
+DEF_ACC_SSE2(uchar, float)
+DEF_ACC_SSE2(uchar, double)
+DEF_ACC_SSE2(ushort, float)
+DEF_ACC_SSE2(ushort, double)
+DEF_ACC_SSE2(float, float)
+DEF_ACC_SSE2(float, double)
+DEF_ACC_SSE2(double, double)
+
 #endif
 
+// The masked multi-channel rows are processed by blocks with the mask replicated to every channel,
+// so that they can go through the single-channel loops.
+enum { ACC_MASK_BUF_SIZE = 1024 };
+
+inline int replicateMask( const uchar* mask, uchar* buf, int len, int cn )
+{
+    int n = std::min(len, (int)ACC_MASK_BUF_SIZE/cn);
+    for( int i = 0; i < n; i++, buf += cn )
+        for( int k = 0; k < cn; k++ )
+            buf[k] = mask[i];
+    return n;
+}
+
 template<typename T, typename AT> void
 acc_( const T* src, AT* dst, const uchar* mask, int len, int cn )
 {
+    if( mask && cn > 1 )
+    {
+        uchar mbuf[ACC_MASK_BUF_SIZE];
+        for( int i = 0, n; i < len; i += n, src += n*cn, dst += n*cn )
+        {
+            n = replicateMask(mask + i, mbuf, len - i, cn);
+            acc_(src, dst, mbuf, n*cn, 1);
+        }
+        return;
+    }
+
     int i = Acc_SIMD<T, AT>()(src, dst, mask, len, cn);
 
     if( !mask )
@@ -502,35 +891,23 @@ acc_( const T* src, AT* dst, const uchar* mask, int len, int cn )
                 dst[i] += src[i];
         }
     }
-    else if( cn == 3 )
-    {
-        for( ; i < len; i++, src += 3, dst += 3 )
-        {
-            if( mask[i] )
-            {
-                AT t0 = src[0] + dst[0];
-                AT t1 = src[1] + dst[1];
-                AT t2 = src[2] + dst[2];
-
-                dst[0] = t0; dst[1] = t1; dst[2] = t2;
-            }
-        }
-    }
-    else
-    {
-        for( ; i < len; i++, src += cn, dst += cn )
-            if( mask[i] )
-            {
-                for( int k = 0; k < cn; k++ )
-                    dst[k] += src[k];
-            }
-    }
 }
 
 
 template<typename T, typename AT> void
 accSqr_( const T* src, AT* dst, const uchar* mask, int len, int cn )
 {
+    if( mask && cn > 1 )
+    {
+        uchar mbuf[ACC_MASK_BUF_SIZE];
+        for( int i = 0, n; i < len; i += n, src += n*cn, dst += n*cn )
+        {
+            n = replicateMask(mask + i, mbuf, len - i, cn);
+            accSqr_(src, dst, mbuf, n*cn, 1);
+        }
+        return;
+    }
+
     int i = AccSqr_SIMD<T, AT>()(src, dst, mask, len, cn);
 
     if( !mask )
@@ -560,35 +937,23 @@ accSqr_( const T* src, AT* dst, const uchar* mask, int len, int cn )
                 dst[i] += (AT)src[i]*src[i];
         }
     }
-    else if( cn == 3 )
-    {
-        for( ; i < len; i++, src += 3, dst += 3 )
-        {
-            if( mask[i] )
-            {
-                AT t0 = (AT)src[0]*src[0] + dst[0];
-                AT t1 = (AT)src[1]*src[1] + dst[1];
-                AT t2 = (AT)src[2]*src[2] + dst[2];
-
-                dst[0] = t0; dst[1] = t1; dst[2] = t2;
-            }
-        }
-    }
-    else
-    {
-        for( ; i < len; i++, src += cn, dst += cn )
-            if( mask[i] )
-            {
-                for( int k = 0; k < cn; k++ )
-                    dst[k] += (AT)src[k]*src[k];
-            }
-    }
 }
 
 
 template<typename T, typename AT> void
 accProd_( const T* src1, const T* src2, AT* dst, const uchar* mask, int len, int cn )
 {
+    if( mask && cn > 1 )
+    {
+        uchar mbuf[ACC_MASK_BUF_SIZE];
+        for( int i = 0, n; i < len; i += n, src1 += n*cn, src2 += n*cn, dst += n*cn )
+        {
+            n = replicateMask(mask + i, mbuf, len - i, cn);
+            accProd_(src1, src2, dst, mbuf, n*cn, 1);
+        }
+        return;
+    }
+
     int i = AccProd_SIMD<T, AT>()(src1, src2, dst, mask, len, cn);
 
     if( !mask )
@@ -618,35 +983,23 @@ accProd_( const T* src1, const T* src2, AT* dst, const uchar* mask, int len, int
                 dst[i] += (AT)src1[i]*src2[i];
         }
     }
-    else if( cn == 3 )
-    {
-        for( ; i < len; i++, src1 += 3, src2 += 3, dst += 3 )
-        {
-            if( mask[i] )
-            {
-                AT t0 = (AT)src1[0]*src2[0] + dst[0];
-                AT t1 = (AT)src1[1]*src2[1] + dst[1];
-                AT t2 = (AT)src1[2]*src2[2] + dst[2];
-
-                dst[0] = t0; dst[1] = t1; dst[2] = t2;
-            }
-        }
-    }
-    else
-    {
-        for( ; i < len; i++, src1 += cn, src2 += cn, dst += cn )
-            if( mask[i] )
-            {
-                for( int k = 0; k < cn; k++ )
-                    dst[k] += (AT)src1[k]*src2[k];
-            }
-    }
 }
 
 
 template<typename T, typename AT> void
 accW_( const T* src, AT* dst, const uchar* mask, int len, int cn, double alpha )
 {
+    if( mask && cn > 1 )
+    {
+        uchar mbuf[ACC_MASK_BUF_SIZE];
+        for( int i = 0, n; i < len; i += n, src += n*cn, dst += n*cn )
+        {
+            n = replicateMask(mask + i, mbuf, len - i, cn);
+            accW_(src, dst, mbuf, n*cn, 1, alpha);
+        }
+        return;
+    }
+
     AT a = (AT)alpha, b = 1 - a;
     int i = AccW_SIMD<T, AT>()(src, dst, mask, len, cn, a);
 
@@ -677,28 +1030,47 @@ accW_( const T* src, AT* dst, const uchar* mask, int len, int cn, double alpha )
                 dst[i] = src[i]*a + dst[i]*b;
         }
     }
-    else if( cn == 3 )
+}
+
+
+template<typename T, typename AT> void
+accWMeanSqr_( const T* src, AT* dst, AT* dstSqr, const uchar* mask, int len, int cn, double alpha )
+{
+    if( mask && cn > 1 )
     {
-        for( ; i < len; i++, src += 3, dst += 3 )
+        uchar mbuf[ACC_MASK_BUF_SIZE];
+        for( int i = 0, n; i < len; i += n, src += n*cn, dst += n*cn, dstSqr += n*cn )
         {
-            if( mask[i] )
-            {
-                AT t0 = src[0]*a + dst[0]*b;
-                AT t1 = src[1]*a + dst[1]*b;
-                AT t2 = src[2]*a + dst[2]*b;
+            n = replicateMask(mask + i, mbuf, len - i, cn);
+            accWMeanSqr_(src, dst, dstSqr, mbuf, n*cn, 1, alpha);
+        }
+        return;
+    }
 
-                dst[0] = t0; dst[1] = t1; dst[2] = t2;
-            }
+    AT a = (AT)alpha, b = 1 - a;
+    int i = AccWMeanSqr_SIMD<T, AT>()(src, dst, dstSqr, mask, len, cn, a);
+
+    if( !mask )
+    {
+        len *= cn;
+        for( ; i < len; i++ )
+        {
+            AT t = src[i];
+            dst[i] = t*a + dst[i]*b;
+            dstSqr[i] = t*t*a + dstSqr[i]*b;
         }
     }
     else
     {
-        for( ; i < len; i++, src += cn, dst += cn )
+        for( ; i < len; i++ )
+        {
             if( mask[i] )
             {
-                for( int k = 0; k < cn; k++ )
-                    dst[k] = src[k]*a + dst[k]*b;
+                AT t = src[i];
+                dst[i] = t*a + dst[i]*b;
+                dstSqr[i] = t*t*a + dstSqr[i]*b;
             }
+        }
     }
 }
 
@@ -718,7 +1090,11 @@ static void accProd_##suffix(const type* src1, const type* src2, \
 \
 static void accW_##suffix(const type* src, acctype* dst, \
                           const uchar* mask, int len, int cn, double alpha) \
-{ accW_(src, dst, mask, len, cn, alpha); }
+{ accW_(src, dst, mask, len, cn, alpha); } \
+\
+static void accWMeanSqr_##suffix(const type* src, acctype* dst, acctype* dstSqr, \
+                                 const uchar* mask, int len, int cn, double alpha) \
+{ accWMeanSqr_(src, dst, dstSqr, mask, len, cn, alpha); }
 
 
 DEF_ACC_FUNCS(8u32f, uchar, float)
@@ -733,6 +1109,7 @@ DEF_ACC_FUNCS(64f, double, double)
 typedef void (*AccFunc)(const uchar*, uchar*, const uchar*, int, int);
 typedef void (*AccProdFunc)(const uchar*, const uchar*, uchar*, const uchar*, int, int);
 typedef void (*AccWFunc)(const uchar*, uchar*, const uchar*, int, int, double);
+typedef void (*AccWMeanSqrFunc)(const uchar*, uchar*, uchar*, const uchar*, int, int, double);
 
 static AccFunc accTab[] =
 {
@@ -766,6 +1143,14 @@ static AccWFunc accWTab[] =
     (AccWFunc)accW_64f
 };
 
+static AccWMeanSqrFunc accWMeanSqrTab[] =
+{
+    (AccWMeanSqrFunc)accWMeanSqr_8u32f, (AccWMeanSqrFunc)accWMeanSqr_8u64f,
+    (AccWMeanSqrFunc)accWMeanSqr_16u32f, (AccWMeanSqrFunc)accWMeanSqr_16u64f,
+    (AccWMeanSqrFunc)accWMeanSqr_32f, (AccWMeanSqrFunc)accWMeanSqr_32f64f,
+    (AccWMeanSqrFunc)accWMeanSqr_64f
+};
+
 inline int getAccTabIdx(int sdepth, int ddepth)
 {
     return sdepth == CV_8U && ddepth == CV_32F ? 0 :
@@ -777,8 +1162,6 @@ inline int getAccTabIdx(int sdepth, int ddepth)
            sdepth == CV_64F && ddepth == CV_64F ? 6 : -1;
 }
 
-#ifdef HAVE_OPENCL
-
 enum
 {
     ACCUMULATE = 0,
@@ -787,6 +1170,105 @@ enum
     ACCUMULATE_WEIGHTED = 3
 };
 
+class AccumulateInvoker : public ParallelLoopBody
+{
+public:
+    // exactly one of the functions is set
+    AccumulateInvoker( AccFunc _accFunc, AccProdFunc _accProdFunc, AccWFunc _accWFunc,
+                       AccWMeanSqrFunc _accWMeanSqrFunc, const Mat& _src1, const Mat& _src2,
+                       Mat& _dst1, Mat& _dst2, const Mat& _mask, double _alpha )
+        : accFunc(_accFunc), accProdFunc(_accProdFunc), accWFunc(_accWFunc),
+          accWMeanSqrFunc(_accWMeanSqrFunc), src1(&_src1), src2(&_src2), dst1(&_dst1), dst2(&_dst2),
+          mask(&_mask), alpha(_alpha)
+    {
+        cn = src1->channels();
+        total = src1->total();
+        continuous = src1->isContinuous() && (!src2->data || src2->isContinuous()) &&
+                     dst1->isContinuous() && (!dst2->data || dst2->isContinuous()) &&
+                     (!mask->data || mask->isContinuous());
+        // continuous arrays are split into rows of the fixed length
+        width = continuous ? (int)std::min(total, (size_t)BLOCK_SIZE) : src1->cols;
+    }
+
+    bool isContinuous() const { return continuous; }
+
+    int rows() const { return width > 0 ? (int)((total + width - 1)/width) : 0; }
+
+    void operator()( const Range& range ) const
+    {
+        for( int i = range.start; i < range.end; i++ )
+        {
+            int len = continuous ? (int)std::min((size_t)width, total - (size_t)i*width) : width;
+            run(rowPtr(*src1, i), rowPtr(*src2, i), (uchar*)rowPtr(*dst1, i), (uchar*)rowPtr(*dst2, i),
+                rowPtr(*mask, i), len);
+        }
+    }
+
+    void run( const uchar* sptr1, const uchar* sptr2, uchar* dptr1, uchar* dptr2,
+              const uchar* mptr, int len ) const
+    {
+        if( accFunc )
+            accFunc(sptr1, dptr1, mptr, len, cn);
+        else if( accProdFunc )
+            accProdFunc(sptr1, sptr2, dptr1, mptr, len, cn);
+        else if( accWFunc )
+            accWFunc(sptr1, dptr1, mptr, len, cn, alpha);
+        else
+            accWMeanSqrFunc(sptr1, dptr1, dptr2, mptr, len, cn, alpha);
+    }
+
+protected:
+    enum { BLOCK_SIZE = 1 << 12 };
+
+    const uchar* rowPtr( const Mat& m, int i ) const
+    {
+        if( !m.data )
+            return 0;
+        return continuous ? m.data + (size_t)i*width*m.elemSize() : m.ptr(i);
+    }
+
+    AccFunc accFunc;
+    AccProdFunc accProdFunc;
+    AccWFunc accWFunc;
+    AccWMeanSqrFunc accWMeanSqrFunc;
+    const Mat* src1;
+    const Mat* src2;
+    Mat* dst1;
+    Mat* dst2;
+    const Mat* mask;
+    double alpha;
+    int cn, width;
+    size_t total;
+    bool continuous;
+};
+
+static void runAccumulate( AccFunc accFunc, AccProdFunc accProdFunc, AccWFunc accWFunc,
+                           AccWMeanSqrFunc accWMeanSqrFunc, const Mat& src1, const Mat& src2,
+                           Mat& dst1, Mat& dst2, const Mat& mask, double alpha )
+{
+    if( src1.empty() )
+        return;
+
+    AccumulateInvoker body(accFunc, accProdFunc, accWFunc, accWMeanSqrFunc,
+                           src1, src2, dst1, dst2, mask, alpha);
+
+    if( body.isContinuous() || src1.dims <= 2 )
+    {
+        parallel_for_(Range(0, body.rows()), body, src1.total()*src1.channels()/(double)(1 << 16));
+        return;
+    }
+
+    const Mat* arrays[] = {&src1, &src2, &dst1, &dst2, &mask, 0};
+    uchar* ptrs[5];
+    NAryMatIterator it(arrays, ptrs);
+    int len = (int)it.size;
+
+    for( size_t i = 0; i < it.nplanes; i++, ++it )
+        body.run(ptrs[0], ptrs[1], ptrs[2], ptrs[3], ptrs[4], len);
+}
+
+#ifdef HAVE_OPENCL
+
 static bool ocl_accumulate( InputArray _src, InputArray _src2, InputOutputArray _dst, double alpha,
                             InputArray _mask, int op_type )
 {
@@ -919,13 +1401,8 @@ void cv::accumulate( InputArray _src, InputOutputArray _dst, InputArray _mask )
     AccFunc func = fidx >= 0 ? accTab[fidx] : 0;
     CV_Assert( func != 0 );
 
-    const Mat* arrays[] = {&src, &dst, &mask, 0};
-    uchar* ptrs[3];
-    NAryMatIterator it(arrays, ptrs);
-    int len = (int)it.size;
-
-    for( size_t i = 0; i < it.nplanes; i++, ++it )
-        func(ptrs[0], ptrs[1], ptrs[2], len, scn);
+    Mat src2, dst2;
+    runAccumulate(func, 0, 0, 0, src, src2, dst, dst2, mask, 0.);
 }
 
 void cv::accumulateSquare( InputArray _src, InputOutputArray _dst, InputArray _mask )
@@ -1002,13 +1479,8 @@ void cv::accumulateSquare( InputArray _src, InputOutputArray _dst, InputArray _m
     AccFunc func = fidx >= 0 ? accSqrTab[fidx] : 0;
     CV_Assert( func != 0 );
 
-    const Mat* arrays[] = {&src, &dst, &mask, 0};
-    uchar* ptrs[3];
-    NAryMatIterator it(arrays, ptrs);
-    int len = (int)it.size;
-
-    for( size_t i = 0; i < it.nplanes; i++, ++it )
-        func(ptrs[0], ptrs[1], ptrs[2], len, scn);
+    Mat src2, dst2;
+    runAccumulate(func, 0, 0, 0, src, src2, dst, dst2, mask, 0.);
 }
 
 void cv::accumulateProduct( InputArray _src1, InputArray _src2,
@@ -1090,13 +1562,8 @@ void cv::accumulateProduct( InputArray _src1, InputArray _src2,
     AccProdFunc func = fidx >= 0 ? accProdTab[fidx] : 0;
     CV_Assert( func != 0 );
 
-    const Mat* arrays[] = {&src1, &src2, &dst, &mask, 0};
-    uchar* ptrs[4];
-    NAryMatIterator it(arrays, ptrs);
-    int len = (int)it.size;
-
-    for( size_t i = 0; i < it.nplanes; i++, ++it )
-        func(ptrs[0], ptrs[1], ptrs[2], ptrs[3], len, scn);
+    Mat dst2;
+    runAccumulate(0, func, 0, 0, src1, src2, dst, dst2, mask, 0.);
 }
 
 void cv::accumulateWeighted( InputArray _src, InputOutputArray _dst,
@@ -1176,13 +1643,28 @@ void cv::accumulateWeighted( InputArray _src, InputOutputArray _dst,
     AccWFunc func = fidx >= 0 ? accWTab[fidx] : 0;
     CV_Assert( func != 0 );
 
-    const Mat* arrays[] = {&src, &dst, &mask, 0};
-    uchar* ptrs[3];
-    NAryMatIterator it(arrays, ptrs);
-    int len = (int)it.size;
+    Mat src2, dst2;
+    runAccumulate(0, 0, func, 0, src, src2, dst, dst2, mask, alpha);
+}
 
-    for( size_t i = 0; i < it.nplanes; i++, ++it )
-        func(ptrs[0], ptrs[1], ptrs[2], len, scn, alpha);
+void cv::accumulateWeightedMeanSqr( InputArray _src, InputOutputArray _dst, InputOutputArray _dstSqr,
+                                    double alpha, InputArray _mask )
+{
+    int stype = _src.type(), sdepth = CV_MAT_DEPTH(stype), scn = CV_MAT_CN(stype);
+    int dtype = _dst.type(), ddepth = CV_MAT_DEPTH(dtype), dcn = CV_MAT_CN(dtype);
+
+    CV_Assert( _src.sameSize(_dst) && dcn == scn );
+    CV_Assert( _dst.sameSize(_dstSqr) && _dstSqr.type() == dtype );
+    CV_Assert( _mask.empty() || (_src.sameSize(_mask) && _mask.type() == CV_8U) );
+
+    Mat src = _src.getMat(), dst = _dst.getMat(), dstSqr = _dstSqr.getMat(), mask = _mask.getMat();
+
+    int fidx = getAccTabIdx(sdepth, ddepth);
+    AccWMeanSqrFunc func = fidx >= 0 ? accWMeanSqrTab[fidx] : 0;
+    CV_Assert( func != 0 );
+
+    Mat src2;
+    runAccumulate(0, 0, 0, func, src, src2, dst, dstSqr, mask, alpha);
 }
 
 
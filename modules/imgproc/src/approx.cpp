@@ -699,6 +699,58 @@ void cv::approxPolyDP( InputArray _curve, OutputArray _approxCurve,
     Mat(nout, 1, CV_MAKETYPE(depth, 2), buf).copyTo(_approxCurve);
 }
 
+namespace cv
+{
+
+class ApproxPolyDPBatchInvoker : public ParallelLoopBody
+{
+public:
+    ApproxPolyDPBatchInvoker( const ContourBatch& _batch, Mat& _buf, std::vector<int>& _nout,
+                              double _epsilon, bool _closed )
+        : batch(&_batch), buf(&_buf), nout(&_nout), epsilon(_epsilon), closed(_closed) {}
+
+    void operator()( const Range& range ) const
+    {
+        int i, maxCount = 1;
+        for( i = range.start; i < range.end; i++ )
+            maxCount = std::max(maxCount, batch->counts[i]);
+
+        AutoBuffer<Range> _stack(maxCount);
+        for( i = range.start; i < range.end; i++ )
+        {
+            int start = batch->starts[i];
+            if( batch->depth == CV_32S )
+                (*nout)[i] = approxPolyDP_(batch->ptrs[i], batch->counts[i], buf->ptr<Point>() + start,
+                                           closed, epsilon, &_stack);
+            else
+                (*nout)[i] = approxPolyDP_((const Point2f*)batch->ptrs[i], batch->counts[i],
+                                           buf->ptr<Point2f>() + start, closed, epsilon, &_stack);
+        }
+    }
+
+protected:
+    const ContourBatch* batch;
+    Mat* buf;
+    std::vector<int>* nout;
+    double epsilon;
+    bool closed;
+};
+
+}
+
+void cv::approxPolyDPBatch( InputArrayOfArrays _curves, OutputArray _approxCurves, OutputArray _offsets,
+                            double epsilon, bool closed )
+{
+    ContourBatch batch(_curves);
+    int n = batch.size();
+    Mat buf(batch.total, 1, CV_MAKETYPE(batch.depth, 2));
+    std::vector<int> nout(n);
+
+    parallel_for_(Range(0, n), ApproxPolyDPBatchInvoker(batch, buf, nout, epsilon, closed),
+                  batch.total/(double)(1 << 14));
+    packContourBatch(batch, buf, nout, _approxCurves, _offsets);
+}
+
 
 CV_IMPL CvSeq*
 cvApproxPoly( const void* array, int header_size,
@@ -230,6 +230,281 @@ static bool ocl_Canny(InputArray _src, OutputArray _dst, float low_thresh, float
 
 #endif
 
+#define CANNY_PUSH(d)    *(d) = uchar(2), stack.push_back(d)
+#define CANNY_POP(d)     (d) = stack.back(), stack.pop_back()
+
+// computes the gradient magnitude (|dx|+|dy| or dx^2+dy^2) of a row;
+// for multi-channel images the channel with the largest magnitude is selected
+// and its derivatives are moved to the first cols elements of the rows
+static void cannyMagnitude(short* _dx, short* _dy, int* _norm, int cols, int cn, bool L2gradient)
+{
+    int j = 0, width = cols * cn;
+#if CV_SSE2
+    bool haveSSE2 = checkHardwareSupport(CV_CPU_SSE2);
+#endif
+
+    if (!L2gradient)
+    {
+#if CV_SSE2
+        if (haveSSE2)
+        {
+            __m128i v_zero = _mm_setzero_si128();
+            for ( ; j <= width - 8; j += 8)
+            {
+                __m128i v_dx = _mm_loadu_si128((const __m128i *)(_dx + j));
+                __m128i v_dy = _mm_loadu_si128((const __m128i *)(_dy + j));
+                v_dx = _mm_max_epi16(v_dx, _mm_sub_epi16(v_zero, v_dx));
+                v_dy = _mm_max_epi16(v_dy, _mm_sub_epi16(v_zero, v_dy));
+
+                __m128i v_norm = _mm_add_epi32(_mm_unpacklo_epi16(v_dx, v_zero), _mm_unpacklo_epi16(v_dy, v_zero));
+                _mm_storeu_si128((__m128i *)(_norm + j), v_norm);
+
+                v_norm = _mm_add_epi32(_mm_unpackhi_epi16(v_dx, v_zero), _mm_unpackhi_epi16(v_dy, v_zero));
+                _mm_storeu_si128((__m128i *)(_norm + j + 4), v_norm);
+            }
+        }
+#elif CV_NEON
+        for ( ; j <= width - 8; j += 8)
+        {
+            int16x8_t v_dx = vld1q_s16(_dx + j), v_dy = vld1q_s16(_dy + j);
+            vst1q_s32(_norm + j, vaddq_s32(vabsq_s32(vmovl_s16(vget_low_s16(v_dx))),
+                                           vabsq_s32(vmovl_s16(vget_low_s16(v_dy)))));
+            vst1q_s32(_norm + j + 4, vaddq_s32(vabsq_s32(vmovl_s16(vget_high_s16(v_dx))),
+                                               vabsq_s32(vmovl_s16(vget_high_s16(v_dy)))));
+        }
+#endif
+        for ( ; j < width; ++j)
+            _norm[j] = std::abs(int(_dx[j])) + std::abs(int(_dy[j]));
+    }
+    else
+    {
+#if CV_SSE2
+        if (haveSSE2)
+        {
+            for ( ; j <= width - 8; j += 8)
+            {
+                __m128i v_dx = _mm_loadu_si128((const __m128i *)(_dx + j));
+                __m128i v_dy = _mm_loadu_si128((const __m128i *)(_dy + j));
+
+                __m128i v_dx_ml = _mm_mullo_epi16(v_dx, v_dx), v_dx_mh = _mm_mulhi_epi16(v_dx, v_dx);
+                __m128i v_dy_ml = _mm_mullo_epi16(v_dy, v_dy), v_dy_mh = _mm_mulhi_epi16(v_dy, v_dy);
+
+                __m128i v_norm = _mm_add_epi32(_mm_unpacklo_epi16(v_dx_ml, v_dx_mh), _mm_unpacklo_epi16(v_dy_ml, v_dy_mh));
+                _mm_storeu_si128((__m128i *)(_norm + j), v_norm);
+
+                v_norm = _mm_add_epi32(_mm_unpackhi_epi16(v_dx_ml, v_dx_mh), _mm_unpackhi_epi16(v_dy_ml, v_dy_mh));
+                _mm_storeu_si128((__m128i *)(_norm + j + 4), v_norm);
+            }
+        }
+#elif CV_NEON
+        for ( ; j <= width - 8; j += 8)
+        {
+            int16x8_t v_dx = vld1q_s16(_dx + j), v_dy = vld1q_s16(_dy + j);
+            int16x4_t v_dxp = vget_low_s16(v_dx), v_dyp = vget_low_s16(v_dy);
+            int32x4_t v_dst = vmlal_s16(vmull_s16(v_dxp, v_dxp), v_dyp, v_dyp);
+            vst1q_s32(_norm + j, v_dst);
+
+            v_dxp = vget_high_s16(v_dx), v_dyp = vget_high_s16(v_dy);
+            v_dst = vmlal_s16(vmull_s16(v_dxp, v_dxp), v_dyp, v_dyp);
+            vst1q_s32(_norm + j + 4, v_dst);
+        }
+#endif
+        for ( ; j < width; ++j)
+            _norm[j] = int(_dx[j])*_dx[j] + int(_dy[j])*_dy[j];
+    }
+
+    if (cn > 1)
+    {
+        for(int jj = 0, jn = 0; jj < cols; ++jj, jn += cn)
+        {
+            int maxIdx = jn;
+            for(int k = 1; k < cn; ++k)
+                if(_norm[jn + k] > _norm[maxIdx]) maxIdx = jn + k;
+            _norm[jj] = _norm[maxIdx];
+            _dx[jj] = _dx[maxIdx];
+            _dy[jj] = _dy[maxIdx];
+        }
+    }
+    _norm[-1] = _norm[cols] = 0;
+}
+
+/*
+ Processes the image by horizontal bands. Within a band the derivatives, the magnitude and
+ the non-maxima suppression are computed chunk by chunk in small buffers, then the edges
+ are traced inside the band. The traced pixels whose neighbors lie in the other bands are
+ stored in borderPts, and the tracing across the band borders is finished afterwards.
+*/
+class CannyInvoker : public ParallelLoopBody
+{
+public:
+    CannyInvoker(const Mat& _src, uchar* _map, ptrdiff_t _mapstep, int _low, int _high,
+                 int _aperture_size, bool _L2gradient, int _nbands,
+                 std::vector<std::vector<uchar*> >& _borderPts)
+        : src(&_src), map(_map), mapstep(_mapstep), low(_low), high(_high),
+          aperture_size(_aperture_size), L2gradient(_L2gradient), nbands(_nbands),
+          borderPts(&_borderPts) {}
+
+    void operator()(const Range& range) const
+    {
+        for (int band = range.start; band < range.end; band++)
+            processBand(band);
+    }
+
+private:
+    void processBand(int band) const
+    {
+        enum { CHUNK_ROWS = 32 };
+
+        const int rows = src->rows, cols = src->cols, cn = src->channels();
+        const int y0 = (int)((int64)band * rows / nbands);
+        const int y1 = (int)((int64)(band + 1) * rows / nbands);
+
+        Ptr<FilterEngine> fdx = createDerivFilter(src->type(), CV_16SC(cn), 1, 0, aperture_size, BORDER_REPLICATE);
+        Ptr<FilterEngine> fdy = createDerivFilter(src->type(), CV_16SC(cn), 0, 1, aperture_size, BORDER_REPLICATE);
+
+        // the derivatives and the magnitude of the chunk rows and of one row above and below
+        Mat dx(CHUNK_ROWS + 2, cols, CV_16SC(cn)), dy(CHUNK_ROWS + 2, cols, CV_16SC(cn));
+        ptrdiff_t magstep = mapstep*cn;
+        AutoBuffer<int> _magbuf(magstep*(CHUNK_ROWS + 2));
+        int* magbuf = _magbuf;
+
+        std::vector<uchar*> stack;
+        stack.reserve(std::max(1 << 10, cols * (y1 - y0) / 10));
+
+        for (int r0 = y0; r0 < y1; r0 += CHUNK_ROWS)
+        {
+            int r1 = std::min(r0 + CHUNK_ROWS, y1);
+            int a = std::max(r0 - 1, 0), b = std::min(r1 + 1, rows);
+
+            // local row k corresponds to the image row r0 - 1 + k
+            fdx->apply(*src, dx, Rect(0, a, cols, b - a), Point(0, a - r0 + 1));
+            fdy->apply(*src, dy, Rect(0, a, cols, b - a), Point(0, a - r0 + 1));
+
+            for (int i = r0 - 1; i <= r1; i++)
+            {
+                int* _norm = magbuf + magstep*(i - r0 + 1) + 1;
+                if (i < a || i >= b)
+                    memset(_norm - 1, 0, mapstep*sizeof(int));
+                else
+                    cannyMagnitude(dx.ptr<short>(i - r0 + 1), dy.ptr<short>(i - r0 + 1),
+                                   _norm, cols, cn, L2gradient);
+            }
+
+            for (int i = r0; i < r1; i++)
+            {
+                uchar* _map = map + mapstep*(i + 1) + 1;
+                _map[-1] = _map[cols] = 1;
+
+                const int* _mag = magbuf + magstep*(i - r0 + 1) + 1; // take the central row
+                ptrdiff_t magstep1 = magstep;
+                ptrdiff_t magstep2 = -magstep;
+
+                const short* _x = dx.ptr<short>(i - r0 + 1);
+                const short* _y = dy.ptr<short>(i - r0 + 1);
+
+                // the row above belongs to the other band when i == y0
+                bool checkAbove = i > y0;
+                int prev_flag = 0;
+                for (int j = 0; j < cols; j++)
+                {
+                    #define CANNY_SHIFT 15
+                    const int TG22 = (int)(0.4142135623730950488016887242097*(1<<CANNY_SHIFT) + 0.5);
+
+                    int m = _mag[j];
+
+                    if (m > low)
+                    {
+                        int xs = _x[j];
+                        int ys = _y[j];
+                        int x = std::abs(xs);
+                        int y = std::abs(ys) << CANNY_SHIFT;
+
+                        int tg22x = x * TG22;
+
+                        if (y < tg22x)
+                        {
+                            if (m > _mag[j-1] && m >= _mag[j+1]) goto __ocv_canny_push;
+                        }
+                        else
+                        {
+                            int tg67x = tg22x + (x << (CANNY_SHIFT+1));
+                            if (y > tg67x)
+                            {
+                                if (m > _mag[j+magstep2] && m >= _mag[j+magstep1]) goto __ocv_canny_push;
+                            }
+                            else
+                            {
+                                int s = (xs ^ ys) < 0 ? -1 : 1;
+                                if (m > _mag[j+magstep2-s] && m > _mag[j+magstep1+s]) goto __ocv_canny_push;
+                            }
+                        }
+                    }
+                    prev_flag = 0;
+                    _map[j] = uchar(1);
+                    continue;
+__ocv_canny_push:
+                    if (!prev_flag && m > high && (!checkAbove || _map[j-mapstep] != 2))
+                    {
+                        CANNY_PUSH(_map + j);
+                        prev_flag = 1;
+                    }
+                    else
+                        _map[j] = 0;
+                }
+            }
+        }
+
+        // track the edges within the band (hysteresis thresholding)
+        const uchar* bandStart = map + mapstep*(y0 + 1);
+        const uchar* bandEnd = map + mapstep*(y1 + 1);
+        std::vector<uchar*>& border = (*borderPts)[band];
+
+        while (!stack.empty())
+        {
+            uchar* m;
+            CANNY_POP(m);
+
+            if (!m[-1])         CANNY_PUSH(m - 1);
+            if (!m[1])          CANNY_PUSH(m + 1);
+
+            if (m - mapstep >= bandStart)
+            {
+                if (!m[-mapstep-1]) CANNY_PUSH(m - mapstep - 1);
+                if (!m[-mapstep])   CANNY_PUSH(m - mapstep);
+                if (!m[-mapstep+1]) CANNY_PUSH(m - mapstep + 1);
+            }
+            else
+            {
+                border.push_back(m - mapstep - 1);
+                border.push_back(m - mapstep);
+                border.push_back(m - mapstep + 1);
+            }
+
+            if (m + mapstep < bandEnd)
+            {
+                if (!m[mapstep-1])  CANNY_PUSH(m + mapstep - 1);
+                if (!m[mapstep])    CANNY_PUSH(m + mapstep);
+                if (!m[mapstep+1])  CANNY_PUSH(m + mapstep + 1);
+            }
+            else
+            {
+                border.push_back(m + mapstep - 1);
+                border.push_back(m + mapstep);
+                border.push_back(m + mapstep + 1);
+            }
+        }
+    }
+
+    const Mat* src;
+    uchar* map;
+    ptrdiff_t mapstep;
+    int low, high;
+    int aperture_size;
+    bool L2gradient;
+    int nbands;
+    std::vector<std::vector<uchar*> >* borderPts;
+};
+
 }
 
 void cv::Canny( InputArray _src, OutputArray _dst,
@@ -280,12 +555,6 @@ void cv::Canny( InputArray _src, OutputArray _dst,
     }
 #endif
 
-    Mat dx(src.rows, src.cols, CV_16SC(cn));
-    Mat dy(src.rows, src.cols, CV_16SC(cn));
-
-    Sobel(src, dx, CV_16S, 1, 0, aperture_size, 1, 0, BORDER_REPLICATE);
-    Sobel(src, dy, CV_16S, 0, 1, aperture_size, 1, 0, BORDER_REPLICATE);
-
     if (L2gradient)
     {
         low_thresh = std::min(32767.0, low_thresh);
@@ -297,24 +566,17 @@ void cv::Canny( InputArray _src, OutputArray _dst,
     int low = cvFloor(low_thresh);
     int high = cvFloor(high_thresh);
 
+    // the map of the pixels with one-pixel border:
+    //   0 - the pixel might belong to an edge
+    //   1 - the pixel can not belong to an edge
+    //   2 - the pixel does belong to an edge
     ptrdiff_t mapstep = src.cols + 2;
-    AutoBuffer<uchar> buffer((src.cols+2)*(src.rows+2) + cn * mapstep * 3 * sizeof(int));
+    AutoBuffer<uchar> buffer((src.cols+2)*(src.rows+2));
 
-    int* mag_buf[3];
-    mag_buf[0] = (int*)(uchar*)buffer;
-    mag_buf[1] = mag_buf[0] + mapstep*cn;
-    mag_buf[2] = mag_buf[1] + mapstep*cn;
-    memset(mag_buf[0], 0, /* cn* */mapstep*sizeof(int));
-
-    uchar* map = (uchar*)(mag_buf[2] + mapstep*cn);
+    uchar* map = (uchar*)buffer;
     memset(map, 1, mapstep);
     memset(map + mapstep*(src.rows + 1), 1, mapstep);
 
-    int maxsize = std::max(1 << 10, src.cols * src.rows / 10);
-    std::vector<uchar*> stack(maxsize);
-    uchar **stack_top = &stack[0];
-    uchar **stack_bottom = &stack[0];
-
     /* sector numbers
        (Top-Left Origin)
 
@@ -327,207 +589,27 @@ void cv::Canny( InputArray _src, OutputArray _dst,
         3   2   1
     */
 
-    #define CANNY_PUSH(d)    *(d) = uchar(2), *stack_top++ = (d)
-    #define CANNY_POP(d)     (d) = *--stack_top
-
-#if CV_SSE2
-    bool haveSSE2 = checkHardwareSupport(CV_CPU_SSE2);
-#endif
-
-    // calculate magnitude and angle of gradient, perform non-maxima suppression.
-    // fill the map with one of the following values:
-    //   0 - the pixel might belong to an edge
-    //   1 - the pixel can not belong to an edge
-    //   2 - the pixel does belong to an edge
-    for (int i = 0; i <= src.rows; i++)
+    // calculate magnitude and angle of gradient, perform non-maxima suppression
+    // and track the edges inside the horizontal bands of the image
+    int nbands = std::max(1, std::min(src.rows / 32, std::max(getNumThreads(), 1) * 4));
+    std::vector<std::vector<uchar*> > borderPts(nbands);
+    parallel_for_(Range(0, nbands),
+                  CannyInvoker(src, map, mapstep, low, high, aperture_size, L2gradient, nbands, borderPts),
+                  nbands);
+
+    // continue tracking the edges that cross the band borders
+    std::vector<uchar*> stack;
+    for (int band = 0; band < nbands; band++)
     {
-        int* _norm = mag_buf[(i > 0) + 1] + 1;
-        if (i < src.rows)
-        {
-            short* _dx = dx.ptr<short>(i);
-            short* _dy = dy.ptr<short>(i);
-
-            if (!L2gradient)
-            {
-                int j = 0, width = src.cols * cn;
-#if CV_SSE2
-                if (haveSSE2)
-                {
-                    __m128i v_zero = _mm_setzero_si128();
-                    for ( ; j <= width - 8; j += 8)
-                    {
-                        __m128i v_dx = _mm_loadu_si128((const __m128i *)(_dx + j));
-                        __m128i v_dy = _mm_loadu_si128((const __m128i *)(_dy + j));
-                        v_dx = _mm_max_epi16(v_dx, _mm_sub_epi16(v_zero, v_dx));
-                        v_dy = _mm_max_epi16(v_dy, _mm_sub_epi16(v_zero, v_dy));
-
-                        __m128i v_norm = _mm_add_epi32(_mm_unpacklo_epi16(v_dx, v_zero), _mm_unpacklo_epi16(v_dy, v_zero));
-                        _mm_storeu_si128((__m128i *)(_norm + j), v_norm);
-
-                        v_norm = _mm_add_epi32(_mm_unpackhi_epi16(v_dx, v_zero), _mm_unpackhi_epi16(v_dy, v_zero));
-                        _mm_storeu_si128((__m128i *)(_norm + j + 4), v_norm);
-                    }
-                }
-#elif CV_NEON
-                for ( ; j <= width - 8; j += 8)
-                {
-                    int16x8_t v_dx = vld1q_s16(_dx + j), v_dy = vld1q_s16(_dy + j);
-                    vst1q_s32(_norm + j, vaddq_s32(vabsq_s32(vmovl_s16(vget_low_s16(v_dx))),
-                                                   vabsq_s32(vmovl_s16(vget_low_s16(v_dy)))));
-                    vst1q_s32(_norm + j + 4, vaddq_s32(vabsq_s32(vmovl_s16(vget_high_s16(v_dx))),
-                                                       vabsq_s32(vmovl_s16(vget_high_s16(v_dy)))));
-                }
-#endif
-                for ( ; j < width; ++j)
-                    _norm[j] = std::abs(int(_dx[j])) + std::abs(int(_dy[j]));
-            }
-            else
-            {
-                int j = 0, width = src.cols * cn;
-#if CV_SSE2
-                if (haveSSE2)
-                {
-                    for ( ; j <= width - 8; j += 8)
-                    {
-                        __m128i v_dx = _mm_loadu_si128((const __m128i *)(_dx + j));
-                        __m128i v_dy = _mm_loadu_si128((const __m128i *)(_dy + j));
-
-                        __m128i v_dx_ml = _mm_mullo_epi16(v_dx, v_dx), v_dx_mh = _mm_mulhi_epi16(v_dx, v_dx);
-                        __m128i v_dy_ml = _mm_mullo_epi16(v_dy, v_dy), v_dy_mh = _mm_mulhi_epi16(v_dy, v_dy);
-
-                        __m128i v_norm = _mm_add_epi32(_mm_unpacklo_epi16(v_dx_ml, v_dx_mh), _mm_unpacklo_epi16(v_dy_ml, v_dy_mh));
-                        _mm_storeu_si128((__m128i *)(_norm + j), v_norm);
-
-                        v_norm = _mm_add_epi32(_mm_unpackhi_epi16(v_dx_ml, v_dx_mh), _mm_unpackhi_epi16(v_dy_ml, v_dy_mh));
-                        _mm_storeu_si128((__m128i *)(_norm + j + 4), v_norm);
-                    }
-                }
-#elif CV_NEON
-                for ( ; j <= width - 8; j += 8)
-                {
-                    int16x8_t v_dx = vld1q_s16(_dx + j), v_dy = vld1q_s16(_dy + j);
-                    int16x4_t v_dxp = vget_low_s16(v_dx), v_dyp = vget_low_s16(v_dy);
-                    int32x4_t v_dst = vmlal_s16(vmull_s16(v_dxp, v_dxp), v_dyp, v_dyp);
-                    vst1q_s32(_norm + j, v_dst);
-
-                    v_dxp = vget_high_s16(v_dx), v_dyp = vget_high_s16(v_dy);
-                    v_dst = vmlal_s16(vmull_s16(v_dxp, v_dxp), v_dyp, v_dyp);
-                    vst1q_s32(_norm + j + 4, v_dst);
-                }
-#endif
-                for ( ; j < width; ++j)
-                    _norm[j] = int(_dx[j])*_dx[j] + int(_dy[j])*_dy[j];
-            }
-
-            if (cn > 1)
-            {
-                for(int j = 0, jn = 0; j < src.cols; ++j, jn += cn)
-                {
-                    int maxIdx = jn;
-                    for(int k = 1; k < cn; ++k)
-                        if(_norm[jn + k] > _norm[maxIdx]) maxIdx = jn + k;
-                    _norm[j] = _norm[maxIdx];
-                    _dx[j] = _dx[maxIdx];
-                    _dy[j] = _dy[maxIdx];
-                }
-            }
-            _norm[-1] = _norm[src.cols] = 0;
-        }
-        else
-            memset(_norm-1, 0, /* cn* */mapstep*sizeof(int));
-
-        // at the very beginning we do not have a complete ring
-        // buffer of 3 magnitude rows for non-maxima suppression
-        if (i == 0)
-            continue;
-
-        uchar* _map = map + mapstep*i + 1;
-        _map[-1] = _map[src.cols] = 1;
-
-        int* _mag = mag_buf[1] + 1; // take the central row
-        ptrdiff_t magstep1 = mag_buf[2] - mag_buf[1];
-        ptrdiff_t magstep2 = mag_buf[0] - mag_buf[1];
-
-        const short* _x = dx.ptr<short>(i-1);
-        const short* _y = dy.ptr<short>(i-1);
-
-        if ((stack_top - stack_bottom) + src.cols > maxsize)
-        {
-            int sz = (int)(stack_top - stack_bottom);
-            maxsize = std::max(maxsize * 3/2, sz + src.cols);
-            stack.resize(maxsize);
-            stack_bottom = &stack[0];
-            stack_top = stack_bottom + sz;
-        }
-
-        int prev_flag = 0;
-        for (int j = 0; j < src.cols; j++)
-        {
-            #define CANNY_SHIFT 15
-            const int TG22 = (int)(0.4142135623730950488016887242097*(1<<CANNY_SHIFT) + 0.5);
-
-            int m = _mag[j];
-
-            if (m > low)
-            {
-                int xs = _x[j];
-                int ys = _y[j];
-                int x = std::abs(xs);
-                int y = std::abs(ys) << CANNY_SHIFT;
-
-                int tg22x = x * TG22;
-
-                if (y < tg22x)
-                {
-                    if (m > _mag[j-1] && m >= _mag[j+1]) goto __ocv_canny_push;
-                }
-                else
-                {
-                    int tg67x = tg22x + (x << (CANNY_SHIFT+1));
-                    if (y > tg67x)
-                    {
-                        if (m > _mag[j+magstep2] && m >= _mag[j+magstep1]) goto __ocv_canny_push;
-                    }
-                    else
-                    {
-                        int s = (xs ^ ys) < 0 ? -1 : 1;
-                        if (m > _mag[j+magstep2-s] && m > _mag[j+magstep1+s]) goto __ocv_canny_push;
-                    }
-                }
-            }
-            prev_flag = 0;
-            _map[j] = uchar(1);
-            continue;
-__ocv_canny_push:
-            if (!prev_flag && m > high && _map[j-mapstep] != 2)
-            {
-                CANNY_PUSH(_map + j);
-                prev_flag = 1;
-            }
-            else
-                _map[j] = 0;
-        }
-
-        // scroll the ring buffer
-        _mag = mag_buf[0];
-        mag_buf[0] = mag_buf[1];
-        mag_buf[1] = mag_buf[2];
-        mag_buf[2] = _mag;
+        const std::vector<uchar*>& border = borderPts[band];
+        for (size_t k = 0; k < border.size(); k++)
+            if (!*border[k])
+                CANNY_PUSH(border[k]);
     }
 
-    // now track the edges (hysteresis thresholding)
-    while (stack_top > stack_bottom)
+    while (!stack.empty())
     {
         uchar* m;
-        if ((stack_top - stack_bottom) + 8 > maxsize)
-        {
-            int sz = (int)(stack_top - stack_bottom);
-            maxsize = maxsize * 3/2;
-            stack.resize(maxsize);
-            stack_bottom = &stack[0];
-            stack_top = stack_bottom + sz;
-        }
-
         CANNY_POP(m);
 
         if (!m[-1])         CANNY_PUSH(m - 1);
@@ -42,6 +42,7 @@
 //
 #include "precomp.hpp"
 #include <vector>
+#include <limits>
 
 namespace cv{
     namespace connectedcomponents{
@@ -51,8 +52,14 @@ namespace cv{
         }
         void init(int /*labels*/){
         }
+        int maxStripes(int /*labels*/) const{
+            return INT_MAX;
+        }
+        void initStripes(int /*nstripes*/){
+        }
         inline
-        void operator()(int r, int c, int l){
+        void operator()(int s, int r, int c, int l){
+            (void) s;
             (void) r;
             (void) c;
             (void) l;
@@ -64,50 +71,81 @@ namespace cv{
         Point2ui64(uint64 _x, uint64 _y):x(_x), y(_y){}
     };
 
+    //The statistics are accumulated per stripe of the second scan and merged in finish().
+    //CC_STAT_WIDTH and CC_STAT_HEIGHT hold the rightmost column and the bottom row until then.
     struct CCStatsOp{
         const _OutputArray* _mstatsv;
         cv::Mat statsv;
         const _OutputArray* _mcentroidsv;
         cv::Mat centroidsv;
+        int nlabels;
+        std::vector<int> stripeStats;
         std::vector<Point2ui64> integrals;
 
-        CCStatsOp(OutputArray _statsv, OutputArray _centroidsv): _mstatsv(&_statsv), _mcentroidsv(&_centroidsv){
+        CCStatsOp(OutputArray _statsv, OutputArray _centroidsv): _mstatsv(&_statsv), _mcentroidsv(&_centroidsv), nlabels(0){
         }
         inline
-        void init(int nlabels){
+        void init(int _nlabels){
+            nlabels = _nlabels;
             _mstatsv->create(cv::Size(CC_STAT_MAX, nlabels), cv::DataType<int>::type);
             statsv = _mstatsv->getMat();
             _mcentroidsv->create(cv::Size(2, nlabels), cv::DataType<double>::type);
             centroidsv = _mcentroidsv->getMat();
-
-            for(int l = 0; l < (int) nlabels; ++l){
-                int *row = (int *) &statsv.at<int>(l, 0);
+        }
+        //keep the per-stripe tables within 64Mb
+        int maxStripes(int _nlabels) const{
+            size_t labelSize = CC_STAT_MAX*sizeof(int) + sizeof(Point2ui64);
+            return (int)std::max((size_t)1, ((size_t)1 << 26)/(labelSize*_nlabels));
+        }
+        void initStripes(int nstripes){
+            stripeStats.resize((size_t)nstripes*nlabels*CC_STAT_MAX);
+            integrals.assign((size_t)nstripes*nlabels, Point2ui64(0, 0));
+            for(size_t l = 0; l < (size_t)nstripes*nlabels; ++l){
+                int *row = &stripeStats[l*CC_STAT_MAX];
                 row[CC_STAT_LEFT] = INT_MAX;
                 row[CC_STAT_TOP] = INT_MAX;
                 row[CC_STAT_WIDTH] = INT_MIN;
                 row[CC_STAT_HEIGHT] = INT_MIN;
                 row[CC_STAT_AREA] = 0;
             }
-            integrals.resize(nlabels, Point2ui64(0, 0));
         }
-        void operator()(int r, int c, int l){
-            int *row = &statsv.at<int>(l, 0);
+        inline
+        void operator()(int s, int r, int c, int l){
+            size_t idx = (size_t)s*nlabels + l;
+            int *row = &stripeStats[idx*CC_STAT_MAX];
             row[CC_STAT_LEFT] = MIN(row[CC_STAT_LEFT], c);
             row[CC_STAT_WIDTH] = MAX(row[CC_STAT_WIDTH], c);
             row[CC_STAT_TOP] = MIN(row[CC_STAT_TOP], r);
             row[CC_STAT_HEIGHT] = MAX(row[CC_STAT_HEIGHT], r);
             row[CC_STAT_AREA]++;
-            Point2ui64 &integral = integrals[l];
+            Point2ui64 &integral = integrals[idx];
             integral.x += c;
             integral.y += r;
         }
         void finish(){
-            for(int l = 0; l < statsv.rows; ++l){
+            int nstripes = nlabels > 0 ? (int)(integrals.size()/nlabels) : 0;
+            for(int l = 0; l < nlabels; ++l){
                 int *row = &statsv.at<int>(l, 0);
+                Point2ui64 integral(0, 0);
+                for(int k = 0; k < CC_STAT_MAX; ++k){
+                    row[k] = stripeStats[(size_t)l*CC_STAT_MAX + k];
+                }
+                for(int s = 0; s < nstripes; ++s){
+                    size_t idx = (size_t)s*nlabels + l;
+                    const int *srow = &stripeStats[idx*CC_STAT_MAX];
+                    if(s > 0){
+                        row[CC_STAT_LEFT] = MIN(row[CC_STAT_LEFT], srow[CC_STAT_LEFT]);
+                        row[CC_STAT_WIDTH] = MAX(row[CC_STAT_WIDTH], srow[CC_STAT_WIDTH]);
+                        row[CC_STAT_TOP] = MIN(row[CC_STAT_TOP], srow[CC_STAT_TOP]);
+                        row[CC_STAT_HEIGHT] = MAX(row[CC_STAT_HEIGHT], srow[CC_STAT_HEIGHT]);
+                        row[CC_STAT_AREA] += srow[CC_STAT_AREA];
+                    }
+                    integral.x += integrals[idx].x;
+                    integral.y += integrals[idx].y;
+                }
                 row[CC_STAT_WIDTH] = row[CC_STAT_WIDTH] - row[CC_STAT_LEFT] + 1;
                 row[CC_STAT_HEIGHT] = row[CC_STAT_HEIGHT] - row[CC_STAT_TOP] + 1;
 
-                Point2ui64 &integral = integrals[l];
                 double *centroid = &centroidsv.at<double>(l, 0);
                 double area = ((unsigned*)row)[CC_STAT_AREA];
                 centroid[0] = double(integral.x) / area;
@@ -164,12 +202,12 @@ namespace cv{
         return root;
     }
 
-    //Flatten the Union Find tree and relabel the components
+    //Flatten the Union Find tree and relabel the components of the label range [first, end),
+    //the final labels starting from k; returns the next free final label
     template<typename LabelT>
     inline static
-    LabelT flattenL(LabelT *P, LabelT length){
-        LabelT k = 1;
-        for(LabelT i = 1; i < length; ++i){
+    LabelT flattenL(LabelT *P, LabelT first, LabelT end, LabelT k){
+        for(LabelT i = first; i < end; ++i){
             if(P[i] < i){
                 P[i] = P[P[i]];
             }else{
@@ -179,14 +217,233 @@ namespace cv{
         return k;
     }
 
+    //Upper bound for the number of provisional labels of a stripe: one per 2x2 block for
+    //8-way connectivity, and one per two pixels (the checkerboard case) for 4-way
+    inline static
+    size_t maxStripeLabels(int rows, int cols, int connectivity){
+        if(connectivity == 8){
+            return size_t((rows + 1)/2) * size_t((cols + 1)/2);
+        }
+        return (size_t(rows) * cols + 1)/2;
+    }
+
+    //Splits the rows into stripes; 8-way stripes hold whole 2x2 blocks
+    inline static
+    void splitRows(int rows, int nstripes, int connectivity, std::vector<int> &split){
+        split.resize(nstripes + 1);
+        for(int s = 0; s < nstripes; ++s){
+            int r = (int)((int64)s * rows / nstripes);
+            split[s] = connectivity == 8 ? (r & ~1) : r;
+        }
+        split[nstripes] = rows;
+    }
+
     //Based on "Two Strategies to Speed up Connected Components Algorithms", the SAUF (Scan array union find) variant
     //using decision trees
     //Kesheng Wu, et al
-    //Note: rows are encoded as position in the "rows" array to save lookup times
-    //reference for 4-way: {{-1, 0}, {0, -1}};//b, d neighborhoods
-    const int G4[2][2] = {{1, 0}, {0, -1}};//b, d neighborhoods
-    //reference for 8-way: {{-1, -1}, {-1, 0}, {-1, 1}, {0, -1}};//a, b, c, d neighborhoods
-    const int G8[4][2] = {{1, -1}, {1, 0}, {1, 1}, {0, -1}};//a, b, c, d neighborhoods
+    //Every stripe is scanned independently with its own range of provisional labels, the first row
+    //of a stripe not looking at the row above.
+    template<typename LabelT, typename PixelT>
+    class FirstScan4Invoker : public ParallelLoopBody{
+    public:
+        FirstScan4Invoker(const cv::Mat &_I, cv::Mat &_L, LabelT *_P, const int *_split,
+                          const LabelT *_firstLabel, LabelT *_endLabel)
+            : I(&_I), L(&_L), P(_P), split(_split), firstLabel(_firstLabel), endLabel(_endLabel){
+        }
+        void operator()(const cv::Range &range) const{
+            const int cols = L->cols;
+            for(int s = range.start; s < range.end; ++s){
+                LabelT lunique = firstLabel[s];
+                for(int r_i = split[s]; r_i < split[s + 1]; ++r_i){
+                    LabelT * const Lrow = L->ptr<LabelT>(r_i);
+                    LabelT * const Lrow_prev = (LabelT *)(((char *)Lrow) - L->step.p[0]);
+                    const PixelT * const Irow = I->ptr<PixelT>(r_i);
+                    const PixelT * const Irow_prev = (const PixelT *)(((char *)Irow) - I->step.p[0]);
+                    const bool T_b_r = r_i > split[s];
+                    for(int c_i = 0; c_i < cols; ++c_i){
+                        if(!Irow[c_i]){
+                            Lrow[c_i] = 0;
+                            continue;
+                        }
+                        const bool T_b = T_b_r && Irow_prev[c_i];
+                        const bool T_d = c_i > 0 && Irow[c_i - 1];
+                        if(T_b){
+                            if(T_d){
+                                //copy(d, b)
+                                Lrow[c_i] = set_union(P, Lrow[c_i - 1], Lrow_prev[c_i]);
+                            }else{
+                                //copy(b)
+                                Lrow[c_i] = Lrow_prev[c_i];
+                            }
+                        }else{
+                            if(T_d){
+                                //copy(d)
+                                Lrow[c_i] = Lrow[c_i - 1];
+                            }else{
+                                //new label
+                                Lrow[c_i] = lunique;
+                                P[lunique] = lunique;
+                                lunique = lunique + 1;
+                            }
+                        }
+                    }
+                }
+                endLabel[s] = lunique;
+            }
+        }
+    protected:
+        const cv::Mat *I;
+        cv::Mat *L;
+        LabelT *P;
+        const int *split;
+        const LabelT *firstLabel;
+        LabelT *endLabel;
+    };
+
+    //8-way labeling of 2x2 blocks: the foreground pixels of a block are always connected,
+    //so a block gets one label, stored in its top left pixel. With the pixels above and
+    //to the left of the block
+    //     p q r s
+    //     t a b
+    //     u c d
+    //the block is connected to the upper left block if (p, a), to the upper block if
+    //(q or r, a or b), to the upper right block if (s, b) and to the left block if (t or u, a or c).
+    //The raster index of the first pixel of every block is kept per provisional label,
+    //so that the components can be numbered in the raster order of their first pixels.
+    template<typename LabelT, typename PixelT>
+    class FirstScan8Invoker : public ParallelLoopBody{
+    public:
+        FirstScan8Invoker(const cv::Mat &_I, cv::Mat &_L, LabelT *_P, int64 *_firstPixel, const int *_split,
+                          const LabelT *_firstLabel, LabelT *_endLabel)
+            : I(&_I), L(&_L), P(_P), firstPixel(_firstPixel), split(_split),
+              firstLabel(_firstLabel), endLabel(_endLabel){
+        }
+        void operator()(const cv::Range &range) const{
+            const int rows = L->rows;
+            const int cols = L->cols;
+            for(int s = range.start; s < range.end; ++s){
+                LabelT lunique = firstLabel[s];
+                for(int r_i = split[s]; r_i < split[s + 1]; r_i += 2){
+                    LabelT * const Lrow = L->ptr<LabelT>(r_i);
+                    const LabelT * const Lrow_prev = r_i > split[s] ? L->ptr<LabelT>(r_i - 2) : 0;
+                    const PixelT * const Irow = I->ptr<PixelT>(r_i);
+                    const PixelT * const Irow_prev = r_i > split[s] ? I->ptr<PixelT>(r_i - 1) : 0;
+                    const PixelT * const Irow_next = r_i + 1 < rows ? I->ptr<PixelT>(r_i + 1) : 0;
+                    for(int c_i = 0; c_i < cols; c_i += 2){
+                        const bool T_r = c_i + 1 < cols;
+                        const bool T_a = Irow[c_i] != 0;
+                        const bool T_b = T_r && Irow[c_i + 1] != 0;
+                        const bool T_c = Irow_next && Irow_next[c_i] != 0;
+                        const bool T_d = Irow_next && T_r && Irow_next[c_i + 1] != 0;
+                        if(!(T_a || T_b || T_c || T_d)){
+                            Lrow[c_i] = 0;
+                            continue;
+                        }
+
+                        LabelT label = 0;
+                        if((T_a || T_c) && c_i > 0 && (Irow[c_i - 1] || (Irow_next && Irow_next[c_i - 1]))){
+                            label = Lrow[c_i - 2];
+                        }
+                        if(Irow_prev){
+                            if((T_a || T_b) && (Irow_prev[c_i] || (T_r && Irow_prev[c_i + 1]))){
+                                label = label ? set_union(P, label, Lrow_prev[c_i]) : Lrow_prev[c_i];
+                            }
+                            if(T_a && c_i > 0 && Irow_prev[c_i - 1]){
+                                label = label ? set_union(P, label, Lrow_prev[c_i - 2]) : Lrow_prev[c_i - 2];
+                            }
+                            if(T_b && c_i + 2 < cols && Irow_prev[c_i + 2]){
+                                label = label ? set_union(P, label, Lrow_prev[c_i + 2]) : Lrow_prev[c_i + 2];
+                            }
+                        }
+
+                        const int64 first = T_a || T_b ? (int64)r_i * cols + (T_a ? c_i : c_i + 1) :
+                                                         (int64)(r_i + 1) * cols + (T_c ? c_i : c_i + 1);
+                        if(!label){
+                            //new label
+                            label = lunique;
+                            P[lunique] = lunique;
+                            firstPixel[lunique] = first;
+                            lunique = lunique + 1;
+                        }else if(first < firstPixel[label]){
+                            firstPixel[label] = first;
+                        }
+                        Lrow[c_i] = label;
+                    }
+                }
+                endLabel[s] = lunique;
+            }
+        }
+    protected:
+        const cv::Mat *I;
+        cv::Mat *L;
+        LabelT *P;
+        int64 *firstPixel;
+        const int *split;
+        const LabelT *firstLabel;
+        LabelT *endLabel;
+    };
+
+    //Replaces the provisional labels by the final ones and accumulates the statistics of every stripe
+    template<typename LabelT, typename PixelT, typename StatsOp>
+    class SecondScanInvoker : public ParallelLoopBody{
+    public:
+        SecondScanInvoker(const cv::Mat &_I, cv::Mat &_L, const LabelT *_P, const int *_split,
+                          int _connectivity, StatsOp &_sop)
+            : I(&_I), L(&_L), P(_P), split(_split), connectivity(_connectivity), sop(&_sop){
+        }
+        void operator()(const cv::Range &range) const{
+            const int rows = L->rows;
+            const int cols = L->cols;
+            for(int s = range.start; s < range.end; ++s){
+                if(connectivity == 8){
+                    for(int r_i = split[s]; r_i < split[s + 1]; r_i += 2){
+                        LabelT * const Lrow = L->ptr<LabelT>(r_i);
+                        LabelT * const Lrow_next = r_i + 1 < rows ? L->ptr<LabelT>(r_i + 1) : 0;
+                        const PixelT * const Irow = I->ptr<PixelT>(r_i);
+                        const PixelT * const Irow_next = r_i + 1 < rows ? I->ptr<PixelT>(r_i + 1) : 0;
+                        for(int c_i = 0; c_i < cols; c_i += 2){
+                            const LabelT l = P[Lrow[c_i]];
+                            LabelT v = Irow[c_i] ? l : 0;
+                            Lrow[c_i] = v;
+                            (*sop)(s, r_i, c_i, v);
+                            if(c_i + 1 < cols){
+                                v = Irow[c_i + 1] ? l : 0;
+                                Lrow[c_i + 1] = v;
+                                (*sop)(s, r_i, c_i + 1, v);
+                            }
+                            if(Lrow_next){
+                                v = Irow_next[c_i] ? l : 0;
+                                Lrow_next[c_i] = v;
+                                (*sop)(s, r_i + 1, c_i, v);
+                                if(c_i + 1 < cols){
+                                    v = Irow_next[c_i + 1] ? l : 0;
+                                    Lrow_next[c_i + 1] = v;
+                                    (*sop)(s, r_i + 1, c_i + 1, v);
+                                }
+                            }
+                        }
+                    }
+                }else{
+                    for(int r_i = split[s]; r_i < split[s + 1]; ++r_i){
+                        LabelT *Lrow = L->ptr<LabelT>(r_i);
+                        for(int c_i = 0; c_i < cols; ++c_i){
+                            const LabelT l = P[Lrow[c_i]];
+                            Lrow[c_i] = l;
+                            (*sop)(s, r_i, c_i, l);
+                        }
+                    }
+                }
+            }
+        }
+    protected:
+        const cv::Mat *I;
+        cv::Mat *L;
+        const LabelT *P;
+        const int *split;
+        int connectivity;
+        StatsOp *sop;
+    };
+
     template<typename LabelT, typename PixelT, typename StatsOp = NoOp >
     struct LabelingImpl{
     LabelT operator()(const cv::Mat &I, cv::Mat &L, int connectivity, StatsOp &sop){
@@ -195,136 +452,114 @@ namespace cv{
         CV_Assert(connectivity == 8 || connectivity == 4);
         const int rows = L.rows;
         const int cols = L.cols;
-        //A quick and dirty upper bound for the maximimum number of labels.  The 4 comes from
-        //the fact that a 3x3 block can never have more than 4 unique labels for both 4 & 8-way
-        const size_t Plength = 4 * (size_t(rows + 3 - 1)/3) * (size_t(cols + 3 - 1)/3);
+
+        //the stripes use disjoint ranges of provisional labels, which must fit into LabelT
+        int nstripes = std::max(std::min(cv::getNumThreads(), rows/32), 1);
+        std::vector<int> split;
+        std::vector<LabelT> firstLabel, endLabel;
+        size_t Plength = 0;
+        for(;;){
+            splitRows(rows, nstripes, connectivity, split);
+            Plength = 1;
+            for(int s = 0; s < nstripes; ++s){
+                Plength += maxStripeLabels(split[s + 1] - split[s], cols, connectivity);
+            }
+            if(nstripes == 1 || Plength <= (size_t)std::numeric_limits<LabelT>::max()){
+                break;
+            }
+            nstripes = 1;
+        }
+        firstLabel.resize(nstripes);
+        endLabel.resize(nstripes);
+        firstLabel[0] = 1;
+        for(int s = 1; s < nstripes; ++s){
+            firstLabel[s] = (LabelT)(firstLabel[s - 1] + maxStripeLabels(split[s] - split[s - 1], cols, connectivity));
+        }
+
         LabelT *P = (LabelT *) fastMalloc(sizeof(LabelT) * Plength);
         P[0] = 0;
-        LabelT lunique = 1;
+        std::vector<int64> firstPixel;
+
         //scanning phase
-        for(int r_i = 0; r_i < rows; ++r_i){
-            LabelT * const Lrow = L.ptr<LabelT>(r_i);
-            LabelT * const Lrow_prev = (LabelT *)(((char *)Lrow) - L.step.p[0]);
+        if(connectivity == 8){
+            firstPixel.resize(Plength);
+            cv::parallel_for_(cv::Range(0, nstripes), FirstScan8Invoker<LabelT, PixelT>(I, L, P, &firstPixel[0], &split[0],
+                                                                                      &firstLabel[0], &endLabel[0]), nstripes);
+        }else{
+            cv::parallel_for_(cv::Range(0, nstripes), FirstScan4Invoker<LabelT, PixelT>(I, L, P, &split[0],
+                                                                                      &firstLabel[0], &endLabel[0]), nstripes);
+        }
+
+        //merge the components that cross the stripe boundaries
+        for(int s = 1; s < nstripes; ++s){
+            const int r_i = split[s];
+            if(r_i >= split[s + 1]){
+                continue;
+            }
             const PixelT * const Irow = I.ptr<PixelT>(r_i);
-            const PixelT * const Irow_prev = (const PixelT *)(((char *)Irow) - I.step.p[0]);
-            LabelT *Lrows[2] = {
-                Lrow,
-                Lrow_prev
-            };
-            const PixelT *Irows[2] = {
-                Irow,
-                Irow_prev
-            };
+            const PixelT * const Irow_prev = I.ptr<PixelT>(r_i - 1);
+            const LabelT * const Lrow = L.ptr<LabelT>(r_i);
             if(connectivity == 8){
-                const int a = 0;
-                const int b = 1;
-                const int c = 2;
-                const int d = 3;
-                const bool T_a_r = (r_i - G8[a][0]) >= 0;
-                const bool T_b_r = (r_i - G8[b][0]) >= 0;
-                const bool T_c_r = (r_i - G8[c][0]) >= 0;
-                for(int c_i = 0; Irows[0] != Irow + cols; ++Irows[0], c_i++){
-                    if(!*Irows[0]){
-                        Lrow[c_i] = 0;
-                        continue;
+                const LabelT * const Lrow_prev = L.ptr<LabelT>(r_i - 2);
+                for(int c_i = 0; c_i < cols; c_i += 2){
+                    const bool T_r = c_i + 1 < cols;
+                    const bool T_a = Irow[c_i] != 0;
+                    const bool T_b = T_r && Irow[c_i + 1] != 0;
+                    if((T_a || T_b) && (Irow_prev[c_i] || (T_r && Irow_prev[c_i + 1]))){
+                        set_union(P, Lrow[c_i], Lrow_prev[c_i]);
                     }
-                    Irows[1] = Irow_prev + c_i;
-                    Lrows[0] = Lrow + c_i;
-                    Lrows[1] = Lrow_prev + c_i;
-                    const bool T_a = T_a_r && (c_i + G8[a][1]) >= 0   && *(Irows[G8[a][0]] + G8[a][1]);
-                    const bool T_b = T_b_r                            && *(Irows[G8[b][0]] + G8[b][1]);
-                    const bool T_c = T_c_r && (c_i + G8[c][1]) < cols && *(Irows[G8[c][0]] + G8[c][1]);
-                    const bool T_d =          (c_i + G8[d][1]) >= 0   && *(Irows[G8[d][0]] + G8[d][1]);
-
-                    //decision tree
-                    if(T_b){
-                        //copy(b)
-                        *Lrows[0] = *(Lrows[G8[b][0]] + G8[b][1]);
-                    }else{//not b
-                        if(T_c){
-                            if(T_a){
-                                //copy(c, a)
-                                *Lrows[0] = set_union(P, *(Lrows[G8[c][0]] + G8[c][1]), *(Lrows[G8[a][0]] + G8[a][1]));
-                            }else{
-                                if(T_d){
-                                    //copy(c, d)
-                                    *Lrows[0] = set_union(P, *(Lrows[G8[c][0]] + G8[c][1]), *(Lrows[G8[d][0]] + G8[d][1]));
-                                }else{
-                                    //copy(c)
-                                    *Lrows[0] = *(Lrows[G8[c][0]] + G8[c][1]);
-                                }
-                            }
-                        }else{//not c
-                            if(T_a){
-                                //copy(a)
-                                *Lrows[0] = *(Lrows[G8[a][0]] + G8[a][1]);
-                            }else{
-                                if(T_d){
-                                    //copy(d)
-                                    *Lrows[0] = *(Lrows[G8[d][0]] + G8[d][1]);
-                                }else{
-                                    //new label
-                                    *Lrows[0] = lunique;
-                                    P[lunique] = lunique;
-                                    lunique = lunique + 1;
-                                }
-                            }
-                        }
+                    if(T_a && c_i > 0 && Irow_prev[c_i - 1]){
+                        set_union(P, Lrow[c_i], Lrow_prev[c_i - 2]);
+                    }
+                    if(T_b && c_i + 2 < cols && Irow_prev[c_i + 2]){
+                        set_union(P, Lrow[c_i], Lrow_prev[c_i + 2]);
                     }
                 }
             }else{
-                //B & D only
-                const int b = 0;
-                const int d = 1;
-                const bool T_b_r = (r_i - G4[b][0]) >= 0;
-                for(int c_i = 0; Irows[0] != Irow + cols; ++Irows[0], c_i++){
-                    if(!*Irows[0]){
-                        Lrow[c_i] = 0;
-                        continue;
-                    }
-                    Irows[1] = Irow_prev + c_i;
-                    Lrows[0] = Lrow + c_i;
-                    Lrows[1] = Lrow_prev + c_i;
-                    const bool T_b = T_b_r                            && *(Irows[G4[b][0]] + G4[b][1]);
-                    const bool T_d =          (c_i + G4[d][1]) >= 0   && *(Irows[G4[d][0]] + G4[d][1]);
-                    if(T_b){
-                        if(T_d){
-                            //copy(d, b)
-                            *Lrows[0] = set_union(P, *(Lrows[G4[d][0]] + G4[d][1]), *(Lrows[G4[b][0]] + G4[b][1]));
-                        }else{
-                            //copy(b)
-                            *Lrows[0] = *(Lrows[G4[b][0]] + G4[b][1]);
-                        }
-                    }else{
-                        if(T_d){
-                            //copy(d)
-                            *Lrows[0] = *(Lrows[G4[d][0]] + G4[d][1]);
-                        }else{
-                            //new label
-                            *Lrows[0] = lunique;
-                            P[lunique] = lunique;
-                            lunique = lunique + 1;
-                        }
+                const LabelT * const Lrow_prev = L.ptr<LabelT>(r_i - 1);
+                for(int c_i = 0; c_i < cols; ++c_i){
+                    if(Irow[c_i] && Irow_prev[c_i]){
+                        set_union(P, Lrow[c_i], Lrow_prev[c_i]);
                     }
                 }
             }
         }
 
         //analysis
-        LabelT nLabels = flattenL(P, lunique);
-        sop.init(nLabels);
+        LabelT nLabels = 1;
+        for(int s = 0; s < nstripes; ++s){
+            nLabels = flattenL(P, firstLabel[s], endLabel[s], nLabels);
+        }
 
-        for(int r_i = 0; r_i < rows; ++r_i){
-            LabelT *Lrow_start = L.ptr<LabelT>(r_i);
-            LabelT *Lrow_end = Lrow_start + cols;
-            LabelT *Lrow = Lrow_start;
-            for(int c_i = 0; Lrow != Lrow_end; ++Lrow, ++c_i){
-                const LabelT l = P[*Lrow];
-                *Lrow = l;
-                sop(r_i, c_i, l);
+        if(connectivity == 8 && nLabels > 2){
+            //the blocks are visited in a different order than the pixels, so renumber the
+            //components by their first pixels, as the pixel-wise scan would do
+            std::vector<std::pair<int64, LabelT> > order(nLabels - 1, std::make_pair(std::numeric_limits<int64>::max(), LabelT(0)));
+            for(int s = 0; s < nstripes; ++s){
+                for(LabelT i = firstLabel[s]; i < endLabel[s]; ++i){
+                    std::pair<int64, LabelT> &o = order[P[i] - 1];
+                    o.first = std::min(o.first, firstPixel[i]);
+                    o.second = P[i];
+                }
+            }
+            std::sort(order.begin(), order.end());
+            std::vector<LabelT> relabel(nLabels);
+            for(LabelT k = 1; k < nLabels; ++k){
+                relabel[order[k - 1].second] = k;
+            }
+            for(int s = 0; s < nstripes; ++s){
+                for(LabelT i = firstLabel[s]; i < endLabel[s]; ++i){
+                    P[i] = relabel[P[i]];
+                }
             }
         }
 
+        sop.init(nLabels);
+        nstripes = std::max(std::min(std::min(cv::getNumThreads(), rows/32), sop.maxStripes(nLabels)), 1);
+        splitRows(rows, nstripes, connectivity, split);
+        sop.initStripes(nstripes);
+        cv::parallel_for_(cv::Range(0, nstripes), SecondScanInvoker<LabelT, PixelT, StatsOp>(I, L, P, &split[0], connectivity, sop), nstripes);
+
         sop.finish();
         fastFree(P);
 
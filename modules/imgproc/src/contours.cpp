@@ -1702,6 +1702,369 @@ cvFindContours( void*  img,  CvMemStorage*  storage,
     return count;
 }
 
+namespace cv
+{
+
+struct ContourNode
+{
+    int parent;         // index of the parent contour, -1 for the image frame
+    int next;           // next contour with the same mark value
+    int isHole;
+    int start, end;     // range of the contour points in the common point buffer
+    Point origin;
+    Rect rect;
+};
+
+// skips the run of pixels equal to prev, starting from x; returns the end of the run
+static inline int skipContourRun( const schar* row, int x, int width, int prev, bool haveSSE2 )
+{
+#if CV_SSE2
+    if( haveSSE2 )
+    {
+        __m128i v_prev = _mm_set1_epi8((char)prev);
+        for( ; x <= width - 16; x += 16 )
+        {
+            __m128i v = _mm_loadu_si128((const __m128i*)(row + x));
+            if( _mm_movemask_epi8(_mm_cmpeq_epi8(v, v_prev)) != 0xFFFF )
+                break;
+        }
+    }
+#else
+    (void)haveSSE2;
+#endif
+    for( ; x < width && row[x] == prev; x++ )
+        ;
+    return x;
+}
+
+/*
+   The same as icvFetchContourEx for CV_CHAIN_APPROX_NONE/CV_CHAIN_APPROX_SIMPLE,
+   but appends the points to a vector. The bounding rectangle is computed only if rect != 0.
+*/
+static void fetchContour8u( schar* ptr, int step, Point pt, int isHole, int method,
+                            int nbd, std::vector<Point>& points, Rect* rect )
+{
+    int deltas[16];
+    schar *i0 = ptr, *i1, *i3, *i4;
+    int prev_s = -1, s, s_end;
+    int xmin = pt.x, xmax = pt.x, ymin = pt.y, ymax = pt.y;
+
+    CV_INIT_3X3_DELTAS( deltas, step, 1 );
+    memcpy( deltas + 8, deltas, 8 * sizeof( deltas[0] ));
+
+    s_end = s = isHole ? 0 : 4;
+
+    do
+    {
+        s = (s - 1) & 7;
+        i1 = i0 + deltas[s];
+        if( *i1 != 0 )
+            break;
+    }
+    while( s != s_end );
+
+    if( s == s_end )            /* single pixel domain */
+    {
+        *i0 = (schar) (nbd | 0x80);
+        points.push_back(pt);
+    }
+    else
+    {
+        i3 = i0;
+        prev_s = s ^ 4;
+
+        /* follow border */
+        for( ;; )
+        {
+            s_end = s;
+
+            for( ;; )
+            {
+                i4 = i3 + deltas[++s];
+                if( *i4 != 0 )
+                    break;
+            }
+            s &= 7;
+
+            /* check "right" bound */
+            if( (unsigned) (s - 1) < (unsigned) s_end )
+                *i3 = (schar) (nbd | 0x80);
+            else if( *i3 == 1 )
+                *i3 = (schar) nbd;
+
+            if( s != prev_s || method == CV_CHAIN_APPROX_NONE )
+                points.push_back(pt);
+
+            if( s != prev_s && rect )
+            {
+                /* update bounds */
+                if( pt.x < xmin )
+                    xmin = pt.x;
+                else if( pt.x > xmax )
+                    xmax = pt.x;
+
+                if( pt.y < ymin )
+                    ymin = pt.y;
+                else if( pt.y > ymax )
+                    ymax = pt.y;
+            }
+
+            prev_s = s;
+            pt.x += icvCodeDeltas[s].x;
+            pt.y += icvCodeDeltas[s].y;
+
+            if( i4 == i0 && i3 == i1 )
+                break;
+
+            i3 = i4;
+            s = (s + 4) & 7;
+        }                       /* end of border following loop */
+    }
+
+    if( rect )
+        *rect = Rect(xmin, ymin, xmax - xmin + 1, ymax - ymin + 1);
+}
+
+/*
+   Suzuki border following over a binarized 8-bit image with zero borders, equivalent to
+   the cvStartFindContours/cvFindNextContour loop. All the contour points are written to
+   one buffer and the contour tree is kept as parent indices, so that no CvSeq or
+   CvMemStorage is involved.
+*/
+static void findContours8u( Mat& img, int mode, int method, Point offset,
+                            std::vector<Point>& points, std::vector<ContourNode>& nodes )
+{
+    schar* img0 = (schar*)img.data;
+    int step = (int)img.step;
+    int width = img.cols - 1, height = img.rows - 1;
+    int nbd = 2;
+    int cinfoTable[128];
+    bool haveSSE2 = checkHardwareSupport(CV_CPU_SSE2);
+
+    for( int i = 0; i < 128; i++ )
+        cinfoTable[i] = -1;
+
+    for( int y = 1; y < height; y++ )
+    {
+        schar* row = img0 + step*y;
+        Point lnbd(0, y);
+        int prev = 0, p = 0;
+
+        for( int x = 1; x < width; x++ )
+        {
+            x = skipContourRun(row, x, width, prev, haveSSE2);
+            if( x >= width )
+                break;
+            p = row[x];
+
+            int isHole = 0, parent = -1;
+
+            /* if not external contour */
+            if( !(prev == 0 && p == 1) )
+            {
+                /* check hole */
+                if( p != 0 || prev < 1 )
+                    goto resume_scan;
+
+                if( prev & -2 )
+                    lnbd.x = x - 1;
+                isHole = 1;
+            }
+
+            if( mode == RETR_EXTERNAL && (isHole || img0[lnbd.y * step + lnbd.x] > 0) )
+                goto resume_scan;
+
+            /* find contour parent */
+            if( !(mode <= RETR_LIST || (!isHole && mode == RETR_CCOMP) || lnbd.x <= 0) )
+            {
+                int lval = img0[lnbd.y * step + lnbd.x] & 0x7f;
+                int par = -1, cur = cinfoTable[lval];
+
+                /* find the first bounding contour */
+                for( ; cur >= 0; cur = nodes[cur].next )
+                {
+                    const ContourNode& c = nodes[cur];
+                    if( (unsigned) (lnbd.x - c.rect.x) < (unsigned) c.rect.width &&
+                        (unsigned) (lnbd.y - c.rect.y) < (unsigned) c.rect.height )
+                    {
+                        if( par >= 0 && icvTraceContour( img0 + nodes[par].origin.y * step +
+                                                         nodes[par].origin.x, step, row + lnbd.x,
+                                                         nodes[par].isHole ) > 0 )
+                            break;
+                        par = cur;
+                    }
+                }
+
+                CV_Assert( par >= 0 );
+
+                /* the parent of a contour of the same kind as the previous one
+                   is the parent of the previous contour */
+                parent = nodes[par].isHole == isHole ? nodes[par].parent : par;
+            }
+
+            lnbd.x = x - isHole;
+
+            {
+                ContourNode node;
+                node.parent = parent;
+                node.next = -1;
+                node.isHole = isHole;
+                node.origin = Point(x - isHole, y);
+                node.start = (int)points.size();
+
+                if( mode <= RETR_LIST )
+                {
+                    fetchContour8u( row + x - isHole, step, node.origin + offset, isHole,
+                                    method, 2, points, 0 );
+                }
+                else
+                {
+                    int lval = nbd;
+                    nbd = (nbd + 1) & 127;
+                    nbd += nbd == 0 ? 3 : 0;
+                    fetchContour8u( row + x - isHole, step, node.origin + offset, isHole,
+                                    method, lval, points, &node.rect );
+                    node.rect.x -= offset.x;
+                    node.rect.y -= offset.y;
+                    node.next = cinfoTable[lval];
+                    cinfoTable[lval] = (int)nodes.size();
+                }
+
+                node.end = (int)points.size();
+                nodes.push_back(node);
+            }
+
+            /* the traced border may have changed the current pixel */
+            prev = row[x];
+            continue;
+
+        resume_scan:
+            prev = p;
+            /* update lnbd */
+            if( prev & -2 )
+                lnbd.x = x;
+        }
+    }
+}
+
+class ContourCopyInvoker : public ParallelLoopBody
+{
+public:
+    ContourCopyInvoker( const std::vector<Point>& _points, const std::vector<ContourNode>& _nodes,
+                        const std::vector<int>& _order, std::vector<Mat>& _dst )
+        : points(&_points), nodes(&_nodes), order(&_order), dst(&_dst) {}
+
+    virtual void operator()( const Range& range ) const
+    {
+        for( int i = range.start; i < range.end; i++ )
+        {
+            const ContourNode& node = (*nodes)[(*order)[i]];
+            Mat& ci = (*dst)[i];
+            CV_Assert( ci.isContinuous() );
+            if( node.end > node.start )
+                memcpy( ci.ptr(), &(*points)[node.start], (node.end - node.start)*sizeof(Point) );
+        }
+    }
+
+protected:
+    const std::vector<Point>* points;
+    const std::vector<ContourNode>* nodes;
+    const std::vector<int>* order;
+    std::vector<Mat>* dst;
+};
+
+static void findContoursNative( Mat& image, OutputArrayOfArrays _contours,
+                                OutputArray _hierarchy, int mode, int method, Point offset )
+{
+    /* make zero borders */
+    Size size = image.size();
+    memset( image.ptr(0), 0, size.width );
+    memset( image.ptr(size.height - 1), 0, size.width );
+    for( int y = 1; y < size.height - 1; y++ )
+    {
+        uchar* row = image.ptr(y);
+        row[0] = row[size.width - 1] = 0;
+    }
+
+    /* converts all pixels to 0 or 1 */
+    threshold( image, image, 0, 1, THRESH_BINARY );
+
+    std::vector<Point> points;
+    std::vector<ContourNode> nodes;
+    findContours8u( image, mode, method, offset, points, nodes );
+
+    int i, total = (int)nodes.size();
+    if( total == 0 )
+    {
+        _contours.clear();
+        return;
+    }
+
+    /* every new contour becomes the first child of its parent, and the contours
+       are output in the depth-first order of that tree, like cvTreeToNodeSeq does */
+    std::vector<int> firstChild(total + 1, -1), nextSibling(total, -1), prevSibling(total, -1);
+    for( i = 0; i < total; i++ )
+    {
+        int& first = firstChild[nodes[i].parent + 1];
+        nextSibling[i] = first;
+        if( first >= 0 )
+            prevSibling[first] = i;
+        first = i;
+    }
+
+    std::vector<int> order, index(total);
+    std::vector<int> stack;
+    order.reserve(total);
+    for( int c = firstChild[0]; c >= 0; )
+    {
+        index[c] = (int)order.size();
+        order.push_back(c);
+        if( firstChild[c + 1] >= 0 )
+        {
+            stack.push_back(c);
+            c = firstChild[c + 1];
+            continue;
+        }
+        while( nextSibling[c] < 0 && !stack.empty() )
+        {
+            c = stack.back();
+            stack.pop_back();
+        }
+        c = nextSibling[c];
+    }
+    CV_Assert( (int)order.size() == total );
+
+    _contours.create(total, 1, 0, -1, true);
+    std::vector<Mat> dst(total);
+    for( i = 0; i < total; i++ )
+    {
+        const ContourNode& node = nodes[order[i]];
+        _contours.create(node.end - node.start, 1, CV_32SC2, i, true);
+        dst[i] = _contours.getMat(i);
+    }
+    parallel_for_(Range(0, total), ContourCopyInvoker(points, nodes, order, dst),
+                  (double)points.size()/(1 << 16));
+
+    if( _hierarchy.needed() )
+    {
+        _hierarchy.create(1, total, CV_32SC4, -1, true);
+        Vec4i* hierarchy = _hierarchy.getMat().ptr<Vec4i>();
+
+        for( i = 0; i < total; i++ )
+        {
+            int c = order[i], parent = nodes[c].parent;
+            // Vec has a user-declared copy constructor but no assignment operator, so fill it in place
+            Vec4i& h = hierarchy[i];
+            h[0] = nextSibling[c] >= 0 ? index[nextSibling[c]] : -1;
+            h[1] = prevSibling[c] >= 0 ? index[prevSibling[c]] : -1;
+            h[2] = firstChild[c + 1] >= 0 ? index[firstChild[c + 1]] : -1;
+            h[3] = parent >= 0 ? index[parent] : -1;
+        }
+    }
+}
+
+}
+
 void cv::findContours( InputOutputArray _image, OutputArrayOfArrays _contours,
                    OutputArray _hierarchy, int mode, int method, Point offset )
 {
@@ -1712,11 +2075,20 @@ void cv::findContours( InputOutputArray _image, OutputArrayOfArrays _contours,
     CV_Assert(_contours.empty() || (_contours.channels() == 2 && _contours.depth() == CV_32S));
 
     Mat image = _image.getMat();
+    if( _hierarchy.needed() )
+        _hierarchy.clear();
+
+    if( image.type() == CV_8UC1 && image.dims <= 2 && image.rows > 0 &&
+        (mode == RETR_EXTERNAL || mode == RETR_LIST || mode == RETR_CCOMP || mode == RETR_TREE) &&
+        (method == CHAIN_APPROX_NONE || method == CHAIN_APPROX_SIMPLE) )
+    {
+        findContoursNative( image, _contours, _hierarchy, mode, method, offset );
+        return;
+    }
+
     MemStorage storage(cvCreateMemStorage());
     CvMat _cimage = image;
     CvSeq* _ccontours = 0;
-    if( _hierarchy.needed() )
-        _hierarchy.clear();
     cvFindContours(&_cimage, storage, &_ccontours, sizeof(CvContour), mode, method, offset);
     if( !_ccontours )
     {
@@ -1746,11 +2118,11 @@ void cv::findContours( InputOutputArray _image, OutputArrayOfArrays _contours,
         for( i = 0; i < total; i++, ++it )
         {
             CvSeq* c = *it;
-            int h_next = c->h_next ? ((CvContour*)c->h_next)->color : -1;
-            int h_prev = c->h_prev ? ((CvContour*)c->h_prev)->color : -1;
-            int v_next = c->v_next ? ((CvContour*)c->v_next)->color : -1;
-            int v_prev = c->v_prev ? ((CvContour*)c->v_prev)->color : -1;
-            hierarchy[i] = Vec4i(h_next, h_prev, v_next, v_prev);
+            Vec4i& h = hierarchy[i];
+            h[0] = c->h_next ? ((CvContour*)c->h_next)->color : -1;
+            h[1] = c->h_prev ? ((CvContour*)c->h_prev)->color : -1;
+            h[2] = c->v_next ? ((CvContour*)c->v_next)->color : -1;
+            h[3] = c->v_prev ? ((CvContour*)c->v_prev)->color : -1;
         }
     }
 }
@@ -126,34 +126,15 @@ struct CHullCmpPoints
 };
 
 
-void convexHull( InputArray _points, OutputArray _hull, bool clockwise, bool returnPoints )
+int convexHullIndices( const Point* data0, int total, bool is_float, bool clockwise,
+                       Point** pointer, int* stack, int* hullbuf )
 {
-    Mat points = _points.getMat();
-    int i, total = points.checkVector(2), depth = points.depth(), nout = 0;
+    int i, nout = 0;
     int miny_ind = 0, maxy_ind = 0;
-    CV_Assert(total >= 0 && (depth == CV_32F || depth == CV_32S));
-
-    if( total == 0 )
-    {
-        _hull.release();
-        return;
-    }
-
-    returnPoints = !_hull.fixedType() ? returnPoints : _hull.type() != CV_32S;
-
-    bool is_float = depth == CV_32F;
-    AutoBuffer<Point*> _pointer(total);
-    AutoBuffer<int> _stack(total + 2), _hullbuf(total);
-    Point** pointer = _pointer;
     Point2f** pointerf = (Point2f**)pointer;
-    Point* data0 = points.ptr<Point>();
-    int* stack = _stack;
-    int* hullbuf = _hullbuf;
-
-    CV_Assert(points.isContinuous());
 
     for( i = 0; i < total; i++ )
-        pointer[i] = &data0[i];
+        pointer[i] = (Point*)&data0[i];
 
     // sort the point set by x-coordinate, find min and max y
     if( !is_float )
@@ -249,6 +230,33 @@ void convexHull( InputArray _points, OutputArray _hull, bool clockwise, bool ret
             hullbuf[nout++] = int(pointer[br_stack[i]] - data0);
     }
 
+    return nout;
+}
+
+
+void convexHull( InputArray _points, OutputArray _hull, bool clockwise, bool returnPoints )
+{
+    Mat points = _points.getMat();
+    int i, total = points.checkVector(2), depth = points.depth();
+    CV_Assert(total >= 0 && (depth == CV_32F || depth == CV_32S));
+
+    if( total == 0 )
+    {
+        _hull.release();
+        return;
+    }
+
+    returnPoints = !_hull.fixedType() ? returnPoints : _hull.type() != CV_32S;
+
+    AutoBuffer<Point*> _pointer(total);
+    AutoBuffer<int> _stack(total + 2), _hullbuf(total);
+    const Point* data0 = points.ptr<Point>();
+    int* hullbuf = _hullbuf;
+
+    CV_Assert(points.isContinuous());
+
+    int nout = convexHullIndices(data0, total, depth == CV_32F, clockwise, _pointer, _stack, hullbuf);
+
     if( !returnPoints )
         Mat(nout, 1, CV_32S, hullbuf).copyTo(_hull);
     else
@@ -262,6 +270,70 @@ void convexHull( InputArray _points, OutputArray _hull, bool clockwise, bool ret
 }
 
 
+class ConvexHullBatchInvoker : public ParallelLoopBody
+{
+public:
+    ConvexHullBatchInvoker( const ContourBatch& _batch, Mat& _buf, std::vector<int>& _nout,
+                            bool _clockwise, bool _returnPoints )
+        : batch(&_batch), buf(&_buf), nout(&_nout), clockwise(_clockwise), returnPoints(_returnPoints) {}
+
+    void operator()( const Range& range ) const
+    {
+        int i, j, maxCount = 0;
+        bool is_float = batch->depth == CV_32F;
+        for( i = range.start; i < range.end; i++ )
+            maxCount = std::max(maxCount, batch->counts[i]);
+
+        AutoBuffer<Point*> _pointer(maxCount);
+        AutoBuffer<int> _stack(maxCount + 2), _hullbuf(maxCount);
+        int* hullbuf = _hullbuf;
+        for( i = range.start; i < range.end; i++ )
+        {
+            int total = batch->counts[i], start = batch->starts[i];
+            if( total == 0 )
+            {
+                (*nout)[i] = 0;
+                continue;
+            }
+            const Point* data0 = batch->ptrs[i];
+            int n = convexHullIndices(data0, total, is_float, clockwise, _pointer, _stack, hullbuf);
+            if( returnPoints )
+            {
+                Point* dst = buf->ptr<Point>() + start;
+                for( j = 0; j < n; j++ )
+                    dst[j] = data0[hullbuf[j]];
+            }
+            else
+                memcpy( buf->ptr<int>() + start, hullbuf, n*sizeof(int) );
+            (*nout)[i] = n;
+        }
+    }
+
+protected:
+    const ContourBatch* batch;
+    Mat* buf;
+    std::vector<int>* nout;
+    bool clockwise, returnPoints;
+};
+
+}
+
+void cv::convexHullBatch( InputArrayOfArrays _contours, OutputArray _hulls, OutputArray _offsets,
+                          bool clockwise, bool returnPoints )
+{
+    ContourBatch batch(_contours);
+    int n = batch.size();
+    Mat buf(batch.total, 1, returnPoints ? CV_MAKETYPE(batch.depth, 2) : CV_32S);
+    std::vector<int> nout(n);
+
+    parallel_for_(Range(0, n), ConvexHullBatchInvoker(batch, buf, nout, clockwise, returnPoints),
+                  batch.total/(double)(1 << 14));
+    packContourBatch(batch, buf, nout, _hulls, _offsets);
+}
+
+namespace cv
+{
+
 void convexityDefects( InputArray _points, InputArray _hull, OutputArray _defects )
 {
     Mat points = _points.getMat();
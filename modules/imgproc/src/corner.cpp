@@ -263,51 +263,20 @@ static void calcEigenValsVecs( const Mat& _cov, Mat& _dst )
 enum { MINEIGENVAL=0, HARRIS=1, EIGENVALSVECS=2 };
 
 
-static void
-cornerEigenValsVecs( const Mat& src, Mat& eigenv, int block_size,
-                     int aperture_size, int op_type, double k=0.,
-                     int borderType=BORDER_DEFAULT )
+// computes the products of the derivatives: dx*dx, dx*dy and dy*dy
+static void calcCovariation( const Mat& Dx, const Mat& Dy, Mat& cov )
 {
-#ifdef HAVE_TEGRA_OPTIMIZATION
-    if (tegra::cornerEigenValsVecs(src, eigenv, block_size, aperture_size, op_type, k, borderType))
-        return;
-#endif
+    Size size = Dx.size();
 #if CV_SSE2
     bool haveSSE2 = checkHardwareSupport(CV_CPU_SSE2);
 #endif
 
-    int depth = src.depth();
-    double scale = (double)(1 << ((aperture_size > 0 ? aperture_size : 3) - 1)) * block_size;
-    if( aperture_size < 0 )
-        scale *= 2.0;
-    if( depth == CV_8U )
-        scale *= 255.0;
-    scale = 1.0/scale;
-
-    CV_Assert( src.type() == CV_8UC1 || src.type() == CV_32FC1 );
-
-    Mat Dx, Dy;
-    if( aperture_size > 0 )
-    {
-        Sobel( src, Dx, CV_32F, 1, 0, aperture_size, scale, 0, borderType );
-        Sobel( src, Dy, CV_32F, 0, 1, aperture_size, scale, 0, borderType );
-    }
-    else
-    {
-        Scharr( src, Dx, CV_32F, 1, 0, scale, 0, borderType );
-        Scharr( src, Dy, CV_32F, 0, 1, scale, 0, borderType );
-    }
-
-    Size size = src.size();
-    Mat cov( size, CV_32FC3 );
-    int i, j;
-
-    for( i = 0; i < size.height; i++ )
+    for( int i = 0; i < size.height; i++ )
     {
         float* cov_data = cov.ptr<float>(i);
         const float* dxdata = Dx.ptr<float>(i);
         const float* dydata = Dy.ptr<float>(i);
-        j = 0;
+        int j = 0;
 
         #if CV_NEON
         for( ; j <= size.width - 4; j += 4 )
@@ -361,16 +330,98 @@ cornerEigenValsVecs( const Mat& src, Mat& eigenv, int block_size,
             cov_data[j*3+2] = dy*dy;
         }
     }
+}
+
+/*
+ Computes the result for a band of rows: the derivatives, their products and the box filter
+ are calculated in the buffers that hold the band and the rows above and below it needed by
+ the box filter. The derivatives of the band rows are computed from the neighbor source rows,
+ so the bands can be processed in parallel.
+*/
+class CornerEigenValsVecsInvoker : public ParallelLoopBody
+{
+public:
+    CornerEigenValsVecsInvoker( const Mat& _src, Mat& _eigenv, int _block_size, int _aperture_size,
+                                int _op_type, double _k, int _borderType, double _scale )
+        : src(&_src), eigenv(&_eigenv), block_size(_block_size), aperture_size(_aperture_size),
+          op_type(_op_type), k(_k), borderType(_borderType), scale(_scale) {}
 
-    boxFilter(cov, cov, cov.depth(), Size(block_size, block_size),
-        Point(-1,-1), false, borderType );
+    void operator()( const Range& range ) const
+    {
+        Size size = src->size();
+        int a = std::max(range.start - block_size/2, 0);
+        int b = std::min(range.end + (block_size - 1 - block_size/2), size.height);
+        int ksize = aperture_size > 0 ? aperture_size : CV_SCHARR;
+        bool isolated = (borderType & BORDER_ISOLATED) != 0;
+
+        // the same kernels as in Sobel(), with the scale applied to the smoothing part
+        Mat kx, ky, Dx(b - a, size.width, CV_32F), Dy(b - a, size.width, CV_32F);
+        getDerivKernels( kx, ky, 1, 0, ksize, false, CV_32F );
+        ky *= scale;
+        Ptr<FilterEngine> f = createSeparableLinearFilter( src->type(), CV_32F, kx, ky, Point(-1,-1),
+                                                           0, borderType & ~BORDER_ISOLATED );
+        f->apply( *src, Dx, Rect(0, a, size.width, b - a), Point(), isolated );
+
+        getDerivKernels( kx, ky, 0, 1, ksize, false, CV_32F );
+        kx *= scale;
+        f = createSeparableLinearFilter( src->type(), CV_32F, kx, ky, Point(-1,-1),
+                                         0, borderType & ~BORDER_ISOLATED );
+        f->apply( *src, Dy, Rect(0, a, size.width, b - a), Point(), isolated );
+
+        Mat cov( b - a, size.width, CV_32FC3 );
+        calcCovariation( Dx, Dy, cov );
+
+        // the buffer rows outside of the band are either the neighbor rows of the image,
+        // or the buffer begins/ends at the image border, so the border extrapolation is the same
+        int y0 = range.start - a, y1 = range.end - a;
+        f = createBoxFilter( cov.type(), cov.type(), Size(block_size, block_size),
+                             Point(-1,-1), false, borderType & ~BORDER_ISOLATED );
+        f->apply( cov, cov, Rect(0, y0, size.width, y1 - y0), Point(0, y0) );
+
+        Mat bandCov = cov.rowRange(y0, y1), bandEigenv = eigenv->rowRange(range);
+        if( op_type == MINEIGENVAL )
+            calcMinEigenVal( bandCov, bandEigenv );
+        else if( op_type == HARRIS )
+            calcHarris( bandCov, bandEigenv, k );
+        else if( op_type == EIGENVALSVECS )
+            calcEigenValsVecs( bandCov, bandEigenv );
+    }
+
+private:
+    const Mat* src;
+    Mat* eigenv;
+    int block_size, aperture_size, op_type;
+    double k;
+    int borderType;
+    double scale;
+};
+
+static void
+cornerEigenValsVecs( const Mat& src, Mat& eigenv, int block_size,
+                     int aperture_size, int op_type, double k=0.,
+                     int borderType=BORDER_DEFAULT )
+{
+#ifdef HAVE_TEGRA_OPTIMIZATION
+    if (tegra::cornerEigenValsVecs(src, eigenv, block_size, aperture_size, op_type, k, borderType))
+        return;
+#endif
+
+    int depth = src.depth();
+    double scale = (double)(1 << ((aperture_size > 0 ? aperture_size : 3) - 1)) * block_size;
+    if( aperture_size < 0 )
+        scale *= 2.0;
+    if( depth == CV_8U )
+        scale *= 255.0;
+    scale = 1.0/scale;
+
+    CV_Assert( src.type() == CV_8UC1 || src.type() == CV_32FC1 );
 
-    if( op_type == MINEIGENVAL )
-        calcMinEigenVal( cov, eigenv );
-    else if( op_type == HARRIS )
-        calcHarris( cov, eigenv, k );
-    else if( op_type == EIGENVALSVECS )
-        calcEigenValsVecs( cov, eigenv );
+    // every band should be much taller than the box filter, so that the rows
+    // processed by both neighbor bands do not add much work
+    int nstripes = std::max(std::min(src.rows/std::max(block_size*4, 32), (int)(src.total() >> 16)), 1);
+    parallel_for_( Range(0, src.rows),
+                   CornerEigenValsVecsInvoker(src, eigenv, block_size, aperture_size, op_type, k, borderType, scale),
+                   nstripes );
 }
 
 #ifdef HAVE_OPENCL
@@ -50,11 +50,90 @@
 namespace cv
 {
 
-struct greaterThanPtr :
-        public std::binary_function<const float *, const float *, bool>
+// a local maximum of the corner response; the stronger candidates come first
+// in a heap, the candidates of equal strength are ordered by their position
+struct CornerCandidate
 {
-    bool operator () (const float * a, const float * b) const
-    { return *a > *b; }
+    float val;
+    int y, x;
+
+    bool operator < (const CornerCandidate& c) const
+    {
+        return val < c.val || (val == c.val && (y > c.y || (y == c.y && x > c.x)));
+    }
+};
+
+/*
+ Finds the local maxima of the thresholded corner response within a band of rows.
+ A pixel is a local maximum if its response is not less than the thresholded responses
+ of its 8 neighbors, which is what comparing the response with its dilation does.
+ If keep > 0, only the keep strongest candidates of the band are retained.
+*/
+class FindCornerCandidatesInvoker : public ParallelLoopBody
+{
+public:
+    FindCornerCandidatesInvoker( const Mat& _eig, const Mat& _mask, float _thresh, int _keep,
+                                 std::vector<std::vector<CornerCandidate> >& _candidates )
+        : eig(&_eig), mask(&_mask), thresh(_thresh), keep(_keep), candidates(&_candidates) {}
+
+    void operator()( const Range& range ) const
+    {
+        int nbands = (int)candidates->size(), rows = eig->rows - 2, cols = eig->cols;
+
+        for( int band = range.start; band < range.end; band++ )
+        {
+            std::vector<CornerCandidate>& cands = (*candidates)[band];
+            int y0 = 1 + (int)((int64)band*rows/nbands), y1 = 1 + (int)((int64)(band + 1)*rows/nbands);
+
+            for( int y = y0; y < y1; y++ )
+            {
+                const float* prev = eig->ptr<float>(y - 1);
+                const float* curr = eig->ptr<float>(y);
+                const float* next = eig->ptr<float>(y + 1);
+                const uchar* mask_data = mask->data ? mask->ptr(y) : 0;
+
+                for( int x = 1; x < cols - 1; x++ )
+                {
+                    float val = curr[x];
+                    if( !(val > thresh) || val == 0 || (mask_data && !mask_data[x]) )
+                        continue;
+                    if( clip(prev[x-1]) > val || clip(prev[x]) > val || clip(prev[x+1]) > val ||
+                        clip(curr[x-1]) > val || clip(curr[x+1]) > val ||
+                        clip(next[x-1]) > val || clip(next[x]) > val || clip(next[x+1]) > val )
+                        continue;
+
+                    CornerCandidate c;
+                    c.val = val; c.y = y; c.x = x;
+                    if( keep <= 0 || (int)cands.size() < keep )
+                    {
+                        cands.push_back(c);
+                        if( keep > 0 )
+                            std::push_heap(cands.begin(), cands.end(), weaker);
+                    }
+                    else if( cands.front() < c )
+                    {
+                        // replace the weakest of the kept candidates
+                        std::pop_heap(cands.begin(), cands.end(), weaker);
+                        cands.back() = c;
+                        std::push_heap(cands.begin(), cands.end(), weaker);
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    // the response after threshold(THRESH_TOZERO)
+    float clip( float v ) const { return v > thresh ? v : 0.f; }
+
+    // orders the heap of the kept candidates so that the weakest one is on the top
+    static bool weaker( const CornerCandidate& a, const CornerCandidate& b ) { return b < a; }
+
+    const Mat* eig;
+    const Mat* mask;
+    float thresh;
+    int keep;
+    std::vector<std::vector<CornerCandidate> >* candidates;
 };
 
 #ifdef HAVE_OPENCL
@@ -274,7 +353,7 @@ void cv::goodFeaturesToTrack( InputArray _image, OutputArray _corners,
                ocl_goodFeaturesToTrack(_image, _corners, maxCorners, qualityLevel, minDistance,
                                     _mask, blockSize, useHarrisDetector, harrisK))
 
-    Mat image = _image.getMat(), eig, tmp;
+    Mat image = _image.getMat(), eig;
     if (image.empty())
     {
         _corners.release();
@@ -288,31 +367,27 @@ void cv::goodFeaturesToTrack( InputArray _image, OutputArray _corners,
 
     double maxVal = 0;
     minMaxLoc( eig, 0, &maxVal, 0, 0, _mask );
-    threshold( eig, eig, maxVal*qualityLevel, 0, THRESH_TOZERO );
-    dilate( eig, tmp, Mat());
-
-    Size imgsize = image.size();
-    std::vector<const float*> tmpCorners;
 
-    // collect list of pointers to features - put them into temporary image
+    // find the local maxima above the threshold in parallel bands; when the corners are not
+    // filtered by the distance, every band keeps only the maxCorners strongest candidates
     Mat mask = _mask.getMat();
-    for( int y = 1; y < imgsize.height - 1; y++ )
-    {
-        const float* eig_data = (const float*)eig.ptr(y);
-        const float* tmp_data = (const float*)tmp.ptr(y);
-        const uchar* mask_data = mask.data ? mask.ptr(y) : 0;
+    int nbands = std::max(std::min((image.rows - 2)/32, getNumThreads()*4), 1);
+    int keep = minDistance < 1 && maxCorners > 0 ? maxCorners : 0;
+    std::vector<std::vector<CornerCandidate> > bandCandidates(nbands);
+    parallel_for_(Range(0, nbands),
+                  FindCornerCandidatesInvoker(eig, mask, (float)(maxVal*qualityLevel), keep, bandCandidates),
+                  nbands);
 
-        for( int x = 1; x < imgsize.width - 1; x++ )
-        {
-            float val = eig_data[x];
-            if( val != 0 && val == tmp_data[x] && (!mask_data || mask_data[x]) )
-                tmpCorners.push_back(eig_data + x);
-        }
-    }
-    std::sort( tmpCorners.begin(), tmpCorners.end(), greaterThanPtr() );
+    std::vector<CornerCandidate> candidates;
+    for( int k = 0; k < nbands; k++ )
+        candidates.insert(candidates.end(), bandCandidates[k].begin(), bandCandidates[k].end());
+
+    // take the candidates from the strongest one; only the candidates that are actually
+    // taken are ordered, instead of sorting all of them
+    std::make_heap(candidates.begin(), candidates.end());
 
     std::vector<Point2f> corners;
-    size_t i, j, total = tmpCorners.size(), ncorners = 0;
+    size_t j, ncorners = 0;
 
     if (minDistance >= 1)
     {
@@ -328,11 +403,12 @@ void cv::goodFeaturesToTrack( InputArray _image, OutputArray _corners,
 
         minDistance *= minDistance;
 
-        for( i = 0; i < total; i++ )
+        while( !candidates.empty() )
         {
-            int ofs = (int)((const uchar*)tmpCorners[i] - eig.ptr());
-            int y = (int)(ofs / eig.step);
-            int x = (int)((ofs - y*eig.step)/sizeof(float));
+            std::pop_heap(candidates.begin(), candidates.end());
+            int x = candidates.back().x;
+            int y = candidates.back().y;
+            candidates.pop_back();
 
             bool good = true;
 
@@ -387,13 +463,11 @@ void cv::goodFeaturesToTrack( InputArray _image, OutputArray _corners,
     }
     else
     {
-        for( i = 0; i < total; i++ )
+        while( !candidates.empty() )
         {
-            int ofs = (int)((const uchar*)tmpCorners[i] - eig.ptr());
-            int y = (int)(ofs / eig.step);
-            int x = (int)((ofs - y*eig.step)/sizeof(float));
-
-            corners.push_back(Point2f((float)x, (float)y));
+            std::pop_heap(candidates.begin(), candidates.end());
+            corners.push_back(Point2f((float)candidates.back().x, (float)candidates.back().y));
+            candidates.pop_back();
             ++ncorners;
             if( maxCorners > 0 && (int)ncorners == maxCorners )
                 break;
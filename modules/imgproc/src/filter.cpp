@@ -62,10 +62,12 @@ BaseRowFilter::~BaseRowFilter() {}
 BaseColumnFilter::BaseColumnFilter() { ksize = anchor = -1; }
 BaseColumnFilter::~BaseColumnFilter() {}
 void BaseColumnFilter::reset() {}
+Ptr<BaseColumnFilter> BaseColumnFilter::clone() const { return Ptr<BaseColumnFilter>(); }
 
 BaseFilter::BaseFilter() { ksize = Size(-1,-1); anchor = Point(-1,-1); }
 BaseFilter::~BaseFilter() {}
 void BaseFilter::reset() {}
+Ptr<BaseFilter> BaseFilter::clone() const { return Ptr<BaseFilter>(); }
 
 FilterEngine::FilterEngine()
 {
@@ -393,6 +395,56 @@ int FilterEngine::proceed( const uchar* src, int srcstep, int count,
 }
 
 
+static void applyFilterEngine( FilterEngine& f, const Mat& src, Mat& dst,
+                               const Rect& srcRoi, Point dstOfs, bool isolated )
+{
+    int y = f.start(src, srcRoi, isolated);
+    f.proceed( src.ptr() + y*src.step + srcRoi.x*src.elemSize(),
+               (int)src.step, f.endY - f.startY,
+               dst.ptr(dstOfs.y) +
+               dstOfs.x*dst.elemSize(), (int)dst.step );
+}
+
+/*
+ Processes a horizontal stripe of the ROI by a copy of the engine with its own ring buffer
+ and its own copies of the stateful filters. The rows above and below the stripe are taken
+ from the source image, so the result is the same as when the whole ROI is processed at once.
+*/
+class FilterEngineStripeInvoker : public ParallelLoopBody
+{
+public:
+    FilterEngineStripeInvoker( const FilterEngine& _engine, const Mat& _src, Mat& _dst,
+                               const Rect& _srcRoi, Point _dstOfs, bool _isolated, int _nstripes )
+        : engine(&_engine), src(&_src), dst(&_dst), srcRoi(_srcRoi),
+          dstOfs(_dstOfs), isolated(_isolated), nstripes(_nstripes) {}
+
+    void operator()( const Range& range ) const
+    {
+        int y0 = (int)((int64)range.start*srcRoi.height/nstripes);
+        int y1 = (int)((int64)range.end*srcRoi.height/nstripes);
+        if( y0 >= y1 )
+            return;
+
+        FilterEngine f = *engine;
+        if( f.filter2D )
+            f.filter2D = engine->filter2D->clone();
+        if( f.columnFilter )
+            f.columnFilter = engine->columnFilter->clone();
+
+        applyFilterEngine( f, *src, *dst, Rect(srcRoi.x, srcRoi.y + y0, srcRoi.width, y1 - y0),
+                           Point(dstOfs.x, dstOfs.y + y0), isolated );
+    }
+
+private:
+    const FilterEngine* engine;
+    const Mat* src;
+    Mat* dst;
+    Rect srcRoi;
+    Point dstOfs;
+    bool isolated;
+    int nstripes;
+};
+
 void FilterEngine::apply(const Mat& src, Mat& dst,
     const Rect& _srcRoi, Point dstOfs, bool isolated)
 {
@@ -409,11 +461,23 @@ void FilterEngine::apply(const Mat& src, Mat& dst,
         dstOfs.x + srcRoi.width <= dst.cols &&
         dstOfs.y + srcRoi.height <= dst.rows );
 
-    int y = start(src, srcRoi, isolated);
-    proceed( src.ptr() + y*src.step + srcRoi.x*src.elemSize(),
-             (int)src.step, endY - startY,
-             dst.ptr(dstOfs.y) +
-             dstOfs.x*dst.elemSize(), (int)dst.step );
+    // every stripe should have at least 64K pixels and be much taller than the kernel,
+    // so that the rows shared by the neighbor stripes do not add much work
+    int nstripes = std::min(srcRoi.height/std::max(ksize.height*4, 32),
+                            (int)std::min((int64)srcRoi.area() >> 16, (int64)getNumThreads()*4));
+    // the stripes can not be processed concurrently when the output overwrites the input
+    bool inplace = src.datastart < dst.dataend && dst.datastart < src.dataend;
+
+    if( nstripes > 1 && getNumThreads() > 1 && !inplace &&
+        (!filter2D || filter2D->clone()) && (!columnFilter || columnFilter->clone()) )
+    {
+        parallel_for_(Range(0, nstripes),
+                      FilterEngineStripeInvoker(*this, src, dst, srcRoi, dstOfs, isolated, nstripes),
+                      nstripes);
+        return;
+    }
+
+    applyFilterEngine( *this, src, dst, srcRoi, dstOfs, isolated );
 }
 
 }
@@ -3278,6 +3342,8 @@ template<class CastOp, class VecOp> struct ColumnFilter : public BaseColumnFilte
                    (kernel.rows == 1 || kernel.cols == 1));
     }
 
+    virtual Ptr<BaseColumnFilter> clone() const { return makePtr<ColumnFilter<CastOp, VecOp> >(*this); }
+
     void operator()(const uchar** src, uchar* dst, int dststep, int count, int width)
     {
         const ST* ky = kernel.template ptr<ST>();
@@ -3341,6 +3407,8 @@ template<class CastOp, class VecOp> struct SymmColumnFilter : public ColumnFilte
         CV_Assert( (symmetryType & (KERNEL_SYMMETRICAL | KERNEL_ASYMMETRICAL)) != 0 );
     }
 
+    virtual Ptr<BaseColumnFilter> clone() const { return makePtr<SymmColumnFilter<CastOp, VecOp> >(*this); }
+
     void operator()(const uchar** src, uchar* dst, int dststep, int count, int width)
     {
         int ksize2 = this->ksize/2;
@@ -3447,6 +3515,8 @@ struct SymmColumnSmallFilter : public SymmColumnFilter<CastOp, VecOp>
         CV_Assert( this->ksize == 3 );
     }
 
+    virtual Ptr<BaseColumnFilter> clone() const { return makePtr<SymmColumnSmallFilter<CastOp, VecOp> >(*this); }
+
     void operator()(const uchar** src, uchar* dst, int dststep, int count, int width)
     {
         int ksize2 = this->ksize/2;
@@ -3923,6 +3993,8 @@ template<typename ST, class CastOp, class VecOp> struct Filter2D : public BaseFi
         ptrs.resize( coords.size() );
     }
 
+    virtual Ptr<BaseFilter> clone() const { return makePtr<Filter2D<ST, CastOp, VecOp> >(*this); }
+
     void operator()(const uchar** src, uchar* dst, int dststep, int count, int width, int cn)
     {
         KT _delta = delta;
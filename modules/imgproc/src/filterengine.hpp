@@ -98,6 +98,9 @@ public:
     virtual void operator()(const uchar** src, uchar* dst, int dststep, int dstcount, int width) = 0;
     //! resets the internal buffers, if any
     virtual void reset();
+    //! makes an independent copy of the filter that can be used concurrently with this one.
+    //! The default implementation returns an empty pointer, so that cv::FilterEngine processes the image in a single thread.
+    virtual Ptr<BaseColumnFilter> clone() const;
 
     int ksize;
     int anchor;
@@ -126,6 +129,8 @@ public:
     virtual void operator()(const uchar** src, uchar* dst, int dststep, int dstcount, int width, int cn) = 0;
     //! resets the internal buffers, if any
     virtual void reset();
+    //! makes an independent copy of the filter, see BaseColumnFilter::clone()
+    virtual Ptr<BaseFilter> clone() const;
 
     Size ksize;
     Point anchor;
@@ -237,6 +242,7 @@ public:
     virtual int proceed(const uchar* src, int srcStep, int srcCount,
                         uchar* dst, int dstStep);
     //! applies filter to the specified ROI of the image. if srcRoi=(0,0,-1,-1), the whole image is filtered.
+    //! Large images are split into horizontal stripes processed in parallel, each by its own copy of the engine.
     virtual void apply( const Mat& src, Mat& dst,
                         const Rect& srcRoi = Rect(0,0,-1,-1),
                         Point dstOfs = Point(0,0),
@@ -455,41 +455,47 @@ floodFillGrad_CnIR( Mat& image, Mat& msk,
 *                                    External Functions                                  *
 \****************************************************************************************/
 
-int cv::floodFill( InputOutputArray _image, InputOutputArray _mask,
-                  Point seedPoint, Scalar newVal, Rect* rect,
-                  Scalar loDiff, Scalar upDiff, int flags )
+namespace cv
 {
-    ConnectedComp comp;
-    std::vector<FFillSegment> buffer;
 
-    if( rect )
-        *rect = Rect();
+/*
+   The part of floodFill that does not depend on the seed: the parameter checks,
+   the scanline stack and the bordered mask, shared by all the seeds of a batch.
+*/
+class FloodFiller
+{
+public:
+    FloodFiller( const Mat& _img, const Mat& _mask, Scalar _loDiff, Scalar _upDiff, int _flags );
 
-    int i, connectivity = flags & 255;
-    union {
-        uchar b[4];
-        int i[4];
-        float f[4];
-        double _[4];
-    } nv_buf;
-    nv_buf._[0] = nv_buf._[1] = nv_buf._[2] = nv_buf._[3] = 0;
+    int fill( Point seedPoint, Scalar newVal, Rect* rect );
+
+    // lets the next seed see the temporary mask clear, as a separate floodFill call would;
+    // only the bounding rectangle of the previous fill has to be reset
+    void clearTempMask( const Rect& rect );
+
+protected:
+    void prepareMask();
 
+    Mat img, mask;
+    Scalar loDiff, upDiff;
+    int flags;
+    bool is_simple, maskReady, tempMask;
+    uchar newMaskVal;
     struct { Vec3b b; Vec3i i; Vec3f f; } ld_buf, ud_buf;
-    Mat img = _image.getMat(), mask;
-    if( !_mask.empty() )
-        mask = _mask.getMat();
-    Size size = img.size();
+    std::vector<FFillSegment> buffer;
+};
 
-    int type = img.type();
-    int depth = img.depth();
+FloodFiller::FloodFiller( const Mat& _img, const Mat& _mask, Scalar _loDiff, Scalar _upDiff, int _flags )
+    : img(_img), mask(_mask), loDiff(_loDiff), upDiff(_upDiff), flags(_flags),
+      maskReady(false), tempMask(_mask.empty())
+{
+    int i, connectivity = flags & 255;
     int cn = img.channels();
 
-    if( connectivity == 0 )
-        connectivity = 4;
-    else if( connectivity != 4 && connectivity != 8 )
+    if( connectivity != 0 && connectivity != 4 && connectivity != 8 )
         CV_Error( CV_StsBadFlag, "Connectivity must be 4, 0(=4) or 8" );
 
-    bool is_simple = mask.empty() && (flags & FLOODFILL_MASK_ONLY) == 0;
+    is_simple = mask.empty() && (flags & FLOODFILL_MASK_ONLY) == 0;
 
     for( i = 0; i < cn; i++ )
     {
@@ -498,51 +504,20 @@ int cv::floodFill( InputOutputArray _image, InputOutputArray _mask,
         is_simple = is_simple && fabs(loDiff[i]) < DBL_EPSILON && fabs(upDiff[i]) < DBL_EPSILON;
     }
 
-    if( (unsigned)seedPoint.x >= (unsigned)size.width ||
-       (unsigned)seedPoint.y >= (unsigned)size.height )
-        CV_Error( CV_StsOutOfRange, "Seed point is outside of image" );
-
-    scalarToRawData( newVal, &nv_buf, type, 0);
-    size_t buffer_size = MAX( size.width, size.height ) * 2;
+    size_t buffer_size = MAX( img.cols, img.rows ) * 2;
     buffer.resize( buffer_size );
+    newMaskVal = (uchar)((flags & ~0xff) == 0 ? 1 : ((flags >> 8) & 255));
+}
 
-    if( is_simple )
-    {
-        size_t elem_size = img.elemSize();
-        const uchar* seed_ptr = img.ptr(seedPoint.y) + elem_size*seedPoint.x;
-
-        size_t k = 0;
-        for(; k < elem_size; k++)
-            if (seed_ptr[k] != nv_buf.b[k])
-                break;
-
-        if( k != elem_size )
-        {
-            if( type == CV_8UC1 )
-                floodFill_CnIR(img, seedPoint, nv_buf.b[0], &comp, flags, &buffer);
-            else if( type == CV_8UC3 )
-                floodFill_CnIR(img, seedPoint, Vec3b(nv_buf.b), &comp, flags, &buffer);
-            else if( type == CV_32SC1 )
-                floodFill_CnIR(img, seedPoint, nv_buf.i[0], &comp, flags, &buffer);
-            else if( type == CV_32FC1 )
-                floodFill_CnIR(img, seedPoint, nv_buf.f[0], &comp, flags, &buffer);
-            else if( type == CV_32SC3 )
-                floodFill_CnIR(img, seedPoint, Vec3i(nv_buf.i), &comp, flags, &buffer);
-            else if( type == CV_32FC3 )
-                floodFill_CnIR(img, seedPoint, Vec3f(nv_buf.f), &comp, flags, &buffer);
-            else
-                CV_Error( CV_StsUnsupportedFormat, "" );
-            if( rect )
-                *rect = comp.rect;
-            return comp.area;
-        }
-    }
+void FloodFiller::prepareMask()
+{
+    Size size = img.size();
+    int i, depth = img.depth(), cn = img.channels();
 
     if( mask.empty() )
     {
-        Mat tempMask( size.height + 2, size.width + 2, CV_8UC1 );
-        tempMask.setTo(Scalar::all(0));
-        mask = tempMask;
+        mask.create( size.height + 2, size.width + 2, CV_8UC1 );
+        mask.setTo(Scalar::all(0));
     }
     else
     {
@@ -579,7 +554,67 @@ int cv::floodFill( InputOutputArray _image, InputOutputArray _mask,
     else
         CV_Error( CV_StsUnsupportedFormat, "" );
 
-    uchar newMaskVal = (uchar)((flags & ~0xff) == 0 ? 1 : ((flags >> 8) & 255));
+    maskReady = true;
+}
+
+int FloodFiller::fill( Point seedPoint, Scalar newVal, Rect* rect )
+{
+    ConnectedComp comp;
+
+    if( rect )
+        *rect = Rect();
+
+    union {
+        uchar b[4];
+        int i[4];
+        float f[4];
+        double _[4];
+    } nv_buf;
+    nv_buf._[0] = nv_buf._[1] = nv_buf._[2] = nv_buf._[3] = 0;
+
+    Size size = img.size();
+    int type = img.type();
+
+    if( (unsigned)seedPoint.x >= (unsigned)size.width ||
+       (unsigned)seedPoint.y >= (unsigned)size.height )
+        CV_Error( CV_StsOutOfRange, "Seed point is outside of image" );
+
+    scalarToRawData( newVal, &nv_buf, type, 0);
+
+    if( is_simple )
+    {
+        size_t elem_size = img.elemSize();
+        const uchar* seed_ptr = img.ptr(seedPoint.y) + elem_size*seedPoint.x;
+
+        size_t k = 0;
+        for(; k < elem_size; k++)
+            if (seed_ptr[k] != nv_buf.b[k])
+                break;
+
+        if( k != elem_size )
+        {
+            if( type == CV_8UC1 )
+                floodFill_CnIR(img, seedPoint, nv_buf.b[0], &comp, flags, &buffer);
+            else if( type == CV_8UC3 )
+                floodFill_CnIR(img, seedPoint, Vec3b(nv_buf.b), &comp, flags, &buffer);
+            else if( type == CV_32SC1 )
+                floodFill_CnIR(img, seedPoint, nv_buf.i[0], &comp, flags, &buffer);
+            else if( type == CV_32FC1 )
+                floodFill_CnIR(img, seedPoint, nv_buf.f[0], &comp, flags, &buffer);
+            else if( type == CV_32SC3 )
+                floodFill_CnIR(img, seedPoint, Vec3i(nv_buf.i), &comp, flags, &buffer);
+            else if( type == CV_32FC3 )
+                floodFill_CnIR(img, seedPoint, Vec3f(nv_buf.f), &comp, flags, &buffer);
+            else
+                CV_Error( CV_StsUnsupportedFormat, "" );
+            if( rect )
+                *rect = comp.rect;
+            return comp.area;
+        }
+    }
+
+    if( !maskReady )
+        prepareMask();
 
     if( type == CV_8UC1 )
         floodFillGrad_CnIR<uchar, uchar, int, Diff8uC1>(
@@ -619,6 +654,54 @@ int cv::floodFill( InputOutputArray _image, InputOutputArray _mask,
     return comp.area;
 }
 
+void FloodFiller::clearTempMask( const Rect& rect )
+{
+    if( tempMask && maskReady && rect.area() > 0 )
+        mask(rect + Point(1, 1)).setTo(Scalar::all(0));
+}
+
+}
+
+int cv::floodFill( InputOutputArray _image, InputOutputArray _mask,
+                  Point seedPoint, Scalar newVal, Rect* rect,
+                  Scalar loDiff, Scalar upDiff, int flags )
+{
+    Mat mask;
+    if( !_mask.empty() )
+        mask = _mask.getMat();
+
+    FloodFiller filler(_image.getMat(), mask, loDiff, upDiff, flags);
+    return filler.fill(seedPoint, newVal, rect);
+}
+
+
+int cv::floodFillBatch( InputOutputArray _image, InputOutputArray _mask,
+                        const std::vector<Point>& seedPoints, const std::vector<Scalar>& newVals,
+                        std::vector<Rect>& rects, std::vector<int>& areas,
+                        Scalar loDiff, Scalar upDiff, int flags )
+{
+    size_t i, nseeds = seedPoints.size();
+    CV_Assert( newVals.size() == 1 || newVals.size() == nseeds );
+
+    rects.assign(nseeds, Rect());
+    areas.assign(nseeds, 0);
+
+    Mat mask;
+    if( !_mask.empty() )
+        mask = _mask.getMat();
+
+    FloodFiller filler(_image.getMat(), mask, loDiff, upDiff, flags);
+    int total = 0;
+    for( i = 0; i < nseeds; i++ )
+    {
+        if( i > 0 )
+            filler.clearTempMask(rects[i-1]);
+        areas[i] = filler.fill(seedPoints[i], newVals[newVals.size() == 1 ? 0 : i], &rects[i]);
+        total += areas[i];
+    }
+    return total;
+}
+
 
 int cv::floodFill( InputOutputArray _image, Point seedPoint,
                   Scalar newVal, Rect* rect,
@@ -42,6 +42,15 @@
 #ifndef _CV_GCGRAPH_H_
 #define _CV_GCGRAPH_H_
 
+/*
+ Max-flow/min-cut by the Boykov-Kolmogorov algorithm.
+
+ The edges are added in the pairs (i->j, j->i), and the first call of maxFlow() packs them so that
+ the edges of every vertex are stored contiguously. After maxFlow() the terminal weights can be
+ changed by addTermWeights() (the weights are added, so they may be negative then), and the next
+ maxFlow() continues from the residual graph and the search trees of the previous one
+ (the dynamic graph cuts by Kohli and Torr): only the trees around the changed vertices are rebuilt.
+*/
 template <class TWeight> class GCGraph
 {
 public:
@@ -60,7 +69,8 @@ private:
     public:
         Vtx *next; // initialized and used in maxFlow() only
         int parent;
-        int first;
+        int first; // the edges of the vertex are [first, last) after the first maxFlow()
+        int last;
         int ts;
         int dist;
         TWeight weight;
@@ -70,19 +80,26 @@ private:
     {
     public:
         int dst;
-        int next;
+        int rev; // the edge in the opposite direction
         TWeight weight;
     };
 
+    void packEdges();
+
     std::vector<Vtx> vtcs;
     std::vector<Edge> edges;
+    std::vector<int> changedVtcs;
     TWeight flow;
+    int curr_ts;
+    bool packed;
 };
 
 template <class TWeight>
 GCGraph<TWeight>::GCGraph()
 {
     flow = 0;
+    curr_ts = 0;
+    packed = false;
 }
 template <class TWeight>
 GCGraph<TWeight>::GCGraph( unsigned int vtxCount, unsigned int edgeCount )
@@ -99,11 +116,14 @@ void GCGraph<TWeight>::create( unsigned int vtxCount, unsigned int edgeCount )
     vtcs.reserve( vtxCount );
     edges.reserve( edgeCount + 2 );
     flow = 0;
+    curr_ts = 0;
+    packed = false;
 }
 
 template <class TWeight>
 int GCGraph<TWeight>::addVtx()
 {
+    CV_Assert( !packed );
     Vtx v;
     memset( &v, 0, sizeof(Vtx));
     vtcs.push_back(v);
@@ -117,21 +137,22 @@ void GCGraph<TWeight>::addEdges( int i, int j, TWeight w, TWeight revw )
     CV_Assert( j>=0 && j<(int)vtcs.size() );
     CV_Assert( w>=0 && revw>=0 );
     CV_Assert( i != j );
+    CV_Assert( !packed );
 
     if( !edges.size() )
         edges.resize( 2 );
 
     Edge fromI, toI;
     fromI.dst = j;
-    fromI.next = vtcs[i].first;
+    fromI.rev = (int)edges.size() + 1;
     fromI.weight = w;
-    vtcs[i].first = (int)edges.size();
+    vtcs[i].last++;
     edges.push_back( fromI );
 
     toI.dst = i;
-    toI.next = vtcs[j].first;
+    toI.rev = (int)edges.size() - 1;
     toI.weight = revw;
-    vtcs[j].first = (int)edges.size();
+    vtcs[j].last++;
     edges.push_back( toI );
 }
 
@@ -147,6 +168,37 @@ void GCGraph<TWeight>::addTermWeights( int i, TWeight sourceW, TWeight sinkW )
         sinkW -= dw;
     flow += (sourceW < sinkW) ? sourceW : sinkW;
     vtcs[i].weight = sourceW - sinkW;
+    if( packed && vtcs[i].weight != dw )
+        changedVtcs.push_back(i);
+}
+
+// reorders the edges by the source vertex; until then Vtx::last is the number of the edges
+template <class TWeight>
+void GCGraph<TWeight>::packEdges()
+{
+    int i, nvtcs = (int)vtcs.size(), nedges = (int)edges.size(), ofs = 2;
+    std::vector<Edge> packedEdges(nedges);
+    std::vector<int> idx(nedges);
+
+    for( i = 0; i < nvtcs; i++ )
+    {
+        int count = vtcs[i].last;
+        vtcs[i].first = vtcs[i].last = ofs;
+        ofs += count;
+    }
+
+    // the source of the edge e is the destination of its pair
+    for( i = 2; i < nedges; i++ )
+        idx[i] = vtcs[edges[edges[i].rev].dst].last++;
+    for( i = 2; i < nedges; i++ )
+    {
+        Edge& e = packedEdges[idx[i]];
+        e.dst = edges[i].dst;
+        e.rev = idx[edges[i].rev];
+        e.weight = edges[i].weight;
+    }
+    edges.swap(packedEdges);
+    packed = true;
 }
 
 template <class TWeight>
@@ -154,33 +206,86 @@ TWeight GCGraph<TWeight>::maxFlow()
 {
     const int TERMINAL = -1, ORPHAN = -2;
     Vtx stub, *nilNode = &stub, *first = nilNode, *last = nilNode;
-    int curr_ts = 0;
     stub.next = nilNode;
+
+    if( vtcs.empty() )
+        return flow;
+    if( edges.empty() )
+        edges.resize( 2 );
+
+    bool reuseTrees = packed;
+    if( !packed )
+        packEdges();
+
     Vtx *vtxPtr = &vtcs[0];
     Edge *edgePtr = &edges[0];
 
     std::vector<Vtx*> orphans;
 
-    // initialize the active queue and the graph vertices
-    for( int i = 0; i < (int)vtcs.size(); i++ )
+    if( !reuseTrees )
+    {
+        // initialize the active queue and the graph vertices
+        for( int i = 0; i < (int)vtcs.size(); i++ )
+        {
+            Vtx* v = vtxPtr + i;
+            v->ts = 0;
+            if( v->weight != 0 )
+            {
+                last = last->next = v;
+                v->dist = 1;
+                v->parent = TERMINAL;
+                v->t = v->weight < 0;
+            }
+            else
+                v->parent = 0;
+        }
+    }
+    else
     {
-        Vtx* v = vtxPtr + i;
-        v->ts = 0;
-        if( v->weight != 0 )
+        // the changed vertices become the roots of the trees of their new terminals, and
+        // the vertices below them or below the vertices that lost the terminals become the orphans
+        for( size_t i = 0; i < changedVtcs.size(); i++ )
         {
-            last = last->next = v;
-            v->dist = 1;
-            v->parent = TERMINAL;
-            v->t = v->weight < 0;
+            Vtx* v = vtxPtr + changedVtcs[i];
+            if( v->weight != 0 )
+            {
+                uchar t = v->weight < 0;
+                if( v->parent != 0 && v->t != t )
+                {
+                    for( int ei = v->first; ei < v->last; ei++ )
+                    {
+                        Vtx* u = vtxPtr+edgePtr[ei].dst;
+                        int ej = u->parent;
+                        if( ej > 0 && vtxPtr+edgePtr[ej].dst == v )
+                        {
+                            orphans.push_back(u);
+                            u->parent = ORPHAN;
+                        }
+                    }
+                }
+                v->parent = TERMINAL;
+                v->t = t;
+                v->ts = curr_ts;
+                v->dist = 1;
+                if( !v->next )
+                {
+                    v->next = nilNode;
+                    last = last->next = v;
+                }
+            }
+            else if( v->parent == TERMINAL )
+            {
+                orphans.push_back(v);
+                v->parent = ORPHAN;
+            }
         }
-        else
-            v->parent = 0;
+        changedVtcs.clear();
     }
     first = first->next;
     last->next = nilNode;
     nilNode->next = 0;
 
-    // run the search-path -> augment-graph -> restore-trees loop
+    // run the restore-trees -> search-path -> augment-graph loop
     for(;;)
     {
         Vtx* v, *u;
@@ -188,22 +293,115 @@ TWeight GCGraph<TWeight>::maxFlow()
         TWeight minWeight, weight;
         uchar vt;
 
+        // restore the search trees by finding new parents for the orphans
+        if( !orphans.empty() )
+            curr_ts++;
+        while( !orphans.empty() )
+        {
+            Vtx* v2 = orphans.back();
+            orphans.pop_back();
+            if( v2->parent != ORPHAN )
+                continue;
+
+            int d, minDist = INT_MAX;
+            e0 = 0;
+            vt = v2->t;
+
+            for( ei = v2->first; ei < v2->last; ei++ )
+            {
+                if( edgePtr[vt ? ei : edgePtr[ei].rev].weight == 0 )
+                    continue;
+                u = vtxPtr+edgePtr[ei].dst;
+                if( u->t != vt || u->parent == 0 )
+                    continue;
+                // compute the distance to the tree root
+                for( d = 0;; )
+                {
+                    if( u->ts == curr_ts )
+                    {
+                        d += u->dist;
+                        break;
+                    }
+                    ej = u->parent;
+                    d++;
+                    if( ej < 0 )
+                    {
+                        if( ej == ORPHAN )
+                            d = INT_MAX-1;
+                        else
+                        {
+                            u->ts = curr_ts;
+                            u->dist = 1;
+                        }
+                        break;
+                    }
+                    u = vtxPtr+edgePtr[ej].dst;
+                }
+
+                // update the distance
+                if( ++d < INT_MAX )
+                {
+                    if( d < minDist )
+                    {
+                        minDist = d;
+                        e0 = ei;
+                    }
+                    for( u = vtxPtr+edgePtr[ei].dst; u->ts != curr_ts; u = vtxPtr+edgePtr[u->parent].dst )
+                    {
+                        u->ts = curr_ts;
+                        u->dist = --d;
+                    }
+                }
+            }
+
+            if( (v2->parent = e0) > 0 )
+            {
+                v2->ts = curr_ts;
+                v2->dist = minDist;
+                continue;
+            }
+
+            /* no parent is found; the neighbors of both trees that can grow to v2 become active,
+               since with the reused trees the opposite tree may have never been active here */
+            v2->ts = 0;
+            for( ei = v2->first; ei < v2->last; ei++ )
+            {
+                u = vtxPtr+edgePtr[ei].dst;
+                ej = u->parent;
+                if( !ej )
+                    continue;
+                if( edgePtr[u->t ? ei : edgePtr[ei].rev].weight && !u->next )
+                {
+                    u->next = nilNode;
+                    last = last->next = u;
+                    if( first == nilNode )
+                        first = u;
+                }
+                if( u->t == vt && ej > 0 && vtxPtr+edgePtr[ej].dst == v2 )
+                {
+                    orphans.push_back(u);
+                    u->parent = ORPHAN;
+                }
+            }
+        }
+
         // grow S & T search trees, find an edge connecting them
+        e0 = -1;
         while( first != nilNode )
         {
             v = first;
             if( v->parent )
             {
                 vt = v->t;
-                for( ei = v->first; ei != 0; ei = edgePtr[ei].next )
+                for( ei = v->first; ei < v->last; ei++ )
                 {
-                    if( edgePtr[ei^vt].weight == 0 )
+                    if( edgePtr[vt ? edgePtr[ei].rev : ei].weight == 0 )
                         continue;
                     u = vtxPtr+edgePtr[ei].dst;
                     if( !u->parent )
                     {
                         u->t = vt;
-                        u->parent = ei ^ 1;
+                        u->parent = edgePtr[ei].rev;
                         u->ts = v->ts;
                         u->dist = v->dist + 1;
                         if( !u->next )
@@ -216,14 +414,14 @@ TWeight GCGraph<TWeight>::maxFlow()
 
                     if( u->t != vt )
                     {
-                        e0 = ei ^ vt;
+                        e0 = vt ? edgePtr[ei].rev : ei;
                         break;
                     }
 
                     if( u->dist > v->dist+1 && u->ts <= v->ts )
                     {
                         // reassign the parent
-                        u->parent = ei ^ 1;
+                        u->parent = edgePtr[ei].rev;
                         u->ts = v->ts;
                         u->dist = v->dist + 1;
                     }
@@ -245,11 +443,11 @@ TWeight GCGraph<TWeight>::maxFlow()
         // k = 1: source tree, k = 0: destination tree
         for( int k = 1; k >= 0; k-- )
         {
-            for( v = vtxPtr+edgePtr[e0^k].dst;; v = vtxPtr+edgePtr[ei].dst )
+            for( v = vtxPtr+edgePtr[k ? edgePtr[e0].rev : e0].dst;; v = vtxPtr+edgePtr[ei].dst )
             {
                 if( (ei = v->parent) < 0 )
                     break;
-                weight = edgePtr[ei^k].weight;
+                weight = edgePtr[k ? edgePtr[ei].rev : ei].weight;
                 minWeight = MIN(minWeight, weight);
                 CV_Assert( minWeight > 0 );
             }
@@ -260,18 +458,19 @@ TWeight GCGraph<TWeight>::maxFlow()
 
         // modify weights of the edges along the path and collect orphans
         edgePtr[e0].weight -= minWeight;
-        edgePtr[e0^1].weight += minWeight;
+        edgePtr[edgePtr[e0].rev].weight += minWeight;
         flow += minWeight;
 
         // k = 1: source tree, k = 0: destination tree
         for( int k = 1; k >= 0; k-- )
         {
-            for( v = vtxPtr+edgePtr[e0^k].dst;; v = vtxPtr+edgePtr[ei].dst )
+            for( v = vtxPtr+edgePtr[k ? edgePtr[e0].rev : e0].dst;; v = vtxPtr+edgePtr[ei].dst )
             {
                 if( (ei = v->parent) < 0 )
                     break;
-                edgePtr[ei^(k^1)].weight += minWeight;
-                if( (edgePtr[ei^k].weight -= minWeight) == 0 )
+                int rev = edgePtr[ei].rev;
+                edgePtr[k ? ei : rev].weight += minWeight;
+                if( (edgePtr[k ? rev : ei].weight -= minWeight) == 0 )
                 {
                     orphans.push_back(v);
                     v->parent = ORPHAN;
@@ -285,92 +484,6 @@ TWeight GCGraph<TWeight>::maxFlow()
                v->parent = ORPHAN;
             }
         }
-
-        // restore the search trees by finding new parents for the orphans
-        curr_ts++;
-        while( !orphans.empty() )
-        {
-            Vtx* v2 = orphans.back();
-            orphans.pop_back();
-
-            int d, minDist = INT_MAX;
-            e0 = 0;
-            vt = v2->t;
-
-            for( ei = v2->first; ei != 0; ei = edgePtr[ei].next )
-            {
-                if( edgePtr[ei^(vt^1)].weight == 0 )
-                    continue;
-                u = vtxPtr+edgePtr[ei].dst;
-                if( u->t != vt || u->parent == 0 )
-                    continue;
-                // compute the distance to the tree root
-                for( d = 0;; )
-                {
-                    if( u->ts == curr_ts )
-                    {
-                        d += u->dist;
-                        break;
-                    }
-                    ej = u->parent;
-                    d++;
-                    if( ej < 0 )
-                    {
-                        if( ej == ORPHAN )
-                            d = INT_MAX-1;
-                        else
-                        {
-                            u->ts = curr_ts;
-                            u->dist = 1;
-                        }
-                        break;
-                    }
-                    u = vtxPtr+edgePtr[ej].dst;
-                }
-
-                // update the distance
-                if( ++d < INT_MAX )
-                {
-                    if( d < minDist )
-                    {
-                        minDist = d;
-                        e0 = ei;
-                    }
-                    for( u = vtxPtr+edgePtr[ei].dst; u->ts != curr_ts; u = vtxPtr+edgePtr[u->parent].dst )
-                    {
-                        u->ts = curr_ts;
-                        u->dist = --d;
-                    }
-                }
-            }
-
-            if( (v2->parent = e0) > 0 )
-            {
-                v2->ts = curr_ts;
-                v2->dist = minDist;
-                continue;
-            }
-
-            /* no parent is found */
-            v2->ts = 0;
-            for( ei = v2->first; ei != 0; ei = edgePtr[ei].next )
-            {
-                u = vtxPtr+edgePtr[ei].dst;
-                ej = u->parent;
-                if( u->t != vt || !ej )
-                    continue;
-                if( edgePtr[ei^(vt^1)].weight && !u->next )
-                {
-                    u->next = nilNode;
-                    last = last->next = u;
-                }
-                if( ej > 0 && vtxPtr+edgePtr[ej].dst == v2 )
-                {
-                    orphans.push_back(u);
-                    u->parent = ORPHAN;
-                }
-            }
-        }
     }
     return flow;
 }
@@ -379,7 +492,8 @@ template <class TWeight>
 bool GCGraph<TWeight>::inSourceSegment( int i )
 {
     CV_Assert( i>=0 && i<(int)vtcs.size() );
-    return vtcs[i].t == 0;
+    // the sink segment is the sink tree, the free vertices may keep the tree they were in before
+    return vtcs[i].t == 0 || vtcs[i].parent == 0;
 }
 
 #endif
@@ -441,15 +441,39 @@ static void learnGMMs( const Mat& img, const Mat& mask, const Mat& compIdxs, GMM
 }
 
 /*
-  Construct GCGraph
+  Calculate the terminal weights of the pixel
+*/
+static inline void calcTermWeights( const Vec3b& color, uchar maskVal, const GMM& bgdGMM, const GMM& fgdGMM, double lambda,
+                                    double& fromSource, double& toSink )
+{
+    if( maskVal == GC_PR_BGD || maskVal == GC_PR_FGD )
+    {
+        fromSource = -log( bgdGMM(color) );
+        toSink = -log( fgdGMM(color) );
+    }
+    else if( maskVal == GC_BGD )
+    {
+        fromSource = 0;
+        toSink = lambda;
+    }
+    else // GC_FGD
+    {
+        fromSource = lambda;
+        toSink = 0;
+    }
+}
+
+/*
+  Construct GCGraph, termW receives the terminal weights
 */
 static void constructGCGraph( const Mat& img, const Mat& mask, const GMM& bgdGMM, const GMM& fgdGMM, double lambda,
                        const Mat& leftW, const Mat& upleftW, const Mat& upW, const Mat& uprightW,
-                       GCGraph<double>& graph )
+                       Mat& termW, GCGraph<double>& graph )
 {
     int vtxCount = img.cols*img.rows,
         edgeCount = 2*(4*img.cols*img.rows - 3*(img.cols + img.rows) + 2);
     graph.create(vtxCount, edgeCount);
+    termW.create( img.size(), CV_64FC2 );
     Point p;
     for( p.y = 0; p.y < img.rows; p.y++ )
     {
@@ -457,26 +481,11 @@ static void constructGCGraph( const Mat& img, const Mat& mask, const GMM& bgdGMM
         {
             // add node
             int vtxIdx = graph.addVtx();
-            Vec3b color = img.at<Vec3b>(p);
 
             // set t-weights
-            double fromSource, toSink;
-            if( mask.at<uchar>(p) == GC_PR_BGD || mask.at<uchar>(p) == GC_PR_FGD )
-            {
-                fromSource = -log( bgdGMM(color) );
-                toSink = -log( fgdGMM(color) );
-            }
-            else if( mask.at<uchar>(p) == GC_BGD )
-            {
-                fromSource = 0;
-                toSink = lambda;
-            }
-            else // GC_FGD
-            {
-                fromSource = lambda;
-                toSink = 0;
-            }
-            graph.addTermWeights( vtxIdx, fromSource, toSink );
+            double* tw = termW.ptr<double>(p.y) + p.x*2;
+            calcTermWeights( img.at<Vec3b>(p), mask.at<uchar>(p), bgdGMM, fgdGMM, lambda, tw[0], tw[1] );
+            graph.addTermWeights( vtxIdx, tw[0], tw[1] );
 
             // set n-weights
             if( p.x>0 )
@@ -503,6 +512,30 @@ static void constructGCGraph( const Mat& img, const Mat& mask, const GMM& bgdGMM
     }
 }
 
+/*
+  Update the terminal weights of GCGraph after the GMMs have changed; the n-weights stay the same,
+  so the next maxFlow() continues from the current flow and search trees
+*/
+static void updateGCGraph( const Mat& img, const Mat& mask, const GMM& bgdGMM, const GMM& fgdGMM, double lambda,
+                           Mat& termW, GCGraph<double>& graph )
+{
+    Point p;
+    for( p.y = 0; p.y < img.rows; p.y++ )
+    {
+        for( p.x = 0; p.x < img.cols; p.x++ )
+        {
+            double fromSource, toSink, *tw = termW.ptr<double>(p.y) + p.x*2;
+            calcTermWeights( img.at<Vec3b>(p), mask.at<uchar>(p), bgdGMM, fgdGMM, lambda, fromSource, toSink );
+            if( fromSource != tw[0] || toSink != tw[1] )
+            {
+                graph.addTermWeights( p.y*img.cols + p.x, fromSource - tw[0], toSink - tw[1] );
+                tw[0] = fromSource;
+                tw[1] = toSink;
+            }
+        }
+    }
+}
+
 /*
   Estimate segmentation using MaxFlow algorithm
 */
@@ -564,12 +597,16 @@ void cv::grabCut( InputArray _img, InputOutputArray _mask, Rect rect,
     Mat leftW, upleftW, upW, uprightW;
     calcNWeights( img, leftW, upleftW, upW, uprightW, beta, gamma );
 
+    GCGraph<double> graph;
+    Mat termW;
     for( int i = 0; i < iterCount; i++ )
     {
-        GCGraph<double> graph;
         assignGMMsComponents( img, mask, bgdGMM, fgdGMM, compIdxs );
         learnGMMs( img, mask, compIdxs, bgdGMM, fgdGMM );
-        constructGCGraph(img, mask, bgdGMM, fgdGMM, lambda, leftW, upleftW, upW, uprightW, graph );
+        if( i == 0 )
+            constructGCGraph(img, mask, bgdGMM, fgdGMM, lambda, leftW, upleftW, upW, uprightW, termW, graph );
+        else
+            updateGCGraph(img, mask, bgdGMM, fgdGMM, lambda, termW, graph );
         estimateSegmentation( graph, mask );
     }
 }
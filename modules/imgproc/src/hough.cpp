@@ -66,6 +66,79 @@ struct hough_cmp_gt
 };
 
 
+/*
+Computes dst[k] = cvRound(a[k]*u + b[k]*v) + offset, i.e. the accumulator columns
+either of the point (u, v) for the angles with the cos/sin tables a, b,
+or of the points (a[k], b[k]) for the single angle with cos/sin u, v.
+*/
+static void
+houghRhoIndices( const float* a, const float* b, float u, float v,
+                 int count, int offset, int* dst, bool haveSSE2 )
+{
+    int k = 0;
+#if CV_SSE2
+    if( haveSSE2 )
+    {
+        __m128 v_u = _mm_set1_ps(u), v_v = _mm_set1_ps(v);
+        __m128i v_offset = _mm_set1_epi32(offset);
+        for( ; k <= count - 4; k += 4 )
+        {
+            __m128 v_r = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(a + k), v_u),
+                                    _mm_mul_ps(_mm_loadu_ps(b + k), v_v));
+            _mm_storeu_si128((__m128i*)(dst + k), _mm_add_epi32(_mm_cvtps_epi32(v_r), v_offset));
+        }
+    }
+#else
+    (void)haveSSE2;
+#endif
+    for( ; k < count; k++ )
+        dst[k] = cvRound( a[k]*u + b[k]*v ) + offset;
+}
+
+
+/*
+Fills the rows of the classical Hough accumulator for a range of angles.
+Every angle owns its accumulator row, so the angle ranges are processed
+independently and the result does not depend on the number of threads.
+*/
+class HoughLinesAccumInvoker : public ParallelLoopBody
+{
+public:
+    HoughLinesAccumInvoker( const std::vector<float>& _xs, const std::vector<float>& _ys,
+                            const float* _tabSin, const float* _tabCos, int* _accum, int _numrho )
+        : xs(_xs), ys(_ys), tabSin(_tabSin), tabCos(_tabCos), accum(_accum), numrho(_numrho)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        int k, count = (int)xs.size();
+        if( count == 0 )
+            return;
+
+        bool haveSSE2 = checkHardwareSupport(CV_CPU_SSE2);
+        AutoBuffer<int> _rbuf(count);
+        int* rbuf = _rbuf;
+
+        for( int n = range.start; n < range.end; n++ )
+        {
+            int* adata = accum + (n+1) * (numrho+2) + 1;
+            houghRhoIndices( &xs[0], &ys[0], tabCos[n], tabSin[n], count, (numrho - 1) / 2, rbuf, haveSSE2 );
+            for( k = 0; k < count; k++ )
+                adata[rbuf[k]]++;
+        }
+    }
+
+private:
+    const std::vector<float>& xs;
+    const std::vector<float>& ys;
+    const float* tabSin;
+    const float* tabCos;
+    int* accum;
+    int numrho;
+};
+
+
 /*
 Here image is an input raster;
 step is it's step; size characterizes it's ROI;
@@ -142,18 +215,21 @@ HoughLinesStandard( const Mat& img, float rho, float theta,
     }
 
     // stage 1. fill accumulator
+    std::vector<float> xs, ys;
     for( i = 0; i < height; i++ )
         for( j = 0; j < width; j++ )
         {
             if( image[i * step + j] != 0 )
-                for(int n = 0; n < numangle; n++ )
-                {
-                    int r = cvRound( j * tabCos[n] + i * tabSin[n] );
-                    r += (numrho - 1) / 2;
-                    accum[(n+1) * (numrho+2) + r+1]++;
-                }
+            {
+                xs.push_back((float)j);
+                ys.push_back((float)i);
+            }
         }
 
+    parallel_for_(Range(0, numangle),
+                  HoughLinesAccumInvoker(xs, ys, tabSin, tabCos, accum, numrho),
+                  (double)xs.size()*numangle/(1<<16));
+
     // stage 2. find local maximums
     for(int r = 0; r < numrho; r++ )
         for(int n = 0; n < numangle; n++ )
@@ -197,6 +273,152 @@ struct hough_index
 };
 
 
+/*
+Coarse accumulator of the multi-scale transform. Every stripe of the feature
+points is accumulated into its own partial accumulator (the first one is the
+output accumulator itself); the partial accumulators are summed afterwards.
+The counters wrap around modulo 256 either way, so the sum is exact.
+*/
+class HoughSDivCoarseInvoker : public ParallelLoopBody
+{
+public:
+    HoughSDivCoarseInvoker( const std::vector<int>& _x, const std::vector<int>& _y,
+                            float _rho, float _theta, int _rn, int _tn, int _nstripes,
+                            std::vector<std::vector<uchar> >& _caccums )
+        : x(_x), y(_y), rho(_rho), theta(_theta), rn(_rn), tn(_tn), nstripes(_nstripes), caccums(_caccums)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        const float d2r = (float)(CV_PI / 180);
+        float irho = 1 / rho;
+        float itheta = 1 / theta;
+        int fn = (int)x.size();
+
+        for( int s = range.start; s < range.end; s++ )
+        {
+            int fi = (int)((int64)fn * s / nstripes), fi_end = (int)((int64)fn * (s + 1) / nstripes);
+            if( s > 0 )
+                caccums[s].assign(rn * tn, (uchar)0);
+            uchar* caccum = &caccums[s][0];
+
+            for( ; fi < fi_end; fi++ )
+            {
+                int i, ti0, ti1, halftn;
+                float r, t, r0, scale_factor, rv;
+                int iprev = -1;
+                float phi, phi1;
+                float theta_it;     // Value of theta for iterating
+
+                float yc = (float) y[fi] + 0.5f;
+                float xc = (float) x[fi] + 0.5f;
+
+                /* Update the accumulator */
+                t = (float) fabs( cvFastArctan( yc, xc ) * d2r );
+                r = (float) std::sqrt( (double)xc * xc + (double)yc * yc );
+                r0 = r * irho;
+                ti0 = cvFloor( (t + CV_PI*0.5) * itheta );
+
+                caccum[ti0]++;
+
+                theta_it = rho / r;
+                theta_it = theta_it < theta ? theta_it : theta;
+                scale_factor = theta_it * itheta;
+                halftn = cvFloor( CV_PI / theta_it );
+                for( ti1 = 1, phi = theta_it - (float)(CV_PI*0.5), phi1 = (theta_it + t) * itheta;
+                     ti1 < halftn; ti1++, phi += theta_it, phi1 += scale_factor )
+                {
+                    rv = r0 * std::cos( phi );
+                    i = (int)rv * tn;
+                    i += cvFloor( phi1 );
+                    assert( i >= 0 );
+                    assert( i < rn * tn );
+                    caccum[i] = (uchar) (caccum[i] + ((i ^ iprev) != 0));
+                    iprev = i;
+                }
+            }
+        }
+    }
+
+private:
+    const std::vector<int>& x;
+    const std::vector<int>& y;
+    float rho, theta;
+    int rn, tn, nstripes;
+    std::vector<std::vector<uchar> >& caccums;
+};
+
+
+/*
+Fine accumulators of the multi-scale transform: one srn x stn accumulator
+(plus the two guard counters) per selected coarse cell, independent of each other.
+*/
+class HoughSDivFineInvoker : public ParallelLoopBody
+{
+public:
+    HoughSDivFineInvoker( const std::vector<int>& _x, const std::vector<int>& _y,
+                          const std::vector<int>& _cells, const float* _sinTable,
+                          float _srho, float _stheta, int _srn, int _stn, int _tn, uchar* _maccums )
+        : x(_x), y(_y), cells(_cells), sinTable(_sinTable), srho(_srho), stheta(_stheta),
+          srn(_srn), stn(_stn), tn(_tn), maccums(_maccums)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        const float d2r = (float)(CV_PI / 180);
+        float isrho = 1 / srho;
+        float istheta = 1 / stheta;
+        int sfn = srn * stn, fn = (int)x.size();
+
+        for( int c = range.start; c < range.end; c++ )
+        {
+            int ri = cells[c] / tn, ti = cells[c] - ri * tn;
+            uchar* mcaccum = maccums + (size_t)c * (sfn + 2) + 1;
+            memset( mcaccum - 1, 0, (sfn + 2) * sizeof( uchar ));
+
+            for( int index = 0; index < fn; index++ )
+            {
+                int i, ti0, ti1, ti2;
+                float r, t, r0, rv;
+
+                float yc = (float) y[index] + 0.5f;
+                float xc = (float) x[index] + 0.5f;
+
+                // Update the accumulator
+                t = (float) fabs( cvFastArctan( yc, xc ) * d2r );
+                r = (float) std::sqrt( (double)xc * xc + (double)yc * yc ) * isrho;
+                ti0 = cvFloor( (t + CV_PI * 0.5) * istheta );
+                ti2 = (ti * stn - ti0) * 5;
+                r0 = (float) ri *srn;
+
+                for( ti1 = 0; ti1 < stn; ti1++, ti2 += 5 )
+                {
+                    rv = r * sinTable[(int) (std::abs( ti2 ))] - r0;
+                    i = cvFloor( rv ) * stn + ti1;
+
+                    i = CV_IMAX( i, -1 );
+                    i = CV_IMIN( i, sfn );
+                    mcaccum[i]++;
+                    assert( i >= -1 );
+                    assert( i <= sfn );
+                }
+            }
+        }
+    }
+
+private:
+    const std::vector<int>& x;
+    const std::vector<int>& y;
+    const std::vector<int>& cells;
+    const float* sinTable;
+    float srho, stheta;
+    int srn, stn, tn;
+    uchar* maccums;
+};
+
+
 static void
 HoughLinesSDiv( const Mat& img,
                 float rho, float theta, int threshold,
@@ -204,23 +426,11 @@ HoughLinesSDiv( const Mat& img,
                 std::vector<Vec2f>& lines, int linesMax,
                 double min_theta, double max_theta )
 {
-    #define _POINT(row, column)\
-        (image_src[(row)*step+(column)])
-
     int index, i;
-    int ri, ti, ti1, ti0;
+    int ri, ti;
     int row, col;
-    float r, t;                 /* Current rho and theta */
-    float rv;                   /* Some temporary rho value */
-
-    int fn = 0;
-    float xc, yc;
 
-    const float d2r = (float)(CV_PI / 180);
     int sfn = srn * stn;
-    int fi;
-    int count;
-    int cmax = 0;
 
     std::vector<hough_index> lst;
 
@@ -229,8 +439,6 @@ HoughLinesSDiv( const Mat& img,
 
     threshold = MIN( threshold, 255 );
 
-    const uchar* image_src = img.ptr();
-    int step = (int)img.step;
     int w = img.cols;
     int h = img.rows;
 
@@ -238,8 +446,6 @@ HoughLinesSDiv( const Mat& img,
     float itheta = 1 / theta;
     float srho = rho / srn;
     float stheta = theta / stn;
-    float isrho = 1 / srho;
-    float istheta = 1 / stheta;
 
     int rn = cvFloor( std::sqrt( (double)w * w + (double)h * h ) * irho );
     int tn = cvFloor( 2 * CV_PI * itheta );
@@ -253,150 +459,87 @@ HoughLinesSDiv( const Mat& img,
     for( index = 0; index < 5 * tn * stn; index++ )
         sinTable[index] = (float)cos( stheta * index * 0.2f );
 
-    std::vector<uchar> _caccum(rn * tn, (uchar)0);
-    uchar* caccum = &_caccum[0];
-
-    // Counting all feature pixels
-    for( row = 0; row < h; row++ )
-        for( col = 0; col < w; col++ )
-            fn += _POINT( row, col ) != 0;
-
-    std::vector<int> _x(fn), _y(fn);
-    int* x = &_x[0], *y = &_y[0];
-
-    // Full Hough Transform (it's accumulator update part)
-    fi = 0;
+    // Remember all the feature points
+    std::vector<int> x, y;
     for( row = 0; row < h; row++ )
     {
+        const uchar* image_src = img.ptr(row);
         for( col = 0; col < w; col++ )
         {
-            if( _POINT( row, col ))
+            if( image_src[col] )
             {
-                int halftn;
-                float r0;
-                float scale_factor;
-                int iprev = -1;
-                float phi, phi1;
-                float theta_it;     // Value of theta for iterating
-
-                // Remember the feature point
-                x[fi] = col;
-                y[fi] = row;
-                fi++;
-
-                yc = (float) row + 0.5f;
-                xc = (float) col + 0.5f;
+                x.push_back(col);
+                y.push_back(row);
+            }
+        }
+    }
 
-                /* Update the accumulator */
-                t = (float) fabs( cvFastArctan( yc, xc ) * d2r );
-                r = (float) std::sqrt( (double)xc * xc + (double)yc * yc );
-                r0 = r * irho;
-                ti0 = cvFloor( (t + CV_PI*0.5) * itheta );
+    // Full Hough Transform (it's accumulator update part)
+    int fn = (int)x.size();
+    int nstripes = std::max(std::min(getNumThreads(), fn / 1024), 1);
+    std::vector<std::vector<uchar> > caccums(nstripes);
+    caccums[0].assign(rn * tn, (uchar)0);
 
-                caccum[ti0]++;
+    parallel_for_(Range(0, nstripes),
+                  HoughSDivCoarseInvoker(x, y, rho, theta, rn, tn, nstripes, caccums),
+                  nstripes);
 
-                theta_it = rho / r;
-                theta_it = theta_it < theta ? theta_it : theta;
-                scale_factor = theta_it * itheta;
-                halftn = cvFloor( CV_PI / theta_it );
-                for( ti1 = 1, phi = theta_it - (float)(CV_PI*0.5), phi1 = (theta_it + t) * itheta;
-                     ti1 < halftn; ti1++, phi += theta_it, phi1 += scale_factor )
-                {
-                    rv = r0 * std::cos( phi );
-                    i = (int)rv * tn;
-                    i += cvFloor( phi1 );
-                    assert( i >= 0 );
-                    assert( i < rn * tn );
-                    caccum[i] = (uchar) (caccum[i] + ((i ^ iprev) != 0));
-                    iprev = i;
-                    if( cmax < caccum[i] )
-                        cmax = caccum[i];
-                }
-            }
-        }
+    uchar* caccum = &caccums[0][0];
+    for( int s = 1; s < nstripes; s++ )
+    {
+        const uchar* partial = &caccums[s][0];
+        for( i = 0; i < rn * tn; i++ )
+            caccum[i] = (uchar)(caccum[i] + partial[i]);
     }
 
     // Starting additional analysis
-    count = 0;
+    std::vector<int> cells;
     for( ri = 0; ri < rn; ri++ )
     {
         for( ti = 0; ti < tn; ti++ )
         {
             if( caccum[ri * tn + ti] > threshold )
-                count++;
+                cells.push_back(ri * tn + ti);
         }
     }
 
+    int count = (int)cells.size();
     if( count * 100 > rn * tn )
     {
         HoughLinesStandard( img, rho, theta, threshold, lines, linesMax, min_theta, max_theta );
         return;
     }
 
-    std::vector<uchar> _buffer(srn * stn + 2);
-    uchar* buffer = &_buffer[0];
-    uchar* mcaccum = buffer + 1;
+    std::vector<uchar> _maccums((size_t)count * (sfn + 2) + 1);
+    parallel_for_(Range(0, count),
+                  HoughSDivFineInvoker(x, y, cells, sinTable, srho, stheta, srn, stn, tn, &_maccums[0]),
+                  (double)count * fn * stn / (1 << 16));
 
-    count = 0;
-    for( ri = 0; ri < rn; ri++ )
+    for( int c = 0; c < count; c++ )
     {
-        for( ti = 0; ti < tn; ti++ )
+        ri = cells[c] / tn;
+        ti = cells[c] - ri * tn;
+        const uchar* mcaccum = &_maccums[(size_t)c * (sfn + 2) + 1];
+
+        // Find peaks in maccum...
+        for( index = 0; index < sfn; index++ )
         {
-            if( caccum[ri * tn + ti] > threshold )
+            int pos = (int)(lst.size() - 1);
+            if( pos < 0 || lst[pos].value < mcaccum[index] )
             {
-                count++;
-                memset( mcaccum, 0, sfn * sizeof( uchar ));
-
-                for( index = 0; index < fn; index++ )
-                {
-                    int ti2;
-                    float r0;
-
-                    yc = (float) y[index] + 0.5f;
-                    xc = (float) x[index] + 0.5f;
-
-                    // Update the accumulator
-                    t = (float) fabs( cvFastArctan( yc, xc ) * d2r );
-                    r = (float) std::sqrt( (double)xc * xc + (double)yc * yc ) * isrho;
-                    ti0 = cvFloor( (t + CV_PI * 0.5) * istheta );
-                    ti2 = (ti * stn - ti0) * 5;
-                    r0 = (float) ri *srn;
-
-                    for( ti1 = 0; ti1 < stn; ti1++, ti2 += 5 )
-                    {
-                        rv = r * sinTable[(int) (std::abs( ti2 ))] - r0;
-                        i = cvFloor( rv ) * stn + ti1;
-
-                        i = CV_IMAX( i, -1 );
-                        i = CV_IMIN( i, sfn );
-                        mcaccum[i]++;
-                        assert( i >= -1 );
-                        assert( i <= sfn );
-                    }
-                }
-
-                // Find peaks in maccum...
-                for( index = 0; index < sfn; index++ )
+                hough_index vi(mcaccum[index],
+                               index / stn * srho + ri * rho,
+                               index % stn * stheta + ti * theta - (float)(CV_PI*0.5));
+                lst.push_back(vi);
+                for( ; pos >= 0; pos-- )
                 {
-                    i = 0;
-                    int pos = (int)(lst.size() - 1);
-                    if( pos < 0 || lst[pos].value < mcaccum[index] )
-                    {
-                        hough_index vi(mcaccum[index],
-                                       index / stn * srho + ri * rho,
-                                       index % stn * stheta + ti * theta - (float)(CV_PI*0.5));
-                        lst.push_back(vi);
-                        for( ; pos >= 0; pos-- )
-                        {
-                            if( lst[pos].value > vi.value )
-                                break;
-                            lst[pos+1] = lst[pos];
-                        }
-                        lst[pos+1] = vi;
-                        if( (int)lst.size() > linesMax )
-                            lst.pop_back();
-                    }
+                    if( lst[pos].value > vi.value )
+                        break;
+                    lst[pos+1] = lst[pos];
                 }
+                lst[pos+1] = vi;
+                if( (int)lst.size() > linesMax )
+                    lst.pop_back();
             }
         }
     }
@@ -414,6 +557,53 @@ HoughLinesSDiv( const Mat& img,
 *                              Probabilistic Hough Transform                             *
 \****************************************************************************************/
 
+/*
+Candidate phase of the probabilistic transform: marks the non-zero pixels in the mask
+and collects them per stripe of rows, so that the concatenated list keeps the raster order.
+*/
+class HoughLinesPCandidatesInvoker : public ParallelLoopBody
+{
+public:
+    HoughLinesPCandidatesInvoker( const Mat& _image, Mat& _mask, int _nstripes,
+                                  std::vector<std::vector<Point> >& _nzlocs )
+        : image(_image), mask(_mask), nstripes(_nstripes), nzlocs(_nzlocs)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        Point pt;
+        int width = image.cols, height = image.rows;
+
+        for( int s = range.start; s < range.end; s++ )
+        {
+            std::vector<Point>& nzloc = nzlocs[s];
+            int y_end = height * (s + 1) / nstripes;
+            for( pt.y = height * s / nstripes; pt.y < y_end; pt.y++ )
+            {
+                const uchar* data = image.ptr(pt.y);
+                uchar* mdata = mask.ptr(pt.y);
+                for( pt.x = 0; pt.x < width; pt.x++ )
+                {
+                    if( data[pt.x] )
+                    {
+                        mdata[pt.x] = (uchar)1;
+                        nzloc.push_back(pt);
+                    }
+                    else
+                        mdata[pt.x] = 0;
+                }
+            }
+        }
+    }
+
+private:
+    const Mat& image;
+    Mat& mask;
+    int nstripes;
+    std::vector<std::vector<Point> >& nzlocs;
+};
+
 static void
 HoughLinesProbabilistic( Mat& image,
                          float rho, float theta, int threshold,
@@ -467,29 +657,28 @@ HoughLinesProbabilistic( Mat& image,
 
     for( int n = 0; n < numangle; n++ )
     {
-        trigtab[n*2] = (float)(cos((double)n*theta) * irho);
-        trigtab[n*2+1] = (float)(sin((double)n*theta) * irho);
+        trigtab[n] = (float)(cos((double)n*theta) * irho);
+        trigtab[numangle + n] = (float)(sin((double)n*theta) * irho);
     }
-    const float* ttab = &trigtab[0];
+    const float* tabCos = &trigtab[0];
+    const float* tabSin = tabCos + numangle;
     uchar* mdata0 = mask.ptr();
     std::vector<Point> nzloc;
+    AutoBuffer<int> _rbuf(numangle);
+    int* rbuf = _rbuf;
+    bool haveSSE2 = checkHardwareSupport(CV_CPU_SSE2);
 
     // stage 1. collect non-zero image points
-    for( pt.y = 0; pt.y < height; pt.y++ )
-    {
-        const uchar* data = image.ptr(pt.y);
-        uchar* mdata = mask.ptr(pt.y);
-        for( pt.x = 0; pt.x < width; pt.x++ )
-        {
-            if( data[pt.x] )
-            {
-                mdata[pt.x] = (uchar)1;
-                nzloc.push_back(pt);
-            }
-            else
-                mdata[pt.x] = 0;
-        }
-    }
+    int nstripes = std::max(std::min(getNumThreads(), height / 64), 1);
+    std::vector<std::vector<Point> > nzlocs(nstripes);
+    parallel_for_(Range(0, nstripes), HoughLinesPCandidatesInvoker(image, mask, nstripes, nzlocs), nstripes);
+
+    size_t total = 0;
+    for( int s = 0; s < nstripes; s++ )
+        total += nzlocs[s].size();
+    nzloc.reserve(total);
+    for( int s = 0; s < nstripes; s++ )
+        nzloc.insert(nzloc.end(), nzlocs[s].begin(), nzlocs[s].end());
 
     int count = (int)nzloc.size();
 
@@ -515,11 +704,10 @@ HoughLinesProbabilistic( Mat& image,
             continue;
 
         // update accumulator, find the most probable line
+        houghRhoIndices( tabCos, tabSin, (float)j, (float)i, numangle, (numrho - 1) / 2, rbuf, haveSSE2 );
         for( int n = 0; n < numangle; n++, adata += numrho )
         {
-            int r = cvRound( j * ttab[n*2] + i * ttab[n*2+1] );
-            r += (numrho - 1) / 2;
-            int val = ++adata[r];
+            int val = ++adata[rbuf[n]];
             if( max_val < val )
             {
                 max_val = val;
@@ -533,8 +721,8 @@ HoughLinesProbabilistic( Mat& image,
 
         // from the current point walk in each direction
         // along the found line and extract the line segment
-        a = -ttab[max_n*2+1];
-        b = ttab[max_n*2];
+        a = -tabSin[max_n];
+        b = tabCos[max_n];
         x0 = j;
         y0 = i;
         if( fabs(a) > fabs(b) )
@@ -636,12 +824,9 @@ HoughLinesProbabilistic( Mat& image,
                     if( good_line )
                     {
                         adata = accum.ptr<int>();
+                        houghRhoIndices( tabCos, tabSin, (float)j1, (float)i1, numangle, (numrho - 1) / 2, rbuf, haveSSE2 );
                         for( int n = 0; n < numangle; n++, adata += numrho )
-                        {
-                            int r = cvRound( j1 * ttab[n*2] + i1 * ttab[n*2+1] );
-                            r += (numrho - 1) / 2;
-                            adata[r]--;
-                        }
+                            adata[rbuf[n]]--;
                     }
                     *mdata = 0;
                 }
@@ -1001,13 +1186,106 @@ cvHoughLines2( CvArr* src_image, void* lineStorage, int method,
 *                                     Circle Detection                                   *
 \****************************************************************************************/
 
+namespace cv
+{
+
+/*
+Accumulates the circle center evidence of the edge pixels. Every stripe of rows
+gets its own partial accumulator (the first one is the output accumulator itself)
+and its own list of the edge pixels; both are merged in the stripe order afterwards.
+*/
+class HoughCirclesAccumInvoker : public ParallelLoopBody
+{
+public:
+    HoughCirclesAccumInvoker( const Mat& _edges, const Mat& _dx, const Mat& _dy, float _idp,
+                              int _min_radius, int _max_radius, int _nstripes,
+                              std::vector<Mat>& _accums, std::vector<std::vector<Point> >& _nzs )
+        : edges(_edges), dx(_dx), dy(_dy), idp(_idp), min_radius(_min_radius), max_radius(_max_radius),
+          nstripes(_nstripes), accums(_accums), nzs(_nzs)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        const int SHIFT = 10, ONE = 1 << SHIFT;
+        int rows = edges.rows, cols = edges.cols;
+
+        for( int s = range.start; s < range.end; s++ )
+        {
+            if( s > 0 )
+                accums[s] = Mat::zeros(accums[0].size(), CV_32SC1);
+            int arows = accums[s].rows - 2, acols = accums[s].cols - 2;
+            int astep = (int)(accums[s].step/sizeof(int));
+            int* adata = accums[s].ptr<int>();
+            std::vector<Point>& nz = nzs[s];
+            int y_end = rows * (s + 1) / nstripes;
+
+            for( int y = rows * s / nstripes; y < y_end; y++ )
+            {
+                const uchar* edges_row = edges.ptr(y);
+                const short* dx_row = dx.ptr<short>(y);
+                const short* dy_row = dy.ptr<short>(y);
+
+                for( int x = 0; x < cols; x++ )
+                {
+                    float vx, vy;
+                    int sx, sy, x0, y0, x1, y1, r;
+
+                    vx = dx_row[x];
+                    vy = dy_row[x];
+
+                    if( !edges_row[x] || (vx == 0 && vy == 0) )
+                        continue;
+
+                    float mag = std::sqrt(vx*vx+vy*vy);
+                    assert( mag >= 1 );
+                    sx = cvRound((vx*idp)*ONE/mag);
+                    sy = cvRound((vy*idp)*ONE/mag);
+
+                    x0 = cvRound((x*idp)*ONE);
+                    y0 = cvRound((y*idp)*ONE);
+                    // Step from min_radius to max_radius in both directions of the gradient
+                    for(int k1 = 0; k1 < 2; k1++ )
+                    {
+                        x1 = x0 + min_radius * sx;
+                        y1 = y0 + min_radius * sy;
+
+                        for( r = min_radius; r <= max_radius; x1 += sx, y1 += sy, r++ )
+                        {
+                            int x2 = x1 >> SHIFT, y2 = y1 >> SHIFT;
+                            if( (unsigned)x2 >= (unsigned)acols ||
+                                (unsigned)y2 >= (unsigned)arows )
+                                break;
+                            adata[y2*astep + x2]++;
+                        }
+
+                        sx = -sx; sy = -sy;
+                    }
+
+                    nz.push_back(Point(x, y));
+                }
+            }
+        }
+    }
+
+private:
+    const Mat& edges;
+    const Mat& dx;
+    const Mat& dy;
+    float idp;
+    int min_radius, max_radius, nstripes;
+    std::vector<Mat>& accums;
+    std::vector<std::vector<Point> >& nzs;
+};
+
+}
+
 static void
 icvHoughCirclesGradient( CvMat* img, float dp, float min_dist,
                          int min_radius, int max_radius,
                          int canny_threshold, int acc_threshold,
                          CvSeq* circles, int circles_max )
 {
-    const int SHIFT = 10, ONE = 1 << SHIFT;
     cv::Ptr<CvMat> dx, dy;
     cv::Ptr<CvMat> edges, accum, dist_buf;
     std::vector<int> sort_buf;
@@ -1016,8 +1294,8 @@ icvHoughCirclesGradient( CvMat* img, float dp, float min_dist,
     int x, y, i, j, k, center_count, nz_count;
     float min_radius2 = (float)min_radius*min_radius;
     float max_radius2 = (float)max_radius*max_radius;
-    int rows, cols, arows, acols;
-    int astep, *adata;
+    int rows, arows, acols;
+    int *adata;
     float* ddata;
     CvSeq *nz, *centers;
     float idp, dr;
@@ -1048,58 +1326,27 @@ icvHoughCirclesGradient( CvMat* img, float dp, float min_dist,
     centers = cvCreateSeq( CV_32SC1, sizeof(CvSeq), sizeof(int), storage );
 
     rows = img->rows;
-    cols = img->cols;
     arows = accum->rows - 2;
     acols = accum->cols - 2;
     adata = accum->data.i;
-    astep = accum->step/sizeof(adata[0]);
+
     // Accumulate circle evidence for each edge pixel
-    for( y = 0; y < rows; y++ )
+    int nstripes = MAX(MIN(cv::getNumThreads(), rows / 32), 1);
+    std::vector<cv::Mat> accums(nstripes);
+    std::vector<std::vector<cv::Point> > nzs(nstripes);
+    cv::Mat edgesMat = cv::cvarrToMat(edges), dxMat = cv::cvarrToMat(dx), dyMat = cv::cvarrToMat(dy);
+    accums[0] = cv::cvarrToMat(accum);
+    cv::parallel_for_(cv::Range(0, nstripes),
+                      cv::HoughCirclesAccumInvoker(edgesMat, dxMat, dyMat, idp, min_radius, max_radius,
+                                                   nstripes, accums, nzs),
+                      nstripes);
+
+    for( i = 0; i < nstripes; i++ )
     {
-        const uchar* edges_row = edges->data.ptr + y*edges->step;
-        const short* dx_row = (const short*)(dx->data.ptr + y*dx->step);
-        const short* dy_row = (const short*)(dy->data.ptr + y*dy->step);
-
-        for( x = 0; x < cols; x++ )
-        {
-            float vx, vy;
-            int sx, sy, x0, y0, x1, y1, r;
-            CvPoint pt;
-
-            vx = dx_row[x];
-            vy = dy_row[x];
-
-            if( !edges_row[x] || (vx == 0 && vy == 0) )
-                continue;
-
-            float mag = std::sqrt(vx*vx+vy*vy);
-            assert( mag >= 1 );
-            sx = cvRound((vx*idp)*ONE/mag);
-            sy = cvRound((vy*idp)*ONE/mag);
-
-            x0 = cvRound((x*idp)*ONE);
-            y0 = cvRound((y*idp)*ONE);
-            // Step from min_radius to max_radius in both directions of the gradient
-            for(int k1 = 0; k1 < 2; k1++ )
-            {
-                x1 = x0 + min_radius * sx;
-                y1 = y0 + min_radius * sy;
-
-                for( r = min_radius; r <= max_radius; x1 += sx, y1 += sy, r++ )
-                {
-                    int x2 = x1 >> SHIFT, y2 = y1 >> SHIFT;
-                    if( (unsigned)x2 >= (unsigned)acols ||
-                        (unsigned)y2 >= (unsigned)arows )
-                        break;
-                    adata[y2*astep + x2]++;
-                }
-
-                sx = -sx; sy = -sy;
-            }
-
-            pt.x = x; pt.y = y;
-            cvSeqPush( nz, &pt );
-        }
+        if( i > 0 )
+            cv::add(accums[0], accums[i], accums[0]);
+        if( !nzs[i].empty() )
+            cvSeqPushMulti( nz, &nzs[i][0], (int)nzs[i].size() );
     }
 
     nz_count = nz->total;
@@ -440,6 +440,105 @@ static void momentsInTile( const Mat& img, double* moments )
 
 typedef void (*MomentsInTileFunc)(const Mat& img, double* moments);
 
+// adds the moments mom[] of a tile with the top-left corner at (x, y) to m[]
+static void accumulateTileMoments( double* m, const double* mom, int x, int y )
+{
+    double xm = x * mom[0], ym = y * mom[0];
+
+    // + m00 ( = m00' )
+    m[0] += mom[0];
+
+    // + m10 ( = m10' + x*m00' )
+    m[1] += mom[1] + xm;
+
+    // + m01 ( = m01' + y*m00' )
+    m[2] += mom[2] + ym;
+
+    // + m20 ( = m20' + 2*x*m10' + x*x*m00' )
+    m[3] += mom[3] + x * (mom[1] * 2 + xm);
+
+    // + m11 ( = m11' + x*m01' + y*m10' + x*y*m00' )
+    m[4] += mom[4] + x * (mom[2] + ym) + y * mom[1];
+
+    // + m02 ( = m02' + 2*y*m01' + y*y*m00' )
+    m[5] += mom[5] + y * (mom[2] * 2 + ym);
+
+    // + m30 ( = m30' + 3*x*m20' + 3*x*x*m10' + x*x*x*m00' )
+    m[6] += mom[6] + x * (3. * mom[3] + x * (3. * mom[1] + xm));
+
+    // + m21 ( = m21' + x*(2*m11' + 2*y*m10' + x*m01' + x*y*m00') + y*m20')
+    m[7] += mom[7] + x * (2 * (mom[4] + y * mom[1]) + x * (mom[2] + ym)) + y * mom[3];
+
+    // + m12 ( = m12' + y*(2*m11' + 2*x*m01' + y*m10' + x*y*m00') + x*m02')
+    m[8] += mom[8] + y * (2 * (mom[4] + x * mom[2]) + y * (mom[1] + xm)) + x * mom[5];
+
+    // + m03 ( = m03' + 3*y*m02' + 3*y*y*m01' + y*y*y*m00' )
+    m[9] += mom[9] + y * (3. * mom[5] + y * (3. * mom[2] + ym));
+}
+
+/*
+ Computes the raw moments of the rows of tiles [range.start, range.end). The moments of every
+ row of tiles are stored separately and summed up afterwards in the fixed order, so the result
+ does not depend on the number of threads.
+*/
+class MomentsInvoker : public ParallelLoopBody
+{
+public:
+    enum { TILE_SIZE = 32 };
+
+    MomentsInvoker( const Mat& _src, MomentsInTileFunc _func, bool _binary, double* _stripMoments )
+        : src(&_src), func(_func), binary(_binary), stripMoments(_stripMoments) {}
+
+    void operator()( const Range& range ) const
+    {
+        uchar nzbuf[TILE_SIZE*TILE_SIZE];
+        Size size = src->size();
+
+        for( int i = range.start; i < range.end; i++ )
+        {
+            int y = i*TILE_SIZE;
+            double* m = stripMoments + i*10;
+            Size tileSize;
+            tileSize.height = std::min((int)TILE_SIZE, size.height - y);
+
+            for( int k = 0; k < 10; k++ )
+                m[k] = 0;
+
+            for( int x = 0; x < size.width; x += TILE_SIZE )
+            {
+                tileSize.width = std::min((int)TILE_SIZE, size.width - x);
+                Mat tile(*src, cv::Rect(x, y, tileSize.width, tileSize.height));
+
+                if( binary )
+                {
+                    cv::Mat tmp(tileSize, CV_8U, nzbuf);
+                    cv::compare( tile, 0, tmp, CV_CMP_NE );
+                    tile = tmp;
+                }
+
+                double mom[10];
+                func( tile, mom );
+
+                if(binary)
+                {
+                    double s = 1./255;
+                    for( int k = 0; k < 10; k++ )
+                        mom[k] *= s;
+                }
+
+                // accumulate moments computed in each tile
+                accumulateTileMoments( m, mom, x, 0 );
+            }
+        }
+    }
+
+private:
+    const Mat* src;
+    MomentsInTileFunc func;
+    bool binary;
+    double* stripMoments;
+};
+
 Moments::Moments()
 {
     m00 = m10 = m01 = m20 = m11 = m02 = m30 = m21 = m12 = m03 =
@@ -555,9 +654,8 @@ static bool ocl_moments( InputArray _src, Moments& m, bool binary)
 
 cv::Moments cv::moments( InputArray _src, bool binary )
 {
-    const int TILE_SIZE = 32;
+    const int TILE_SIZE = MomentsInvoker::TILE_SIZE;
     MomentsInTileFunc func = 0;
-    uchar nzbuf[TILE_SIZE*TILE_SIZE];
     Moments m;
     int type = _src.type(), depth = CV_MAT_DEPTH(type), cn = CV_MAT_CN(type);
     Size size = _src.size();
@@ -656,74 +754,139 @@ cv::Moments cv::moments( InputArray _src, bool binary )
         else
             CV_Error( CV_StsUnsupportedFormat, "" );
 
-        Mat src0(mat);
-
-        for( int y = 0; y < size.height; y += TILE_SIZE )
-        {
-            Size tileSize;
-            tileSize.height = std::min(TILE_SIZE, size.height - y);
-
-            for( int x = 0; x < size.width; x += TILE_SIZE )
-            {
-                tileSize.width = std::min(TILE_SIZE, size.width - x);
-                Mat src(src0, cv::Rect(x, y, tileSize.width, tileSize.height));
+        // the rows of tiles are processed in parallel, their moments are summed up in order
+        int nstrips = (size.height + TILE_SIZE - 1)/TILE_SIZE;
+        AutoBuffer<double> _stripMoments(nstrips*10);
+        double* stripMoments = _stripMoments;
+        parallel_for_(Range(0, nstrips), MomentsInvoker(mat, func, binary, stripMoments),
+                      (double)mat.total()/(1 << 16));
 
-                if( binary )
-                {
-                    cv::Mat tmp(tileSize, CV_8U, nzbuf);
-                    cv::compare( src, 0, tmp, CV_CMP_NE );
-                    src = tmp;
-                }
+        double mom[10] = {0,0,0,0,0,0,0,0,0,0};
+        for( int i = 0; i < nstrips; i++ )
+            accumulateTileMoments( mom, stripMoments + i*10, 0, i*TILE_SIZE );
 
-                double mom[10];
-                func( src, mom );
+        m.m00 = mom[0]; m.m10 = mom[1]; m.m01 = mom[2];
+        m.m20 = mom[3]; m.m11 = mom[4]; m.m02 = mom[5];
+        m.m30 = mom[6]; m.m21 = mom[7]; m.m12 = mom[8]; m.m03 = mom[9];
+    }
 
-                if(binary)
-                {
-                    double s = 1./255;
-                    for( int k = 0; k < 10; k++ )
-                        mom[k] *= s;
-                }
+    completeMomentState( &m );
+    return m;
+}
 
-                double xm = x * mom[0], ym = y * mom[0];
 
-                // accumulate moments computed in each tile
+namespace cv
+{
 
-                // + m00 ( = m00' )
-                m.m00 += mom[0];
+/*
+ Accumulates the raw moments of the labeled regions within bands of rows. Every band has its own
+ table of the moments, the tables are summed up afterwards in the band order. The pixels of a
+ run of equal labels are accounted at once, using the closed-form sums of x^k over the run.
+*/
+template<typename LT> class LabelMomentsInvoker : public ParallelLoopBody
+{
+public:
+    LabelMomentsInvoker( const Mat& _labels, int _nlabels, int _nbands, double* _bandMoments )
+        : labels(&_labels), nlabels(_nlabels), nbands(_nbands), bandMoments(_bandMoments) {}
 
-                // + m10 ( = m10' + x*m00' )
-                m.m10 += mom[1] + xm;
+    void operator()( const Range& range ) const
+    {
+        int width = labels->cols;
 
-                // + m01 ( = m01' + y*m00' )
-                m.m01 += mom[2] + ym;
+        for( int band = range.start; band < range.end; band++ )
+        {
+            int y0 = (int)((int64)band*labels->rows/nbands);
+            int y1 = (int)((int64)(band + 1)*labels->rows/nbands);
+            double* mom = bandMoments + (size_t)band*nlabels*10;
+            memset( mom, 0, sizeof(mom[0])*nlabels*10 );
 
-                // + m20 ( = m20' + 2*x*m10' + x*x*m00' )
-                m.m20 += mom[3] + x * (mom[1] * 2 + xm);
+            for( int y = y0; y < y1; y++ )
+            {
+                const LT* row = labels->ptr<LT>(y);
+                double fy = y, fyy = fy*y;
 
-                // + m11 ( = m11' + x*m01' + y*m10' + x*y*m00' )
-                m.m11 += mom[4] + x * (mom[2] + ym) + y * mom[1];
+                for( int x = 0; x < width; )
+                {
+                    int x0 = x;
+                    LT l = row[x];
+                    while( ++x < width && row[x] == l )
+                        ;
+                    if( (unsigned)l >= (unsigned)nlabels )
+                        continue;
+
+                    // sums of 1, x, x^2 and x^3 over [x0, x)
+                    int64 a = x0, b = x;
+                    double s0 = (double)(b - a);
+                    double s1 = (double)((b*(b - 1) - a*(a - 1))/2);
+                    double s2 = (double)(((b - 1)*b*(2*b - 1) - (a - 1)*a*(2*a - 1))/6);
+                    double s3 = (double)((b*(b - 1)/2)*(b*(b - 1)/2) - (a*(a - 1)/2)*(a*(a - 1)/2));
+
+                    double* m = mom + (size_t)l*10;
+                    m[0] += s0;          // m00
+                    m[1] += s1;          // m10
+                    m[2] += fy*s0;       // m01
+                    m[3] += s2;          // m20
+                    m[4] += fy*s1;       // m11
+                    m[5] += fyy*s0;      // m02
+                    m[6] += s3;          // m30
+                    m[7] += fy*s2;       // m21
+                    m[8] += fyy*s1;      // m12
+                    m[9] += fyy*fy*s0;   // m03
+                }
+            }
+        }
+    }
 
-                // + m02 ( = m02' + 2*y*m01' + y*y*m00' )
-                m.m02 += mom[5] + y * (mom[2] * 2 + ym);
+private:
+    const Mat* labels;
+    int nlabels, nbands;
+    double* bandMoments;
+};
 
-                // + m30 ( = m30' + 3*x*m20' + 3*x*x*m10' + x*x*x*m00' )
-                m.m30 += mom[6] + x * (3. * mom[3] + x * (3. * mom[1] + xm));
+}
 
-                // + m21 ( = m21' + x*(2*m11' + 2*y*m10' + x*m01' + x*y*m00') + y*m20')
-                m.m21 += mom[7] + x * (2 * (mom[4] + y * mom[1]) + x * (mom[2] + ym)) + y * mom[3];
+void cv::labelMoments( InputArray _labels, std::vector<Moments>& mv, int nlabels )
+{
+    Mat labels = _labels.getMat();
+    int type = labels.type();
+    CV_Assert( labels.dims == 2 && (type == CV_32SC1 || type == CV_16UC1 || type == CV_8UC1) );
 
-                // + m12 ( = m12' + y*(2*m11' + 2*x*m01' + y*m10' + x*y*m00') + x*m02')
-                m.m12 += mom[8] + y * (2 * (mom[4] + x * mom[2]) + y * (mom[1] + xm)) + x * mom[5];
+    if( nlabels <= 0 )
+    {
+        double maxVal = -1;
+        if( !labels.empty() )
+            minMaxIdx( labels, 0, &maxVal );
+        nlabels = (int)maxVal + 1;
+    }
+    mv.assign( std::max(nlabels, 0), Moments() );
+    if( nlabels <= 0 || labels.empty() )
+        return;
+
+    // the number of bands does not depend on the number of threads, so neither does the result;
+    // the tables of the moments of all the bands should not take too much memory
+    int maxBands = (int)std::min((int64)16, ((int64)1 << 24)/((int64)nlabels*10*(int64)sizeof(double)));
+    int nbands = std::max(std::min(labels.rows/64, maxBands), 1);
+    AutoBuffer<double> _bandMoments((size_t)nbands*nlabels*10);
+    double* bandMoments = _bandMoments;
+
+    if( type == CV_32SC1 )
+        parallel_for_(Range(0, nbands), LabelMomentsInvoker<int>(labels, nlabels, nbands, bandMoments), nbands);
+    else if( type == CV_16UC1 )
+        parallel_for_(Range(0, nbands), LabelMomentsInvoker<ushort>(labels, nlabels, nbands, bandMoments), nbands);
+    else
+        parallel_for_(Range(0, nbands), LabelMomentsInvoker<uchar>(labels, nlabels, nbands, bandMoments), nbands);
 
-                // + m03 ( = m03' + 3*y*m02' + 3*y*y*m01' + y*y*y*m00' )
-                m.m03 += mom[9] + y * (3. * mom[5] + y * (3. * mom[2] + ym));
-            }
+    for( int l = 0; l < nlabels; l++ )
+    {
+        double m[10] = {0,0,0,0,0,0,0,0,0,0};
+        for( int band = 0; band < nbands; band++ )
+        {
+            const double* bm = bandMoments + ((size_t)band*nlabels + l)*10;
+            for( int k = 0; k < 10; k++ )
+                m[k] += bm[k];
         }
+        mv[l] = Moments(m[0], m[1], m[2], m[3], m[4], m[5], m[6], m[7], m[8], m[9]);
     }
-
-    completeMomentState( &m );
-    return m;
 }
 
 
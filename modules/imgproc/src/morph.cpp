@@ -92,6 +92,11 @@ struct MorphNoVec
     int operator()(uchar**, int, uchar*, int) const { return 0; }
 };
 
+struct MorphBinaryNoVec
+{
+    int operator()(const uchar*, const uchar*, uchar*, int) const { return 0; }
+};
+
 #if CV_SSE2
 
 template<class VecUpdate> struct MorphRowIVec
@@ -518,6 +523,51 @@ template<class VecUpdate> struct MorphFVec
     }
 };
 
+template<class VecUpdate> struct MorphBinaryIVec
+{
+    enum { ESZ = VecUpdate::ESZ };
+
+    int operator()(const uchar* src1, const uchar* src2, uchar* dst, int width) const
+    {
+        if( !checkHardwareSupport(CV_CPU_SSE2) )
+            return 0;
+
+        int i;
+        width *= ESZ;
+        VecUpdate updateOp;
+
+        for( i = 0; i <= width - 16; i += 16 )
+        {
+            __m128i s = _mm_loadu_si128((const __m128i*)(src1 + i));
+            __m128i x = _mm_loadu_si128((const __m128i*)(src2 + i));
+            _mm_storeu_si128((__m128i*)(dst + i), updateOp(s, x));
+        }
+
+        return i/ESZ;
+    }
+};
+
+
+template<class VecUpdate> struct MorphBinaryFVec
+{
+    int operator()(const uchar* _src1, const uchar* _src2, uchar* _dst, int width) const
+    {
+        if( !checkHardwareSupport(CV_CPU_SSE) )
+            return 0;
+
+        const float* src1 = (const float*)_src1;
+        const float* src2 = (const float*)_src2;
+        float* dst = (float*)_dst;
+        int i;
+        VecUpdate updateOp;
+
+        for( i = 0; i <= width - 4; i += 4 )
+            _mm_storeu_ps(dst + i, updateOp(_mm_loadu_ps(src1 + i), _mm_loadu_ps(src2 + i)));
+
+        return i;
+    }
+};
+
 struct VMin8u
 {
     enum { ESZ = 1 };
@@ -582,6 +632,15 @@ typedef MorphIVec<VMax16s> DilateVec16s;
 typedef MorphFVec<VMin32f> ErodeVec32f;
 typedef MorphFVec<VMax32f> DilateVec32f;
 
+typedef MorphBinaryIVec<VMin8u> ErodeBinaryVec8u;
+typedef MorphBinaryIVec<VMax8u> DilateBinaryVec8u;
+typedef MorphBinaryIVec<VMin16u> ErodeBinaryVec16u;
+typedef MorphBinaryIVec<VMax16u> DilateBinaryVec16u;
+typedef MorphBinaryIVec<VMin16s> ErodeBinaryVec16s;
+typedef MorphBinaryIVec<VMax16s> DilateBinaryVec16s;
+typedef MorphBinaryFVec<VMin32f> ErodeBinaryVec32f;
+typedef MorphBinaryFVec<VMax32f> DilateBinaryVec32f;
+
 #else
 
 #ifdef HAVE_TEGRA_OPTIMIZATION
@@ -621,6 +680,15 @@ typedef MorphNoVec DilateVec16s;
 typedef MorphNoVec ErodeVec32f;
 typedef MorphNoVec DilateVec32f;
 
+typedef MorphBinaryNoVec ErodeBinaryVec8u;
+typedef MorphBinaryNoVec DilateBinaryVec8u;
+typedef MorphBinaryNoVec ErodeBinaryVec16u;
+typedef MorphBinaryNoVec DilateBinaryVec16u;
+typedef MorphBinaryNoVec ErodeBinaryVec16s;
+typedef MorphBinaryNoVec DilateBinaryVec16s;
+typedef MorphBinaryNoVec ErodeBinaryVec32f;
+typedef MorphBinaryNoVec DilateBinaryVec32f;
+
 #endif
 
 typedef MorphRowNoVec ErodeRowVec64f;
@@ -629,6 +697,8 @@ typedef MorphColumnNoVec ErodeColumnVec64f;
 typedef MorphColumnNoVec DilateColumnVec64f;
 typedef MorphNoVec ErodeVec64f;
 typedef MorphNoVec DilateVec64f;
+typedef MorphBinaryNoVec ErodeBinaryVec64f;
+typedef MorphBinaryNoVec DilateBinaryVec64f;
 
 
 template<class Op, class VecOp> struct MorphRowFilter : public BaseRowFilter
@@ -695,6 +765,8 @@ template<class Op, class VecOp> struct MorphColumnFilter : public BaseColumnFilt
         anchor = _anchor;
     }
 
+    virtual Ptr<BaseColumnFilter> clone() const { return makePtr<MorphColumnFilter<Op, VecOp> >(*this); }
+
     void operator()(const uchar** _src, uchar* dst, int dststep, int count, int width)
     {
         int i, k, _ksize = ksize;
@@ -796,6 +868,8 @@ template<class Op, class VecOp> struct MorphFilter : BaseFilter
         ptrs.resize( coords.size() );
     }
 
+    virtual Ptr<BaseFilter> clone() const { return makePtr<MorphFilter<Op, VecOp> >(*this); }
+
     void operator()(const uchar** src, uchar* dst, int dststep, int count, int width, int cn)
     {
         const Point* pt = &coords[0];
@@ -1081,6 +1155,355 @@ cv::Mat cv::getStructuringElement(int shape, Size ksize, Point anchor)
 namespace cv
 {
 
+/*
+The kernel heights starting from which morphRect is faster than the separable filter,
+and the widths starting from which its row pass is faster than the vectorized row filter,
+which processes up to 16 elements at once; the heights are the same for all the depths
+*/
+enum { RECT_MORPH_MIN_HEIGHT = 11 };
+
+static int rectMorphMinWidth( int depth )
+{
+    return depth == CV_8U ? 192 : depth == CV_64F ? 12 : 48;
+}
+
+/*
+Erosion and dilation with a rectangular structuring element by the van Herk/Gil-Werman algorithm.
+The sequence is split into blocks of ksize elements; for each element, H holds the minimum
+(maximum) up to the end of its block and G, from the beginning of its block, so the result
+for any window of ksize elements is op(H[i], G[i + ksize - 1]). It takes 3 comparisons per
+element independently of ksize. The filter runs down the rows of an image, so each step
+is a vector operation over a whole row; the row pass first interleaves the pixels of
+several rows, RECT_MORPH_GROUP_SIZE bytes per pixel, so that the same code filters them
+along the rows.
+*/
+enum { RECT_MORPH_GROUP_SIZE = 128, RECT_MORPH_BUF_SIZE = 1 << 16, RECT_MORPH_BAND_SIZE = 1 << 18 };
+
+template<class Op, class VecOp> struct MorphRectFilter
+{
+    typedef typename Op::rtype T;
+
+    // dst[i] = op(a[i], b[i])
+    static void update( const T* a, const T* b, T* dst, int n )
+    {
+        VecOp vecOp;
+        Op op;
+        int i = vecOp((const uchar*)a, (const uchar*)b, (uchar*)dst, n);
+        for( ; i < n; i++ )
+            dst[i] = op(a[i], b[i]);
+    }
+
+    // computes count rows of dst (the step is in elements) from the rows src[0], ..., src[count + ksize - 2],
+    // starting from the element x; H is the buffer of ksize rows, G, of one row, all of width elements
+    static void run( const T** src, int x, T* dst, size_t dstep, int count, int width,
+                     int ksize, T* H, T* G )
+    {
+        size_t esz = width*sizeof(T);
+
+        for( int r = 0; r < count; r += ksize )
+        {
+            int i, j = r + std::min(ksize, count - r), n = j - r;
+
+            memcpy(H + (n - 1)*width, src[j - 1] + x, esz);
+            for( i = n - 2; i >= 0; i-- )
+                update(src[r + i] + x, H + (i + 1)*width, H + i*width, width);
+
+            i = 0;
+            if( n == ksize )
+            {
+                memcpy(dst + r*dstep, H, esz);
+                i = 1;
+            }
+
+            for( ; i < n; i++ )
+            {
+                for( ; j <= r + i + ksize - 1; j++ )
+                {
+                    if( j == r + n )
+                        memcpy(G, src[j] + x, esz);
+                    else
+                        update(G, src[j] + x, G, width);
+                }
+                update(H + i*width, G, dst + (r + i)*dstep, width);
+            }
+        }
+    }
+};
+
+/*
+The source of morphRect, extended by the border the same way the filter engine does it:
+the pixels outside of the ROI are used when they are available.
+*/
+struct MorphRectSource
+{
+    MorphRectSource( const Mat& _src, Size _ksize, Point anchor, int borderType, const Scalar& borderValue )
+        : src(_src), ksize(_ksize), left(anchor.x), extended(false)
+    {
+        Size wholeSize;
+        Point ofs;
+        src.locateROI(wholeSize, ofs);
+        int i, esz = (int)src.elemSize(), width = src.cols + ksize.width - 1;
+
+        constRow.resize(width*esz);
+        scalarToRawData(borderValue, &constRow[0], CV_MAKETYPE(src.depth(), std::min(src.channels(), 4)),
+                        width*src.channels());
+
+        // the offsets of the border pixels from the ROI, INT_MIN for the constant border
+        xofs.resize(width);
+        for( i = 0; i < width; i++ )
+        {
+            int x = borderInterpolate(ofs.x + i - anchor.x, wholeSize.width, borderType);
+            xofs[i] = x >= 0 ? (x - ofs.x)*esz : INT_MIN;
+        }
+
+        rows.resize(src.rows + ksize.height - 1);
+        for( i = 0; i < (int)rows.size(); i++ )
+        {
+            int y = borderInterpolate(ofs.y + i - anchor.y, wholeSize.height, borderType);
+            rows[i] = y >= 0 ? src.ptr() + (y - ofs.y)*src.step : 0;
+        }
+    }
+
+    // the row i with the left and right borders, the buffer has src.cols + ksize.width - 1 pixels
+    void extendedRow( int i, uchar* buf ) const
+    {
+        int j, k, esz = (int)src.elemSize(), width = (int)xofs.size();
+        const uchar* S = rows[i];
+
+        if( !S || extended )
+        {
+            memcpy(buf, S ? S : &constRow[0], width*esz);
+            return;
+        }
+
+        memcpy(buf + left*esz, S, src.cols*esz);
+        for( j = 0; j < width; j++ )
+        {
+            if( j == left )
+                j += src.cols;
+            if( j >= width )
+                break;
+            const uchar* s = xofs[j] != INT_MIN ? S + xofs[j] : &constRow[j*esz];
+            for( k = 0; k < esz; k++ )
+                buf[j*esz + k] = s[k];
+        }
+    }
+
+    // the row i, when the kernel width is 1
+    const uchar* row( int i ) const
+    {
+        return rows[i] ? rows[i] : &constRow[0];
+    }
+
+    // copies all the extended rows to buf, so that the source can be overwritten
+    void extend( Mat& buf )
+    {
+        buf.create((int)rows.size(), (int)xofs.size(), src.type());
+        for( int i = 0; i < buf.rows; i++ )
+            extendedRow(i, buf.ptr(i));
+        for( int i = 0; i < buf.rows; i++ )
+            rows[i] = buf.ptr(i);
+        extended = true;
+    }
+
+    const Mat& src;
+    Size ksize;
+    int left;
+    bool extended;
+    std::vector<uchar> constRow;
+    std::vector<int> xofs;
+    std::vector<const uchar*> rows;
+};
+
+/*
+The image is processed by horizontal bands of at least RECT_MORPH_BAND_SIZE bytes and 4 kernel
+heights: the row pass of a band fills the buffer with its rows and the borders, and the column
+pass computes the band of dst from it while it is still in the cache. The column pass goes by
+vertical strips, so that its buffers stay in the cache as well.
+*/
+template<class Op, class VecOp> class MorphRectInvoker : public ParallelLoopBody
+{
+public:
+    typedef typename Op::rtype T;
+
+    MorphRectInvoker( const MorphRectSource& _src, Mat& _dst, int _op, int _bandRows )
+        : src(_src), dst(_dst), op(_op), bandRows(_bandRows)
+    {
+    }
+
+    static int groupRows( int type )
+    {
+        return std::max(RECT_MORPH_GROUP_SIZE/(int)CV_ELEM_SIZE(type), 1);
+    }
+
+    void operator()( const Range& range ) const
+    {
+        Size ksize = src.ksize;
+        int i, cn = dst.channels(), width = dst.cols*cn, len = (dst.cols + ksize.width - 1)*cn;
+        int stride = groupRows(dst.type())*cn, nrows = bandRows + ksize.height - 1;
+        int bsize = std::min(std::max(RECT_MORPH_BUF_SIZE/((ksize.height + 1)*(int)sizeof(T)) & -16, 16), width);
+        bool rowPass = ksize.width > 1, columnPass = ksize.height > 1;
+
+        AutoBuffer<T> _buf((rowPass && columnPass ? nrows*width : 0) + len +
+                           (ksize.width >= rectMorphMinWidth(dst.depth()) ? stride*(len + width + ksize.width + 1) : 0) +
+                           (columnPass ? bsize*(ksize.height + 1) : 0));
+        AutoBuffer<const T*> _rows(std::max(nrows, len/cn));
+        T* buf = _buf;
+        T* rowbuf = buf + (rowPass && columnPass ? nrows*width : 0);
+        T* work = rowbuf + len;
+        const T** rows = _rows;
+
+        for( int b = range.start; b < range.end; b++ )
+        {
+            int y0 = b*bandRows, y1 = std::min(y0 + bandRows, dst.rows), n = y1 - y0 + ksize.height - 1;
+
+            if( !columnPass )
+            {
+                filterRows(y0, y1, dst.ptr<T>(y0), dst.step/sizeof(T), rowbuf, work, rows);
+                continue;
+            }
+
+            if( rowPass )
+            {
+                filterRows(y0, y0 + n, buf, width, rowbuf, work, rows);
+                for( i = 0; i < n; i++ )
+                    rows[i] = buf + i*width;
+            }
+            else
+                for( i = 0; i < n; i++ )
+                    rows[i] = (const T*)src.row(y0 + i);
+
+            for( int x = 0; x < width; x += bsize )
+                MorphRectFilter<Op, VecOp>::run(rows, x, dst.ptr<T>(y0) + x, dst.step/sizeof(T),
+                                                y1 - y0, std::min(bsize, width - x), ksize.height,
+                                                work, work + bsize*ksize.height);
+        }
+    }
+
+    // filters the extended rows [y0, y1) of the source along the rows; rowbuf and work are the buffers
+    void filterRows( int y0, int y1, T* D, size_t dstep, T* rowbuf, T* work, const T** ptrs ) const
+    {
+        int type = dst.type(), ROWS = groupRows(type), ksize = src.ksize.width;
+        int i, k, cn = dst.channels(), width = dst.cols, len = width + ksize - 1, stride = ROWS*cn;
+
+        if( ksize < rectMorphMinWidth(dst.depth()) )
+        {
+            Ptr<BaseRowFilter> f = getMorphologyRowFilter(op, type, ksize, -1);
+            for( int y = y0; y < y1; y++, D += dstep )
+            {
+                src.extendedRow(y, (uchar*)rowbuf);
+                (*f)((const uchar*)rowbuf, (uchar*)D, width, cn);
+            }
+            return;
+        }
+
+        T* S = work;
+        T* B = S + stride*len;
+        T* H = B + stride*width;
+        for( i = 0; i < len; i++ )
+            ptrs[i] = S + i*stride;
+
+        for( int g = y0; g < y1; g += ROWS, D += dstep*ROWS )
+        {
+            int nrows = std::min(ROWS, y1 - g);
+
+            for( int r = 0; r < nrows; r++ )
+            {
+                src.extendedRow(g + r, (uchar*)rowbuf);
+                T* s = S + r*cn;
+                if( cn == 1 )
+                    for( i = 0; i < len; i++ )
+                        s[i*stride] = rowbuf[i];
+                else
+                    for( i = 0; i < len; i++, s += stride )
+                        for( k = 0; k < cn; k++ )
+                            s[k] = rowbuf[i*cn + k];
+            }
+
+            MorphRectFilter<Op, VecOp>::run(ptrs, 0, B, stride, width, nrows*cn, ksize, H, H + stride*ksize);
+
+            for( int r = 0; r < nrows; r++ )
+            {
+                T* d = D + dstep*r;
+                const T* b = B + r*cn;
+                if( cn == 1 )
+                    for( i = 0; i < width; i++ )
+                        d[i] = b[i*stride];
+                else
+                    for( i = 0; i < width; i++, d += cn, b += stride )
+                        for( k = 0; k < cn; k++ )
+                            d[k] = b[k];
+            }
+        }
+    }
+
+private:
+    const MorphRectSource& src;
+    Mat& dst;
+    int op, bandRows;
+};
+
+/*
+Erosion or dilation with the rectangular structuring element by the van Herk/Gil-Werman algorithm,
+bit-exact with the separable filter. When the processing is in-place, the extended source
+is copied to buf, which morphologyEx reuses between its two passes.
+*/
+static void morphRect( int op, const Mat& src, Mat& dst, Size ksize, Point anchor,
+                       int borderType, const Scalar& _borderValue, Mat& buf )
+{
+    int depth = src.depth();
+    Scalar borderValue = _borderValue;
+    borderType &= ~BORDER_ISOLATED;
+
+    if( borderType == BORDER_CONSTANT && borderValue == morphologyDefaultBorderValue() )
+    {
+        if( op == MORPH_ERODE )
+            borderValue = Scalar::all( depth == CV_8U ? (double)UCHAR_MAX :
+                                       depth == CV_16U ? (double)USHRT_MAX :
+                                       depth == CV_16S ? (double)SHRT_MAX :
+                                       depth == CV_32F ? (double)FLT_MAX : DBL_MAX);
+        else
+            borderValue = Scalar::all( depth == CV_8U || depth == CV_16U ?
+                                           0. :
+                                       depth == CV_16S ? (double)SHRT_MIN :
+                                       depth == CV_32F ? (double)-FLT_MAX : -DBL_MAX);
+    }
+
+    MorphRectSource msrc(src, ksize, anchor, borderType, borderValue);
+    if( src.datastart < dst.dataend && dst.datastart < src.dataend )
+        msrc.extend(buf);
+
+    int bandRows = std::max(ksize.height*4, (int)(RECT_MORPH_BAND_SIZE/(dst.cols*dst.elemSize())));
+    int nbands = (dst.rows + bandRows - 1)/bandRows;
+
+    if( op == MORPH_ERODE )
+    {
+        if( depth == CV_8U )
+            parallel_for_(Range(0, nbands), MorphRectInvoker<MinOp<uchar>, ErodeBinaryVec8u>(msrc, dst, op, bandRows));
+        else if( depth == CV_16U )
+            parallel_for_(Range(0, nbands), MorphRectInvoker<MinOp<ushort>, ErodeBinaryVec16u>(msrc, dst, op, bandRows));
+        else if( depth == CV_16S )
+            parallel_for_(Range(0, nbands), MorphRectInvoker<MinOp<short>, ErodeBinaryVec16s>(msrc, dst, op, bandRows));
+        else if( depth == CV_32F )
+            parallel_for_(Range(0, nbands), MorphRectInvoker<MinOp<float>, ErodeBinaryVec32f>(msrc, dst, op, bandRows));
+        else
+            parallel_for_(Range(0, nbands), MorphRectInvoker<MinOp<double>, ErodeBinaryVec64f>(msrc, dst, op, bandRows));
+    }
+    else
+    {
+        if( depth == CV_8U )
+            parallel_for_(Range(0, nbands), MorphRectInvoker<MaxOp<uchar>, DilateBinaryVec8u>(msrc, dst, op, bandRows));
+        else if( depth == CV_16U )
+            parallel_for_(Range(0, nbands), MorphRectInvoker<MaxOp<ushort>, DilateBinaryVec16u>(msrc, dst, op, bandRows));
+        else if( depth == CV_16S )
+            parallel_for_(Range(0, nbands), MorphRectInvoker<MaxOp<short>, DilateBinaryVec16s>(msrc, dst, op, bandRows));
+        else if( depth == CV_32F )
+            parallel_for_(Range(0, nbands), MorphRectInvoker<MaxOp<float>, DilateBinaryVec32f>(msrc, dst, op, bandRows));
+        else
+            parallel_for_(Range(0, nbands), MorphRectInvoker<MaxOp<double>, DilateBinaryVec64f>(msrc, dst, op, bandRows));
+    }
+}
+
 class MorphologyRunner : public ParallelLoopBody
 {
 public:
@@ -1672,7 +2095,8 @@ static bool ocl_morphOp(InputArray _src, OutputArray _dst, InputArray _kernel,
 static void morphOp( int op, InputArray _src, OutputArray _dst,
                      InputArray _kernel,
                      Point anchor, int iterations,
-                     int borderType, const Scalar& borderValue )
+                     int borderType, const Scalar& borderValue,
+                     Mat* rectBuf = 0 )
 {
     Mat kernel = _kernel.getMat();
     Size ksize = !kernel.empty() ? kernel.size() : Size(3,3);
@@ -1721,6 +2145,16 @@ static void morphOp( int op, InputArray _src, OutputArray _dst,
     _dst.create( src.size(), src.type() );
     Mat dst = _dst.getMat();
 
+    int depth = src.depth();
+    if( iterations == 1 && (kernel.rows >= RECT_MORPH_MIN_HEIGHT || kernel.cols >= rectMorphMinWidth(depth)) &&
+        (depth == CV_8U || depth == CV_16U || depth == CV_16S || depth == CV_32F || depth == CV_64F) &&
+        countNonZero(kernel) == kernel.rows*kernel.cols )
+    {
+        Mat tmp;
+        morphRect(op, src, dst, kernel.size(), anchor, borderType, borderValue, rectBuf ? *rectBuf : tmp);
+        return;
+    }
+
     int nStripes = 1;
 #if defined HAVE_TEGRA_OPTIMIZATION
     if (src.data != dst.data && iterations == 1 &&  //NOTE: threads are not used for inplace processing
@@ -1828,43 +2262,43 @@ void cv::morphologyEx( InputArray _src, OutputArray _dst, int op,
         ocl_morphologyEx(_src, _dst, op, kernel, anchor, iterations, borderType, borderValue))
 #endif
 
-    Mat src = _src.getMat(), temp;
+    Mat src = _src.getMat(), temp, rectBuf;
     _dst.create(src.size(), src.type());
     Mat dst = _dst.getMat();
 
     switch( op )
     {
     case MORPH_ERODE:
-        erode( src, dst, kernel, anchor, iterations, borderType, borderValue );
+        morphOp( MORPH_ERODE, src, dst, kernel, anchor, iterations, borderType, borderValue, &rectBuf );
         break;
     case MORPH_DILATE:
-        dilate( src, dst, kernel, anchor, iterations, borderType, borderValue );
+        morphOp( MORPH_DILATE, src, dst, kernel, anchor, iterations, borderType, borderValue, &rectBuf );
         break;
     case MORPH_OPEN:
-        erode( src, dst, kernel, anchor, iterations, borderType, borderValue );
-        dilate( dst, dst, kernel, anchor, iterations, borderType, borderValue );
+        morphOp( MORPH_ERODE, src, dst, kernel, anchor, iterations, borderType, borderValue, &rectBuf );
+        morphOp( MORPH_DILATE, dst, dst, kernel, anchor, iterations, borderType, borderValue, &rectBuf );
         break;
     case CV_MOP_CLOSE:
-        dilate( src, dst, kernel, anchor, iterations, borderType, borderValue );
-        erode( dst, dst, kernel, anchor, iterations, borderType, borderValue );
+        morphOp( MORPH_DILATE, src, dst, kernel, anchor, iterations, borderType, borderValue, &rectBuf );
+        morphOp( MORPH_ERODE, dst, dst, kernel, anchor, iterations, borderType, borderValue, &rectBuf );
         break;
     case CV_MOP_GRADIENT:
-        erode( src, temp, kernel, anchor, iterations, borderType, borderValue );
-        dilate( src, dst, kernel, anchor, iterations, borderType, borderValue );
+        morphOp( MORPH_ERODE, src, temp, kernel, anchor, iterations, borderType, borderValue, &rectBuf );
+        morphOp( MORPH_DILATE, src, dst, kernel, anchor, iterations, borderType, borderValue, &rectBuf );
         dst -= temp;
         break;
     case CV_MOP_TOPHAT:
         if( src.data != dst.data )
             temp = dst;
-        erode( src, temp, kernel, anchor, iterations, borderType, borderValue );
-        dilate( temp, temp, kernel, anchor, iterations, borderType, borderValue );
+        morphOp( MORPH_ERODE, src, temp, kernel, anchor, iterations, borderType, borderValue, &rectBuf );
+        morphOp( MORPH_DILATE, temp, temp, kernel, anchor, iterations, borderType, borderValue, &rectBuf );
         dst = src - temp;
         break;
     case CV_MOP_BLACKHAT:
         if( src.data != dst.data )
             temp = dst;
-        dilate( src, temp, kernel, anchor, iterations, borderType, borderValue );
-        erode( temp, temp, kernel, anchor, iterations, borderType, borderValue );
+        morphOp( MORPH_DILATE, src, temp, kernel, anchor, iterations, borderType, borderValue, &rectBuf );
+        morphOp( MORPH_ERODE, temp, temp, kernel, anchor, iterations, borderType, borderValue, &rectBuf );
         dst = temp - src;
         break;
     default:
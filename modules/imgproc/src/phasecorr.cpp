@@ -569,6 +569,216 @@ cv::Point2d cv::phaseCorrelate(InputArray _src1, InputArray _src2, InputArray _w
 }
 
 
+namespace cv
+{
+
+class PhaseCorrelator_Impl : public PhaseCorrelator
+{
+public:
+    PhaseCorrelator_Impl(bool useWindow, int levels);
+
+    void setReference(InputArray ref);
+    Point2d correlate(InputArray src, double* response);
+
+    void setUseWindow(bool useWindow);
+    bool getUseWindow() const;
+
+    void setLevels(int levels);
+    int getLevels() const;
+
+    void collectGarbage();
+
+private:
+    struct Level
+    {
+        Size size;
+        Mat window, refSpectrum;
+        // buffers reused by every correlate() call
+        Mat src, padded, spectrum, P, Pm, C;
+    };
+
+    void prepare();
+    Point2d correlateLevel(Level& l, const Mat& src, Point shift, double* response);
+
+    bool useWindow_;
+    int levels_;
+    Mat ref_;
+    std::vector<Level> pyr_;
+};
+
+PhaseCorrelator_Impl::PhaseCorrelator_Impl(bool useWindow, int levels) :
+    useWindow_(useWindow), levels_(levels)
+{
+    CV_Assert( levels >= 1 );
+}
+
+void PhaseCorrelator_Impl::setReference(InputArray _ref)
+{
+    Mat ref = _ref.getMat();
+    CV_Assert( ref.channels() == 1 && !ref.empty() );
+
+    ref.convertTo(ref_, ref.depth() == CV_64F ? CV_64F : CV_32F);
+    pyr_.clear();
+}
+
+void PhaseCorrelator_Impl::setUseWindow(bool useWindow)
+{
+    if( useWindow != useWindow_ )
+        pyr_.clear();
+    useWindow_ = useWindow;
+}
+
+bool PhaseCorrelator_Impl::getUseWindow() const
+{
+    return useWindow_;
+}
+
+void PhaseCorrelator_Impl::setLevels(int levels)
+{
+    CV_Assert( levels >= 1 );
+    if( levels != levels_ )
+        pyr_.clear();
+    levels_ = levels;
+}
+
+int PhaseCorrelator_Impl::getLevels() const
+{
+    return levels_;
+}
+
+void PhaseCorrelator_Impl::collectGarbage()
+{
+    for( size_t i = 0; i < pyr_.size(); i++ )
+    {
+        Level& l = pyr_[i];
+        l.src.release();
+        l.spectrum.release();
+        l.P.release();
+        l.Pm.release();
+        l.C.release();
+    }
+}
+
+// computes the windowed reference spectra of all the pyramid levels
+void PhaseCorrelator_Impl::prepare()
+{
+    int type = ref_.type();
+    Mat img = ref_;
+
+    for( int i = 0; i < levels_; i++ )
+    {
+        if( i > 0 )
+        {
+            // the coarsest levels are too small to find anything on them
+            if( std::min(img.cols, img.rows) < 64 )
+                break;
+            Mat down;
+            pyrDown(img, down);
+            img = down;
+        }
+
+        pyr_.push_back(Level());
+        Level& l = pyr_.back();
+        l.size = img.size();
+        int M = getOptimalDFTSize(img.rows);
+        int N = getOptimalDFTSize(img.cols);
+
+        l.padded = Mat::zeros(M, N, type);
+        img.copyTo(l.padded(Rect(0, 0, img.cols, img.rows)));
+        if( useWindow_ )
+        {
+            Mat win;
+            createHanningWindow(win, l.size, type);
+            l.window = Mat::zeros(M, N, type);
+            win.copyTo(l.window(Rect(0, 0, img.cols, img.rows)));
+            multiply(l.window, l.padded, l.padded);
+        }
+        dft(l.padded, l.refSpectrum, DFT_REAL_OUTPUT);
+        l.padded.setTo(Scalar::all(0));
+    }
+}
+
+// correlates the reference with src translated by -shift, see phaseCorrelate
+Point2d PhaseCorrelator_Impl::correlateLevel(Level& l, const Mat& src, Point shift, double* response)
+{
+    int rows = src.rows, cols = src.cols;
+    Mat roi = l.padded(Rect(0, 0, cols, rows));
+
+    if( shift == Point() )
+        src.copyTo(roi);
+    else
+    {
+        roi.setTo(Scalar::all(0));
+        int w = cols - std::abs(shift.x), h = rows - std::abs(shift.y);
+        if( w > 0 && h > 0 )
+            src(Rect(std::max(shift.x, 0), std::max(shift.y, 0), w, h)).copyTo(
+                roi(Rect(std::max(-shift.x, 0), std::max(-shift.y, 0), w, h)));
+    }
+
+    if( !l.window.empty() )
+        multiply(l.window, l.padded, l.padded);
+
+    dft(l.padded, l.spectrum, DFT_REAL_OUTPUT);
+    mulSpectrums(l.refSpectrum, l.spectrum, l.P, 0, true);
+    magSpectrums(l.P, l.Pm);
+    divSpectrums(l.P, l.Pm, l.C, 0, false);
+    idft(l.C, l.C);
+    fftShift(l.C);
+
+    Point peakLoc;
+    minMaxLoc(l.C, NULL, NULL, NULL, &peakLoc);
+    Point2d t = weightedCentroid(l.C, peakLoc, Size(5, 5), response);
+    if( response )
+        *response /= l.padded.rows*l.padded.cols;
+
+    Point2d center((double)l.padded.cols / 2.0, (double)l.padded.rows / 2.0);
+    return center - t + Point2d(shift);
+}
+
+Point2d PhaseCorrelator_Impl::correlate(InputArray _src, double* response)
+{
+    Mat src = _src.getMat();
+    CV_Assert( !ref_.empty() && src.channels() == 1 && src.size() == ref_.size() );
+
+    if( pyr_.empty() )
+        prepare();
+
+    int i, nlevels = (int)pyr_.size();
+    for( i = 0; i < nlevels; i++ )
+    {
+        Level& l = pyr_[i];
+        if( i == 0 )
+        {
+            if( src.type() != ref_.type() )
+                src.convertTo(l.src, ref_.type());
+            else
+                l.src = src;
+        }
+        else
+            pyrDown(pyr_[i-1].src, l.src, l.size);
+    }
+
+    // coarse-to-fine: every level refines the doubled shift found on the coarser one
+    Point2d shift;
+    for( i = nlevels - 1; i >= 0; i-- )
+    {
+        Point ishift(cvRound(shift.x*2), cvRound(shift.y*2));
+        shift = correlateLevel(pyr_[i], pyr_[i].src, i == nlevels - 1 ? Point() : ishift,
+                               i == 0 ? response : 0);
+    }
+    if( src.type() == ref_.type() )
+        pyr_[0].src.release();
+
+    return shift;
+}
+
+}
+
+cv::Ptr<cv::PhaseCorrelator> cv::createPhaseCorrelator(bool useWindow, int levels)
+{
+    return makePtr<PhaseCorrelator_Impl>(useWindow, levels);
+}
+
 void cv::createHanningWindow(OutputArray _dst, cv::Size winSize, int type)
 {
     CV_Assert( type == CV_32FC1 || type == CV_64FC1 );
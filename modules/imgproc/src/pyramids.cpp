@@ -846,133 +846,161 @@ typedef PyrUpNoVec<float, float> PyrUpVec_32f;
 
 #endif
 
-template<class CastOp, class VecOp> void
-pyrDown_( const Mat& _src, Mat& _dst, int borderType )
+/*
+ The horizontal and the vertical passes of pyrDown for one image row: the source rows are
+ convolved horizontally and decimated into a ring buffer of 5 rows, from which the
+ destination rows are computed. Keeps the state, so that the rows can be supplied one by one.
+*/
+template<class CastOp, class VecOp> class PyrDownFilter
 {
-    const int PD_SZ = 5;
+public:
     typedef typename CastOp::type1 WT;
     typedef typename CastOp::rtype T;
+    enum { PD_SZ = 5 };
 
-    CV_Assert( !_src.empty() );
-    Size ssize = _src.size(), dsize = _dst.size();
-    int cn = _src.channels();
-    int bufstep = (int)alignSize(dsize.width*cn, 16);
-    AutoBuffer<WT> _buf(bufstep*PD_SZ + 16);
-    WT* buf = alignPtr((WT*)_buf, 16);
-    int tabL[CV_CN_MAX*(PD_SZ+2)], tabR[CV_CN_MAX*(PD_SZ+2)];
-    AutoBuffer<int> _tabM(dsize.width*cn);
-    int* tabM = _tabM;
-    WT* rows[PD_SZ];
-    CastOp castOp;
-    VecOp vecOp;
-
-    CV_Assert( ssize.width > 0 && ssize.height > 0 &&
-               std::abs(dsize.width*2 - ssize.width) <= 2 &&
-               std::abs(dsize.height*2 - ssize.height) <= 2 );
-    int k, x, sy0 = -PD_SZ/2, sy = sy0, width0 = std::min((ssize.width-PD_SZ/2-1)/2 + 1, dsize.width);
-
-    for( x = 0; x <= PD_SZ+1; x++ )
+    PyrDownFilter( Size ssize, Size dsize, int _cn, int borderType )
     {
-        int sx0 = borderInterpolate(x - PD_SZ/2, ssize.width, borderType)*cn;
-        int sx1 = borderInterpolate(x + width0*2 - PD_SZ/2, ssize.width, borderType)*cn;
-        for( k = 0; k < cn; k++ )
+        CV_Assert( ssize.width > 0 && ssize.height > 0 &&
+                   std::abs(dsize.width*2 - ssize.width) <= 2 &&
+                   std::abs(dsize.height*2 - ssize.height) <= 2 );
+        cn = _cn;
+        bufstep = (int)alignSize(dsize.width*cn, 16);
+        _buf.allocate(bufstep*PD_SZ + 16);
+        buf = alignPtr((WT*)_buf, 16);
+        _tabM.allocate(dsize.width*cn);
+        tabM = _tabM;
+        width0 = std::min((ssize.width-PD_SZ/2-1)/2 + 1, dsize.width);
+
+        int x, k;
+        for( x = 0; x <= PD_SZ+1; x++ )
         {
-            tabL[x*cn + k] = sx0 + k;
-            tabR[x*cn + k] = sx1 + k;
+            int sx0 = borderInterpolate(x - PD_SZ/2, ssize.width, borderType)*cn;
+            int sx1 = borderInterpolate(x + width0*2 - PD_SZ/2, ssize.width, borderType)*cn;
+            for( k = 0; k < cn; k++ )
+            {
+                tabL[x*cn + k] = sx0 + k;
+                tabR[x*cn + k] = sx1 + k;
+            }
         }
-    }
 
-    ssize.width *= cn;
-    dsize.width *= cn;
-    width0 *= cn;
+        dwidth = dsize.width*cn;
+        width0 *= cn;
 
-    for( x = 0; x < dsize.width; x++ )
-        tabM[x] = (x/cn)*2*cn + x % cn;
+        for( x = 0; x < dwidth; x++ )
+            tabM[x] = (x/cn)*2*cn + x % cn;
+    }
 
-    for( int y = 0; y < dsize.height; y++ )
+    // horizontal convolution and decimation of the source row sy (sy >= -PD_SZ/2)
+    void hfilter( const T* src, int sy )
     {
-        T* dst = _dst.ptr<T>(y);
-        WT *row0, *row1, *row2, *row3, *row4;
+        WT* row = buf + ((sy + PD_SZ/2) % PD_SZ)*bufstep;
+        int x, limit = cn;
+        const int* tab = tabL;
 
-        // fill the ring buffer (horizontal convolution and decimation)
-        for( ; sy <= y*2 + 2; sy++ )
+        for( x = 0;;)
         {
-            WT* row = buf + ((sy - sy0) % PD_SZ)*bufstep;
-            int _sy = borderInterpolate(sy, ssize.height, borderType);
-            const T* src = _src.ptr<T>(_sy);
-            int limit = cn;
-            const int* tab = tabL;
-
-            for( x = 0;;)
+            for( ; x < limit; x++ )
             {
-                for( ; x < limit; x++ )
-                {
-                    row[x] = src[tab[x+cn*2]]*6 + (src[tab[x+cn]] + src[tab[x+cn*3]])*4 +
-                        src[tab[x]] + src[tab[x+cn*4]];
-                }
+                row[x] = src[tab[x+cn*2]]*6 + (src[tab[x+cn]] + src[tab[x+cn*3]])*4 +
+                    src[tab[x]] + src[tab[x+cn*4]];
+            }
 
-                if( x == dsize.width )
-                    break;
+            if( x == dwidth )
+                break;
 
-                if( cn == 1 )
+            if( cn == 1 )
+            {
+                for( ; x < width0; x++ )
+                    row[x] = src[x*2]*6 + (src[x*2 - 1] + src[x*2 + 1])*4 +
+                        src[x*2 - 2] + src[x*2 + 2];
+            }
+            else if( cn == 3 )
+            {
+                for( ; x < width0; x += 3 )
                 {
-                    for( ; x < width0; x++ )
-                        row[x] = src[x*2]*6 + (src[x*2 - 1] + src[x*2 + 1])*4 +
-                            src[x*2 - 2] + src[x*2 + 2];
+                    const T* s = src + x*2;
+                    WT t0 = s[0]*6 + (s[-3] + s[3])*4 + s[-6] + s[6];
+                    WT t1 = s[1]*6 + (s[-2] + s[4])*4 + s[-5] + s[7];
+                    WT t2 = s[2]*6 + (s[-1] + s[5])*4 + s[-4] + s[8];
+                    row[x] = t0; row[x+1] = t1; row[x+2] = t2;
                 }
-                else if( cn == 3 )
+            }
+            else if( cn == 4 )
+            {
+                for( ; x < width0; x += 4 )
                 {
-                    for( ; x < width0; x += 3 )
-                    {
-                        const T* s = src + x*2;
-                        WT t0 = s[0]*6 + (s[-3] + s[3])*4 + s[-6] + s[6];
-                        WT t1 = s[1]*6 + (s[-2] + s[4])*4 + s[-5] + s[7];
-                        WT t2 = s[2]*6 + (s[-1] + s[5])*4 + s[-4] + s[8];
-                        row[x] = t0; row[x+1] = t1; row[x+2] = t2;
-                    }
+                    const T* s = src + x*2;
+                    WT t0 = s[0]*6 + (s[-4] + s[4])*4 + s[-8] + s[8];
+                    WT t1 = s[1]*6 + (s[-3] + s[5])*4 + s[-7] + s[9];
+                    row[x] = t0; row[x+1] = t1;
+                    t0 = s[2]*6 + (s[-2] + s[6])*4 + s[-6] + s[10];
+                    t1 = s[3]*6 + (s[-1] + s[7])*4 + s[-5] + s[11];
+                    row[x+2] = t0; row[x+3] = t1;
                 }
-                else if( cn == 4 )
-                {
-                    for( ; x < width0; x += 4 )
-                    {
-                        const T* s = src + x*2;
-                        WT t0 = s[0]*6 + (s[-4] + s[4])*4 + s[-8] + s[8];
-                        WT t1 = s[1]*6 + (s[-3] + s[5])*4 + s[-7] + s[9];
-                        row[x] = t0; row[x+1] = t1;
-                        t0 = s[2]*6 + (s[-2] + s[6])*4 + s[-6] + s[10];
-                        t1 = s[3]*6 + (s[-1] + s[7])*4 + s[-5] + s[11];
-                        row[x+2] = t0; row[x+3] = t1;
-                    }
-                }
-                else
+            }
+            else
+            {
+                for( ; x < width0; x++ )
                 {
-                    for( ; x < width0; x++ )
-                    {
-                        int sx = tabM[x];
-                        row[x] = src[sx]*6 + (src[sx - cn] + src[sx + cn])*4 +
-                            src[sx - cn*2] + src[sx + cn*2];
-                    }
+                    int sx = tabM[x];
+                    row[x] = src[sx]*6 + (src[sx - cn] + src[sx + cn])*4 +
+                        src[sx - cn*2] + src[sx + cn*2];
                 }
-
-                limit = dsize.width;
-                tab = tabR - x;
             }
+
+            limit = dwidth;
+            tab = tabR - x;
         }
+    }
 
-        // do vertical convolution and decimation and write the result to the destination image
-        for( k = 0; k < PD_SZ; k++ )
-            rows[k] = buf + ((y*2 - PD_SZ/2 + k - sy0) % PD_SZ)*bufstep;
-        row0 = rows[0]; row1 = rows[1]; row2 = rows[2]; row3 = rows[3]; row4 = rows[4];
+    // vertical convolution and decimation; the source rows y*2-2 ... y*2+2 must be in the buffer
+    void vfilter( int y, T* dst )
+    {
+        WT* rows[PD_SZ];
+        for( int k = 0; k < PD_SZ; k++ )
+            rows[k] = buf + ((y*2 + k) % PD_SZ)*bufstep;
+        WT *row0 = rows[0], *row1 = rows[1], *row2 = rows[2], *row3 = rows[3], *row4 = rows[4];
 
-        x = vecOp(rows, dst, (int)_dst.step, dsize.width);
-        for( ; x < dsize.width; x++ )
+        int x = vecOp(rows, dst, 0, dwidth);
+        for( ; x < dwidth; x++ )
             dst[x] = castOp(row2[x]*6 + (row1[x] + row3[x])*4 + row0[x] + row4[x]);
     }
+
+private:
+    int cn, bufstep, width0, dwidth;
+    AutoBuffer<WT> _buf;
+    WT* buf;
+    int tabL[CV_CN_MAX*(PD_SZ+2)], tabR[CV_CN_MAX*(PD_SZ+2)];
+    AutoBuffer<int> _tabM;
+    int* tabM;
+    CastOp castOp;
+    VecOp vecOp;
+};
+
+template<class CastOp, class VecOp> void
+pyrDown_( const Mat& _src, Mat& _dst, int borderType, const Range& range )
+{
+    typedef typename CastOp::rtype T;
+    const int PD_SZ = 5;
+
+    CV_Assert( !_src.empty() );
+    PyrDownFilter<CastOp, VecOp> f(_src.size(), _dst.size(), _src.channels(), borderType);
+    int sy = range.start*2 - PD_SZ/2;
+
+    for( int y = range.start; y < range.end; y++ )
+    {
+        // fill the ring buffer (horizontal convolution and decimation)
+        for( ; sy <= y*2 + 2; sy++ )
+            f.hfilter(_src.ptr<T>(borderInterpolate(sy, _src.rows, borderType)), sy);
+
+        // do vertical convolution and decimation and write the result to the destination image
+        f.vfilter(y, _dst.ptr<T>(y));
+    }
 }
 
 
 template<class CastOp, class VecOp> void
-pyrUp_( const Mat& _src, Mat& _dst, int)
+pyrUp_( const Mat& _src, Mat& _dst, int, const Range& range )
 {
     const int PU_SZ = 3;
     typedef typename CastOp::type1 WT;
@@ -992,7 +1020,7 @@ pyrUp_( const Mat& _src, Mat& _dst, int)
 
     CV_Assert( std::abs(dsize.width - ssize.width*2) == dsize.width % 2 &&
                std::abs(dsize.height - ssize.height*2) == dsize.height % 2);
-    int k, x, sy0 = -PU_SZ/2, sy = sy0;
+    int k, x, sy0 = -PU_SZ/2, sy = range.start - PU_SZ/2;
 
     ssize.width *= cn;
     dsize.width *= cn;
@@ -1000,7 +1028,7 @@ pyrUp_( const Mat& _src, Mat& _dst, int)
     for( x = 0; x < ssize.width; x++ )
         dtab[x] = (x/cn)*2*cn + x % cn;
 
-    for( int y = 0; y < ssize.height; y++ )
+    for( int y = range.start; y < range.end; y++ )
     {
         T* dst0 = _dst.ptr<T>(y*2);
         T* dst1 = _dst.ptr<T>(std::min(y*2+1, dsize.height-1));
@@ -1059,7 +1087,175 @@ pyrUp_( const Mat& _src, Mat& _dst, int)
     }
 }
 
-typedef void (*PyrFunc)(const Mat&, Mat&, int);
+typedef void (*PyrFunc)(const Mat&, Mat&, int, const Range&);
+
+class PyrInvoker : public ParallelLoopBody
+{
+public:
+    PyrInvoker( PyrFunc _func, const Mat& _src, Mat& _dst, int _borderType )
+        : func(_func), src(&_src), dst(&_dst), borderType(_borderType) {}
+
+    void operator()( const Range& range ) const
+    {
+        func(*src, *dst, borderType, range);
+    }
+
+private:
+    PyrFunc func;
+    const Mat* src;
+    Mat* dst;
+    int borderType;
+};
+
+/*
+ Builds the pyramid levels first, ..., last (the level first-1 must be ready) in one pass
+ over the source rows: as soon as a row of some level is computed, it is used to compute
+ the rows of the next levels, so the intermediate rows are read back from the cache.
+ The builder computes the rows [range.start, range.end) of the last level and the
+ corresponding rows of the upper levels. When several builders run in parallel, each of them
+ writes to the pyramid only its own rows, while the rows of the neighbor bands that are
+ needed to compute the next levels are kept in the private buffers.
+*/
+template<class CastOp, class VecOp> class PyramidBandBuilder
+{
+public:
+    typedef typename CastOp::rtype T;
+    typedef PyrDownFilter<CastOp, VecOp> Filter;
+
+    PyramidBandBuilder( const std::vector<Mat>& _pyr, int _first, int _last,
+                        int _borderType, const Range& range )
+        : pyr(_pyr), first(_first), last(_last), borderType(_borderType),
+          lo(_last+1), hi(_last+1), ownLo(_last+1), ownHi(_last+1),
+          y(_last+1), sy(_last+1), halo(_last+1), filters(_last+1)
+    {
+        int l, cn = pyr[0].channels();
+        bool lastBand = range.end == pyr[last].rows;
+
+        lo[last] = range.start;
+        hi[last] = range.end;
+        for( l = last; l >= first; l-- )
+        {
+            int h = pyr[l].rows, d = last - l;
+            ownLo[l] = std::min(range.start << d, h);
+            ownHi[l] = lastBand ? h : std::min(range.end << d, h);
+            if( l < last )
+            {
+                // the rows 2*y-2 ... 2*y+2 are needed to compute the row y of the next level
+                lo[l] = std::min(ownLo[l], std::max(lo[l+1]*2 - 2, 0));
+                hi[l] = std::max(ownHi[l], std::min(hi[l+1]*2 + 1, h));
+                halo[l].create((ownLo[l] - lo[l]) + (hi[l] - ownHi[l]), pyr[l].cols, pyr[l].type());
+            }
+            y[l] = lo[l];
+            sy[l] = lo[l]*2 - Filter::PD_SZ/2;
+            filters[l] = makePtr<Filter>(pyr[l-1].size(), pyr[l].size(), cn, borderType);
+        }
+    }
+
+    void run()
+    {
+        produce(first);
+    }
+
+private:
+    T* row( int l, int i ) const
+    {
+        if( l < first || (ownLo[l] <= i && i < ownHi[l]) )
+            return (T*)pyr[l].ptr<T>(i);
+        return (T*)halo[l].ptr<T>(i < ownLo[l] ? i - lo[l] : ownLo[l] - lo[l] + i - ownHi[l]);
+    }
+
+    // computes the rows of the level l while the rows of the level l-1 are available
+    void produce( int l )
+    {
+        Filter& f = *filters[l];
+        int srcRows = pyr[l-1].rows;
+
+        while( y[l] < hi[l] )
+        {
+            for( ; sy[l] <= y[l]*2 + 2; sy[l]++ )
+            {
+                int i = borderInterpolate(sy[l], srcRows, borderType);
+                if( l > first && i >= y[l-1] )
+                    return;
+                f.hfilter(row(l-1, i), sy[l]);
+            }
+            f.vfilter(y[l], row(l, y[l]));
+            y[l]++;
+
+            if( l < last )
+                produce(l+1);
+        }
+    }
+
+    const std::vector<Mat>& pyr;
+    int first, last, borderType;
+    std::vector<int> lo, hi, ownLo, ownHi, y, sy;
+    std::vector<Mat> halo;
+    std::vector<Ptr<Filter> > filters;
+};
+
+template<class CastOp, class VecOp> void
+buildPyramid_( const std::vector<Mat>& pyr, int first, int last, int borderType, const Range& range )
+{
+    PyramidBandBuilder<CastOp, VecOp> builder(pyr, first, last, borderType, range);
+    builder.run();
+}
+
+typedef void (*PyrBuildFunc)(const std::vector<Mat>&, int, int, int, const Range&);
+
+class PyramidBandInvoker : public ParallelLoopBody
+{
+public:
+    PyramidBandInvoker( PyrBuildFunc _func, const std::vector<Mat>& _pyr, int _first, int _last,
+                        int _borderType, int _nbands )
+        : func(_func), pyr(&_pyr), first(_first), last(_last), borderType(_borderType), nbands(_nbands) {}
+
+    void operator()( const Range& range ) const
+    {
+        int rows = (*pyr)[last].rows;
+        for( int band = range.start; band < range.end; band++ )
+            func(*pyr, first, last, borderType,
+                 Range((int)((int64)band*rows/nbands), (int)((int64)(band + 1)*rows/nbands)));
+    }
+
+private:
+    PyrBuildFunc func;
+    const std::vector<Mat>* pyr;
+    int first, last, borderType, nbands;
+};
+
+static void buildPyramidLevels( const std::vector<Mat>& pyr, int first, int last, int borderType )
+{
+    int depth = pyr[0].depth();
+    PyrBuildFunc func = 0;
+    if( depth == CV_8U )
+        func = buildPyramid_<FixPtCast<uchar, 8>, PyrDownVec_32s8u>;
+    else if( depth == CV_16S )
+        func = buildPyramid_<FixPtCast<short, 8>, PyrDownVec_32s16s >;
+    else if( depth == CV_16U )
+        func = buildPyramid_<FixPtCast<ushort, 8>, PyrDownVec_32s16u >;
+    else if( depth == CV_32F )
+        func = buildPyramid_<FltCast<float, 8>, PyrDownVec_32f>;
+    else if( depth == CV_64F )
+        func = buildPyramid_<FltCast<double, 8>, PyrDownNoVec<double, double> >;
+    else
+        CV_Error( CV_StsUnsupportedFormat, "" );
+
+    // the parallel bands are formed at the deepest level that has enough rows for all the threads,
+    // so that the rows recomputed by the neighbor bands do not add much work;
+    // the remaining small levels are built in one more pass
+    int nthreads = getNumThreads(), mid = first;
+    if( nthreads <= 1 )
+        mid = last;
+    else
+        while( mid < last && pyr[mid+1].rows >= nthreads*32 )
+            mid++;
+    int nbands = std::max(std::min(nthreads, pyr[mid].rows/32), 1);
+
+    parallel_for_(Range(0, nbands), PyramidBandInvoker(func, pyr, first, mid, borderType, nbands), nbands);
+    if( mid < last )
+        func(pyr, mid + 1, last, borderType, Range(0, pyr[last].rows));
+}
 
 #ifdef HAVE_OPENCL
 
@@ -1240,7 +1436,8 @@ void cv::pyrDown( InputArray _src, OutputArray _dst, const Size& _dsz, int borde
     else
         CV_Error( CV_StsUnsupportedFormat, "" );
 
-    func( src, dst, borderType );
+    parallel_for_(Range(0, dst.rows), PyrInvoker(func, src, dst, borderType),
+                  std::max(std::min(dst.rows/32, (int)(dst.total() >> 16)), 1));
 }
 
 void cv::pyrUp( InputArray _src, OutputArray _dst, const Size& _dsz, int borderType )
@@ -1317,7 +1514,8 @@ void cv::pyrUp( InputArray _src, OutputArray _dst, const Size& _dsz, int borderT
     else
         CV_Error( CV_StsUnsupportedFormat, "" );
 
-    func( src, dst, borderType );
+    parallel_for_(Range(0, src.rows), PyrInvoker(func, src, dst, borderType),
+                  std::max(std::min(src.rows/16, (int)(dst.total() >> 16)), 1));
 }
 
 void cv::buildPyramid( InputArray _src, OutputArrayOfArrays _dst, int maxlevel, int borderType )
@@ -1432,8 +1630,31 @@ void cv::buildPyramid( InputArray _src, OutputArrayOfArrays _dst, int maxlevel,
         }
     }
 #endif
+#ifdef HAVE_TEGRA_OPTIMIZATION
     for( ; i <= maxlevel; i++ )
         pyrDown( _dst.getMatRef(i-1), _dst.getMatRef(i), Size(), borderType );
+#else
+    if( (borderType & ~BORDER_ISOLATED) == BORDER_WRAP )
+    {
+        // the first rows of a level need the last rows of the previous one
+        for( ; i <= maxlevel; i++ )
+            pyrDown( _dst.getMatRef(i-1), _dst.getMatRef(i), Size(), borderType );
+        return;
+    }
+
+    if( i <= maxlevel )
+    {
+        std::vector<Mat> pyr(maxlevel + 1);
+        for( int k = 0; k <= maxlevel; k++ )
+        {
+            Mat& level = _dst.getMatRef(k);
+            if( k >= i )
+                level.create(Size((pyr[k-1].cols + 1)/2, (pyr[k-1].rows + 1)/2), src.type());
+            pyr[k] = level;
+        }
+        buildPyramidLevels(pyr, i, maxlevel, borderType);
+    }
+#endif
 }
 
 CV_IMPL void cvPyrDown( const void* srcarr, void* dstarr, int _filter )
@@ -340,24 +340,15 @@ static void rotatingCalipers( const Point2f* points, int n, int mode, float* out
 }
 
 
-cv::RotatedRect cv::minAreaRect( InputArray _points )
+namespace cv
+{
+
+// finds the box given the clockwise convex hull
+static RotatedRect minAreaRect_( const Point2f* hpoints, int n )
 {
-    Mat hull;
     Point2f out[3];
     RotatedRect box;
 
-    convexHull(_points, hull, true, true);
-
-    if( hull.depth() != CV_32F )
-    {
-        Mat temp;
-        hull.convertTo(temp, CV_32F);
-        hull = temp;
-    }
-
-    int n = hull.checkVector(2);
-    const Point2f* hpoints = hull.ptr<Point2f>();
-
     if( n > 2 )
     {
         rotatingCalipers( hpoints, n, CALIPERS_MINAREARECT, (float*)out );
@@ -387,6 +378,80 @@ cv::RotatedRect cv::minAreaRect( InputArray _points )
     return box;
 }
 
+class MinAreaRectBatchInvoker : public ParallelLoopBody
+{
+public:
+    MinAreaRectBatchInvoker( const ContourBatch& _batch, Mat& _boxes )
+        : batch(&_batch), boxes(&_boxes) {}
+
+    void operator()( const Range& range ) const
+    {
+        int i, j, maxCount = 0;
+        bool is_float = batch->depth == CV_32F;
+        for( i = range.start; i < range.end; i++ )
+            maxCount = std::max(maxCount, batch->counts[i]);
+
+        AutoBuffer<Point*> _pointer(maxCount);
+        AutoBuffer<int> _stack(maxCount + 2), _hullbuf(maxCount);
+        AutoBuffer<Point2f> _hpoints(maxCount);
+        int* hullbuf = _hullbuf;
+        Point2f* hpoints = _hpoints;
+
+        for( i = range.start; i < range.end; i++ )
+        {
+            const Point* data0 = batch->ptrs[i];
+            int n = batch->counts[i] > 0 ?
+                convexHullIndices(data0, batch->counts[i], is_float, true, _pointer, _stack, hullbuf) : 0;
+            if( is_float )
+                for( j = 0; j < n; j++ )
+                    hpoints[j] = ((const Point2f*)data0)[hullbuf[j]];
+            else
+                for( j = 0; j < n; j++ )
+                    hpoints[j] = Point2f((float)data0[hullbuf[j]].x, (float)data0[hullbuf[j]].y);
+
+            RotatedRect box = minAreaRect_(hpoints, n);
+            float* dst = boxes->ptr<float>(i);
+            dst[0] = box.center.x; dst[1] = box.center.y;
+            dst[2] = box.size.width; dst[3] = box.size.height;
+            dst[4] = box.angle;
+        }
+    }
+
+protected:
+    const ContourBatch* batch;
+    Mat* boxes;
+};
+
+}
+
+cv::RotatedRect cv::minAreaRect( InputArray _points )
+{
+    Mat hull;
+
+    convexHull(_points, hull, true, true);
+
+    if( hull.depth() != CV_32F )
+    {
+        Mat temp;
+        hull.convertTo(temp, CV_32F);
+        hull = temp;
+    }
+
+    return minAreaRect_(hull.ptr<Point2f>(), hull.checkVector(2));
+}
+
+void cv::minAreaRectBatch( InputArrayOfArrays _contours, OutputArray _boxes )
+{
+    ContourBatch batch(_contours);
+    int n = batch.size();
+
+    _boxes.create(n, 5, CV_32F);
+    if( n == 0 )
+        return;
+    Mat boxes = _boxes.getMat();
+    parallel_for_(Range(0, n), MinAreaRectBatchInvoker(batch, boxes), batch.total/(double)(1 << 14));
+}
+
 
 CV_IMPL CvBox2D
 cvMinAreaRect2( const CvArr* array, CvMemStorage* /*storage*/ )
@@ -334,21 +334,16 @@ double cv::arcLength( InputArray _curve, bool is_closed )
     return perimeter;
 }
 
-// area of a whole sequence
-double cv::contourArea( InputArray _contour, bool oriented )
+namespace cv
 {
-    Mat contour = _contour.getMat();
-    int npoints = contour.checkVector(2);
-    int depth = contour.depth();
-    CV_Assert(npoints >= 0 && (depth == CV_32F || depth == CV_32S));
 
+static double contourArea_( const Point* ptsi, int npoints, bool is_float, bool oriented )
+{
     if( npoints == 0 )
         return 0.;
 
     double a00 = 0;
-    bool is_float = depth == CV_32F;
-    const Point* ptsi = contour.ptr<Point>();
-    const Point2f* ptsf = contour.ptr<Point2f>();
+    const Point2f* ptsf = (const Point2f*)ptsi;
     Point2f prev = is_float ? ptsf[npoints-1] : Point2f((float)ptsi[npoints-1].x, (float)ptsi[npoints-1].y);
 
     for( int i = 0; i < npoints; i++ )
@@ -365,29 +360,34 @@ double cv::contourArea( InputArray _contour, bool oriented )
     return a00;
 }
 
+}
 
-cv::RotatedRect cv::fitEllipse( InputArray _points )
+// area of a whole sequence
+double cv::contourArea( InputArray _contour, bool oriented )
 {
-    Mat points = _points.getMat();
-    int i, n = points.checkVector(2);
-    int depth = points.depth();
-    CV_Assert( n >= 0 && (depth == CV_32F || depth == CV_32S));
+    Mat contour = _contour.getMat();
+    int npoints = contour.checkVector(2);
+    int depth = contour.depth();
+    CV_Assert(npoints >= 0 && (depth == CV_32F || depth == CV_32S));
 
-    RotatedRect box;
+    return contourArea_(contour.ptr<Point>(), npoints, depth == CV_32F, oriented);
+}
 
-    if( n < 5 )
-        CV_Error( CV_StsBadSize, "There should be at least 5 points to fit the ellipse" );
+
+namespace cv
+{
+
+// Ad and bd must have room for n*5 and n elements
+static RotatedRect fitEllipse_( const Point* ptsi, int n, bool is_float, double* Ad, double* bd )
+{
+    int i;
+    RotatedRect box;
 
     // New fitellipse algorithm, contributed by Dr. Daniel Weiss
     Point2f c(0,0);
     double gfp[5], rp[5], t;
     const double min_eps = 1e-8;
-    bool is_float = depth == CV_32F;
-    const Point* ptsi = points.ptr<Point>();
-    const Point2f* ptsf = points.ptr<Point2f>();
-
-    AutoBuffer<double> _Ad(n*5), _bd(n);
-    double *Ad = _Ad, *bd = _bd;
+    const Point2f* ptsf = (const Point2f*)ptsi;
 
     // first fit for parameters A - E
     Mat A( n, 5, CV_64F, Ad );
@@ -476,24 +476,34 @@ cv::RotatedRect cv::fitEllipse( InputArray _points )
     return box;
 }
 
+}
+
+cv::RotatedRect cv::fitEllipse( InputArray _points )
+{
+    Mat points = _points.getMat();
+    int n = points.checkVector(2);
+    int depth = points.depth();
+    CV_Assert( n >= 0 && (depth == CV_32F || depth == CV_32S));
+
+    if( n < 5 )
+        CV_Error( CV_StsBadSize, "There should be at least 5 points to fit the ellipse" );
+
+    AutoBuffer<double> _Ad(n*5), _bd(n);
+    return fitEllipse_(points.ptr<Point>(), n, depth == CV_32F, _Ad, _bd);
+}
+
 
 namespace cv
 {
 
 // Calculates bounding rectagnle of a point set or retrieves already calculated
-static Rect pointSetBoundingRect( const Mat& points )
+static Rect pointSetBoundingRect_( const Point* pts, int npoints, bool is_float )
 {
-    int npoints = points.checkVector(2);
-    int depth = points.depth();
-    CV_Assert(npoints >= 0 && (depth == CV_32F || depth == CV_32S));
-
     int  xmin = 0, ymin = 0, xmax = -1, ymax = -1, i;
-    bool is_float = depth == CV_32F;
 
     if( npoints == 0 )
         return Rect();
 
-    const Point* pts = points.ptr<Point>();
     Point pt = pts[0];
 
 #if CV_SSE4_2
@@ -600,6 +610,15 @@ static Rect pointSetBoundingRect( const Mat& points )
     return Rect(xmin, ymin, xmax - xmin + 1, ymax - ymin + 1);
 }
 
+static Rect pointSetBoundingRect( const Mat& points )
+{
+    int npoints = points.checkVector(2);
+    int depth = points.depth();
+    CV_Assert(npoints >= 0 && (depth == CV_32F || depth == CV_32S));
+
+    return pointSetBoundingRect_(points.ptr<Point>(), npoints, depth == CV_32F);
+}
+
 
 static Rect maskBoundingRect( const Mat& img )
 {
@@ -702,6 +721,173 @@ cv::Rect cv::boundingRect(InputArray array)
     return m.depth() <= CV_8U ? maskBoundingRect(m) : pointSetBoundingRect(m);
 }
 
+///////////////////////////////////////// batch processing /////////////////////////////////////////
+
+cv::ContourBatch::ContourBatch( InputArrayOfArrays _contours, int minPoints )
+{
+    int i, n = (int)_contours.total();
+    ptrs.resize(n);
+    counts.resize(n);
+    starts.resize(n);
+    total = maxCount = 0;
+    depth = -1;
+
+    for( i = 0; i < n; i++ )
+    {
+        Mat c = _contours.getMat(i);
+        int npoints = c.empty() ? 0 : c.checkVector(2);
+        CV_Assert( npoints >= 0 );
+        if( npoints < minPoints )
+            CV_Error( CV_StsBadSize, "Too few points in a contour" );
+        if( npoints > 0 )
+        {
+            CV_Assert( (c.depth() == CV_32S || c.depth() == CV_32F) && (depth < 0 || c.depth() == depth) );
+            depth = c.depth();
+        }
+        ptrs[i] = c.ptr<Point>();
+        counts[i] = npoints;
+        starts[i] = total;
+        total += npoints;
+        maxCount = std::max(maxCount, npoints);
+    }
+    if( depth < 0 )
+        depth = CV_32S;
+}
+
+void cv::packContourBatch( const ContourBatch& batch, const Mat& buf, const std::vector<int>& nout,
+                           OutputArray _dst, OutputArray _offsets )
+{
+    int i, n = batch.size();
+    size_t esz = buf.elemSize();
+
+    _offsets.create(n + 1, 1, CV_32S);
+    int* offsets = _offsets.getMat().ptr<int>();
+    offsets[0] = 0;
+    for( i = 0; i < n; i++ )
+        offsets[i+1] = offsets[i] + nout[i];
+
+    _dst.create(offsets[n], 1, buf.type());
+    if( offsets[n] == 0 )
+        return;
+    Mat dst = _dst.getMat();
+    CV_Assert( dst.isContinuous() );
+    for( i = 0; i < n; i++ )
+        if( nout[i] > 0 )
+            memcpy( dst.ptr() + offsets[i]*esz, buf.ptr() + batch.starts[i]*esz, nout[i]*esz );
+}
+
+namespace cv
+{
+
+class ContourAreaBatchInvoker : public ParallelLoopBody
+{
+public:
+    ContourAreaBatchInvoker( const ContourBatch& _batch, double* _areas, bool _oriented )
+        : batch(&_batch), areas(_areas), oriented(_oriented) {}
+
+    void operator()( const Range& range ) const
+    {
+        bool is_float = batch->depth == CV_32F;
+        for( int i = range.start; i < range.end; i++ )
+            areas[i] = contourArea_(batch->ptrs[i], batch->counts[i], is_float, oriented);
+    }
+
+protected:
+    const ContourBatch* batch;
+    double* areas;
+    bool oriented;
+};
+
+class BoundingRectBatchInvoker : public ParallelLoopBody
+{
+public:
+    BoundingRectBatchInvoker( const ContourBatch& _batch, Rect* _rects )
+        : batch(&_batch), rects(_rects) {}
+
+    void operator()( const Range& range ) const
+    {
+        bool is_float = batch->depth == CV_32F;
+        for( int i = range.start; i < range.end; i++ )
+            rects[i] = pointSetBoundingRect_(batch->ptrs[i], batch->counts[i], is_float);
+    }
+
+protected:
+    const ContourBatch* batch;
+    Rect* rects;
+};
+
+class FitEllipseBatchInvoker : public ParallelLoopBody
+{
+public:
+    FitEllipseBatchInvoker( const ContourBatch& _batch, Mat& _boxes )
+        : batch(&_batch), boxes(&_boxes) {}
+
+    void operator()( const Range& range ) const
+    {
+        int i, maxCount = 0;
+        bool is_float = batch->depth == CV_32F;
+        for( i = range.start; i < range.end; i++ )
+            maxCount = std::max(maxCount, batch->counts[i]);
+
+        // the least-squares systems of all the contours of the stripe share the buffers
+        AutoBuffer<double> _Ad(maxCount*5), _bd(maxCount);
+        for( i = range.start; i < range.end; i++ )
+        {
+            RotatedRect box = fitEllipse_(batch->ptrs[i], batch->counts[i], is_float, _Ad, _bd);
+            float* dst = boxes->ptr<float>(i);
+            dst[0] = box.center.x; dst[1] = box.center.y;
+            dst[2] = box.size.width; dst[3] = box.size.height;
+            dst[4] = box.angle;
+        }
+    }
+
+protected:
+    const ContourBatch* batch;
+    Mat* boxes;
+};
+
+}
+
+void cv::contourAreaBatch( InputArrayOfArrays _contours, OutputArray _areas, bool oriented )
+{
+    ContourBatch batch(_contours);
+    int n = batch.size();
+
+    _areas.create(n, 1, CV_64F);
+    if( n == 0 )
+        return;
+    Mat areas = _areas.getMat();
+    CV_Assert( areas.isContinuous() );
+    parallel_for_(Range(0, n), ContourAreaBatchInvoker(batch, areas.ptr<double>(), oriented),
+                  batch.total/(double)(1 << 16));
+}
+
+void cv::boundingRectBatch( InputArrayOfArrays _contours, OutputArray _rects )
+{
+    ContourBatch batch(_contours);
+    int n = batch.size();
+
+    _rects.create(n, 4, CV_32S);
+    if( n == 0 )
+        return;
+    Mat rects = _rects.getMat();
+    CV_Assert( rects.isContinuous() );
+    parallel_for_(Range(0, n), BoundingRectBatchInvoker(batch, rects.ptr<Rect>()),
+                  batch.total/(double)(1 << 16));
+}
+
+void cv::fitEllipseBatch( InputArrayOfArrays _contours, OutputArray _boxes )
+{
+    ContourBatch batch(_contours, 5);
+    int n = batch.size();
+
+    _boxes.create(n, 5, CV_32F);
+    if( n == 0 )
+        return;
+    Mat boxes = _boxes.getMat();
+    parallel_for_(Range(0, n), FitEllipseBatchInvoker(batch, boxes), batch.total/(double)(1 << 12));
+}
+
 ////////////////////////////////////////////// C API ///////////////////////////////////////////
 
 CV_IMPL int
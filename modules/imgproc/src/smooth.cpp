@@ -117,6 +117,8 @@ struct ColumnSum :
 
     virtual void reset() { sumCount = 0; }
 
+    virtual Ptr<BaseColumnFilter> clone() const { return makePtr<ColumnSum<ST, T> >(*this); }
+
     virtual void operator()(const uchar** src, uchar* dst, int dststep, int count, int width)
     {
         int i;
@@ -220,6 +222,8 @@ struct ColumnSum<int, uchar> :
 
     virtual void reset() { sumCount = 0; }
 
+    virtual Ptr<BaseColumnFilter> clone() const { return makePtr<ColumnSum<int, uchar> >(*this); }
+
     virtual void operator()(const uchar** src, uchar* dst, int dststep, int count, int width)
     {
         int i;
@@ -395,6 +399,8 @@ struct ColumnSum<int, short> :
 
     virtual void reset() { sumCount = 0; }
 
+    virtual Ptr<BaseColumnFilter> clone() const { return makePtr<ColumnSum<int, short> >(*this); }
+
     virtual void operator()(const uchar** src, uchar* dst, int dststep, int count, int width)
     {
         int i;
@@ -564,6 +570,8 @@ struct ColumnSum<int, ushort> :
 
     virtual void reset() { sumCount = 0; }
 
+    virtual Ptr<BaseColumnFilter> clone() const { return makePtr<ColumnSum<int, ushort> >(*this); }
+
     virtual void operator()(const uchar** src, uchar* dst, int dststep, int count, int width)
     {
         int i;
@@ -729,6 +737,8 @@ struct ColumnSum<int, int> :
 
     virtual void reset() { sumCount = 0; }
 
+    virtual Ptr<BaseColumnFilter> clone() const { return makePtr<ColumnSum<int, int> >(*this); }
+
     virtual void operator()(const uchar** src, uchar* dst, int dststep, int count, int width)
     {
         int i;
@@ -879,6 +889,8 @@ struct ColumnSum<int, float> :
 
     virtual void reset() { sumCount = 0; }
 
+    virtual Ptr<BaseColumnFilter> clone() const { return makePtr<ColumnSum<int, float> >(*this); }
+
     virtual void operator()(const uchar** src, uchar* dst, int dststep, int count, int width)
     {
         int i;
@@ -1614,6 +1626,345 @@ static void createGaussianKernels( Mat & kx, Mat & ky, int type, Size ksize,
 
 }
 
+/****************************************************************************************\
+                                 Recursive Gaussian Filter
+\****************************************************************************************/
+
+namespace cv
+{
+
+// the sigma starting from which GaussianBlur switches to the recursive filter by default
+static const double RECURSIVE_GAUSSIAN_MIN_SIGMA = 10.;
+
+/*
+Coefficients of the 4th order recursive approximation of the Gaussian by Deriche:
+the right half of the kernel is approximated by two damped cosines,
+g(n) ~ sum (a*cos(w*n/sigma) + b*sin(w*n/sigma))*exp(-l*n/sigma), n >= 0,
+that is computed by a causal filter
+yp[n] = n0*x[n] + n1*x[n-1] + n2*x[n-2] + n3*x[n-3] - d1*yp[n-1] - d2*yp[n-2] - d3*yp[n-3] - d4*yp[n-4],
+and the left half, by the mirrored anti-causal filter
+ym[n] = m1*x[n+1] + m2*x[n+2] + m3*x[n+3] + m4*x[n+4] - d1*ym[n+1] - d2*ym[n+2] - d3*ym[n+3] - d4*ym[n+4],
+so that the result is yp[n] + ym[n]. Both parts are normalized for the unit DC gain.
+The line is extended by border pixels on both sides, which are filled according to
+the border type, so that the initial state of the filters does not affect the result.
+*/
+struct RecursiveGaussianCoeffs
+{
+    RecursiveGaussianCoeffs( double sigma )
+    {
+        static const double a[2] = { 1.680, -0.6803 }, b[2] = { 3.735, -0.2598 },
+                            l[2] = { 1.783, 1.723 }, w[2] = { 0.6318, 1.997 };
+        double p[2][3], q[2][2];
+
+        // each damped cosine is (q0 + q1*z^-1)/(1 + p1*z^-1 + p2*z^-2)
+        for( int k = 0; k < 2; k++ )
+        {
+            double r = std::exp(-l[k]/sigma), cs = std::cos(w[k]/sigma), sn = std::sin(w[k]/sigma);
+            p[k][0] = 1; p[k][1] = -2*r*cs; p[k][2] = r*r;
+            q[k][0] = a[k]; q[k][1] = (b[k]*sn - a[k]*cs)*r;
+        }
+
+        double n[4], d[5];
+        for( int i = 0; i < 5; i++ )
+        {
+            d[i] = 0;
+            for( int j = std::max(i - 2, 0); j <= std::min(i, 2); j++ )
+                d[i] += p[0][j]*p[1][i - j];
+        }
+        for( int i = 0; i < 4; i++ )
+        {
+            n[i] = 0;
+            for( int j = std::max(i - 2, 0); j <= std::min(i, 1); j++ )
+                n[i] += q[0][j]*p[1][i - j] + q[1][j]*p[0][i - j];
+        }
+
+        // the anti-causal part starts from x[n+1]: its numerator is that of z*(H(z^-1) - h(0))
+        double m[4] = { n[1] - d[1]*n[0], n[2] - d[2]*n[0], n[3] - d[3]*n[0], -d[4]*n[0] };
+        double dsum = d[0] + d[1] + d[2] + d[3] + d[4];
+        double scale = dsum/(n[0] + n[1] + n[2] + n[3] + m[0] + m[1] + m[2] + m[3]);
+
+        n0 = n[0]*scale; n1 = n[1]*scale; n2 = n[2]*scale; n3 = n[3]*scale;
+        m1 = m[0]*scale; m2 = m[1]*scale; m3 = m[2]*scale; m4 = m[3]*scale;
+        d1 = d[1]; d2 = d[2]; d3 = d[3]; d4 = d[4];
+        // the responses of the filters to a constant unit input
+        gp = (n0 + n1 + n2 + n3)/dsum;
+        gm = (m1 + m2 + m3 + m4)/dsum;
+        border = cvCeil(sigma*4) + 4;
+    }
+
+    double n0, n1, n2, n3, m1, m2, m3, m4, d1, d2, d3, d4, gp, gm;
+    int border;
+};
+
+// source indices of the extended line, -1 for BORDER_CONSTANT pixels
+static void recursiveGaussianOffsets( int len, int border, int borderType, std::vector<int>& ofs )
+{
+    ofs.resize(len + border*2);
+    for( int i = 0; i < (int)ofs.size(); i++ )
+        ofs[i] = borderInterpolate(i - border, len, borderType);
+}
+
+/*
+Filters n interleaved lines: element k of the line i is X[i*stride + k], 0 <= i < len,
+and the filtered non-border elements are stored to Y the same way. The lines run through
+the recursion together, which vectorizes across them and hides the latency of the recursion.
+X has 4 spare rows on both sides, Y has 4 spare rows before the line
+and R keeps the last 4 rows of the anti-causal filter.
+*/
+static void recursiveGaussianLines( double* X, double* Y, double* R, int len, int stride, int n,
+                                    const RecursiveGaussianCoeffs& c )
+{
+    double n0 = c.n0, n1 = c.n1, n2 = c.n2, n3 = c.n3, m1 = c.m1, m2 = c.m2, m3 = c.m3, m4 = c.m4;
+    double d1 = c.d1, d2 = c.d2, d3 = c.d3, d4 = c.d4;
+    int i, j, end = len - c.border;
+#if CV_SSE2
+    bool haveSSE2 = checkHardwareSupport(CV_CPU_SSE2);
+    __m128d v_n0 = _mm_set1_pd(n0), v_n1 = _mm_set1_pd(n1), v_n2 = _mm_set1_pd(n2), v_n3 = _mm_set1_pd(n3);
+    __m128d v_m1 = _mm_set1_pd(m1), v_m2 = _mm_set1_pd(m2), v_m3 = _mm_set1_pd(m3), v_m4 = _mm_set1_pd(m4);
+    __m128d v_d1 = _mm_set1_pd(d1), v_d2 = _mm_set1_pd(d2), v_d3 = _mm_set1_pd(d3), v_d4 = _mm_set1_pd(d4);
+#endif
+
+    // causal pass, up to the last output row
+    for( j = 0; j < n; j++ )
+    {
+        double x0 = X[j];
+        X[j - stride] = X[j - stride*2] = X[j - stride*3] = x0;
+        Y[j - stride] = Y[j - stride*2] = Y[j - stride*3] = Y[j - stride*4] = x0*c.gp;
+    }
+
+    for( i = 0; i < end; i++ )
+    {
+        const double* x = X + i*stride;
+        double* y = Y + i*stride;
+        j = 0;
+#if CV_SSE2
+        if( haveSSE2 )
+        {
+            for( ; j <= n - 2; j += 2 )
+            {
+                __m128d v_x = _mm_add_pd(_mm_add_pd(_mm_mul_pd(v_n0, _mm_loadu_pd(x + j)), _mm_mul_pd(v_n1, _mm_loadu_pd(x + j - stride))),
+                                         _mm_add_pd(_mm_mul_pd(v_n2, _mm_loadu_pd(x + j - stride*2)), _mm_mul_pd(v_n3, _mm_loadu_pd(x + j - stride*3))));
+                __m128d v_y = _mm_add_pd(_mm_add_pd(_mm_mul_pd(v_d1, _mm_loadu_pd(y + j - stride)), _mm_mul_pd(v_d2, _mm_loadu_pd(y + j - stride*2))),
+                                         _mm_add_pd(_mm_mul_pd(v_d3, _mm_loadu_pd(y + j - stride*3)), _mm_mul_pd(v_d4, _mm_loadu_pd(y + j - stride*4))));
+                _mm_storeu_pd(y + j, _mm_sub_pd(v_x, v_y));
+            }
+        }
+#endif
+        for( ; j < n; j++ )
+            y[j] = ((n0*x[j] + n1*x[j - stride]) + (n2*x[j - stride*2] + n3*x[j - stride*3])) -
+                   ((d1*y[j - stride] + d2*y[j - stride*2]) + (d3*y[j - stride*3] + d4*y[j - stride*4]));
+    }
+
+    // anti-causal pass; the output row i of it goes to R[i & 3]
+    double* xlast = X + (len - 1)*stride;
+    for( j = 0; j < n; j++ )
+    {
+        double x0 = xlast[j];
+        xlast[j + stride] = xlast[j + stride*2] = xlast[j + stride*3] = xlast[j + stride*4] = x0;
+        R[j] = R[j + stride] = R[j + stride*2] = R[j + stride*3] = x0*c.gm;
+    }
+
+    for( i = len - 1; i >= c.border; i-- )
+    {
+        const double* x = X + i*stride;
+        const double* r1 = R + ((i + 1) & 3)*stride;
+        const double* r2 = R + ((i + 2) & 3)*stride;
+        const double* r3 = R + ((i + 3) & 3)*stride;
+        double* r0 = R + (i & 3)*stride;
+        double* y = Y + i*stride;
+        bool output = i < end;
+        j = 0;
+#if CV_SSE2
+        if( haveSSE2 )
+        {
+            for( ; j <= n - 2; j += 2 )
+            {
+                __m128d v_x = _mm_add_pd(_mm_add_pd(_mm_mul_pd(v_m1, _mm_loadu_pd(x + j + stride)), _mm_mul_pd(v_m2, _mm_loadu_pd(x + j + stride*2))),
+                                         _mm_add_pd(_mm_mul_pd(v_m3, _mm_loadu_pd(x + j + stride*3)), _mm_mul_pd(v_m4, _mm_loadu_pd(x + j + stride*4))));
+                __m128d v_r = _mm_add_pd(_mm_add_pd(_mm_mul_pd(v_d1, _mm_loadu_pd(r1 + j)), _mm_mul_pd(v_d2, _mm_loadu_pd(r2 + j))),
+                                         _mm_add_pd(_mm_mul_pd(v_d3, _mm_loadu_pd(r3 + j)), _mm_mul_pd(v_d4, _mm_loadu_pd(r0 + j))));
+                v_r = _mm_sub_pd(v_x, v_r);
+                _mm_storeu_pd(r0 + j, v_r);
+                if( output )
+                    _mm_storeu_pd(y + j, _mm_add_pd(_mm_loadu_pd(y + j), v_r));
+            }
+        }
+#endif
+        for( ; j < n; j++ )
+        {
+            double r = ((m1*x[j + stride] + m2*x[j + stride*2]) + (m3*x[j + stride*3] + m4*x[j + stride*4])) -
+                       ((d1*r1[j] + d2*r2[j]) + (d3*r3[j] + d4*r0[j]));
+            r0[j] = r;
+            if( output )
+                y[j] += r;
+        }
+    }
+}
+
+/*
+The row pass filters groups of RECURSIVE_GAUSSIAN_ROWS rows: their pixels are interleaved
+into one buffer, all the channels at once, so that the recursion runs across the rows.
+The column pass processes vertical strips of RECURSIVE_GAUSSIAN_STRIP elements the same way.
+*/
+enum { RECURSIVE_GAUSSIAN_ROWS = 8, RECURSIVE_GAUSSIAN_STRIP = 32 };
+
+template<typename T> class RecursiveGaussianRowInvoker : public ParallelLoopBody
+{
+public:
+    RecursiveGaussianRowInvoker( const Mat& _src, Mat& _dst, const RecursiveGaussianCoeffs& _c,
+                                 const std::vector<int>& _xofs )
+        : src(_src), dst(_dst), c(_c), xofs(_xofs)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        const int ROWS = RECURSIVE_GAUSSIAN_ROWS;
+        int i, k, cn = src.channels(), width = src.cols, len = (int)xofs.size(), stride = ROWS*cn;
+        AutoBuffer<double> _buf((len*2 + 16)*stride);
+        double* X = (double*)_buf + 4*stride;
+        double* Y = X + (len + 8)*stride;
+        double* R = Y + len*stride;
+
+        for( int g = range.start; g < range.end; g++ )
+        {
+            int y0 = g*ROWS, nrows = std::min(ROWS, src.rows - y0);
+
+            for( int r = 0; r < nrows; r++ )
+            {
+                const T* S = src.ptr<T>(y0 + r);
+                double* x = X + r*cn;
+                for( i = 0; i < len; i++, x += stride )
+                {
+                    if( xofs[i] >= 0 )
+                    {
+                        const T* s = S + xofs[i]*cn;
+                        for( k = 0; k < cn; k++ )
+                            x[k] = s[k];
+                    }
+                    else
+                        for( k = 0; k < cn; k++ )
+                            x[k] = 0.;
+                }
+            }
+
+            recursiveGaussianLines(X, Y, R, len, stride, nrows*cn, c);
+
+            for( int r = 0; r < nrows; r++ )
+            {
+                float* D = dst.ptr<float>(y0 + r);
+                const double* y = Y + c.border*stride + r*cn;
+                for( i = 0; i < width; i++, y += stride, D += cn )
+                    for( k = 0; k < cn; k++ )
+                        D[k] = (float)y[k];
+            }
+        }
+    }
+
+private:
+    const Mat& src;
+    Mat& dst;
+    const RecursiveGaussianCoeffs& c;
+    const std::vector<int>& xofs;
+};
+
+template<typename T> class RecursiveGaussianColumnInvoker : public ParallelLoopBody
+{
+public:
+    RecursiveGaussianColumnInvoker( const Mat& _src, Mat& _dst, const RecursiveGaussianCoeffs& _c,
+                                    const std::vector<int>& _yofs )
+        : src(_src), dst(_dst), c(_c), yofs(_yofs)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        const int STRIP = RECURSIVE_GAUSSIAN_STRIP;
+        int i, j, width = src.cols*src.channels(), len = (int)yofs.size();
+        AutoBuffer<double> _buf((len*2 + 16)*STRIP);
+        double* X = (double*)_buf + 4*STRIP;
+        double* Y = X + (len + 8)*STRIP;
+        double* R = Y + len*STRIP;
+
+        for( int s = range.start; s < range.end; s++ )
+        {
+            int x0 = s*STRIP, n = std::min(STRIP, width - x0);
+
+            for( i = 0; i < len; i++ )
+            {
+                double* x = X + i*STRIP;
+                if( yofs[i] >= 0 )
+                {
+                    const float* S = src.ptr<float>(yofs[i]) + x0;
+                    for( j = 0; j < n; j++ )
+                        x[j] = S[j];
+                }
+                else
+                    for( j = 0; j < n; j++ )
+                        x[j] = 0.;
+            }
+
+            recursiveGaussianLines(X, Y, R, len, STRIP, n, c);
+
+            for( i = 0; i < src.rows; i++ )
+            {
+                const double* y = Y + (i + c.border)*STRIP;
+                T* D = dst.ptr<T>(i) + x0;
+                for( j = 0; j < n; j++ )
+                    D[j] = saturate_cast<T>(y[j]);
+            }
+        }
+    }
+
+private:
+    const Mat& src;
+    Mat& dst;
+    const RecursiveGaussianCoeffs& c;
+    const std::vector<int>& yofs;
+};
+
+/*
+Gaussian smoothing with the recursive filter: its cost per pixel does not depend on sigma.
+Returns false for the depths it does not handle.
+*/
+static bool recursiveGaussianBlur( const Mat& src, Mat& dst, double sigma1, double sigma2, int borderType )
+{
+    int depth = src.depth(), cn = src.channels();
+    if( depth != CV_8U && depth != CV_16U && depth != CV_16S && depth != CV_32F )
+        return false;
+
+    borderType &= ~BORDER_ISOLATED;
+    RecursiveGaussianCoeffs cx(sigma1), cy(sigma2);
+    std::vector<int> xofs, yofs;
+    recursiveGaussianOffsets(src.cols, cx.border, borderType, xofs);
+    recursiveGaussianOffsets(src.rows, cy.border, borderType, yofs);
+
+    Mat tmp(src.size(), CV_MAKETYPE(CV_32F, cn));
+    double nstripes = (double)src.total()*cn/(1 << 16);
+    int ngroups = (src.rows + RECURSIVE_GAUSSIAN_ROWS - 1)/RECURSIVE_GAUSSIAN_ROWS;
+    if( depth == CV_8U )
+        parallel_for_(Range(0, ngroups), RecursiveGaussianRowInvoker<uchar>(src, tmp, cx, xofs), nstripes);
+    else if( depth == CV_16U )
+        parallel_for_(Range(0, ngroups), RecursiveGaussianRowInvoker<ushort>(src, tmp, cx, xofs), nstripes);
+    else if( depth == CV_16S )
+        parallel_for_(Range(0, ngroups), RecursiveGaussianRowInvoker<short>(src, tmp, cx, xofs), nstripes);
+    else
+        parallel_for_(Range(0, ngroups), RecursiveGaussianRowInvoker<float>(src, tmp, cx, xofs), nstripes);
+
+    int nstrips = (src.cols*cn + RECURSIVE_GAUSSIAN_STRIP - 1)/RECURSIVE_GAUSSIAN_STRIP;
+    if( depth == CV_8U )
+        parallel_for_(Range(0, nstrips), RecursiveGaussianColumnInvoker<uchar>(tmp, dst, cy, yofs), nstripes);
+    else if( depth == CV_16U )
+        parallel_for_(Range(0, nstrips), RecursiveGaussianColumnInvoker<ushort>(tmp, dst, cy, yofs), nstripes);
+    else if( depth == CV_16S )
+        parallel_for_(Range(0, nstrips), RecursiveGaussianColumnInvoker<short>(tmp, dst, cy, yofs), nstripes);
+    else
+        parallel_for_(Range(0, nstrips), RecursiveGaussianColumnInvoker<float>(tmp, dst, cy, yofs), nstripes);
+    return true;
+}
+
+}
+
 cv::Ptr<cv::FilterEngine> cv::createGaussianFilter( int type, Size ksize,
                                         double sigma1, double sigma2,
                                         int borderType )
@@ -1627,12 +1978,15 @@ cv::Ptr<cv::FilterEngine> cv::createGaussianFilter( int type, Size ksize,
 
 void cv::GaussianBlur( InputArray _src, OutputArray _dst, Size ksize,
                    double sigma1, double sigma2,
-                   int borderType )
+                   int borderType, int algorithm )
 {
     int type = _src.type();
     Size size = _src.size();
     _dst.create( size, type );
 
+    CV_Assert( algorithm == GAUSSIAN_BLUR_AUTO || algorithm == GAUSSIAN_BLUR_KERNEL ||
+               algorithm == GAUSSIAN_BLUR_RECURSIVE );
+
     if( borderType != BORDER_CONSTANT && (borderType & BORDER_ISOLATED) != 0 )
     {
         if( size.height == 1 )
@@ -1721,6 +2075,39 @@ void cv::GaussianBlur( InputArray _src, OutputArray _dst, Size ksize,
     }
 #endif
 
+    if( algorithm != GAUSSIAN_BLUR_KERNEL && _src.dims() <= 2 )
+    {
+        double sx = sigma1, sy = sigma2 > 0 ? sigma2 : sigma1;
+        bool useRecursive;
+
+        if( algorithm == GAUSSIAN_BLUR_RECURSIVE )
+        {
+            // the same sigmas as the kernel would have
+            if( sx <= 0 )
+                sx = ((ksize.width-1)*0.5 - 1)*0.3 + 0.8;
+            if( sy <= 0 )
+                sy = ((ksize.height-1)*0.5 - 1)*0.3 + 0.8;
+            useRecursive = sx > 0 && sy > 0;
+        }
+        else
+        {
+            // only the large sigmas, with the kernel not truncated below 3*sigma and the pixels
+            // outside of the ROI not used by the kernel
+            useRecursive = !_dst.isUMat() &&
+                sx >= RECURSIVE_GAUSSIAN_MIN_SIGMA && sy >= RECURSIVE_GAUSSIAN_MIN_SIGMA &&
+                (ksize.width <= 0 || ksize.width >= cvRound(sx*6 + 1)) &&
+                (ksize.height <= 0 || ksize.height >= cvRound(sy*6 + 1)) &&
+                ((borderType & BORDER_ISOLATED) != 0 || !_src.isSubmatrix());
+        }
+
+        if( useRecursive )
+        {
+            Mat src = _src.getMat(), dst = _dst.getMat();
+            if( recursiveGaussianBlur(src, dst, sx, sy, borderType) )
+                return;
+        }
+    }
+
     Mat kx, ky;
     createGaussianKernels(kx, ky, type, ksize, sigma1, sigma2);
     sepFilter2D(_src, _dst, CV_MAT_DEPTH(type), kx, ky, Point(-1,-1), 0, borderType );
@@ -2577,6 +2964,286 @@ medianBlur_SortNet( const Mat& _src, Mat& _dst, int m )
     }
 }
 
+/*
+ Median of 16-bit and floating-point images for the apertures that are too large for the sorting
+ networks. The image is split into tiles processed in parallel, and each tile is traversed
+ in the snake order, so that the histogram of the sliding window (the Huang's algorithm) is
+ updated by one row or one column of the aperture per pixel. The histogram is indexed by 16-bit
+ keys: the values themselves for 16-bit images and, for floats, the ranks of the values within
+ the tile, which has at most 65536 pixels for this reason. It has three levels (1, 16 and 256
+ keys per bin), so the new median is found from the previous one in a few steps.
+*/
+enum { MEDIAN_HIST_MAX_KSIZE = 255, MEDIAN_HIST_TILE_SIZE = 256 };
+
+struct MedianHist
+{
+    MedianHist( ushort* buf, int ksize )
+        : fine(buf), mid(buf + 65536), coarse(buf + 65536 + 4096), med(0), less(0), t(ksize*ksize/2)
+    {
+        memset(buf, 0, (65536 + 4096 + 256)*sizeof(buf[0]));
+    }
+
+    void add( int v )
+    {
+        fine[v]++; mid[v >> 4]++; coarse[v >> 8]++;
+        less += v < med;
+    }
+
+    // replaces the key u by v
+    void replace( int u, int v )
+    {
+        fine[u]--; mid[u >> 4]--; coarse[u >> 8]--;
+        fine[v]++; mid[v >> 4]++; coarse[v >> 8]++;
+        less += (v < med) - (u < med);
+    }
+
+    // moves med to the key, such that less <= t < less + fine[med], where less is the number of smaller keys
+    int find()
+    {
+        if( less <= t && t < less + fine[med] )
+            return med;
+
+        // the numbers of keys less than the first keys of the mid and the coarse bins of med
+        int q = med >> 4, b = med >> 8;
+        int lessMid = less - sum(fine, q << 4, med), lessCoarse = lessMid - sum(mid, b << 4, q);
+
+        if( less > t )
+        {
+            if( lessMid > t )
+            {
+                less = lessMid;
+                if( lessCoarse > t )
+                {
+                    for( less = lessCoarse; less - coarse[b - 1] > t; )
+                        less -= coarse[--b];
+                    q = b << 4;
+                }
+                while( less - mid[q - 1] > t )
+                    less -= mid[--q];
+                med = q << 4;
+            }
+            do
+                less -= fine[--med];
+            while( less > t );
+        }
+        else
+        {
+            if( lessMid + mid[q] <= t )
+            {
+                if( lessCoarse + coarse[b] <= t )
+                {
+                    for( less = lessCoarse + coarse[b++]; less + coarse[b] <= t; )
+                        less += coarse[b++];
+                    q = b << 4;
+                }
+                else
+                    less = lessMid + mid[q++];
+                while( less + mid[q] <= t )
+                    less += mid[q++];
+                med = q << 4;
+            }
+            else
+                less += fine[med++];
+            while( less + fine[med] <= t )
+                less += fine[med++];
+        }
+        return med;
+    }
+
+    static int sum( const ushort* h, int from, int to )
+    {
+        int s = 0;
+        for( int i = from; i < to; i++ )
+            s += h[i];
+        return s;
+    }
+
+    ushort *fine, *mid, *coarse;
+    int med, less, t;
+};
+
+// the medians of the tw x th tile of keys K (the step is sw), traversed in the snake order
+static void medianHistTile( const ushort* K, int sw, int tw, int th, int ksize, ushort* hbuf, ushort* dst )
+{
+    MedianHist h(hbuf, ksize);
+    int i, x = 0;
+
+    for( i = 0; i < ksize*ksize; i++ )
+        h.add(K[(i / ksize)*sw + i % ksize]);
+    dst[0] = (ushort)h.find();
+
+    for( int y = 0; y < th; y++ )
+    {
+        const ushort* R = K + y*sw;
+        if( y > 0 )
+        {
+            for( i = 0; i < ksize; i++ )
+            {
+                h.replace(R[x + i - sw], R[(ksize - 1)*sw + x + i]);
+            }
+            dst[y*tw + x] = (ushort)h.find();
+        }
+
+        if( y % 2 == 0 )
+            for( ; x < tw - 1; x++ )
+            {
+                for( i = 0; i < ksize; i++ )
+                {
+                    h.replace(R[i*sw + x], R[i*sw + x + ksize]);
+                }
+                dst[y*tw + x + 1] = (ushort)h.find();
+            }
+        else
+            for( ; x > 0; x-- )
+            {
+                for( i = 0; i < ksize; i++ )
+                {
+                    h.replace(R[i*sw + x + ksize - 1], R[i*sw + x - 1]);
+                }
+                dst[y*tw + x - 1] = (ushort)h.find();
+            }
+    }
+}
+
+// replaces the floats by their ranks; vals receives the distinct values in the ascending order
+static void rankFloats( const float* v, int n, ushort* keys, float* vals, unsigned* buf, int* idxbuf )
+{
+    unsigned *u = buf, *u1 = buf + n;
+    int *idx = idxbuf, *idx1 = idxbuf + n;
+    int i, rank, counts[2048];
+
+    for( i = 0; i < n; i++ )
+    {
+        Cv32suf s;
+        s.f = v[i];
+        u[i] = s.u ^ (s.i < 0 ? 0xffffffffu : 0x80000000u);
+        idx[i] = i;
+    }
+
+    // LSD radix sort of the order-preserving unsigned images of the values, 11 bits per pass
+    for( int shift = 0; shift < 32; shift += 11 )
+    {
+        memset(counts, 0, sizeof(counts));
+        for( i = 0; i < n; i++ )
+            counts[(u[i] >> shift) & 2047]++;
+        for( int b = 0, sum = 0; b < 2048; b++ )
+        {
+            int c = counts[b];
+            counts[b] = sum;
+            sum += c;
+        }
+        for( i = 0; i < n; i++ )
+        {
+            int j = counts[(u[i] >> shift) & 2047]++;
+            u1[j] = u[i];
+            idx1[j] = idx[i];
+        }
+        std::swap(u, u1);
+        std::swap(idx, idx1);
+    }
+
+    for( i = 0, rank = -1; i < n; i++ )
+    {
+        if( i == 0 || u[i] != u[i - 1] )
+            vals[++rank] = v[idx[i]];
+        keys[idx[i]] = (ushort)rank;
+    }
+}
+
+class MedianBlurHistInvoker : public ParallelLoopBody
+{
+public:
+    MedianBlurHistInvoker( const Mat& _src, Mat& _dst, int _ksize, int _tileSize )
+        : src(_src), dst(_dst), ksize(_ksize), tileSize(_tileSize)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        int depth = src.depth(), cn = src.channels(), r = ksize/2;
+        int ntx = (src.cols + tileSize - 1)/tileSize, len = tileSize + ksize - 1, area = len*len;
+        AutoBuffer<ushort> _keys(area + tileSize*tileSize + 65536 + 4096 + 256);
+        AutoBuffer<int> _xofs(len*2);
+        AutoBuffer<float> _vals(depth == CV_32F ? area*2 : 1);
+        AutoBuffer<unsigned> _ubuf(depth == CV_32F ? area*2 : 1);
+        AutoBuffer<int> _ibuf(depth == CV_32F ? area*2 : 1);
+        ushort *K = _keys, *out = K + area, *hbuf = out + tileSize*tileSize;
+        int *xofs = _xofs, *yofs = xofs + len;
+        float *fbuf = _vals, *vals = fbuf + area;
+
+        for( int t = range.start; t < range.end; t++ )
+        {
+            int x0 = (t % ntx)*tileSize, y0 = (t / ntx)*tileSize;
+            int tw = std::min(tileSize, src.cols - x0), th = std::min(tileSize, src.rows - y0);
+            int i, j, sw = tw + ksize - 1, sh = th + ksize - 1;
+
+            for( j = 0; j < sw; j++ )
+                xofs[j] = borderInterpolate(x0 + j - r, src.cols, BORDER_REPLICATE)*cn;
+            for( i = 0; i < sh; i++ )
+                yofs[i] = borderInterpolate(y0 + i - r, src.rows, BORDER_REPLICATE);
+
+            for( int c = 0; c < cn; c++ )
+            {
+                if( depth == CV_32F )
+                {
+                    for( i = 0; i < sh; i++ )
+                    {
+                        const float* S = src.ptr<float>(yofs[i]) + c;
+                        for( j = 0; j < sw; j++ )
+                            fbuf[i*sw + j] = S[xofs[j]];
+                    }
+                    rankFloats(fbuf, sw*sh, K, vals, _ubuf, _ibuf);
+                }
+                else
+                {
+                    ushort delta = depth == CV_16S ? 0x8000 : 0;
+                    for( i = 0; i < sh; i++ )
+                    {
+                        const ushort* S = src.ptr<ushort>(yofs[i]) + c;
+                        for( j = 0; j < sw; j++ )
+                            K[i*sw + j] = (ushort)(S[xofs[j]] ^ delta);
+                    }
+                }
+
+                medianHistTile(K, sw, tw, th, ksize, hbuf, out);
+
+                for( i = 0; i < th; i++ )
+                {
+                    const ushort* o = out + i*tw;
+                    if( depth == CV_32F )
+                    {
+                        float* D = dst.ptr<float>(y0 + i) + x0*cn + c;
+                        for( j = 0; j < tw; j++ )
+                            D[j*cn] = vals[o[j]];
+                    }
+                    else
+                    {
+                        ushort delta = depth == CV_16S ? 0x8000 : 0;
+                        ushort* D = dst.ptr<ushort>(y0 + i) + x0*cn + c;
+                        for( j = 0; j < tw; j++ )
+                            D[j*cn] = (ushort)(o[j] ^ delta);
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    const Mat& src;
+    Mat& dst;
+    int ksize, tileSize;
+};
+
+static void
+medianBlur_Hist( const Mat& src, Mat& dst, int ksize )
+{
+    CV_Assert( ksize <= MEDIAN_HIST_MAX_KSIZE );
+    // for the ranks of floats the tile with the borders must have at most 65536 pixels
+    int tileSize = src.depth() == CV_32F ? MEDIAN_HIST_TILE_SIZE + 1 - ksize : MEDIAN_HIST_TILE_SIZE;
+    int ntiles = ((src.cols + tileSize - 1)/tileSize)*((src.rows + tileSize - 1)/tileSize);
+    parallel_for_(Range(0, ntiles), MedianBlurHistInvoker(src, dst, ksize, tileSize));
+}
+
 #ifdef HAVE_OPENCL
 
 static bool ocl_medianFilter(InputArray _src, OutputArray _dst, int m)
@@ -2729,6 +3396,15 @@ void cv::medianBlur( InputArray _src0, OutputArray _dst, int ksize )
 
         return;
     }
+    else if( src0.depth() == CV_16U || src0.depth() == CV_16S || src0.depth() == CV_32F )
+    {
+        if( dst.data != src0.data )
+            src = src0;
+        else
+            src0.copyTo(src);
+
+        medianBlur_Hist( src, dst, ksize );
+    }
     else
     {
         cv::copyMakeBorder( src0, src, 0, 0, ksize/2, ksize/2, BORDER_REPLICATE );
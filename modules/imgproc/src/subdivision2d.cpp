@@ -477,10 +477,95 @@ int Subdiv2D::insert(Point2f pt)
     return curr_point;
 }
 
+// Index of the cell (x, y) of the 2^16 x 2^16 grid along the Hilbert curve
+static unsigned hilbertIndex( unsigned x, unsigned y )
+{
+    unsigned d = 0;
+    for( unsigned s = 1u << 15; s > 0; s >>= 1 )
+    {
+        unsigned rx = (x & s) != 0, ry = (y & s) != 0;
+        d += s * s * ((3 * rx) ^ ry);
+        if( ry == 0 )
+        {
+            if( rx == 1 )
+            {
+                x = s - 1 - x;
+                y = s - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return d;
+}
+
 void Subdiv2D::insert(const std::vector<Point2f>& ptvec)
 {
-    for( size_t i = 0; i < ptvec.size(); i++ )
-        insert(ptvec[i]);
+    int i, n = (int)ptvec.size();
+    if( n == 0 )
+        return;
+
+    for( i = 0; i < n; i++ )
+    {
+        Point2f pt = ptvec[i];
+        if( pt.x < topLeft.x || pt.y < topLeft.y || pt.x >= bottomRight.x || pt.y >= bottomRight.y )
+            CV_Error( CV_StsOutOfRange, "" );
+    }
+
+    // Biased randomized insertion order: the points are split into rounds of geometrically
+    // growing size, and within a round they are sorted along the Hilbert curve. The randomness
+    // keeps the triangulation balanced, while the locality keeps the walks in locate() short.
+    // The round is chosen by a hash of the coordinates, so the copies of a point come together
+    // and the first of them in ptvec is inserted.
+    std::vector<std::pair<uint64, int> > order(n);
+    int maxLevel = 0;
+    while( (2 << maxLevel) < n )
+        maxLevel++;
+    float sx = 65535.f/std::max(bottomRight.x - topLeft.x, FLT_EPSILON);
+    float sy = 65535.f/std::max(bottomRight.y - topLeft.y, FLT_EPSILON);
+    for( i = 0; i < n; i++ )
+    {
+        Cv32suf vx, vy;
+        vx.f = ptvec[i].x;
+        vy.f = ptvec[i].y;
+        unsigned bits = (vx.u * 0x9E3779B1u) ^ (vy.u * 0x85EBCA77u), level = 0;
+        bits = (bits ^ (bits >> 15)) * 0xC2B2AE3Du;
+        bits ^= bits >> 13;
+        while( (int)level < maxLevel && (bits & 1) )
+            level++, bits >>= 1;
+        unsigned x = (unsigned)std::min(cvFloor((ptvec[i].x - topLeft.x)*sx), 65535);
+        unsigned y = (unsigned)std::min(cvFloor((ptvec[i].y - topLeft.y)*sy), 65535);
+        order[i] = std::make_pair(((uint64)(maxLevel - level) << 32) + hilbertIndex(x, y), i);
+    }
+    std::sort(order.begin(), order.end());
+
+    // every point adds 3 edges to the triangulation
+    qedges.reserve(qedges.size() + (size_t)n*3);
+    vtx.reserve(vtx.size() + n);
+
+    // the new vertices are numbered in the order of ptvec; they are put to the free list
+    // in the insertion order, so that newPoint() picks the right one for every point
+    int base = (int)vtx.size();
+    vtx.resize(base + n);
+    for( i = n - 1; i >= 0; i-- )
+    {
+        vtx[base + order[i].second].firstEdge = freePoint;
+        freePoint = base + order[i].second;
+    }
+
+    std::vector<int> unused;
+    for( i = 0; i < n; i++ )
+    {
+        int vidx = base + order[i].second;
+        insert(ptvec[order[i].second]);
+        // a duplicate of an already inserted point does not take its vertex
+        if( freePoint == vidx )
+        {
+            freePoint = vtx[vidx].firstEdge;
+            unused.push_back(vidx);
+        }
+    }
+    for( i = 0; i < (int)unused.size(); i++ )
+        deletePoint(unused[i]);
 }
 
 void Subdiv2D::initDelaunay( Rect rect )
@@ -52,112 +52,398 @@ namespace cv
 {
 
 template <typename T, typename ST, typename QT>
-struct Integral_SIMD
+struct IntegralRow_SIMD
 {
-    bool operator()(const T *, size_t,
-                    ST *, size_t,
-                    QT *, size_t,
-                    ST *, size_t,
-                    Size, int) const
+    int operator()(const T *, const ST *, ST *,
+                   const QT *, QT *, int,
+                   ST &, QT &) const
     {
-        return false;
+        return 0;
     }
 };
 
 #if CV_SSE2
 
-template <>
-struct Integral_SIMD<uchar, int, double>
+// inclusive prefix sums of 8 consecutive bytes, as two vectors of 4 ints
+static inline void v_prefixSum8u(const uchar * src, __m128i & lo, __m128i & hi)
+{
+    __m128i v_zero = _mm_setzero_si128();
+    __m128i v = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)src), v_zero);
+
+    v = _mm_add_epi16(v, _mm_slli_si128(v, 2));
+    v = _mm_add_epi16(v, _mm_slli_si128(v, 4));
+    v = _mm_add_epi16(v, _mm_slli_si128(v, 8));
+
+    lo = _mm_unpacklo_epi16(v, v_zero);
+    hi = _mm_unpackhi_epi16(v, v_zero);
+}
+
+// inclusive prefix sums of the squares of 8 consecutive bytes
+static inline void v_prefixSqSum8u(const uchar * src, __m128i & lo, __m128i & hi)
+{
+    __m128i v_zero = _mm_setzero_si128();
+    __m128i v = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)src), v_zero);
+
+    lo = _mm_unpacklo_epi16(v, v_zero);
+    hi = _mm_unpackhi_epi16(v, v_zero);
+    lo = _mm_madd_epi16(lo, lo);
+    hi = _mm_madd_epi16(hi, hi);
+
+    lo = _mm_add_epi32(lo, _mm_slli_si128(lo, 4));
+    lo = _mm_add_epi32(lo, _mm_slli_si128(lo, 8));
+    hi = _mm_add_epi32(hi, _mm_slli_si128(hi, 4));
+    hi = _mm_add_epi32(hi, _mm_slli_si128(hi, 8));
+    hi = _mm_add_epi32(hi, _mm_shuffle_epi32(lo, _MM_SHUFFLE(3, 3, 3, 3)));
+}
+
+static inline void v_storeIntegral(int * dst, const int * prev, __m128i v)
+{
+    _mm_storeu_si128((__m128i *)dst, _mm_add_epi32(_mm_loadu_si128((const __m128i *)prev), v));
+}
+
+static inline void v_storeIntegral(float * dst, const float * prev, __m128i v)
+{
+    _mm_storeu_ps(dst, _mm_add_ps(_mm_loadu_ps(prev), _mm_cvtepi32_ps(v)));
+}
+
+static inline void v_storeIntegral(double * dst, const double * prev, __m128i v)
 {
-    Integral_SIMD()
+    _mm_storeu_pd(dst, _mm_add_pd(_mm_loadu_pd(prev), _mm_cvtepi32_pd(v)));
+    _mm_storeu_pd(dst + 2, _mm_add_pd(_mm_loadu_pd(prev + 2), _mm_cvtepi32_pd(_mm_srli_si128(v, 8))));
+}
+
+static inline void v_storeSqIntegral(double * dst, const double * prev, __m128i v, __m128d carry)
+{
+    _mm_storeu_pd(dst, _mm_add_pd(_mm_loadu_pd(prev), _mm_add_pd(_mm_cvtepi32_pd(v), carry)));
+    _mm_storeu_pd(dst + 2, _mm_add_pd(_mm_loadu_pd(prev + 2),
+                                      _mm_add_pd(_mm_cvtepi32_pd(_mm_srli_si128(v, 8)), carry)));
+}
+
+// 8u -> 32s/32f/64f sums with an optional 64f square sum. The running row sum
+// is kept as an exact integer, so the results are identical to the scalar code.
+template <typename ST>
+struct IntegralRow_SIMD<uchar, ST, double>
+{
+    IntegralRow_SIMD()
     {
         haveSSE2 = checkHardwareSupport(CV_CPU_SSE2);
     }
 
-    bool operator()(const uchar * src, size_t _srcstep,
-                    int * sum, size_t _sumstep,
-                    double * sqsum, size_t,
-                    int * tilted, size_t,
-                    Size size, int cn) const
+    int operator()(const uchar * src, const ST * prev_sum, ST * sum,
+                   const double * prev_sqsum, double * sqsum, int width,
+                   ST & s, double & sq) const
     {
-        if (sqsum || tilted || cn != 1 || !haveSSE2)
-            return false;
-
-        // the first iteration
-        memset(sum, 0, (size.width + 1) * sizeof(int));
+        // keep the row sums below 2^24, so that they are exact in any sum type
+        if (!haveSSE2 || width > (1 << 16))
+            return 0;
 
-        __m128i v_zero = _mm_setzero_si128(), prev = v_zero;
-        int j = 0;
+        __m128i v_s = _mm_set1_epi32((int)s);
+        __m128d v_sq = _mm_set1_pd(sq);
+        int x = 0;
 
-        // the others
-        for (int i = 0; i < size.height; ++i)
+        for ( ; x <= width - 8; x += 8)
         {
-            const uchar * src_row = src + _srcstep * i;
-            int * prev_sum_row = (int *)((uchar *)sum + _sumstep * i) + 1;
-            int * sum_row = (int *)((uchar *)sum + _sumstep * (i + 1)) + 1;
+            __m128i lo, hi;
+            v_prefixSum8u(src + x, lo, hi);
+            lo = _mm_add_epi32(lo, v_s);
+            hi = _mm_add_epi32(hi, v_s);
+            v_storeIntegral(sum + x, prev_sum + x, lo);
+            v_storeIntegral(sum + x + 4, prev_sum + x + 4, hi);
+            v_s = _mm_shuffle_epi32(hi, _MM_SHUFFLE(3, 3, 3, 3));
+
+            if (sqsum)
+            {
+                v_prefixSqSum8u(src + x, lo, hi);
+                v_storeSqIntegral(sqsum + x, prev_sqsum + x, lo, v_sq);
+                v_storeSqIntegral(sqsum + x + 4, prev_sqsum + x + 4, hi, v_sq);
+                v_sq = _mm_add_pd(v_sq, _mm_cvtepi32_pd(_mm_shuffle_epi32(hi, _MM_SHUFFLE(3, 3, 3, 3))));
+            }
+        }
 
-            sum_row[-1] = 0;
+        s = (ST)_mm_cvtsi128_si32(v_s);
+        _mm_store_sd(&sq, v_sq);
+        return x;
+    }
 
-            prev = v_zero;
-            j = 0;
+    bool haveSSE2;
+};
 
-            for ( ; j + 7 < size.width; j += 8)
+#endif
+
+// computes one row of the sum/sqsum integrals; the rows point to the output column 0
+template<typename T, typename ST, typename QT>
+static void integralRow_( const T* src, const ST* prevSum, ST* sum,
+                          const QT* prevSqsum, QT* sqsum, int width, int cn,
+                          const IntegralRow_SIMD<T, ST, QT>& vop )
+{
+    int x, k;
+    for( k = 0; k < cn; k++ )
+    {
+        sum[k] = 0;
+        if( sqsum )
+            sqsum[k] = 0;
+    }
+
+    prevSum += cn;
+    sum += cn;
+    if( sqsum )
+    {
+        prevSqsum += cn;
+        sqsum += cn;
+    }
+    width *= cn;
+
+    for( k = 0; k < cn; k++ )
+    {
+        ST s = 0;
+        QT sq = 0;
+        x = k;
+        if( cn == 1 )
+            x = vop(src, prevSum, sum, prevSqsum, sqsum, width, s, sq);
+
+        if( sqsum )
+        {
+            for( ; x < width; x += cn )
             {
-                __m128i vsuml = _mm_loadu_si128((const __m128i *)(prev_sum_row + j));
-                __m128i vsumh = _mm_loadu_si128((const __m128i *)(prev_sum_row + j + 4));
+                T it = src[x];
+                s += it;
+                sq += (QT)it*it;
+                sum[x] = prevSum[x] + s;
+                sqsum[x] = prevSqsum[x] + sq;
+            }
+        }
+        else
+        {
+            for( ; x < width; x += cn )
+            {
+                s += src[x];
+                sum[x] = prevSum[x] + s;
+            }
+        }
+    }
+}
 
-                __m128i el8shr0 = _mm_loadl_epi64((const __m128i *)(src_row + j));
-                __m128i el8shr1 = _mm_slli_si128(el8shr0, 1);
-                __m128i el8shr2 = _mm_slli_si128(el8shr0, 2);
-                __m128i el8shr3 = _mm_slli_si128(el8shr0, 3);
+/*
+   Two-pass integral over horizontal stripes. The first pass computes the integrals of
+   every stripe as if it were a separate image; then the bottom rows of the stripes are
+   chained serially into the carries, and the second pass adds them to the stripe rows.
+
+   The tilted sum of a stripe is obtained as the difference of two diagonal integrals
+   of the row prefix sums r(Y,X) (the sum of the first X pixels of row Y-1):
+       A(Y,X) = A(Y-1,min(X+1,W)) + r(Y,X),   B(Y,X) = B(Y-1,X-1) + r(Y,X-1),
+   with B(Y,-1) = r(Y,-1) = 0. Unlike the tilted sum itself, they carry over a stripe
+   boundary Y0 as a shift: A(Y,X) += A(Y0,min(X+Y-Y0,W)), B(Y,X) += B(Y0,X-(Y-Y0)).
+*/
+template<typename T, typename ST, typename QT>
+class IntegralInvoker : public ParallelLoopBody
+{
+public:
+    enum { LOCAL_PASS = 0, FIXUP_PASS = 1 };
+
+    IntegralInvoker( const T* _src, size_t _srcstep, ST* _sum, size_t _sumstep,
+                     QT* _sqsum, size_t _sqsumstep, ST* _tilted, size_t _tiltedstep,
+                     Size _size, int _cn, int _nstripes )
+        : src(_src), sum(_sum), sqsum(_sqsum), tilted(_tilted),
+          srcstep(_srcstep), sumstep(_sumstep), sqsumstep(_sqsumstep), tiltedstep(_tiltedstep),
+          size(_size), cn(_cn), nstripes(_nstripes), pass(LOCAL_PASS)
+    {
+        rowlen = (size.width + 1)*cn;
+        sumBuf.resize((size_t)rowlen*(nstripes + 1));
+        zeroSum = &sumBuf[0];
+        sumCarry = zeroSum + rowlen;
+        zeroSqsum = sqsumCarry = 0;
+        diagLast = diagCarry = 0;
+        if( sqsum )
+        {
+            sqsumBuf.resize((size_t)rowlen*(nstripes + 1));
+            zeroSqsum = &sqsumBuf[0];
+            sqsumCarry = zeroSqsum + rowlen;
+        }
+        if( tilted )
+        {
+            diagBuf.resize((size_t)rowlen*nstripes*4);
+            diagLast = &diagBuf[0];
+            diagCarry = diagLast + (size_t)rowlen*nstripes*2;
+        }
+    }
 
-                vsuml = _mm_add_epi32(vsuml, prev);
-                vsumh = _mm_add_epi32(vsumh, prev);
+    void run()
+    {
+        int k;
+        memset(sum, 0, rowlen*sizeof(sum[0]));
+        if( sqsum )
+            memset(sqsum, 0, rowlen*sizeof(sqsum[0]));
+        if( tilted )
+            memset(tilted, 0, rowlen*sizeof(tilted[0]));
 
-                __m128i el8shr12 = _mm_add_epi16(_mm_unpacklo_epi8(el8shr1, v_zero),
-                                                 _mm_unpacklo_epi8(el8shr2, v_zero));
-                __m128i el8shr03 = _mm_add_epi16(_mm_unpacklo_epi8(el8shr0, v_zero),
-                                                 _mm_unpacklo_epi8(el8shr3, v_zero));
-                __m128i el8 = _mm_add_epi16(el8shr12, el8shr03);
+        pass = LOCAL_PASS;
+        parallel_for_(Range(0, nstripes), *this, nstripes);
 
-                __m128i el4h = _mm_add_epi16(_mm_unpackhi_epi16(el8, v_zero),
-                                             _mm_unpacklo_epi16(el8, v_zero));
+        // chain the bottom rows of the stripes; the first stripe is already final
 
-                vsuml = _mm_add_epi32(vsuml, _mm_unpacklo_epi16(el8, v_zero));
-                vsumh = _mm_add_epi32(vsumh, el4h);
+        for( int i = 1; i < nstripes; i++ )
+        {
+            int y0 = stripeStart(i - 1), y1 = stripeStart(i), h = y1 - y0;
+            const ST* prevCarry = sumCarry + (size_t)rowlen*(i - 1);
+            ST* carry = sumCarry + (size_t)rowlen*i;
+            const ST* last = (const ST*)((const uchar*)sum + sumstep*y1);
+            for( k = 0; k < rowlen; k++ )
+                carry[k] = last[k] + prevCarry[k];
 
-                _mm_storeu_si128((__m128i *)(sum_row + j), vsuml);
-                _mm_storeu_si128((__m128i *)(sum_row + j + 4), vsumh);
+            if( sqsum )
+            {
+                const QT* prevSqCarry = sqsumCarry + (size_t)rowlen*(i - 1);
+                QT* sqCarry = sqsumCarry + (size_t)rowlen*i;
+                const QT* sqLast = (const QT*)((const uchar*)sqsum + sqsumstep*y1);
+                for( k = 0; k < rowlen; k++ )
+                    sqCarry[k] = sqLast[k] + prevSqCarry[k];
+            }
 
-                prev = _mm_add_epi32(prev, _mm_shuffle_epi32(el4h, _MM_SHUFFLE(3, 3, 3, 3)));
+            if( tilted )
+            {
+                const ST* prevA = diagCarry + (size_t)rowlen*2*(i - 1);
+                const ST* prevB = prevA + rowlen;
+                const ST* lastA = diagLast + (size_t)rowlen*2*(i - 1);
+                const ST* lastB = lastA + rowlen;
+                ST* A = diagCarry + (size_t)rowlen*2*i;
+                ST* B = A + rowlen;
+                for( int x = 0; x <= size.width; x++ )
+                    for( k = 0; k < cn; k++ )
+                    {
+                        A[x*cn + k] = lastA[x*cn + k] + prevA[std::min(x + h, size.width)*cn + k];
+                        B[x*cn + k] = lastB[x*cn + k] + (x >= h ? prevB[(x - h)*cn + k] : ST(0));
+                    }
             }
+        }
+
+        pass = FIXUP_PASS;
+        parallel_for_(Range(1, std::max(nstripes, 1)), *this, std::max(nstripes - 1, 1));
+    }
 
-            for (int v = sum_row[j - 1] - prev_sum_row[j - 1]; j < size.width; ++j)
-                sum_row[j] = (v += src_row[j]) + prev_sum_row[j];
+    virtual void operator()( const Range& range ) const
+    {
+        for( int i = range.start; i < range.end; i++ )
+        {
+            if( pass == LOCAL_PASS )
+                processStripe(i);
+            else
+                fixupStripe(i);
         }
+    }
 
-        return true;
+protected:
+    int stripeStart( int i ) const
+    {
+        return (int)((int64)i*size.height/nstripes);
     }
 
-    bool haveSSE2;
-};
+    void processStripe( int i ) const
+    {
+        int y0 = stripeStart(i), y1 = stripeStart(i + 1);
+        IntegralRow_SIMD<T, ST, QT> vop;
+        const ST* prevSum = zeroSum;
+        const QT* prevSqsum = zeroSqsum;
+        ST *A = 0, *B = 0, *r = 0;
+        AutoBuffer<ST> _r;
+
+        if( tilted )
+        {
+            A = diagLast + (size_t)rowlen*2*i;
+            B = A + rowlen;
+            std::fill(A, A + rowlen*2, ST(0));
+            _r.allocate(rowlen);
+            r = _r;
+        }
 
-#endif
+        for( int y = y0; y < y1; y++ )
+        {
+            const T* srow = (const T*)((const uchar*)src + srcstep*y);
+            ST* srow_sum = (ST*)((uchar*)sum + sumstep*(y + 1));
+            QT* srow_sqsum = sqsum ? (QT*)((uchar*)sqsum + sqsumstep*(y + 1)) : 0;
+
+            integralRow_(srow, prevSum, srow_sum, prevSqsum, srow_sqsum, size.width, cn, vop);
+            prevSum = srow_sum;
+            prevSqsum = srow_sqsum;
 
+            if( tilted )
+            {
+                ST* trow = (ST*)((uchar*)tilted + tiltedstep*(y + 1));
+                int w = size.width;
+                for( int k = 0; k < cn; k++ )
+                {
+                    ST s = r[k] = 0;
+                    for( int x = 1; x <= w; x++ )
+                        r[x*cn + k] = s += srow[(x - 1)*cn + k];
+
+                    ST bprev = 0;
+                    for( int x = 0; x <= w; x++ )
+                    {
+                        int idx = x*cn + k;
+                        ST b = B[idx];
+                        A[idx] = A[std::min(x + 1, w)*cn + k] + r[idx];
+                        B[idx] = x > 0 ? bprev + r[idx - cn] : ST(0);
+                        bprev = b;
+                        trow[idx] = A[idx] - B[idx];
+                    }
+                }
+            }
+        }
+    }
+
+    void fixupStripe( int i ) const
+    {
+        int y0 = stripeStart(i), y1 = stripeStart(i + 1), k;
+        const ST* carry = sumCarry + (size_t)rowlen*i;
+        const QT* sqCarry = sqsum ? sqsumCarry + (size_t)rowlen*i : 0;
+        const ST* A = tilted ? diagCarry + (size_t)rowlen*2*i : 0;
+        const ST* B = tilted ? A + rowlen : 0;
+
+        for( int y = y0 + 1; y <= y1; y++ )
+        {
+            ST* srow = (ST*)((uchar*)sum + sumstep*y);
+            for( k = 0; k < rowlen; k++ )
+                srow[k] = srow[k] + carry[k];
+
+            if( sqsum )
+            {
+                QT* sqrow = (QT*)((uchar*)sqsum + sqsumstep*y);
+                for( k = 0; k < rowlen; k++ )
+                    sqrow[k] = sqrow[k] + sqCarry[k];
+            }
+
+            if( tilted )
+            {
+                ST* trow = (ST*)((uchar*)tilted + tiltedstep*y);
+                int d = y - y0;
+                for( int x = 0; x <= size.width; x++ )
+                    for( k = 0; k < cn; k++ )
+                        trow[x*cn + k] += A[std::min(x + d, size.width)*cn + k] -
+                                          (x >= d ? B[(x - d)*cn + k] : ST(0));
+            }
+        }
+    }
+
+    const T* src;
+    ST* sum;
+    QT* sqsum;
+    ST* tilted;
+    size_t srcstep, sumstep, sqsumstep, tiltedstep;
+    Size size;
+    int cn, nstripes, rowlen, pass;
+    std::vector<ST> sumBuf, diagBuf;
+    std::vector<QT> sqsumBuf;
+    ST *zeroSum, *sumCarry, *diagLast, *diagCarry;
+    QT *zeroSqsum, *sqsumCarry;
+};
+
+// single-pass computation of all three integrals, used when the image is not split into stripes
 template<typename T, typename ST, typename QT>
-void integral_( const T* src, size_t _srcstep, ST* sum, size_t _sumstep,
-                QT* sqsum, size_t _sqsumstep, ST* tilted, size_t _tiltedstep,
-                Size size, int cn )
+static void integralTilted_( const T* src, size_t _srcstep, ST* sum, size_t _sumstep,
+                             QT* sqsum, size_t _sqsumstep, ST* tilted, size_t _tiltedstep,
+                             Size size, int cn )
 {
     int x, y, k;
 
-    if (Integral_SIMD<T, ST, QT>()(src, _srcstep,
-                                   sum, _sumstep,
-                                   sqsum, _sqsumstep,
-                                   tilted, _tiltedstep,
-                                   size, cn))
-        return;
-
     int srcstep = (int)(_srcstep/sizeof(T));
     int sumstep = (int)(_sumstep/sizeof(ST));
     int tiltedstep = (int)(_tiltedstep/sizeof(ST));
@@ -174,143 +460,127 @@ void integral_( const T* src, size_t _srcstep, ST* sum, size_t _sumstep,
         sqsum += sqsumstep + cn;
     }
 
-    if( tilted )
-    {
-        memset( tilted, 0, (size.width+cn)*sizeof(tilted[0]));
-        tilted += tiltedstep + cn;
-    }
+    memset( tilted, 0, (size.width+cn)*sizeof(tilted[0]));
+    tilted += tiltedstep + cn;
 
-    if( sqsum == 0 && tilted == 0 )
+    AutoBuffer<ST> _buf(size.width+cn);
+    ST* buf = _buf;
+    ST s;
+    QT sq;
+    for( k = 0; k < cn; k++, src++, sum++, tilted++, buf++ )
     {
-        for( y = 0; y < size.height; y++, src += srcstep - cn, sum += sumstep - cn )
+        sum[-cn] = tilted[-cn] = 0;
+
+        for( x = 0, s = 0, sq = 0; x < size.width; x += cn )
         {
-            for( k = 0; k < cn; k++, src++, sum++ )
-            {
-                ST s = sum[-cn] = 0;
-                for( x = 0; x < size.width; x += cn )
-                {
-                    s += src[x];
-                    sum[x] = sum[x - sumstep] + s;
-                }
-            }
+            T it = src[x];
+            buf[x] = tilted[x] = it;
+            s += it;
+            sq += (QT)it*it;
+            sum[x] = s;
+            if( sqsum )
+                sqsum[x] = sq;
         }
-    }
-    else if( tilted == 0 )
-    {
-        for( y = 0; y < size.height; y++, src += srcstep - cn,
-                        sum += sumstep - cn, sqsum += sqsumstep - cn )
+
+        if( size.width == cn )
+            buf[cn] = 0;
+
+        if( sqsum )
         {
-            for( k = 0; k < cn; k++, src++, sum++, sqsum++ )
-            {
-                ST s = sum[-cn] = 0;
-                QT sq = sqsum[-cn] = 0;
-                for( x = 0; x < size.width; x += cn )
-                {
-                    T it = src[x];
-                    s += it;
-                    sq += (QT)it*it;
-                    ST t = sum[x - sumstep] + s;
-                    QT tq = sqsum[x - sqsumstep] + sq;
-                    sum[x] = t;
-                    sqsum[x] = tq;
-                }
-            }
+            sqsum[-cn] = 0;
+            sqsum++;
         }
     }
-    else
+
+    for( y = 1; y < size.height; y++ )
     {
-        AutoBuffer<ST> _buf(size.width+cn);
-        ST* buf = _buf;
-        ST s;
-        QT sq;
-        for( k = 0; k < cn; k++, src++, sum++, tilted++, buf++ )
-        {
-            sum[-cn] = tilted[-cn] = 0;
+        src += srcstep - cn;
+        sum += sumstep - cn;
+        tilted += tiltedstep - cn;
+        buf += -cn;
 
-            for( x = 0, s = 0, sq = 0; x < size.width; x += cn )
-            {
-                T it = src[x];
-                buf[x] = tilted[x] = it;
-                s += it;
-                sq += (QT)it*it;
-                sum[x] = s;
-                if( sqsum )
-                    sqsum[x] = sq;
-            }
+        if( sqsum )
+            sqsum += sqsumstep - cn;
 
-            if( size.width == cn )
-                buf[cn] = 0;
+        for( k = 0; k < cn; k++, src++, sum++, tilted++, buf++ )
+        {
+            T it = src[0];
+            ST t0 = s = it;
+            QT tq0 = sq = (QT)it*it;
 
+            sum[-cn] = 0;
             if( sqsum )
-            {
                 sqsum[-cn] = 0;
-                sqsum++;
-            }
-        }
-
-        for( y = 1; y < size.height; y++ )
-        {
-            src += srcstep - cn;
-            sum += sumstep - cn;
-            tilted += tiltedstep - cn;
-            buf += -cn;
+            tilted[-cn] = tilted[-tiltedstep];
 
+            sum[0] = sum[-sumstep] + t0;
             if( sqsum )
-                sqsum += sqsumstep - cn;
+                sqsum[0] = sqsum[-sqsumstep] + tq0;
+            tilted[0] = tilted[-tiltedstep] + t0 + buf[cn];
 
-            for( k = 0; k < cn; k++, src++, sum++, tilted++, buf++ )
+            for( x = cn; x < size.width - cn; x += cn )
             {
-                T it = src[0];
-                ST t0 = s = it;
-                QT tq0 = sq = (QT)it*it;
-
-                sum[-cn] = 0;
-                if( sqsum )
-                    sqsum[-cn] = 0;
-                tilted[-cn] = tilted[-tiltedstep];
-
-                sum[0] = sum[-sumstep] + t0;
+                ST t1 = buf[x];
+                buf[x - cn] = t1 + t0;
+                t0 = it = src[x];
+                tq0 = (QT)it*it;
+                s += t0;
+                sq += tq0;
+                sum[x] = sum[x - sumstep] + s;
                 if( sqsum )
-                    sqsum[0] = sqsum[-sqsumstep] + tq0;
-                tilted[0] = tilted[-tiltedstep] + t0 + buf[cn];
-
-                for( x = cn; x < size.width - cn; x += cn )
-                {
-                    ST t1 = buf[x];
-                    buf[x - cn] = t1 + t0;
-                    t0 = it = src[x];
-                    tq0 = (QT)it*it;
-                    s += t0;
-                    sq += tq0;
-                    sum[x] = sum[x - sumstep] + s;
-                    if( sqsum )
-                        sqsum[x] = sqsum[x - sqsumstep] + sq;
-                    t1 += buf[x + cn] + t0 + tilted[x - tiltedstep - cn];
-                    tilted[x] = t1;
-                }
-
-                if( size.width > cn )
-                {
-                    ST t1 = buf[x];
-                    buf[x - cn] = t1 + t0;
-                    t0 = it = src[x];
-                    tq0 = (QT)it*it;
-                    s += t0;
-                    sq += tq0;
-                    sum[x] = sum[x - sumstep] + s;
-                    if( sqsum )
-                        sqsum[x] = sqsum[x - sqsumstep] + sq;
-                    tilted[x] = t0 + t1 + tilted[x - tiltedstep - cn];
-                    buf[x] = t0;
-                }
+                    sqsum[x] = sqsum[x - sqsumstep] + sq;
+                t1 += buf[x + cn] + t0 + tilted[x - tiltedstep - cn];
+                tilted[x] = t1;
+            }
 
+            if( size.width > cn )
+            {
+                ST t1 = buf[x];
+                buf[x - cn] = t1 + t0;
+                t0 = it = src[x];
+                tq0 = (QT)it*it;
+                s += t0;
+                sq += tq0;
+                sum[x] = sum[x - sumstep] + s;
                 if( sqsum )
-                    sqsum++;
+                    sqsum[x] = sqsum[x - sqsumstep] + sq;
+                tilted[x] = t0 + t1 + tilted[x - tiltedstep - cn];
+                buf[x] = t0;
             }
+
+            if( sqsum )
+                sqsum++;
         }
     }
 }
 
+template<typename T, typename ST, typename QT>
+void integral_( const T* src, size_t _srcstep, ST* sum, size_t _sumstep,
+                QT* sqsum, size_t _sqsumstep, ST* tilted, size_t _tiltedstep,
+                Size size, int cn )
+{
+    // the stripes are summed separately and then joined, which changes the order of the additions;
+    // so the work is split only when the sums are exact in any order, otherwise the floating-point
+    // results would depend on the number of threads
+    bool exact = std::numeric_limits<T>::is_integer && DataType<ST>::depth != CV_32F &&
+        (!sqsum || (DataType<QT>::depth == CV_64F && sizeof(T) == 1));
+    int nstripes = 1;
+    if( exact && (double)size.area()*cn >= (double)(1 << 16) )
+        nstripes = std::max(std::min(getNumThreads(), size.height/64), 1);
+
+    if( tilted && nstripes == 1 )
+    {
+        integralTilted_(src, _srcstep, sum, _sumstep, sqsum, _sqsumstep,
+                        tilted, _tiltedstep, size, cn);
+        return;
+    }
+
+    IntegralInvoker<T, ST, QT> invoker(src, _srcstep, sum, _sumstep, sqsum, _sqsumstep,
+                                       tilted, _tiltedstep, size, cn, nstripes);
+    invoker.run();
+}
+
+
 
 #define DEF_INTEGRAL_FUNC(suffix, T, ST, QT) \
 static void integral_##suffix( T* src, size_t srcstep, ST* sum, size_t sumstep, QT* sqsum, size_t sqsumstep, \
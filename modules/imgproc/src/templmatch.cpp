@@ -815,6 +815,428 @@ void crossCorr( const Mat& img, const Mat& _templ, Mat& corr,
     }
 }
 
+/*
+The image side of crossCorr() for one template size, as used by matchTemplate: the image
+is split into the same blocks and the spectra of all the blocks and channels are computed
+once. Correlating a template of that size then costs only the template DFT, the spectrum
+products and the inverse DFTs, and gives the same result as crossCorr().
+*/
+class CrossCorrSpectra
+{
+public:
+    CrossCorrSpectra() : cn(0), depth(0), maxDepth(0), tileCountX(0), tileCount(0) {}
+
+    void create( const Mat& img, Size templSize );
+    void correlate( const Mat& templ, Mat& corr ) const;
+
+    Rect tileRect( int i ) const
+    {
+        int x = (i%tileCountX)*blocksize.width;
+        int y = (i/tileCountX)*blocksize.height;
+        return Rect(x, y, std::min(blocksize.width, corrsize.width - x),
+                    std::min(blocksize.height, corrsize.height - y));
+    }
+
+    Mat img;
+    Size templSize, corrsize, blocksize, dftsize;
+    int cn, depth, maxDepth, tileCountX, tileCount;
+    std::vector<Mat> spectra;
+};
+
+class CrossCorrSpectraInvoker : public ParallelLoopBody
+{
+public:
+    CrossCorrSpectraInvoker( CrossCorrSpectra& _cc ) : cc(_cc) {}
+
+    void operator()( const Range& range ) const
+    {
+        Size templSize = cc.templSize;
+
+        for( int i = range.start; i < range.end; i++ )
+        {
+            Rect r = cc.tileRect(i);
+            Size dsz(r.width + templSize.width - 1, r.height + templSize.height - 1);
+            Mat src0(cc.img, Rect(r.x, r.y, dsz.width, dsz.height));
+
+            for( int k = 0; k < cc.cn; k++ )
+            {
+                Mat& dftImg = cc.spectra[i*cc.cn + k];
+                dftImg.create(cc.dftsize, cc.maxDepth);
+                dftImg = Scalar::all(0);
+
+                Mat src = src0, dst1(dftImg, Rect(0, 0, dsz.width, dsz.height));
+                if( cc.cn > 1 )
+                {
+                    src = cc.depth == cc.maxDepth ? dst1 : Mat(dsz, cc.depth);
+                    int pairs[] = {k, 0};
+                    mixChannels(&src0, 1, &src, 1, pairs, 1);
+                }
+
+                if( dst1.data != src.data )
+                    src.convertTo(dst1, dst1.depth());
+
+                dft( dftImg, dftImg, 0, dsz.height );
+            }
+        }
+    }
+
+private:
+    CrossCorrSpectra& cc;
+};
+
+void CrossCorrSpectra::create( const Mat& _img, Size _templSize )
+{
+    const double blockScale = 4.5;
+    const int minBlockSize = 256;
+
+    img = _img;
+    templSize = _templSize;
+    depth = img.depth();
+    cn = img.channels();
+    maxDepth = depth > CV_8S ? CV_64F : CV_32F;
+    corrsize = Size(img.cols - templSize.width + 1, img.rows - templSize.height + 1);
+
+    // the same blocks as in crossCorr()
+    blocksize.width = cvRound(templSize.width*blockScale);
+    blocksize.width = std::max( blocksize.width, minBlockSize - templSize.width + 1 );
+    blocksize.width = std::min( blocksize.width, corrsize.width );
+    blocksize.height = cvRound(templSize.height*blockScale);
+    blocksize.height = std::max( blocksize.height, minBlockSize - templSize.height + 1 );
+    blocksize.height = std::min( blocksize.height, corrsize.height );
+
+    dftsize.width = std::max(getOptimalDFTSize(blocksize.width + templSize.width - 1), 2);
+    dftsize.height = getOptimalDFTSize(blocksize.height + templSize.height - 1);
+    if( dftsize.width <= 0 || dftsize.height <= 0 )
+        CV_Error( CV_StsOutOfRange, "the input arrays are too big" );
+
+    blocksize.width = MIN( dftsize.width - templSize.width + 1, corrsize.width );
+    blocksize.height = MIN( dftsize.height - templSize.height + 1, corrsize.height );
+
+    tileCountX = (corrsize.width + blocksize.width - 1)/blocksize.width;
+    tileCount = tileCountX * ((corrsize.height + blocksize.height - 1)/blocksize.height);
+
+    spectra.resize(tileCount*cn);
+    parallel_for_(Range(0, tileCount), CrossCorrSpectraInvoker(*this), tileCount);
+}
+
+void CrossCorrSpectra::correlate( const Mat& templ, Mat& corr ) const
+{
+    CV_Assert( templ.type() == img.type() && templ.size() == templSize );
+
+    corr.create(corrsize, CV_32F);
+
+    // compute DFT of each template plane
+    Mat dftTempl( dftsize.height*cn, dftsize.width, maxDepth );
+    for( int k = 0; k < cn; k++ )
+    {
+        Mat src = templ;
+        Mat dst(dftTempl, Rect(0, k*dftsize.height, dftsize.width, dftsize.height));
+        Mat dst1(dftTempl, Rect(0, k*dftsize.height, templ.cols, templ.rows));
+
+        if( cn > 1 )
+        {
+            src = depth == maxDepth ? dst1 : Mat(templ.size(), depth);
+            int pairs[] = {k, 0};
+            mixChannels(&templ, 1, &src, 1, pairs, 1);
+        }
+
+        if( dst1.data != src.data )
+            src.convertTo(dst1, dst1.depth());
+
+        if( dst.cols > templ.cols )
+        {
+            Mat part(dst, Range(0, templ.rows), Range(templ.cols, dst.cols));
+            part = Scalar::all(0);
+        }
+        dft(dst, dst, 0, templ.rows);
+    }
+
+    // correlate the blocks
+    Mat dftImg( dftsize, maxDepth ), plane;
+    for( int i = 0; i < tileCount; i++ )
+    {
+        Rect r = tileRect(i);
+        Mat cdst(corr, r);
+
+        for( int k = 0; k < cn; k++ )
+        {
+            Mat dftTempl1(dftTempl, Rect(0, k*dftsize.height, dftsize.width, dftsize.height));
+            mulSpectrums(spectra[i*cn + k], dftTempl1, dftImg, 0, true);
+            dft( dftImg, dftImg, DFT_INVERSE + DFT_SCALE, r.height );
+
+            Mat src = dftImg(Rect(0, 0, r.width, r.height));
+            if( k == 0 )
+                src.convertTo(cdst, CV_32F);
+            else
+            {
+                if( maxDepth != CV_32F )
+                {
+                    src.convertTo(plane, CV_32F);
+                    src = plane;
+                }
+                add(src, cdst, cdst);
+            }
+        }
+    }
+}
+
+/*
+Turns the cross-correlation of the template with the image into the result of the given
+method, using the integral images of the image (sum for CV_TM_CCOEFF, sum and sqsum otherwise).
+*/
+static void normalizeMatchResult( const Mat& sum, const Mat& sqsum, const Mat& templ, Mat& result, int method )
+{
+    int cn = templ.channels();
+    int numType = method == CV_TM_CCORR || method == CV_TM_CCORR_NORMED ? 0 :
+                  method == CV_TM_CCOEFF || method == CV_TM_CCOEFF_NORMED ? 1 : 2;
+    bool isNormed = method == CV_TM_CCORR_NORMED ||
+                    method == CV_TM_SQDIFF_NORMED ||
+                    method == CV_TM_CCOEFF_NORMED;
+
+    double invArea = 1./((double)templ.rows * templ.cols);
+
+    Scalar templMean, templSdv;
+    double *q0 = 0, *q1 = 0, *q2 = 0, *q3 = 0;
+    double templNorm = 0, templSum2 = 0;
+
+    if( method == CV_TM_CCOEFF )
+        templMean = mean(templ);
+    else
+    {
+        meanStdDev( templ, templMean, templSdv );
+
+        templNorm = templSdv[0]*templSdv[0] + templSdv[1]*templSdv[1] + templSdv[2]*templSdv[2] + templSdv[3]*templSdv[3];
+
+        if( templNorm < DBL_EPSILON && method == CV_TM_CCOEFF_NORMED )
+        {
+            result = Scalar::all(1);
+            return;
+        }
+
+        templSum2 = templNorm + templMean[0]*templMean[0] + templMean[1]*templMean[1] + templMean[2]*templMean[2] + templMean[3]*templMean[3];
+
+        if( numType != 1 )
+        {
+            templMean = Scalar::all(0);
+            templNorm = templSum2;
+        }
+
+        templSum2 /= invArea;
+        templNorm = std::sqrt(templNorm);
+        templNorm /= std::sqrt(invArea); // care of accuracy here
+
+        q0 = (double*)sqsum.data;
+        q1 = q0 + templ.cols*cn;
+        q2 = (double*)(sqsum.data + templ.rows*sqsum.step);
+        q3 = q2 + templ.cols*cn;
+    }
+
+    double* p0 = (double*)sum.data;
+    double* p1 = p0 + templ.cols*cn;
+    double* p2 = (double*)(sum.data + templ.rows*sum.step);
+    double* p3 = p2 + templ.cols*cn;
+
+    int sumstep = sum.data ? (int)(sum.step / sizeof(double)) : 0;
+    int sqstep = sqsum.data ? (int)(sqsum.step / sizeof(double)) : 0;
+
+    int i, j, k;
+
+    for( i = 0; i < result.rows; i++ )
+    {
+        float* rrow = result.ptr<float>(i);
+        int idx = i * sumstep;
+        int idx2 = i * sqstep;
+
+        for( j = 0; j < result.cols; j++, idx += cn, idx2 += cn )
+        {
+            double num = rrow[j], t;
+            double wndMean2 = 0, wndSum2 = 0;
+
+            if( numType == 1 )
+            {
+                for( k = 0; k < cn; k++ )
+                {
+                    t = p0[idx+k] - p1[idx+k] - p2[idx+k] + p3[idx+k];
+                    wndMean2 += t*t;
+                    num -= t*templMean[k];
+                }
+
+                wndMean2 *= invArea;
+            }
+
+            if( isNormed || numType == 2 )
+            {
+                for( k = 0; k < cn; k++ )
+                {
+                    t = q0[idx2+k] - q1[idx2+k] - q2[idx2+k] + q3[idx2+k];
+                    wndSum2 += t;
+                }
+
+                if( numType == 2 )
+                {
+                    num = wndSum2 - 2*num + templSum2;
+                    num = MAX(num, 0.);
+                }
+            }
+
+            if( isNormed )
+            {
+                t = std::sqrt(MAX(wndSum2 - wndMean2,0))*templNorm;
+                if( fabs(num) < t )
+                    num /= t;
+                else if( fabs(num) < t*1.125 )
+                    num = num > 0 ? 1 : -1;
+                else
+                    num = method != CV_TM_SQDIFF_NORMED ? 0 : 1;
+            }
+
+            rrow[j] = (float)num;
+        }
+    }
+}
+
+struct MatchPeakGreater
+{
+    bool operator()( const std::pair<float, int>& a, const std::pair<float, int>& b ) const
+    {
+        return a.first > b.first || (a.first == b.first && a.second < b.second);
+    }
+};
+
+/*
+Finds the topK best local extrema (maximums, or minimums for the CV_TM_SQDIFF* methods)
+of the result map, the ties being resolved in favor of the first one in raster order.
+*/
+static void findMatchPeaks( const Mat& result, int method, int topK,
+                            std::vector<Point>& locations, std::vector<float>& scores )
+{
+    float sign = method == CV_TM_SQDIFF || method == CV_TM_SQDIFF_NORMED ? -1.f : 1.f;
+    int rows = result.rows, cols = result.cols;
+    std::vector<std::pair<float, int> > peaks;
+
+    for( int y = 0; y < rows; y++ )
+    {
+        const float* rrow = result.ptr<float>(y);
+        for( int x = 0; x < cols; x++ )
+        {
+            float v = sign*rrow[x];
+            bool isPeak = true;
+            for( int dy = -1; dy <= 1 && isPeak; dy++ )
+            {
+                if( (unsigned)(y + dy) >= (unsigned)rows )
+                    continue;
+                const float* nrow = result.ptr<float>(y + dy);
+                for( int dx = -1; dx <= 1; dx++ )
+                    if( (unsigned)(x + dx) < (unsigned)cols && sign*nrow[x + dx] > v )
+                    {
+                        isPeak = false;
+                        break;
+                    }
+            }
+            if( isPeak )
+                peaks.push_back(std::make_pair(v, y*cols + x));
+        }
+    }
+
+    int npeaks = std::min(topK, (int)peaks.size());
+    std::partial_sort(peaks.begin(), peaks.begin() + npeaks, peaks.end(), MatchPeakGreater());
+
+    locations.resize(npeaks);
+    scores.resize(npeaks);
+    for( int i = 0; i < npeaks; i++ )
+    {
+        locations[i] = Point(peaks[i].second % cols, peaks[i].second / cols);
+        scores[i] = sign*peaks[i].first;
+    }
+}
+
+/*
+Matches every template with the image; the templates of the same size share the image
+spectra and all of them share the integral images. Either the dense result maps or the
+topK peaks of each map are stored.
+*/
+class MatchTemplateBatchInvoker : public ParallelLoopBody
+{
+public:
+    MatchTemplateBatchInvoker( const std::vector<Mat>& _templs, const std::vector<CrossCorrSpectra>& _spectra,
+                               const std::vector<int>& _sizeIdx, const Mat& _sum, const Mat& _sqsum,
+                               int _method, int _topK, std::vector<Mat>& _results,
+                               std::vector<std::vector<Point> >& _locations,
+                               std::vector<std::vector<float> >& _scores )
+        : templs(_templs), spectra(_spectra), sizeIdx(_sizeIdx), sum(_sum), sqsum(_sqsum),
+          method(_method), topK(_topK), results(_results), locations(_locations), scores(_scores)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        Mat buf;
+        for( int i = range.start; i < range.end; i++ )
+        {
+            Mat& result = topK > 0 ? buf : results[i];
+            spectra[sizeIdx[i]].correlate(templs[i], result);
+            if( method != CV_TM_CCORR )
+                normalizeMatchResult(sum, sqsum, templs[i], result, method);
+            if( topK > 0 )
+                findMatchPeaks(result, method, topK, locations[i], scores[i]);
+        }
+    }
+
+private:
+    const std::vector<Mat>& templs;
+    const std::vector<CrossCorrSpectra>& spectra;
+    const std::vector<int>& sizeIdx;
+    const Mat& sum;
+    const Mat& sqsum;
+    int method, topK;
+    std::vector<Mat>& results;
+    std::vector<std::vector<Point> >& locations;
+    std::vector<std::vector<float> >& scores;
+};
+
+static void matchTemplateBatch_( const Mat& img, const std::vector<Mat>& templs, int method, int topK,
+                                 std::vector<Mat>& results, std::vector<std::vector<Point> >& locations,
+                                 std::vector<std::vector<float> >& scores )
+{
+    int type = img.type(), depth = CV_MAT_DEPTH(type);
+    CV_Assert( CV_TM_SQDIFF <= method && method <= CV_TM_CCOEFF_NORMED );
+    CV_Assert( (depth == CV_8U || depth == CV_32F) && img.dims <= 2 );
+
+    int i, ntempls = (int)templs.size();
+    std::vector<Size> sizes;
+    std::vector<int> sizeIdx(ntempls);
+    for( i = 0; i < ntempls; i++ )
+    {
+        const Mat& templ = templs[i];
+        CV_Assert( templ.type() == type && !templ.empty() &&
+                   templ.cols <= img.cols && templ.rows <= img.rows );
+        sizeIdx[i] = (int)(std::find(sizes.begin(), sizes.end(), templ.size()) - sizes.begin());
+        if( sizeIdx[i] == (int)sizes.size() )
+            sizes.push_back(templ.size());
+    }
+
+    std::vector<CrossCorrSpectra> spectra(sizes.size());
+    for( size_t j = 0; j < sizes.size(); j++ )
+        spectra[j].create(img, sizes[j]);
+
+    Mat sum, sqsum;
+    if( method == CV_TM_CCOEFF )
+        integral(img, sum, CV_64F);
+    else if( method != CV_TM_CCORR )
+        integral(img, sum, sqsum, CV_64F);
+
+    if( topK > 0 )
+    {
+        locations.resize(ntempls);
+        scores.resize(ntempls);
+    }
+
+    parallel_for_(Range(0, ntempls),
+                  MatchTemplateBatchInvoker(templs, spectra, sizeIdx, sum, sqsum, method, topK,
+                                            results, locations, scores),
+                  ntempls);
+}
+
 static void matchTemplateMask( InputArray _img, InputArray _templ, OutputArray _result, int method, InputArray _mask )
 {
     int type = _img.type(), depth = CV_MAT_DEPTH(type), cn = CV_MAT_CN(type);
@@ -905,7 +1327,7 @@ void cv::matchTemplate( InputArray _img, InputArray _templ, OutputArray _result,
         return;
     }
 
-    int type = _img.type(), depth = CV_MAT_DEPTH(type), cn = CV_MAT_CN(type);
+    int type = _img.type(), depth = CV_MAT_DEPTH(type);
     CV_Assert( CV_TM_SQDIFF <= method && method <= CV_TM_CCOEFF_NORMED );
     CV_Assert( (depth == CV_8U || depth == CV_32F) && type == _templ.type() && _img.dims() <= 2 );
 
@@ -918,12 +1340,6 @@ void cv::matchTemplate( InputArray _img, InputArray _templ, OutputArray _result,
     CV_OCL_RUN(_img.dims() <= 2 && _result.isUMat(),
                (!needswap ? ocl_matchTemplate(_img, _templ, _result, method) : ocl_matchTemplate(_templ, _img, _result, method)))
 
-    int numType = method == CV_TM_CCORR || method == CV_TM_CCORR_NORMED ? 0 :
-                  method == CV_TM_CCOEFF || method == CV_TM_CCOEFF_NORMED ? 1 : 2;
-    bool isNormed = method == CV_TM_CCORR_NORMED ||
-                    method == CV_TM_SQDIFF_NORMED ||
-                    method == CV_TM_CCOEFF_NORMED;
-
     Mat img = _img.getMat(), templ = _templ.getMat();
     if (needswap)
         std::swap(img, templ);
@@ -943,7 +1359,7 @@ void cv::matchTemplate( InputArray _img, InputArray _templ, OutputArray _result,
     {
         useIppMT = (templ.rows < img.rows/2 && templ.cols < img.cols/2);
 
-        if (method == CV_TM_SQDIFF && cn == 1 && useIppMT)
+        if (method == CV_TM_SQDIFF && img.channels() == 1 && useIppMT)
         {
             if (ipp_sqrDistance(img, templ, result))
             {
@@ -956,7 +1372,7 @@ void cv::matchTemplate( InputArray _img, InputArray _templ, OutputArray _result,
 #endif
 
 #if defined HAVE_IPP
-    if (cn == 1 && useIppMT)
+    if (img.channels() == 1 && useIppMT)
     {
         if (!ipp_crossCorr(img, templ, result))
         {
@@ -975,111 +1391,49 @@ void cv::matchTemplate( InputArray _img, InputArray _templ, OutputArray _result,
     if( method == CV_TM_CCORR )
         return;
 
-    double invArea = 1./((double)templ.rows * templ.cols);
-
     Mat sum, sqsum;
-    Scalar templMean, templSdv;
-    double *q0 = 0, *q1 = 0, *q2 = 0, *q3 = 0;
-    double templNorm = 0, templSum2 = 0;
-
     if( method == CV_TM_CCOEFF )
-    {
         integral(img, sum, CV_64F);
-        templMean = mean(templ);
-    }
     else
-    {
         integral(img, sum, sqsum, CV_64F);
-        meanStdDev( templ, templMean, templSdv );
-
-        templNorm = templSdv[0]*templSdv[0] + templSdv[1]*templSdv[1] + templSdv[2]*templSdv[2] + templSdv[3]*templSdv[3];
 
-        if( templNorm < DBL_EPSILON && method == CV_TM_CCOEFF_NORMED )
-        {
-            result = Scalar::all(1);
-            return;
-        }
-
-        templSum2 = templNorm + templMean[0]*templMean[0] + templMean[1]*templMean[1] + templMean[2]*templMean[2] + templMean[3]*templMean[3];
-
-        if( numType != 1 )
-        {
-            templMean = Scalar::all(0);
-            templNorm = templSum2;
-        }
-
-        templSum2 /= invArea;
-        templNorm = std::sqrt(templNorm);
-        templNorm /= std::sqrt(invArea); // care of accuracy here
-
-        q0 = (double*)sqsum.data;
-        q1 = q0 + templ.cols*cn;
-        q2 = (double*)(sqsum.data + templ.rows*sqsum.step);
-        q3 = q2 + templ.cols*cn;
-    }
-
-    double* p0 = (double*)sum.data;
-    double* p1 = p0 + templ.cols*cn;
-    double* p2 = (double*)(sum.data + templ.rows*sum.step);
-    double* p3 = p2 + templ.cols*cn;
+    normalizeMatchResult(sum, sqsum, templ, result, method);
+}
 
-    int sumstep = sum.data ? (int)(sum.step / sizeof(double)) : 0;
-    int sqstep = sqsum.data ? (int)(sqsum.step / sizeof(double)) : 0;
 
-    int i, j, k;
-
-    for( i = 0; i < result.rows; i++ )
+void cv::matchTemplateBatch( InputArray _img, InputArrayOfArrays _templs,
+                             OutputArrayOfArrays _results, int method )
+{
+    Mat img = _img.getMat();
+    std::vector<Mat> templs, results;
+    _templs.getMatVector(templs);
+
+    int i, ntempls = (int)templs.size();
+    _results.create(ntempls, 1, CV_32F);
+    results.resize(ntempls);
+    for( i = 0; i < ntempls; i++ )
     {
-        float* rrow = result.ptr<float>(i);
-        int idx = i * sumstep;
-        int idx2 = i * sqstep;
-
-        for( j = 0; j < result.cols; j++, idx += cn, idx2 += cn )
-        {
-            double num = rrow[j], t;
-            double wndMean2 = 0, wndSum2 = 0;
-
-            if( numType == 1 )
-            {
-                for( k = 0; k < cn; k++ )
-                {
-                    t = p0[idx+k] - p1[idx+k] - p2[idx+k] + p3[idx+k];
-                    wndMean2 += t*t;
-                    num -= t*templMean[k];
-                }
-
-                wndMean2 *= invArea;
-            }
+        CV_Assert( templs[i].cols <= img.cols && templs[i].rows <= img.rows );
+        _results.create(img.rows - templs[i].rows + 1, img.cols - templs[i].cols + 1, CV_32F, i);
+        results[i] = _results.getMat(i);
+    }
 
-            if( isNormed || numType == 2 )
-            {
-                for( k = 0; k < cn; k++ )
-                {
-                    t = q0[idx2+k] - q1[idx2+k] - q2[idx2+k] + q3[idx2+k];
-                    wndSum2 += t;
-                }
+    std::vector<std::vector<Point> > locations;
+    std::vector<std::vector<float> > scores;
+    matchTemplateBatch_(img, templs, method, 0, results, locations, scores);
+}
 
-                if( numType == 2 )
-                {
-                    num = wndSum2 - 2*num + templSum2;
-                    num = MAX(num, 0.);
-                }
-            }
+void cv::matchTemplateBatch( InputArray _img, InputArrayOfArrays _templs, int method, int topK,
+                             std::vector<std::vector<Point> >& locations,
+                             std::vector<std::vector<float> >& scores )
+{
+    CV_Assert( topK > 0 );
 
-            if( isNormed )
-            {
-                t = std::sqrt(MAX(wndSum2 - wndMean2,0))*templNorm;
-                if( fabs(num) < t )
-                    num /= t;
-                else if( fabs(num) < t*1.125 )
-                    num = num > 0 ? 1 : -1;
-                else
-                    num = method != CV_TM_SQDIFF_NORMED ? 0 : 1;
-            }
+    Mat img = _img.getMat();
+    std::vector<Mat> templs, results;
+    _templs.getMatVector(templs);
 
-            rrow[j] = (float)num;
-        }
-    }
+    matchTemplateBatch_(img, templs, method, topK, results, locations, scores);
 }
 
 
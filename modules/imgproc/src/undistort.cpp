@@ -59,6 +59,141 @@ cv::Mat cv::getDefaultNewCameraMatrix( InputArray _cameraMatrix, Size imgsize,
     return newCameraMatrix;
 }
 
+namespace cv
+{
+
+class UndistortMapInvoker : public ParallelLoopBody
+{
+public:
+    UndistortMapInvoker( Mat& _map1, Mat& _map2, const double* _ir, const double* _k,
+                         double _u0, double _v0, double _fx, double _fy )
+        : map1(&_map1), map2(&_map2), ir(_ir), k(_k), u0(_u0), v0(_v0), fx(_fx), fy(_fy) {}
+
+    void operator()( const Range& range ) const
+    {
+        int m1type = map1->type(), width = map1->cols;
+        double k1 = k[0], k2 = k[1], p1 = k[2], p2 = k[3], k3 = k[4], k4 = k[5], k5 = k[6], k6 = k[7];
+        double s1 = k[8], s2 = k[9], s3 = k[10], s4 = k[11];
+#if CV_SSE2
+        bool useSSE2 = checkHardwareSupport(CV_CPU_SSE2);
+        __m128d v_1 = _mm_set1_pd(1.), v_2 = _mm_set1_pd(2.);
+        __m128d v_k1 = _mm_set1_pd(k1), v_k2 = _mm_set1_pd(k2), v_k3 = _mm_set1_pd(k3);
+        __m128d v_k4 = _mm_set1_pd(k4), v_k5 = _mm_set1_pd(k5), v_k6 = _mm_set1_pd(k6);
+        __m128d v_p1 = _mm_set1_pd(p1), v_p2 = _mm_set1_pd(p2);
+        __m128d v_s1 = _mm_set1_pd(s1), v_s2 = _mm_set1_pd(s2), v_s3 = _mm_set1_pd(s3), v_s4 = _mm_set1_pd(s4);
+        __m128d v_fx = _mm_set1_pd(fx), v_fy = _mm_set1_pd(fy), v_u0 = _mm_set1_pd(u0), v_v0 = _mm_set1_pd(v0);
+        __m128d v_tab = _mm_set1_pd(INTER_TAB_SIZE);
+        __m128d v_intmin = _mm_set1_pd((double)INT_MIN), v_intmax = _mm_set1_pd((double)INT_MAX);
+        __m128i v_tabmask = _mm_set1_epi32(INTER_TAB_SIZE-1);
+#endif
+
+        for( int i = range.start; i < range.end; i++ )
+        {
+            float* m1f = map1->ptr<float>(i);
+            float* m2f = map2->empty() ? 0 : map2->ptr<float>(i);
+            short* m1 = (short*)m1f;
+            ushort* m2 = (ushort*)m2f;
+            double _x = i*ir[1] + ir[2], _y = i*ir[4] + ir[5], _w = i*ir[7] + ir[8];
+            int j = 0;
+
+#if CV_SSE2
+            if( useSSE2 )
+            {
+                // the same operations as in the scalar loop below, for two pixels at once
+                for( ; j <= width - 2; j += 2 )
+                {
+                    double x1 = _x + ir[0], y1 = _y + ir[3], w1 = _w + ir[6];
+                    __m128d v_w = _mm_div_pd(v_1, _mm_set_pd(w1, _w));
+                    __m128d v_x = _mm_mul_pd(_mm_set_pd(x1, _x), v_w);
+                    __m128d v_y = _mm_mul_pd(_mm_set_pd(y1, _y), v_w);
+                    _x = x1 + ir[0]; _y = y1 + ir[3]; _w = w1 + ir[6];
+
+                    __m128d v_x2 = _mm_mul_pd(v_x, v_x), v_y2 = _mm_mul_pd(v_y, v_y);
+                    __m128d v_r2 = _mm_add_pd(v_x2, v_y2);
+                    __m128d v_2xy = _mm_mul_pd(_mm_mul_pd(v_2, v_x), v_y);
+                    __m128d v_num = _mm_add_pd(_mm_mul_pd(v_k3, v_r2), v_k2);
+                    v_num = _mm_add_pd(_mm_mul_pd(v_num, v_r2), v_k1);
+                    v_num = _mm_add_pd(v_1, _mm_mul_pd(v_num, v_r2));
+                    __m128d v_den = _mm_add_pd(_mm_mul_pd(v_k6, v_r2), v_k5);
+                    v_den = _mm_add_pd(_mm_mul_pd(v_den, v_r2), v_k4);
+                    v_den = _mm_add_pd(v_1, _mm_mul_pd(v_den, v_r2));
+                    __m128d v_kr = _mm_div_pd(v_num, v_den);
+
+                    __m128d v_u = _mm_add_pd(_mm_mul_pd(v_x, v_kr), _mm_mul_pd(v_p1, v_2xy));
+                    v_u = _mm_add_pd(v_u, _mm_mul_pd(v_p2, _mm_add_pd(v_r2, _mm_mul_pd(v_2, v_x2))));
+                    v_u = _mm_add_pd(_mm_add_pd(v_u, _mm_mul_pd(v_s1, v_r2)), _mm_mul_pd(_mm_mul_pd(v_s2, v_r2), v_r2));
+                    v_u = _mm_add_pd(_mm_mul_pd(v_fx, v_u), v_u0);
+                    __m128d v_v = _mm_add_pd(_mm_mul_pd(v_y, v_kr), _mm_mul_pd(v_p1, _mm_add_pd(v_r2, _mm_mul_pd(v_2, v_y2))));
+                    v_v = _mm_add_pd(v_v, _mm_mul_pd(v_p2, v_2xy));
+                    v_v = _mm_add_pd(_mm_add_pd(v_v, _mm_mul_pd(v_s3, v_r2)), _mm_mul_pd(_mm_mul_pd(v_s4, v_r2), v_r2));
+                    v_v = _mm_add_pd(_mm_mul_pd(v_fy, v_v), v_v0);
+
+                    if( m1type == CV_16SC2 )
+                    {
+                        // clamp first: out-of-range values would be converted to INT_MIN
+                        __m128i v_iu = _mm_cvtpd_epi32(_mm_min_pd(_mm_max_pd(_mm_mul_pd(v_u, v_tab), v_intmin), v_intmax));
+                        __m128i v_iv = _mm_cvtpd_epi32(_mm_min_pd(_mm_max_pd(_mm_mul_pd(v_v, v_tab), v_intmin), v_intmax));
+                        // the integer parts are truncated to 16 bits, as the scalar (short) casts do
+                        __m128i v_xy = _mm_srai_epi32(_mm_unpacklo_epi32(v_iu, v_iv), INTER_BITS);
+                        v_xy = _mm_srai_epi32(_mm_slli_epi32(v_xy, 16), 16);
+                        _mm_storel_epi64((__m128i*)(m1 + j*2), _mm_packs_epi32(v_xy, v_xy));
+                        __m128i v_fxy = _mm_add_epi32(_mm_slli_epi32(_mm_and_si128(v_iv, v_tabmask), INTER_BITS),
+                                                      _mm_and_si128(v_iu, v_tabmask));
+                        v_fxy = _mm_packs_epi32(v_fxy, v_fxy);
+                        m2[j] = (ushort)_mm_extract_epi16(v_fxy, 0);
+                        m2[j+1] = (ushort)_mm_extract_epi16(v_fxy, 1);
+                    }
+                    else if( m1type == CV_32FC1 )
+                    {
+                        _mm_storel_pi((__m64*)(m1f + j), _mm_cvtpd_ps(v_u));
+                        _mm_storel_pi((__m64*)(m2f + j), _mm_cvtpd_ps(v_v));
+                    }
+                    else
+                        _mm_storeu_ps(m1f + j*2, _mm_unpacklo_ps(_mm_cvtpd_ps(v_u), _mm_cvtpd_ps(v_v)));
+                }
+            }
+#endif
+
+            for( ; j < width; j++, _x += ir[0], _y += ir[3], _w += ir[6] )
+            {
+                double w = 1./_w, x = _x*w, y = _y*w;
+                double x2 = x*x, y2 = y*y;
+                double r2 = x2 + y2, _2xy = 2*x*y;
+                double kr = (1 + ((k3*r2 + k2)*r2 + k1)*r2)/(1 + ((k6*r2 + k5)*r2 + k4)*r2);
+                double u = fx*(x*kr + p1*_2xy + p2*(r2 + 2*x2) + s1*r2+s2*r2*r2) + u0;
+                double v = fy*(y*kr + p1*(r2 + 2*y2) + p2*_2xy + s3*r2+s4*r2*r2) + v0;
+                if( m1type == CV_16SC2 )
+                {
+                    int iu = saturate_cast<int>(std::min(std::max(u*INTER_TAB_SIZE, (double)INT_MIN), (double)INT_MAX));
+                    int iv = saturate_cast<int>(std::min(std::max(v*INTER_TAB_SIZE, (double)INT_MIN), (double)INT_MAX));
+                    m1[j*2] = (short)(iu >> INTER_BITS);
+                    m1[j*2+1] = (short)(iv >> INTER_BITS);
+                    m2[j] = (ushort)((iv & (INTER_TAB_SIZE-1))*INTER_TAB_SIZE + (iu & (INTER_TAB_SIZE-1)));
+                }
+                else if( m1type == CV_32FC1 )
+                {
+                    m1f[j] = (float)u;
+                    m2f[j] = (float)v;
+                }
+                else
+                {
+                    m1f[j*2] = (float)u;
+                    m1f[j*2+1] = (float)v;
+                }
+            }
+        }
+    }
+
+protected:
+    Mat* map1;
+    Mat* map2;
+    const double* ir;
+    const double* k;
+    double u0, v0, fx, fy;
+};
+
+}
+
 void cv::initUndistortRectifyMap( InputArray _cameraMatrix, InputArray _distCoeffs,
                               InputArray _matR, InputArray _newCameraMatrix,
                               Size size, int m1type, OutputArray _map1, OutputArray _map2 )
@@ -115,55 +250,13 @@ void cv::initUndistortRectifyMap( InputArray _cameraMatrix, InputArray _distCoef
         distCoeffs = distCoeffs.t();
 
     const double* const distPtr = distCoeffs.ptr<double>();
-    double k1 = distPtr[0];
-    double k2 = distPtr[1];
-    double p1 = distPtr[2];
-    double p2 = distPtr[3];
-    double k3 = distCoeffs.cols + distCoeffs.rows - 1 >= 5 ? distPtr[4] : 0.;
-    double k4 = distCoeffs.cols + distCoeffs.rows - 1 >= 8 ? distPtr[5] : 0.;
-    double k5 = distCoeffs.cols + distCoeffs.rows - 1 >= 8 ? distPtr[6] : 0.;
-    double k6 = distCoeffs.cols + distCoeffs.rows - 1 >= 8 ? distPtr[7] : 0.;
-    double s1 = distCoeffs.cols + distCoeffs.rows - 1 >= 12 ? distPtr[8] : 0.;
-    double s2 = distCoeffs.cols + distCoeffs.rows - 1 >= 12 ? distPtr[9] : 0.;
-    double s3 = distCoeffs.cols + distCoeffs.rows - 1 >= 12 ? distPtr[10] : 0.;
-    double s4 = distCoeffs.cols + distCoeffs.rows - 1 >= 12 ? distPtr[11] : 0.;
-
-    for( int i = 0; i < size.height; i++ )
-    {
-        float* m1f = map1.ptr<float>(i);
-        float* m2f = map2.empty() ? 0 : map2.ptr<float>(i);
-        short* m1 = (short*)m1f;
-        ushort* m2 = (ushort*)m2f;
-        double _x = i*ir[1] + ir[2], _y = i*ir[4] + ir[5], _w = i*ir[7] + ir[8];
+    int ncoeffs = distCoeffs.cols + distCoeffs.rows - 1;
+    double k[12] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+    for( int i = 0; i < ncoeffs; i++ )
+        k[i] = distPtr[i];
 
-        for( int j = 0; j < size.width; j++, _x += ir[0], _y += ir[3], _w += ir[6] )
-        {
-            double w = 1./_w, x = _x*w, y = _y*w;
-            double x2 = x*x, y2 = y*y;
-            double r2 = x2 + y2, _2xy = 2*x*y;
-            double kr = (1 + ((k3*r2 + k2)*r2 + k1)*r2)/(1 + ((k6*r2 + k5)*r2 + k4)*r2);
-            double u = fx*(x*kr + p1*_2xy + p2*(r2 + 2*x2) + s1*r2+s2*r2*r2) + u0;
-            double v = fy*(y*kr + p1*(r2 + 2*y2) + p2*_2xy + s3*r2+s4*r2*r2) + v0;
-            if( m1type == CV_16SC2 )
-            {
-                int iu = saturate_cast<int>(u*INTER_TAB_SIZE);
-                int iv = saturate_cast<int>(v*INTER_TAB_SIZE);
-                m1[j*2] = (short)(iu >> INTER_BITS);
-                m1[j*2+1] = (short)(iv >> INTER_BITS);
-                m2[j] = (ushort)((iv & (INTER_TAB_SIZE-1))*INTER_TAB_SIZE + (iu & (INTER_TAB_SIZE-1)));
-            }
-            else if( m1type == CV_32FC1 )
-            {
-                m1f[j] = (float)u;
-                m2f[j] = (float)v;
-            }
-            else
-            {
-                m1f[j*2] = (float)u;
-                m1f[j*2+1] = (float)v;
-            }
-        }
-    }
+    parallel_for_(Range(0, size.height), UndistortMapInvoker(map1, map2, ir, k, u0, v0, fx, fy),
+                  size.area()/(double)(1 << 14));
 }
 
 
@@ -262,20 +355,174 @@ cvInitUndistortRectifyMap( const CvMat* Aarr, const CvMat* dist_coeffs,
 }
 
 
-void cvUndistortPoints( const CvMat* _src, CvMat* _dst, const CvMat* _cameraMatrix,
+namespace cv
+{
+
+class UndistortPointsInvoker : public ParallelLoopBody
+{
+public:
+    UndistortPointsInvoker( const CvMat* _src, CvMat* _dst, const double* _A, const double* _RR,
+                            const double* _k, int _iters, double _eps )
+        : src(_src), dst(_dst), A(_A), RR(_RR), k(_k), iters(_iters), eps(_eps) {}
+
+    void operator()( const Range& range ) const
+    {
+        const Point2f* srcf = (const Point2f*)src->data.ptr;
+        const Point2d* srcd = (const Point2d*)src->data.ptr;
+        Point2f* dstf = (Point2f*)dst->data.ptr;
+        Point2d* dstd = (Point2d*)dst->data.ptr;
+        int stype = CV_MAT_TYPE(src->type), dtype = CV_MAT_TYPE(dst->type);
+        int sstep = src->rows == 1 ? 1 : src->step/CV_ELEM_SIZE(stype);
+        int dstep = dst->rows == 1 ? 1 : dst->step/CV_ELEM_SIZE(dtype);
+        double fx = A[0], fy = A[4], ifx = 1./fx, ify = 1./fy, cx = A[2], cy = A[5];
+        int i = range.start, j;
+
+#if CV_SSE2
+        if( checkHardwareSupport(CV_CPU_SSE2) )
+        {
+            // the same operations as in the scalar loop below, for two points at once
+            __m128d v_1 = _mm_set1_pd(1.), v_2 = _mm_set1_pd(2.), v_eps = _mm_set1_pd(eps);
+            __m128d v_absmask = _mm_castsi128_pd(_mm_srli_epi64(_mm_set1_epi32(-1), 1));
+            __m128d v_cx = _mm_set1_pd(cx), v_cy = _mm_set1_pd(cy), v_ifx = _mm_set1_pd(ifx), v_ify = _mm_set1_pd(ify);
+            __m128d v_k[12];
+            for( j = 0; j < 12; j++ )
+                v_k[j] = _mm_set1_pd(k[j]);
+            __m128d v_2k2 = _mm_set1_pd(2*k[2]), v_2k3 = _mm_set1_pd(2*k[3]);
+
+            for( ; i <= range.end - 2; i += 2 )
+            {
+                __m128d v_x, v_y;
+                if( stype == CV_32FC2 )
+                {
+                    v_x = _mm_set_pd(srcf[(i+1)*sstep].x, srcf[i*sstep].x);
+                    v_y = _mm_set_pd(srcf[(i+1)*sstep].y, srcf[i*sstep].y);
+                }
+                else
+                {
+                    __m128d v_p0 = _mm_loadu_pd(&srcd[i*sstep].x), v_p1 = _mm_loadu_pd(&srcd[(i+1)*sstep].x);
+                    v_x = _mm_unpacklo_pd(v_p0, v_p1);
+                    v_y = _mm_unpackhi_pd(v_p0, v_p1);
+                }
+
+                v_x = _mm_mul_pd(_mm_sub_pd(v_x, v_cx), v_ifx);
+                v_y = _mm_mul_pd(_mm_sub_pd(v_y, v_cy), v_ify);
+                __m128d v_x0 = v_x, v_y0 = v_y, v_done = _mm_setzero_pd();
+
+                for( j = 0; j < iters; j++ )
+                {
+                    __m128d v_r2 = _mm_add_pd(_mm_mul_pd(v_x, v_x), _mm_mul_pd(v_y, v_y));
+                    __m128d v_num = _mm_add_pd(_mm_mul_pd(v_k[7], v_r2), v_k[6]);
+                    v_num = _mm_add_pd(v_1, _mm_mul_pd(_mm_add_pd(_mm_mul_pd(v_num, v_r2), v_k[5]), v_r2));
+                    __m128d v_den = _mm_add_pd(_mm_mul_pd(v_k[4], v_r2), v_k[1]);
+                    v_den = _mm_add_pd(v_1, _mm_mul_pd(_mm_add_pd(_mm_mul_pd(v_den, v_r2), v_k[0]), v_r2));
+                    __m128d v_icdist = _mm_div_pd(v_num, v_den);
+                    __m128d v_dx = _mm_add_pd(_mm_mul_pd(_mm_mul_pd(v_2k2, v_x), v_y),
+                                              _mm_mul_pd(v_k[3], _mm_add_pd(v_r2, _mm_mul_pd(_mm_mul_pd(v_2, v_x), v_x))));
+                    v_dx = _mm_add_pd(_mm_add_pd(v_dx, _mm_mul_pd(v_k[8], v_r2)), _mm_mul_pd(_mm_mul_pd(v_k[9], v_r2), v_r2));
+                    __m128d v_dy = _mm_add_pd(_mm_mul_pd(v_k[2], _mm_add_pd(v_r2, _mm_mul_pd(_mm_mul_pd(v_2, v_y), v_y))),
+                                              _mm_mul_pd(_mm_mul_pd(v_2k3, v_x), v_y));
+                    v_dy = _mm_add_pd(_mm_add_pd(v_dy, _mm_mul_pd(v_k[10], v_r2)), _mm_mul_pd(_mm_mul_pd(v_k[11], v_r2), v_r2));
+                    __m128d v_xn = _mm_mul_pd(_mm_sub_pd(v_x0, v_dx), v_icdist);
+                    __m128d v_yn = _mm_mul_pd(_mm_sub_pd(v_y0, v_dy), v_icdist);
+                    __m128d v_change = _mm_max_pd(_mm_and_pd(_mm_sub_pd(v_xn, v_x), v_absmask),
+                                                  _mm_and_pd(_mm_sub_pd(v_yn, v_y), v_absmask));
+                    // a point that has converged keeps its value while the other one is refined
+                    v_x = _mm_or_pd(_mm_and_pd(v_done, v_x), _mm_andnot_pd(v_done, v_xn));
+                    v_y = _mm_or_pd(_mm_and_pd(v_done, v_y), _mm_andnot_pd(v_done, v_yn));
+                    v_done = _mm_or_pd(v_done, _mm_cmple_pd(v_change, v_eps));
+                    if( _mm_movemask_pd(v_done) == 3 )
+                        break;
+                }
+
+                double x[2], y[2];
+                _mm_storeu_pd(x, v_x);
+                _mm_storeu_pd(y, v_y);
+                for( j = 0; j < 2; j++ )
+                {
+                    double xx = RR[0]*x[j] + RR[1]*y[j] + RR[2];
+                    double yy = RR[3]*x[j] + RR[4]*y[j] + RR[5];
+                    double ww = 1./(RR[6]*x[j] + RR[7]*y[j] + RR[8]);
+                    if( dtype == CV_32FC2 )
+                        dstf[(i+j)*dstep] = Point2f((float)(xx*ww), (float)(yy*ww));
+                    else
+                        dstd[(i+j)*dstep] = Point2d(xx*ww, yy*ww);
+                }
+            }
+        }
+#endif
+
+        for( ; i < range.end; i++ )
+        {
+            double x, y, x0, y0;
+            if( stype == CV_32FC2 )
+            {
+                x = srcf[i*sstep].x;
+                y = srcf[i*sstep].y;
+            }
+            else
+            {
+                x = srcd[i*sstep].x;
+                y = srcd[i*sstep].y;
+            }
+
+            x0 = x = (x - cx)*ifx;
+            y0 = y = (y - cy)*ify;
+
+            // compensate distortion iteratively
+            for( j = 0; j < iters; j++ )
+            {
+                double r2 = x*x + y*y;
+                double icdist = (1 + ((k[7]*r2 + k[6])*r2 + k[5])*r2)/(1 + ((k[4]*r2 + k[1])*r2 + k[0])*r2);
+                double deltaX = 2*k[2]*x*y + k[3]*(r2 + 2*x*x)+ k[8]*r2+k[9]*r2*r2;
+                double deltaY = k[2]*(r2 + 2*y*y) + 2*k[3]*x*y+ k[10]*r2+k[11]*r2*r2;
+                double xn = (x0 - deltaX)*icdist, yn = (y0 - deltaY)*icdist;
+                bool converged = std::max(std::abs(xn - x), std::abs(yn - y)) <= eps;
+                x = xn;
+                y = yn;
+                if( converged )
+                    break;
+            }
+
+            double xx = RR[0]*x + RR[1]*y + RR[2];
+            double yy = RR[3]*x + RR[4]*y + RR[5];
+            double ww = 1./(RR[6]*x + RR[7]*y + RR[8]);
+            x = xx*ww;
+            y = yy*ww;
+
+            if( dtype == CV_32FC2 )
+            {
+                dstf[i*dstep].x = (float)x;
+                dstf[i*dstep].y = (float)y;
+            }
+            else
+            {
+                dstd[i*dstep].x = x;
+                dstd[i*dstep].y = y;
+            }
+        }
+    }
+
+protected:
+    const CvMat* src;
+    CvMat* dst;
+    const double* A;
+    const double* RR;
+    const double* k;
+    int iters;
+    double eps;
+};
+
+}
+
+static void cvUndistortPointsInternal( const CvMat* _src, CvMat* _dst, const CvMat* _cameraMatrix,
                    const CvMat* _distCoeffs,
-                   const CvMat* matR, const CvMat* matP )
+                   const CvMat* matR, const CvMat* matP, cv::TermCriteria criteria )
 {
-    double A[3][3], RR[3][3], k[12]={0,0,0,0,0,0,0,0,0,0,0}, fx, fy, ifx, ify, cx, cy;
+    double A[3][3], RR[3][3], k[12]={0,0,0,0,0,0,0,0,0,0,0};
     CvMat matA=cvMat(3, 3, CV_64F, A), _Dk;
     CvMat _RR=cvMat(3, 3, CV_64F, RR);
-    const CvPoint2D32f* srcf;
-    const CvPoint2D64f* srcd;
-    CvPoint2D32f* dstf;
-    CvPoint2D64f* dstd;
-    int stype, dtype;
-    int sstep, dstep;
-    int i, j, n, iters = 1;
+    int n, iters = 1;
+    double eps = -1;
 
     CV_Assert( CV_IS_MAT(_src) && CV_IS_MAT(_dst) &&
         (_src->rows == 1 || _src->cols == 1) &&
@@ -302,7 +549,10 @@ void cvUndistortPoints( const CvMat* _src, CvMat* _dst, const CvMat* _cameraMatr
             CV_MAKETYPE(CV_64F,CV_MAT_CN(_distCoeffs->type)), k);
 
         cvConvert( _distCoeffs, &_Dk );
-        iters = 5;
+        CV_Assert( (criteria.type & (cv::TermCriteria::COUNT + cv::TermCriteria::EPS)) != 0 );
+        iters = criteria.type & cv::TermCriteria::COUNT ? std::max(criteria.maxCount, 1) : 100;
+        if( criteria.type & cv::TermCriteria::EPS )
+            eps = std::max(criteria.epsilon, 0.);
     }
 
     if( matR )
@@ -322,69 +572,18 @@ void cvUndistortPoints( const CvMat* _src, CvMat* _dst, const CvMat* _cameraMatr
         cvMatMul( &_PP, &_RR, &_RR );
     }
 
-    srcf = (const CvPoint2D32f*)_src->data.ptr;
-    srcd = (const CvPoint2D64f*)_src->data.ptr;
-    dstf = (CvPoint2D32f*)_dst->data.ptr;
-    dstd = (CvPoint2D64f*)_dst->data.ptr;
-    stype = CV_MAT_TYPE(_src->type);
-    dtype = CV_MAT_TYPE(_dst->type);
-    sstep = _src->rows == 1 ? 1 : _src->step/CV_ELEM_SIZE(stype);
-    dstep = _dst->rows == 1 ? 1 : _dst->step/CV_ELEM_SIZE(dtype);
-
     n = _src->rows + _src->cols - 1;
 
-    fx = A[0][0];
-    fy = A[1][1];
-    ifx = 1./fx;
-    ify = 1./fy;
-    cx = A[0][2];
-    cy = A[1][2];
-
-    for( i = 0; i < n; i++ )
-    {
-        double x, y, x0, y0;
-        if( stype == CV_32FC2 )
-        {
-            x = srcf[i*sstep].x;
-            y = srcf[i*sstep].y;
-        }
-        else
-        {
-            x = srcd[i*sstep].x;
-            y = srcd[i*sstep].y;
-        }
-
-        x0 = x = (x - cx)*ifx;
-        y0 = y = (y - cy)*ify;
-
-        // compensate distortion iteratively
-        for( j = 0; j < iters; j++ )
-        {
-            double r2 = x*x + y*y;
-            double icdist = (1 + ((k[7]*r2 + k[6])*r2 + k[5])*r2)/(1 + ((k[4]*r2 + k[1])*r2 + k[0])*r2);
-            double deltaX = 2*k[2]*x*y + k[3]*(r2 + 2*x*x)+ k[8]*r2+k[9]*r2*r2;
-            double deltaY = k[2]*(r2 + 2*y*y) + 2*k[3]*x*y+ k[10]*r2+k[11]*r2*r2;
-            x = (x0 - deltaX)*icdist;
-            y = (y0 - deltaY)*icdist;
-        }
-
-        double xx = RR[0][0]*x + RR[0][1]*y + RR[0][2];
-        double yy = RR[1][0]*x + RR[1][1]*y + RR[1][2];
-        double ww = 1./(RR[2][0]*x + RR[2][1]*y + RR[2][2]);
-        x = xx*ww;
-        y = yy*ww;
+    cv::parallel_for_(cv::Range(0, n), cv::UndistortPointsInvoker(_src, _dst, &A[0][0], &RR[0][0], k, iters, eps),
+                      n/(double)(1 << 12));
+}
 
-        if( dtype == CV_32FC2 )
-        {
-            dstf[i*dstep].x = (float)x;
-            dstf[i*dstep].y = (float)y;
-        }
-        else
-        {
-            dstd[i*dstep].x = x;
-            dstd[i*dstep].y = y;
-        }
-    }
+void cvUndistortPoints( const CvMat* _src, CvMat* _dst, const CvMat* _cameraMatrix,
+                   const CvMat* _distCoeffs,
+                   const CvMat* matR, const CvMat* matP )
+{
+    cvUndistortPointsInternal(_src, _dst, _cameraMatrix, _distCoeffs, matR, matP,
+                              cv::TermCriteria(cv::TermCriteria::COUNT, 5, 0));
 }
 
 
@@ -393,6 +592,17 @@ void cv::undistortPoints( InputArray _src, OutputArray _dst,
                           InputArray _distCoeffs,
                           InputArray _Rmat,
                           InputArray _Pmat )
+{
+    undistortPoints(_src, _dst, _cameraMatrix, _distCoeffs, _Rmat, _Pmat,
+                    TermCriteria(TermCriteria::COUNT, 5, 0));
+}
+
+void cv::undistortPoints( InputArray _src, OutputArray _dst,
+                          InputArray _cameraMatrix,
+                          InputArray _distCoeffs,
+                          InputArray _Rmat,
+                          InputArray _Pmat,
+                          TermCriteria criteria )
 {
     Mat src = _src.getMat(), cameraMatrix = _cameraMatrix.getMat();
     Mat distCoeffs = _distCoeffs.getMat(), R = _Rmat.getMat(), P = _Pmat.getMat();
@@ -411,7 +621,7 @@ void cv::undistortPoints( InputArray _src, OutputArray _dst,
         pP = &(matP = P);
     if( !distCoeffs.empty() )
         pD = &(_cdistCoeffs = distCoeffs);
-    cvUndistortPoints(&_csrc, &_cdst, &_ccameraMatrix, pD, pR, pP);
+    cvUndistortPointsInternal(&_csrc, &_cdst, &_ccameraMatrix, pD, pR, pP, criteria);
 }
 
 namespace cv
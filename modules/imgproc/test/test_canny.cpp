@@ -284,4 +284,26 @@ int CV_CannyTest::validate_test_results( int test_case_idx )
 
 TEST(Imgproc_Canny, accuracy) { CV_CannyTest test; test.safe_run(); }
 
+TEST(Imgproc_Canny, edgesCrossingBands)
+{
+    // a tall contour whose contrast grows from top to bottom, so that only its lower part
+    // is above the high threshold: the whole contour must be traced through all the bands
+    Mat mask(1600, 300, CV_8U, Scalar::all(0));
+    ellipse(mask, Point(150, 800), Size(100, 700), 0, 0, 360, Scalar::all(255), FILLED);
+    Mat img(mask.size(), CV_8U, Scalar::all(0));
+    for (int y = 0; y < img.rows; y++)
+        img.row(y).setTo(Scalar::all(40 + y/16), mask.row(y));
+
+    Mat edges, allEdges;
+    Canny(img, edges, 100, 700);
+    Canny(img, allEdges, 100, 101);
+
+    ASSERT_GT(countNonZero(allEdges), 2000);
+    EXPECT_EQ(0, cvtest::norm(edges, allEdges, NORM_INF));
+
+    Mat roiEdges;
+    Canny(img.rowRange(10, 1590), roiEdges, 100, 700);
+    EXPECT_EQ(0, cvtest::norm(roiEdges, edges.rowRange(10, 1590), NORM_INF));
+}
+
 /* End of file. */
@@ -105,3 +105,116 @@ void CV_ConnectedComponentsTest::run( int /* start_from */)
 }
 
 TEST(Imgproc_ConnectedComponents, regression) { CV_ConnectedComponentsTest test; test.safe_run(); }
+
+// flood fill labeling: components are numbered in the raster order of their first pixels
+static int connectedComponentsRef(const Mat& img, Mat& labels, Mat& stats, int connectivity)
+{
+    labels.create(img.size(), CV_32S);
+    labels = Scalar::all(-1);
+
+    int nlabels = 1;
+    std::vector<Point> stack;
+    for (int y = 0; y < img.rows; y++)
+        for (int x = 0; x < img.cols; x++)
+        {
+            if (labels.at<int>(y, x) >= 0)
+                continue;
+            if (img.at<uchar>(y, x) == 0)
+            {
+                labels.at<int>(y, x) = 0;
+                continue;
+            }
+            int l = nlabels++;
+            stack.push_back(Point(x, y));
+            labels.at<int>(y, x) = l;
+            while (!stack.empty())
+            {
+                Point p = stack.back();
+                stack.pop_back();
+                for (int dy = -1; dy <= 1; dy++)
+                    for (int dx = -1; dx <= 1; dx++)
+                    {
+                        Point q(p.x + dx, p.y + dy);
+                        if ((dx == 0 && dy == 0) || (connectivity == 4 && dx != 0 && dy != 0) ||
+                            !Rect(0, 0, img.cols, img.rows).contains(q) ||
+                            img.at<uchar>(q) == 0 || labels.at<int>(q) >= 0)
+                            continue;
+                        labels.at<int>(q) = l;
+                        stack.push_back(q);
+                    }
+            }
+        }
+
+    stats = Mat::zeros(nlabels, CC_STAT_MAX, CV_32S);
+    Mat br(nlabels, 2, CV_32S, Scalar::all(-1));
+    for (int l = 0; l < nlabels; l++)
+        stats.at<int>(l, CC_STAT_LEFT) = stats.at<int>(l, CC_STAT_TOP) = INT_MAX;
+    for (int y = 0; y < img.rows; y++)
+        for (int x = 0; x < img.cols; x++)
+        {
+            int l = labels.at<int>(y, x);
+            int* s = stats.ptr<int>(l);
+            s[CC_STAT_LEFT] = std::min(s[CC_STAT_LEFT], x);
+            s[CC_STAT_TOP] = std::min(s[CC_STAT_TOP], y);
+            br.at<int>(l, 0) = std::max(br.at<int>(l, 0), x);
+            br.at<int>(l, 1) = std::max(br.at<int>(l, 1), y);
+            s[CC_STAT_AREA]++;
+        }
+    for (int l = 0; l < nlabels; l++)
+    {
+        int* s = stats.ptr<int>(l);
+        s[CC_STAT_WIDTH] = br.at<int>(l, 0) - s[CC_STAT_LEFT] + 1;
+        s[CC_STAT_HEIGHT] = br.at<int>(l, 1) - s[CC_STAT_TOP] + 1;
+    }
+    return nlabels;
+}
+
+TEST(Imgproc_ConnectedComponents, sameAsFloodFill)
+{
+    RNG& rng = theRNG();
+    for (int iter = 0; iter < 60; iter++)
+    {
+        Mat img(rng.uniform(1, 400), rng.uniform(1, 400), CV_8UC1, Scalar::all(0));
+        if (iter % 3 == 0)
+        {
+            randu(img, 0, 256);
+            threshold(img, img, rng.uniform(50, 250), 255, THRESH_BINARY);
+        }
+        else
+        {
+            for (int k = 0; k < 40; k++)
+            {
+                Point c(rng.uniform(0, img.cols), rng.uniform(0, img.rows));
+                ellipse(img, c, Size(rng.uniform(1, 80), rng.uniform(1, 80)), rng.uniform(0, 180), 0, 360,
+                        Scalar::all(k % 3 ? 255 : 0), rng.uniform(-1, 3));
+            }
+        }
+
+        int connectivity = iter % 2 ? 4 : 8;
+        Mat labelsRef, statsRef;
+        int nRef = connectedComponentsRef(img, labelsRef, statsRef, connectivity);
+
+        Mat labels, labels16, stats, centroids;
+        int n = connectedComponentsWithStats(img, labels, stats, centroids, connectivity, CV_32S);
+        ASSERT_EQ(nRef, n) << "size: " << img.size() << ", connectivity: " << connectivity;
+        ASSERT_EQ(0, cvtest::norm(labelsRef, labels, NORM_INF)) << "size: " << img.size() << ", connectivity: " << connectivity;
+        ASSERT_EQ(0, cvtest::norm(statsRef, stats, NORM_INF)) << "size: " << img.size() << ", connectivity: " << connectivity;
+
+        ASSERT_EQ(n, connectedComponents(img, labels16, connectivity, CV_16U));
+        labels16.convertTo(labels16, CV_32S);
+        ASSERT_EQ(0, cvtest::norm(labels, labels16, NORM_INF));
+
+        std::vector<double> sx(n, 0.), sy(n, 0.);
+        for (int y = 0; y < img.rows; y++)
+            for (int x = 0; x < img.cols; x++)
+            {
+                sx[labelsRef.at<int>(y, x)] += x;
+                sy[labelsRef.at<int>(y, x)] += y;
+            }
+        for (int l = 0; l < n; l++)
+        {
+            ASSERT_EQ(sx[l]/stats.at<int>(l, CC_STAT_AREA), centroids.at<double>(l, 0));
+            ASSERT_EQ(sy[l]/stats.at<int>(l, CC_STAT_AREA), centroids.at<double>(l, 1));
+        }
+    }
+}
@@ -389,6 +389,87 @@ _exit_:
 
 TEST(Imgproc_FindContours, accuracy) { CV_FindContourTest test; test.safe_run(); }
 
+// contours and hierarchy produced through the C API and the CvSeq tree
+static void findContoursRef( const Mat& src, vector<vector<Point> >& contours,
+                             vector<Vec4i>& hierarchy, int mode, int method, Point offset )
+{
+    Mat image = src.clone();
+    CvMat _cimage = image;
+    MemStorage storage(cvCreateMemStorage());
+    CvSeq* first = 0;
+
+    contours.clear();
+    hierarchy.clear();
+    cvFindContours(&_cimage, storage, &first, sizeof(CvContour), mode, method, offset);
+    if( !first )
+        return;
+
+    Seq<CvSeq*> all(cvTreeToNodeSeq(first, sizeof(CvSeq), storage));
+    int i, total = (int)all.size();
+    SeqIterator<CvSeq*> it = all.begin();
+    for( i = 0; i < total; i++, ++it )
+    {
+        CvSeq* c = *it;
+        ((CvContour*)c)->color = i;
+        contours.push_back(vector<Point>(c->total));
+        cvCvtSeqToArray(c, &contours.back()[0]);
+    }
+
+    it = all.begin();
+    for( i = 0; i < total; i++, ++it )
+    {
+        CvSeq* c = *it;
+        hierarchy.push_back(Vec4i(c->h_next ? ((CvContour*)c->h_next)->color : -1,
+                                  c->h_prev ? ((CvContour*)c->h_prev)->color : -1,
+                                  c->v_next ? ((CvContour*)c->v_next)->color : -1,
+                                  c->v_prev ? ((CvContour*)c->v_prev)->color : -1));
+    }
+}
+
+TEST(Imgproc_FindContours, sameAsSeqBased)
+{
+    const int modes[] = { RETR_EXTERNAL, RETR_LIST, RETR_CCOMP, RETR_TREE };
+    const int methods[] = { CHAIN_APPROX_NONE, CHAIN_APPROX_SIMPLE };
+
+    RNG& rng = theRNG();
+    for( int iter = 0; iter < 40; iter++ )
+    {
+        Mat img(rng.uniform(1, 300), rng.uniform(1, 300), CV_8UC1, Scalar::all(0));
+        if( iter % 2 == 0 )
+        {
+            // noise gives many small contours with deep nesting
+            randu(img, 0, 256);
+            threshold(img, img, rng.uniform(100, 250), 255, THRESH_BINARY);
+        }
+        else
+        {
+            for( int k = 0; k < 30; k++ )
+            {
+                Point c(rng.uniform(0, img.cols), rng.uniform(0, img.rows));
+                circle(img, c, rng.uniform(1, 60), Scalar::all(k % 2 ? 0 : rng.uniform(1, 256)),
+                       rng.uniform(-1, 4));
+            }
+        }
+
+        Point offset(rng.uniform(-10, 10), rng.uniform(-10, 10));
+        for( int m = 0; m < 4; m++ )
+            for( int a = 0; a < 2; a++ )
+            {
+                vector<vector<Point> > contours, contoursRef;
+                vector<Vec4i> hierarchy, hierarchyRef;
+                Mat image = img.clone();
+
+                findContours(image, contours, hierarchy, modes[m], methods[a], offset);
+                findContoursRef(img, contoursRef, hierarchyRef, modes[m], methods[a], offset);
+
+                ASSERT_EQ(contoursRef.size(), contours.size()) << "mode: " << modes[m] << ", method: " << methods[a];
+                ASSERT_TRUE(hierarchyRef == hierarchy) << "mode: " << modes[m] << ", method: " << methods[a];
+                for( size_t i = 0; i < contours.size(); i++ )
+                    ASSERT_TRUE(contoursRef[i] == contours[i]) << "contour: " << i;
+            }
+    }
+}
+
 TEST(Core_Drawing, _914)
 {
     const int rows = 256;
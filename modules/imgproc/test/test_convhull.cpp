@@ -1871,4 +1871,90 @@ TEST(Imgproc_ContourMoments, accuracy) { CV_ContourMomentsTest test; test.safe_r
 TEST(Imgproc_ContourPerimeterSlice, accuracy) { CV_PerimeterAreaSliceTest test; test.safe_run(); }
 TEST(Imgproc_FitEllipse, small) { CV_FitEllipseSmallTest test; test.safe_run(); }
 
+TEST(Imgproc_ContourBatch, sameAsSingleCalls)
+{
+    RNG& rng = theRNG();
+    Mat img(300, 400, CV_8U, Scalar::all(0));
+    for( int i = 0; i < 60; i++ )
+        ellipse(img, Point(rng.uniform(0, 400), rng.uniform(0, 300)),
+                Size(rng.uniform(1, 30), rng.uniform(1, 30)), rng.uniform(0, 180), 0, 360,
+                Scalar::all(255), i % 3 == 0 ? 1 : -1);
+
+    std::vector<std::vector<Point> > contours, big;
+    findContours(img, contours, RETR_LIST, CHAIN_APPROX_SIMPLE);
+    ASSERT_GT(contours.size(), 10u);
+    contours.push_back(std::vector<Point>());
+    for( size_t i = 0; i < contours.size(); i++ )
+        if( contours[i].size() >= 5 )
+            big.push_back(contours[i]);
+
+    std::vector<Mat> contoursf(contours.size());
+    for( size_t i = 0; i < contours.size(); i++ )
+        if( !contours[i].empty() )
+            Mat(contours[i]).convertTo(contoursf[i], CV_32F, 0.5);
+
+    for( int k = 0; k < 2; k++ )
+    {
+        size_t i, n = contours.size();
+        Mat areas, rects, boxes, hulls, hullIdx, approx;
+        std::vector<int> hullOfs, hullIdxOfs, approxOfs;
+        InputArrayOfArrays c = k == 0 ? _InputArray(contours) : _InputArray(contoursf);
+
+        contourAreaBatch(c, areas, true);
+        boundingRectBatch(c, rects);
+        minAreaRectBatch(c, boxes);
+        convexHullBatch(c, hulls, hullOfs, true);
+        convexHullBatch(c, hullIdx, hullIdxOfs, false, false);
+        approxPolyDPBatch(c, approx, approxOfs, 2, true);
+        ASSERT_EQ(n, (size_t)areas.rows);
+        ASSERT_EQ(n, (size_t)rects.rows);
+        ASSERT_EQ(n, (size_t)boxes.rows);
+        ASSERT_EQ(n + 1, hullOfs.size());
+        ASSERT_EQ(n + 1, hullIdxOfs.size());
+        ASSERT_EQ(n + 1, approxOfs.size());
+
+        for( i = 0; i < n; i++ )
+        {
+            Mat ci = c.getMat((int)i);
+            if( ci.empty() )
+            {
+                EXPECT_EQ(0, areas.at<double>((int)i));
+                EXPECT_EQ(Rect(), rects.at<Rect>((int)i));
+                EXPECT_EQ(0, countNonZero(boxes.row((int)i)));
+                EXPECT_EQ(hullOfs[i], hullOfs[i+1]);
+                EXPECT_EQ(approxOfs[i], approxOfs[i+1]);
+                continue;
+            }
+            EXPECT_EQ(contourArea(ci, true), areas.at<double>((int)i));
+            EXPECT_EQ(boundingRect(ci), rects.at<Rect>((int)i));
+            RotatedRect box = minAreaRect(ci);
+            EXPECT_EQ(0, memcmp(&box, boxes.ptr((int)i), 5*sizeof(float)));
+
+            Mat hull, idx, ap;
+            convexHull(ci, hull, true);
+            convexHull(ci, idx, false, false);
+            approxPolyDP(ci, ap, 2, true);
+            Mat hull1 = hulls.rowRange(hullOfs[i], hullOfs[i+1]);
+            Mat idx1 = hullIdx.rowRange(hullIdxOfs[i], hullIdxOfs[i+1]);
+            Mat ap1 = approx.rowRange(approxOfs[i], approxOfs[i+1]);
+            ASSERT_EQ(hull.total(), hull1.total());
+            ASSERT_EQ(idx.total(), idx1.total());
+            ASSERT_EQ(ap.total(), ap1.total());
+            EXPECT_EQ(0, norm(hull, hull1, NORM_INF));
+            EXPECT_EQ(0, norm(idx, idx1, NORM_INF));
+            EXPECT_EQ(0, norm(ap, ap1, NORM_INF));
+        }
+    }
+
+    Mat boxes;
+    fitEllipseBatch(big, boxes);
+    ASSERT_EQ(big.size(), (size_t)boxes.rows);
+    for( size_t i = 0; i < big.size(); i++ )
+    {
+        RotatedRect box = fitEllipse(big[i]);
+        EXPECT_EQ(0, memcmp(&box, boxes.ptr((int)i), 5*sizeof(float)));
+    }
+    EXPECT_THROW(fitEllipseBatch(contours, boxes), cv::Exception);
+}
+
 /* End of file. */
@@ -1779,11 +1779,201 @@ TEST(Imgproc_GaussianBlur, accuracy) { CV_GaussianBlurTest test; test.safe_run()
 TEST(Imgproc_MedianBlur, accuracy) { CV_MedianBlurTest test; test.safe_run(); }
 TEST(Imgproc_PyramidDown, accuracy) { CV_PyramidDownTest test; test.safe_run(); }
 TEST(Imgproc_PyramidUp, accuracy) { CV_PyramidUpTest test; test.safe_run(); }
+
 TEST(Imgproc_MinEigenVal, accuracy) { CV_MinEigenValTest test; test.safe_run(); }
 TEST(Imgproc_EigenValsVecs, accuracy) { CV_EigenValVecTest test; test.safe_run(); }
 TEST(Imgproc_PreCornerDetect, accuracy) { CV_PreCornerDetectTest test; test.safe_run(); }
+
+TEST(Imgproc_MinEigenVal, isolatedRoi)
+{
+    const int types[] = { CV_8UC1, CV_32FC1 };
+    for( int i = 0; i < 2; i++ )
+    {
+        Mat src(100, 120, types[i]);
+        randu(src, 0, 256);
+        Rect roi(13, 7, 80, 70);
+        Mat roiCopy = src(roi).clone(), dst, ref;
+
+        // an isolated ROI is processed as if it were a separate image
+        cornerMinEigenVal(src(roi), dst, 3, 3, BORDER_REFLECT_101 | BORDER_ISOLATED);
+        cornerMinEigenVal(roiCopy, ref, 3, 3, BORDER_REFLECT_101);
+        EXPECT_EQ(0, cvtest::norm(ref, dst, NORM_INF)) << "type: " << types[i];
+
+        cornerHarris(src(roi), dst, 5, 3, 0.04, BORDER_REFLECT_101 | BORDER_ISOLATED);
+        cornerHarris(roiCopy, ref, 5, 3, 0.04, BORDER_REFLECT_101);
+        EXPECT_EQ(0, cvtest::norm(ref, dst, NORM_INF)) << "type: " << types[i];
+    }
+}
 TEST(Imgproc_Integral, accuracy) { CV_IntegralTest test; test.safe_run(); }
 
+TEST(Imgproc_Integral, sumDepthsAgree)
+{
+    RNG& rng = theRNG();
+    for( int iter = 0; iter < 10; iter++ )
+    {
+        Mat src(rng.uniform(1, 600), rng.uniform(1, 700), CV_8UC1);
+        randu(src, 0, 256);
+
+        Mat sum32s, sum32f, sum64f, sqsum, sqsum32f, tilted, sum0, sqsum0, tilted0;
+        integral(src, sum32s, sqsum, tilted, CV_32S, CV_64F);
+        integral(src, sum32f, sqsum32f, CV_32F, CV_32F);
+        integral(src, sum64f, CV_64F);
+        integral(src, sum0, sqsum0, tilted0, CV_64F, CV_64F);
+        sum32s.convertTo(sum32s, CV_64F);
+        sum32f.convertTo(sum32f, CV_64F);
+        sqsum32f.convertTo(sqsum32f, CV_64F);
+        tilted.convertTo(tilted, CV_64F);
+
+        ASSERT_EQ(0, cvtest::norm(sum0, sum64f, NORM_INF)) << "size: " << src.size();
+        ASSERT_EQ(0, cvtest::norm(sum0, sum32s, NORM_INF)) << "size: " << src.size();
+        if( src.total()*255 < (1 << 24) ) // all the sums are exact in float
+            ASSERT_EQ(0, cvtest::norm(sum0, sum32f, NORM_INF)) << "size: " << src.size();
+        ASSERT_EQ(0, cvtest::norm(sqsum0, sqsum, NORM_INF)) << "size: " << src.size();
+        ASSERT_EQ(0, cvtest::norm(tilted0, tilted, NORM_INF)) << "size: " << src.size();
+        ASSERT_LE(norm(sqsum0, sqsum32f, NORM_INF | NORM_RELATIVE), 1e-6) << "size: " << src.size();
+
+        int x = rng.uniform(0, src.cols), y = rng.uniform(0, src.rows);
+        ASSERT_EQ(sum(src(Rect(0, 0, x, y)))[0], sum0.at<double>(y, x));
+        ASSERT_EQ(sum(src)[0], sum0.at<double>(src.rows, src.cols));
+    }
+}
+
+TEST(Imgproc_Integral, sameForAnyNumThreads)
+{
+    const int depths[][3] = { { CV_8U, CV_32S, CV_64F }, { CV_8U, CV_32F, CV_64F }, { CV_8U, CV_64F, CV_64F },
+                              { CV_16U, CV_64F, CV_64F }, { CV_32F, CV_32F, CV_64F }, { CV_32F, CV_64F, CV_64F },
+                              { CV_64F, CV_64F, CV_64F } };
+    int nthreads = getNumThreads();
+
+    for( int i = 0; i < 7; i++ )
+    {
+        Mat src(517, 389, CV_MAKETYPE(depths[i][0], 3)), sum[2], sqsum[2], tilted[2];
+        randu(src, 0, depths[i][0] == CV_16U ? 65536 : 256);
+        if( depths[i][0] >= CV_32F )
+            src *= 1.37;
+
+        for( int j = 0; j < 2; j++ )
+        {
+            setNumThreads(j == 0 ? 1 : std::max(nthreads, 4));
+            integral(src, sum[j], sqsum[j], tilted[j], depths[i][1], depths[i][2]);
+        }
+        setNumThreads(nthreads);
+
+        EXPECT_EQ(0, cvtest::norm(sum[0], sum[1], NORM_INF)) << "depths: " << i;
+        EXPECT_EQ(0, cvtest::norm(sqsum[0], sqsum[1], NORM_INF)) << "depths: " << i;
+        EXPECT_EQ(0, cvtest::norm(tilted[0], tilted[1], NORM_INF)) << "depths: " << i;
+    }
+}
+
+TEST(Imgproc_BuildPyramid, sameAsPyrDown)
+{
+    const int types[] = { CV_8UC1, CV_8UC3, CV_8UC4, CV_16UC1, CV_16SC2, CV_32FC1, CV_32FC3, CV_64FC1 };
+    const int borders[] = { BORDER_REFLECT_101, BORDER_REFLECT, BORDER_REPLICATE, BORDER_WRAP };
+
+    RNG& rng = theRNG();
+    for( int iter = 0; iter < 40; iter++ )
+    {
+        int type = types[iter % (sizeof(types)/sizeof(types[0]))];
+        int borderType = borders[(iter/2) % 4];
+        int maxlevel = rng.uniform(1, 7);
+        Mat src(rng.uniform(1, 700), rng.uniform(1, 500), type);
+        randu(src, 0, 255);
+
+        vector<Mat> pyr;
+        buildPyramid(src, pyr, maxlevel, borderType);
+        ASSERT_EQ(maxlevel + 1, (int)pyr.size());
+
+        Mat level = src;
+        for( int i = 1; i <= maxlevel; i++ )
+        {
+            Mat next;
+            pyrDown(level, next, Size(), borderType);
+            ASSERT_EQ(next.size(), pyr[i].size());
+            ASSERT_EQ(0, cvtest::norm(next, pyr[i], NORM_INF))
+                << "size: " << src.size() << ", type: " << type << ", level: " << i;
+            level = next;
+        }
+    }
+}
+
+static bool cornerStrengthLess( const std::pair<float, Point>& a, const std::pair<float, Point>& b )
+{
+    return a.first < b.first;
+}
+
+static void goodFeaturesToTrackRef( const Mat& image, std::vector<Point2f>& corners, int maxCorners,
+                                    double qualityLevel, double minDistance, const Mat& mask,
+                                    int blockSize, bool useHarrisDetector, double harrisK )
+{
+    Mat eig, tmp;
+    if( useHarrisDetector )
+        cornerHarris( image, eig, blockSize, 3, harrisK );
+    else
+        cornerMinEigenVal( image, eig, blockSize, 3 );
+
+    double maxVal = 0;
+    minMaxLoc( eig, 0, &maxVal, 0, 0, mask );
+    threshold( eig, eig, maxVal*qualityLevel, 0, THRESH_TOZERO );
+    dilate( eig, tmp, Mat() );
+
+    std::vector<std::pair<float, Point> > candidates;
+    for( int y = 1; y < image.rows - 1; y++ )
+        for( int x = 1; x < image.cols - 1; x++ )
+        {
+            float val = eig.at<float>(y, x);
+            if( val != 0 && val == tmp.at<float>(y, x) && (mask.empty() || mask.at<uchar>(y, x)) )
+                candidates.push_back(std::make_pair(-val, Point(x, y)));
+        }
+    // the candidates of equal strength go in the row-major order
+    std::stable_sort( candidates.begin(), candidates.end(), cornerStrengthLess );
+
+    corners.clear();
+    for( size_t i = 0; i < candidates.size(); i++ )
+    {
+        Point p = candidates[i].second;
+        bool good = true;
+        for( size_t j = 0; j < corners.size() && good; j++ )
+        {
+            float dx = p.x - corners[j].x, dy = p.y - corners[j].y;
+            good = minDistance < 1 || dx*dx + dy*dy >= minDistance*minDistance;
+        }
+        if( good )
+        {
+            corners.push_back(Point2f((float)p.x, (float)p.y));
+            if( maxCorners > 0 && (int)corners.size() == maxCorners )
+                break;
+        }
+    }
+}
+
+TEST(Imgproc_GoodFeaturesToTrack, sameAsDilateAndSort)
+{
+    RNG& rng = theRNG();
+    for( int iter = 0; iter < 20; iter++ )
+    {
+        Mat image(rng.uniform(3, 400), rng.uniform(3, 400), iter % 2 ? CV_8U : CV_32F), mask;
+        randu(image, 0, 256);
+        GaussianBlur(image, image, Size(5, 5), 1.5);
+        if( iter % 3 == 0 )
+        {
+            mask.create(image.size(), CV_8U);
+            randu(mask, 0, 2);
+        }
+
+        int maxCorners = iter % 4 == 0 ? 0 : rng.uniform(1, 500);
+        double minDistance = iter % 5 == 0 ? 0 : rng.uniform(1., 20.);
+        bool useHarris = iter % 2 == 0;
+
+        std::vector<Point2f> corners, ref;
+        goodFeaturesToTrack(image, corners, maxCorners, 0.01, minDistance, mask, 3, useHarris, 0.04);
+        goodFeaturesToTrackRef(image, ref, maxCorners, 0.01, minDistance, mask, 3, useHarris, 0.04);
+
+        ASSERT_EQ(ref.size(), corners.size()) << "iteration " << iter;
+        for( size_t i = 0; i < ref.size(); i++ )
+            ASSERT_EQ(ref[i], corners[i]) << "iteration " << iter << ", corner " << i;
+    }
+}
+
 //////////////////////////////////////////////////////////////////////////////////
 
 class CV_FilterSupportedFormatsTest : public cvtest::BaseTest
@@ -1918,3 +2108,169 @@ TEST(Imgproc_Blur, borderTypes)
     EXPECT_EQ(expected_dst.size(), dst.size());
     EXPECT_DOUBLE_EQ(0.0, cvtest::norm(expected_dst, dst, NORM_INF));
 }
+
+// large images are filtered in parallel stripes; compare with the filtering of small tiles
+// (that reuse the neighbor rows of the parent image), which are processed at once
+static void filterByOp(int op, const Mat& src, Mat& dst)
+{
+    Mat kernel = (Mat_<float>(3, 5) << 1, 2, 0, -1, 3, 0, 1, 5, 1, 0, -2, 1, 0, 2, 1);
+    Mat kx = (Mat_<float>(1, 5) << 1, 4, 6, 4, 1), ky = (Mat_<float>(1, 7) << 1, -2, 3, 0, 3, -2, 1);
+    switch(op)
+    {
+    case 0: filter2D(src, dst, CV_32F, kernel, Point(-1, -1), 0, BORDER_REFLECT_101); break;
+    case 1: sepFilter2D(src, dst, CV_32F, kx, ky, Point(-1, -1), 1, BORDER_REPLICATE); break;
+    case 2: Sobel(src, dst, CV_16S, 1, 1, 5); break;
+    case 3: boxFilter(src, dst, -1, Size(9, 11), Point(-1, -1), true, BORDER_CONSTANT); break;
+    case 4: GaussianBlur(src, dst, Size(7, 7), 1.5); break;
+    case 5: erode(src, dst, getStructuringElement(MORPH_ELLIPSE, Size(5, 7)), Point(-1, -1), 1, BORDER_CONSTANT, Scalar(100)); break;
+    default: break;
+    }
+}
+
+TEST(Imgproc_FilterEngine, stripes)
+{
+    Mat src(1100, 700, CV_8UC3);
+    randu(src, 0, 256);
+
+    for( int op = 0; op <= 5; op++ )
+    {
+        Mat dst, ref;
+        filterByOp(op, src, dst);
+        ref.create(dst.size(), dst.type());
+
+        for( int y = 0; y < src.rows; y += 20 )
+        {
+            int y1 = std::min(y + 20, src.rows);
+            Mat tile;
+            filterByOp(op, src.rowRange(y, y1), tile);
+            tile.copyTo(ref.rowRange(y, y1));
+        }
+        EXPECT_EQ(0, cvtest::norm(dst, ref, NORM_INF)) << "op=" << op;
+    }
+}
+
+TEST(Imgproc_GaussianBlur, recursiveCloseToKernel)
+{
+    const int depths[] = { CV_8U, CV_16U, CV_16S, CV_32F };
+    const int borders[] = { BORDER_REPLICATE, BORDER_REFLECT, BORDER_REFLECT_101, BORDER_CONSTANT };
+    const double sigmas[] = { 2, 12.5 };
+
+    Mat src(130, 170, CV_32FC3);
+    randu(src, 0, 200);
+    // smooth it a bit and add a sharp edge so that both the flat and the steep parts are covered
+    GaussianBlur(src, src, Size(5, 5), 1);
+    src(Rect(40, 30, 60, 50)).setTo(Scalar::all(250));
+
+    for( int di = 0; di < 4; di++ )
+        for( int bi = 0; bi < 4; bi++ )
+            for( int si = 0; si < 2; si++ )
+            {
+                double s = sigmas[si];
+                int ksize = cvCeil(s*8)*2 + 1;
+                Mat src64, ref, dst, img;
+                src.convertTo(img, depths[di]);
+                img.convertTo(src64, CV_64F);
+                GaussianBlur(src64, ref, Size(ksize, ksize), s, s*0.8, borders[bi]);
+                GaussianBlur(img, dst, Size(), s, s*0.8, borders[bi], GAUSSIAN_BLUR_RECURSIVE);
+                ASSERT_EQ(img.type(), dst.type());
+                dst.convertTo(dst, CV_64F);
+                EXPECT_LE(cvtest::norm(dst, ref, NORM_INF), depths[di] == CV_32F ? 0.1 : 1.)
+                    << "depth=" << depths[di] << " border=" << borders[bi] << " sigma=" << s;
+            }
+
+    // the default algorithm is always the kernel, and so is the auto mode for small sigmas
+    Mat img, dst, ref;
+    src.convertTo(img, CV_8U);
+    GaussianBlur(img, dst, Size(), 12.5);
+    GaussianBlur(img, ref, Size(), 12.5, 0, BORDER_DEFAULT, GAUSSIAN_BLUR_KERNEL);
+    EXPECT_EQ(0, cvtest::norm(dst, ref, NORM_INF));
+    GaussianBlur(img, dst, Size(), 3, 0, BORDER_DEFAULT, GAUSSIAN_BLUR_AUTO);
+    GaussianBlur(img, ref, Size(), 3, 0, BORDER_DEFAULT, GAUSSIAN_BLUR_KERNEL);
+    EXPECT_EQ(0, cvtest::norm(dst, ref, NORM_INF));
+}
+
+// large rectangular kernels are processed by the van Herk/Gil-Werman algorithm;
+// compare with the same min/max composed of 3-pixel segments
+static void morphBySegments(int op, const Mat& src, Mat& dst, Size ksize)
+{
+    src.copyTo(dst);
+    for( int i = 0; i < ksize.width/2; i++ )
+        morphologyEx(dst, dst, op, Mat::ones(1, 3, CV_8U), Point(-1, -1), 1, BORDER_REPLICATE);
+    for( int i = 0; i < ksize.height/2; i++ )
+        morphologyEx(dst, dst, op, Mat::ones(3, 1, CV_8U), Point(-1, -1), 1, BORDER_REPLICATE);
+}
+
+TEST(Imgproc_Morphology, rectSameAsSegments)
+{
+    const int types[] = { CV_8UC1, CV_16UC2, CV_16SC1, CV_32FC3, CV_64FC1 };
+    const Size ksizes[] = { Size(13, 13), Size(49, 1), Size(1, 25), Size(21, 11), Size(201, 3) };
+
+    for( int ti = 0; ti < 5; ti++ )
+    {
+        Mat big(230, 300, types[ti]);
+        randu(big, -100, 255);
+
+        for( int ki = 0; ki < 5; ki++ )
+        {
+            Size ksize = ksizes[ki];
+            Mat kernel = getStructuringElement(MORPH_RECT, ksize);
+
+            for( int op = MORPH_ERODE; op <= MORPH_DILATE; op++ )
+            {
+                Mat dst, ref;
+                morphologyEx(big, dst, op, kernel, Point(-1, -1), 1, BORDER_REPLICATE);
+                morphBySegments(op, big, ref, ksize);
+                EXPECT_EQ(0, cvtest::norm(dst, ref, NORM_INF)) << "type=" << types[ti] << " ksize=" << ksize << " op=" << op;
+
+                // the ROI borders come from the parent image, the same as for the whole image
+                Rect roi(20, 30, 200, 150);
+                Mat droi;
+                morphologyEx(big(roi), droi, op, kernel, Point(-1, -1), 1, BORDER_CONSTANT);
+                morphologyEx(big, dst, op, kernel, Point(-1, -1), 1, BORDER_CONSTANT);
+                EXPECT_EQ(0, cvtest::norm(droi, dst(roi), NORM_INF)) << "type=" << types[ti] << " ksize=" << ksize << " op=" << op;
+
+                // in-place
+                Mat img = big.clone();
+                morphologyEx(img, img, op, kernel, Point(-1, -1), 1, BORDER_CONSTANT);
+                EXPECT_EQ(0, cvtest::norm(img, dst, NORM_INF)) << "type=" << types[ti] << " ksize=" << ksize << " op=" << op;
+            }
+
+            Mat grad, eroded, dilated;
+            morphologyEx(big, grad, MORPH_GRADIENT, kernel);
+            erode(big, eroded, kernel);
+            dilate(big, dilated, kernel);
+            EXPECT_EQ(0, cvtest::norm(grad, dilated - eroded, NORM_INF)) << "type=" << types[ti] << " ksize=" << ksize;
+        }
+    }
+}
+
+TEST(Imgproc_MedianBlur, largeApertureSameAs8u)
+{
+    const int ksizes[] = { 7, 15, 31, 73 };
+    Mat src8u(150, 310, CV_8UC3);
+    randu(src8u, 0, 256);
+    src8u(Rect(100, 20, 80, 90)).setTo(Scalar::all(40));
+
+    for( int ki = 0; ki < 4; ki++ )
+    {
+        int ksize = ksizes[ki];
+        Mat ref, src, dst, expected;
+        medianBlur(src8u, ref, ksize);
+
+        src8u.convertTo(src, CV_16U, 200);
+        medianBlur(src, dst, ksize);
+        ref.convertTo(expected, CV_16U, 200);
+        EXPECT_EQ(0, cvtest::norm(dst, expected, NORM_INF)) << "16u ksize=" << ksize;
+
+        src8u.convertTo(src, CV_16S, 100, -12800);
+        medianBlur(src, src, ksize);
+        ref.convertTo(expected, CV_16S, 100, -12800);
+        EXPECT_EQ(0, cvtest::norm(src, expected, NORM_INF)) << "16s ksize=" << ksize;
+
+        // the median commutes with the decreasing mapping as well
+        src8u.convertTo(src, CV_32F, -0.37, 1);
+        medianBlur(src, dst, ksize);
+        ref.convertTo(expected, CV_32F, -0.37, 1);
+        EXPECT_EQ(0, cvtest::norm(dst, expected, NORM_INF)) << "32f ksize=" << ksize;
+    }
+}
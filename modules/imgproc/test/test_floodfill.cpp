@@ -526,4 +526,72 @@ void CV_FloodFillTest::prepare_to_validation( int /*test_case_idx*/ )
 
 TEST(Imgproc_FloodFill, accuracy) { CV_FloodFillTest test; test.safe_run(); }
 
+TEST(Imgproc_FloodFill, batchSameAsSequential)
+{
+    RNG& rng = theRNG();
+
+    for( int iter = 0; iter < 40; iter++ )
+    {
+        Size sz(rng.uniform(1, 120), rng.uniform(1, 120));
+        int type = iter % 3 == 0 ? CV_8UC1 : iter % 3 == 1 ? CV_8UC3 : CV_32SC1;
+        Mat src(sz, type);
+        // few levels give large components, so later seeds often land in filled areas
+        rng.fill(src, RNG::UNIFORM, 0, 4);
+
+        bool useMask = (iter / 3) % 2 != 0;
+        bool grad = (iter / 6) % 2 != 0;
+        int flags = (iter / 12) % 2 != 0 ? 8 : 4;
+        if( grad && (iter / 24) % 2 != 0 )
+            flags |= FLOODFILL_FIXED_RANGE | (1 << 8);
+        Scalar diff = grad ? Scalar::all(1) : Scalar();
+
+        int nseeds = rng.uniform(1, 30);
+        vector<Point> seeds(nseeds);
+        vector<Scalar> newVals(nseeds);
+        for( int i = 0; i < nseeds; i++ )
+        {
+            seeds[i] = Point(rng.uniform(0, sz.width), rng.uniform(0, sz.height));
+            newVals[i] = Scalar::all(rng.uniform(0, 4) + (type == CV_32SC1 ? i*10 : 0));
+        }
+        if( iter % 4 == 0 )
+            newVals.resize(1);
+
+        Mat dst0 = src.clone(), dst1 = src.clone();
+        Mat mask0, mask1;
+        if( useMask )
+        {
+            mask0 = Mat::zeros(sz.height + 2, sz.width + 2, CV_8UC1);
+            rng.fill(mask0(Rect(1, 1, sz.width, sz.height)), RNG::UNIFORM, 0, 8);
+            threshold(mask0, mask0, 6, 1, THRESH_BINARY);
+            mask1 = mask0.clone();
+        }
+
+        int total0 = 0;
+        vector<Rect> rects0(nseeds);
+        vector<int> areas0(nseeds);
+        for( int i = 0; i < nseeds; i++ )
+        {
+            Scalar nv = newVals[newVals.size() == 1 ? 0 : i];
+            areas0[i] = useMask ? floodFill(dst0, mask0, seeds[i], nv, &rects0[i], diff, diff, flags) :
+                                  floodFill(dst0, seeds[i], nv, &rects0[i], diff, diff, flags);
+            total0 += areas0[i];
+        }
+
+        vector<Rect> rects1;
+        vector<int> areas1;
+        int total1 = floodFillBatch(dst1, useMask ? mask1 : noArray(), seeds, newVals,
+                                    rects1, areas1, diff, diff, flags);
+
+        ASSERT_EQ(total0, total1) << "iter " << iter;
+        ASSERT_EQ(0, cvtest::norm(dst0, dst1, NORM_INF)) << "iter " << iter;
+        if( useMask )
+            ASSERT_EQ(0, cvtest::norm(mask0, mask1, NORM_INF)) << "iter " << iter;
+        for( int i = 0; i < nseeds; i++ )
+        {
+            ASSERT_EQ(areas0[i], areas1[i]) << "iter " << iter << ", seed " << i;
+            ASSERT_EQ(rects0[i], rects1[i]) << "iter " << iter << ", seed " << i;
+        }
+    }
+}
+
 /* End of file. */
@@ -170,3 +170,29 @@ TEST(Imgproc_GrabCut, repeatability)
     EXPECT_EQ(0, countNonZero(mask_1 != mask_3));
     EXPECT_EQ(0, countNonZero(mask_2 != mask_3));
 }
+
+// the graph of the next iterations is updated instead of being rebuilt, so the iterations
+// of one call should give the same result as the separate calls
+TEST(Imgproc_GrabCut, iterationsSameAsSeparateCalls)
+{
+    Mat img(150, 200, CV_8UC3), noise(150, 200, CV_8UC3);
+    randu(img, 0, 80);
+    ellipse(img, Point(100, 75), Size(50, 50), 20, 0, 360, Scalar(40, 170, 220), -1);
+    circle(img, Point(66, 50), 15, Scalar(200, 60, 60), -1);
+    randu(noise, 0, 60);
+    img += noise;
+    GaussianBlur(img, img, Size(5, 5), 1.5);
+
+    Rect rect(25, 18, 150, 112);
+    Mat mask, bgdModel, fgdModel;
+    theRNG().state = 12378213;
+    grabCut(img, mask, rect, bgdModel, fgdModel, 0, GC_INIT_WITH_RECT);
+
+    Mat mask1 = mask.clone(), bgdModel1 = bgdModel.clone(), fgdModel1 = fgdModel.clone();
+    grabCut(img, mask1, rect, bgdModel1, fgdModel1, 4, GC_EVAL);
+    for( int i = 0; i < 4; i++ )
+        grabCut(img, mask, rect, bgdModel, fgdModel, 1, GC_EVAL);
+
+    EXPECT_EQ(0, countNonZero(mask1 != mask));
+    EXPECT_GT(countNonZero(mask1 & 1), 5000);
+}
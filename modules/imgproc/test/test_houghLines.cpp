@@ -219,3 +219,49 @@ INSTANTIATE_TEST_CASE_P( ImgProc, ProbabilisticHoughLinesTest, testing::Combine(
                                                                                 testing::Values( 0, 10 ),
                                                                                 testing::Values( 0, 4 )
                                                                                 ));
+
+TEST(Imgproc_HoughLines, syntheticImage)
+{
+    Mat img = Mat::zeros(480, 640, CV_8UC1);
+    line(img, Point(20, 100), Point(620, 100), Scalar(255));
+    line(img, Point(300, 10), Point(300, 470), Scalar(255));
+    RNG rng(12345);
+    for( int i = 0; i < 2000; i++ )
+        img.at<uchar>(rng.uniform(0, img.rows), rng.uniform(0, img.cols)) = 255;
+
+    vector<Vec2f> lines;
+    HoughLines(img, lines, 1, CV_PI/180, 300);
+    ASSERT_LE(2u, lines.size());
+    EXPECT_EQ(2, (int)count_if(lines.begin(), lines.begin() + 2, SimilarWith<Vec2f>(Vec2f(100, (float)(CV_PI/2)), 0.02f, 1.f)) +
+                 (int)count_if(lines.begin(), lines.begin() + 2, SimilarWith<Vec2f>(Vec2f(300, 0), 0.02f, 1.f)));
+
+    vector<Vec4i> segments;
+    HoughLinesP(img, segments, 1, CV_PI/180, 100, 400, 5);
+    ASSERT_EQ(2u, segments.size());
+    for( size_t i = 0; i < segments.size(); i++ )
+    {
+        Vec4i s = segments[i];
+        bool horizontal = s[1] == 100 && s[3] == 100 && std::abs(s[2] - s[0]) == 600;
+        bool vertical = s[0] == 300 && s[2] == 300 && std::abs(s[3] - s[1]) == 460;
+        EXPECT_TRUE(horizontal || vertical) << s;
+    }
+}
+
+TEST(Imgproc_HoughCircles, syntheticImage)
+{
+    Mat img(480, 640, CV_8UC1, Scalar(20));
+    circle(img, Point(200, 180), 50, Scalar(220), -1);
+    circle(img, Point(470, 300), 80, Scalar(220), -1);
+    GaussianBlur(img, img, Size(5, 5), 1.5);
+
+    vector<Vec3f> circles;
+    HoughCircles(img, circles, HOUGH_GRADIENT, 1, 100, 100, 30, 30, 100);
+    ASSERT_EQ(2u, circles.size());
+    for( size_t i = 0; i < circles.size(); i++ )
+    {
+        Vec3f c = circles[i];
+        bool first = std::abs(c[0] - 200) <= 2 && std::abs(c[1] - 180) <= 2 && std::abs(c[2] - 50) <= 3;
+        bool second = std::abs(c[0] - 470) <= 2 && std::abs(c[1] - 300) <= 2 && std::abs(c[2] - 80) <= 3;
+        EXPECT_TRUE(first || second) << c;
+    }
+}
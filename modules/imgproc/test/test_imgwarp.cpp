@@ -1632,4 +1632,83 @@ TEST(Resize, Area_half)
     }
 }
 
+TEST(Imgproc_InitUndistortMap, optimizedSameAsPlain)
+{
+    const Size size(641, 479);
+    double _A[] = { 520, 0, 320, 0, 510, 240, 0, 0, 1 };
+    double _R[] = { 0.999, -0.03, 0.01, 0.03, 0.999, -0.02, -0.01, 0.02, 1 };
+    // the second set of coefficients throws the corners far outside the 16-bit map range
+    double _k[][12] =
+    {
+        { -0.3, 0.1, 0.001, -0.002, 0.05, 0.01, 0.002, 0.001, 0.001, -0.001, 0.002, 0.0005 },
+        { 1e4, 1e6, 0.1, -0.1, 1e8, 0, 0, 0, 0, 0, 0, 0 }
+    };
+    int m1types[] = { CV_16SC2, CV_32FC1, CV_32FC2 };
+    Mat A(3, 3, CV_64F, _A), R(3, 3, CV_64F, _R);
+    bool useOptimized = cv::useOptimized();
+
+    for( int ki = 0; ki < 2; ki++ )
+        for( int ti = 0; ti < 3; ti++ )
+        {
+            SCOPED_TRACE(ki);
+            SCOPED_TRACE(m1types[ti]);
+            Mat k(1, 12, CV_64F, _k[ki]);
+            Mat map1, map2, map1_ref, map2_ref;
+
+            cv::setUseOptimized(false);
+            initUndistortRectifyMap(A, k, R, A, size, m1types[ti], map1_ref, map2_ref);
+            cv::setUseOptimized(true);
+            initUndistortRectifyMap(A, k, R, A, size, m1types[ti], map1, map2);
+            cv::setUseOptimized(useOptimized);
+
+            EXPECT_EQ(0, cvtest::norm(map1_ref, map1, NORM_INF));
+            if( m1types[ti] != CV_32FC2 )
+                EXPECT_EQ(0, cvtest::norm(map2_ref, map2, NORM_INF));
+        }
+}
+
+TEST(Imgproc_UndistortPoints, termCriteria)
+{
+    const int n = 201;
+    double _A[] = { 520, 0, 320, 0, 510, 240, 0, 0, 1 };
+    double _k[] = { -0.2, 0.05, 0.001, -0.001, 0.01 };
+    Mat A(3, 3, CV_64F, _A), k(1, 5, CV_64F, _k);
+    Mat src(1, n, CV_64FC2), dst, dst_ref;
+    RNG rng(0x1234);
+    rng.fill(src, RNG::UNIFORM, Scalar(0, 0), Scalar(640, 480));
+
+    // the default version does 5 iterations
+    undistortPoints(src, dst_ref, A, k);
+    undistortPoints(src, dst, A, k, noArray(), noArray(), TermCriteria(TermCriteria::COUNT, 5, 0));
+    EXPECT_EQ(0, cvtest::norm(dst_ref, dst, NORM_INF));
+
+    // with zero epsilon the iterations only stop early at a fixed point, so the result is the same
+    undistortPoints(src, dst_ref, A, k, noArray(), noArray(), TermCriteria(TermCriteria::COUNT, 20, 0));
+    undistortPoints(src, dst, A, k, noArray(), noArray(), TermCriteria(TermCriteria::COUNT + TermCriteria::EPS, 20, 0));
+    EXPECT_EQ(0, cvtest::norm(dst_ref, dst, NORM_INF));
+
+    bool useOptimized = cv::useOptimized();
+    cv::setUseOptimized(false);
+    undistortPoints(src, dst_ref, A, k, noArray(), noArray(), TermCriteria(TermCriteria::EPS, 0, 1e-12));
+    cv::setUseOptimized(useOptimized);
+    undistortPoints(src, dst, A, k, noArray(), noArray(), TermCriteria(TermCriteria::EPS, 0, 1e-12));
+    EXPECT_EQ(0, cvtest::norm(dst_ref, dst, NORM_INF));
+
+    // converged points, when distorted again, must come back to the source points
+    for( int i = 0; i < n; i++ )
+    {
+        Point2d p = dst.at<Point2d>(i), q = src.at<Point2d>(i);
+        double r2 = p.x*p.x + p.y*p.y;
+        double kr = 1 + ((_k[4]*r2 + _k[1])*r2 + _k[0])*r2;
+        double u = _A[0]*(p.x*kr + 2*_k[2]*p.x*p.y + _k[3]*(r2 + 2*p.x*p.x)) + _A[2];
+        double v = _A[4]*(p.y*kr + _k[2]*(r2 + 2*p.y*p.y) + 2*_k[3]*p.x*p.y) + _A[5];
+        ASSERT_NEAR(q.x, u, 1e-6);
+        ASSERT_NEAR(q.y, v, 1e-6);
+    }
+
+    // a large iteration limit does not matter once the points have converged
+    undistortPoints(src, dst_ref, A, k, noArray(), noArray(), TermCriteria(TermCriteria::COUNT + TermCriteria::EPS, 1000, 1e-12));
+    EXPECT_EQ(0, cvtest::norm(dst_ref, dst, NORM_INF));
+}
+
 /* End of file. */
@@ -463,3 +463,45 @@ protected:
 };
 
 TEST(Imgproc_ContourMoment, small) { CV_SmallContourMomentTest test; test.safe_run(); }
+
+TEST(Imgproc_Moments, labels)
+{
+    Mat image(600, 800, CV_8U, Scalar::all(0)), labels;
+    RNG& rng = theRNG();
+    for( int i = 0; i < 40; i++ )
+    {
+        Point center(rng.uniform(0, image.cols), rng.uniform(0, image.rows));
+        circle(image, center, rng.uniform(3, 60), Scalar::all(255), FILLED);
+    }
+    int nlabels = connectedComponents(image, labels, 8, CV_32S);
+    ASSERT_GT(nlabels, 2);
+
+    const int types[] = { CV_32S, CV_16U, CV_8U };
+    for( int t = 0; t < 3; t++ )
+    {
+        Mat l;
+        labels.convertTo(l, types[t]);
+
+        vector<Moments> mv;
+        labelMoments(l, mv);
+        ASSERT_EQ(nlabels, (int)mv.size());
+
+        for( int i = 0; i < nlabels; i++ )
+        {
+            Moments m0 = moments(labels == i, true), &m = mv[i];
+            double ref[] = { m0.m00, m0.m10, m0.m01, m0.m20, m0.m11, m0.m02, m0.m30, m0.m21, m0.m12, m0.m03,
+                             m0.mu20, m0.mu11, m0.mu02, m0.nu30, m0.nu21, m0.nu12, m0.nu03 };
+            double val[] = { m.m00, m.m10, m.m01, m.m20, m.m11, m.m02, m.m30, m.m21, m.m12, m.m03,
+                             m.mu20, m.mu11, m.mu02, m.nu30, m.nu21, m.nu12, m.nu03 };
+            for( int k = 0; k < (int)(sizeof(ref)/sizeof(ref[0])); k++ )
+                ASSERT_NEAR(ref[k], val[k], std::max(fabs(ref[k]), 1.)*1e-9)
+                    << "label " << i << ", moment " << k;
+        }
+    }
+
+    // the labels outside of [0, nlabels) are ignored
+    vector<Moments> mv;
+    labelMoments(labels, mv, 2);
+    ASSERT_EQ(2, (int)mv.size());
+    EXPECT_EQ(countNonZero(labels == 1), mv[1].m00);
+}
@@ -86,4 +86,42 @@ void CV_PhaseCorrelatorTest::run( int )
 
 TEST(Imgproc_PhaseCorrelatorTest, accuracy) { CV_PhaseCorrelatorTest test; test.safe_run(); }
 
+TEST(Imgproc_PhaseCorrelatorTest, cachedReference)
+{
+    RNG& rng = theRNG();
+    Mat big(500, 600, CV_32F);
+    rng.fill(big, RNG::UNIFORM, 0, 1);
+    GaussianBlur(big, big, Size(0, 0), 2);
+
+    Rect r0(150, 120, 320, 240);
+    Mat ref = big(r0).clone(), hann;
+    createHanningWindow(hann, ref.size(), CV_32F);
+
+    Ptr<PhaseCorrelator> single = createPhaseCorrelator();
+    Ptr<PhaseCorrelator> pyramid = createPhaseCorrelator(true, 3);
+    single->setReference(ref);
+    pyramid->setReference(ref);
+
+    Point shifts[] = { Point(0, 0), Point(4, -3), Point(-9, 14), Point(-80, 60) };
+    for( int i = 0; i < 4; i++ )
+    {
+        Mat src = big(r0 - shifts[i]).clone();
+        double response0 = 0, response1 = 0, response2 = 0;
+        Point2d shift0 = phaseCorrelate(ref.clone(), src.clone(), hann, &response0);
+        Point2d shift1 = single->correlate(src, &response1);
+        Point2d shift2 = pyramid->correlate(src, &response2);
+
+        EXPECT_EQ(shift0, shift1);
+        EXPECT_EQ(response0, response1);
+        EXPECT_LT(norm(shift2 - Point2d(shifts[i])), 0.5);
+    }
+
+    // 8-bit images are converted to the reference type
+    Mat ref8u, src8u;
+    ref.convertTo(ref8u, CV_8U, 255);
+    big(r0 - shifts[2]).convertTo(src8u, CV_8U, 255);
+    single->setReference(ref8u);
+    EXPECT_LT(norm(single->correlate(src8u) - Point2d(shifts[2])), 0.5);
+}
+
 }
@@ -0,0 +1,111 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+#include "test_precomp.hpp"
+
+using namespace cv;
+using namespace std;
+
+struct TriangleLess
+{
+    bool operator()( const Vec6f& a, const Vec6f& b ) const
+    {
+        return std::lexicographical_compare(a.val, a.val + 6, b.val, b.val + 6);
+    }
+};
+
+static void sortedTriangles( const Subdiv2D& subdiv, vector<Vec6f>& triangles )
+{
+    subdiv.getTriangleList(triangles);
+    for( size_t i = 0; i < triangles.size(); i++ )
+    {
+        // rotate every triangle to start from its smallest vertex
+        Vec6f t = triangles[i];
+        int k = 0;
+        for( int j = 1; j < 3; j++ )
+            if( std::make_pair(t[j*2], t[j*2+1]) < std::make_pair(t[k*2], t[k*2+1]) )
+                k = j;
+        for( int j = 0; j < 6; j++ )
+            triangles[i][j] = t[(k*2 + j) % 6];
+    }
+    std::sort(triangles.begin(), triangles.end(), TriangleLess());
+}
+
+TEST(Imgproc_Subdiv2D, bulkInsertSameAsSequential)
+{
+    RNG& rng = theRNG();
+    Rect rect(10, 20, 640, 480);
+    for( int iter = 0; iter < 3; iter++ )
+    {
+        int i, n = iter == 0 ? 1 : 3000;
+        vector<Point2f> pts(n);
+        for( i = 0; i < n; i++ )
+            pts[i] = Point2f(rng.uniform(10.f, 650.f), rng.uniform(20.f, 500.f));
+        if( iter == 2 )
+            pts[n/2] = pts[n/3];
+
+        Subdiv2D seq(rect), bulk(rect);
+        for( i = 0; i < n; i++ )
+            seq.insert(pts[i]);
+        bulk.insert(pts);
+
+        vector<Vec6f> t0, t1;
+        sortedTriangles(seq, t0);
+        sortedTriangles(bulk, t1);
+        ASSERT_EQ(t0.size(), t1.size());
+        for( size_t j = 0; j < t0.size(); j++ )
+            ASSERT_EQ(0, memcmp(&t0[j], &t1[j], sizeof(t0[j])));
+
+        // the vertices are numbered in the order of the input points
+        for( i = 0; i < n; i++ )
+        {
+            int edge = 0, vertex = 0;
+            ASSERT_EQ((int)Subdiv2D::PTLOC_VERTEX, bulk.locate(pts[i], edge, vertex));
+            EXPECT_EQ(i == n/2 && iter == 2 ? n/3 + 4 : i + 4, vertex);
+        }
+    }
+
+    Subdiv2D subdiv(rect);
+    vector<Point2f> outside(2, Point2f(20, 30));
+    outside[1] = Point2f(700, 30);
+    EXPECT_THROW(subdiv.insert(outside), cv::Exception);
+}
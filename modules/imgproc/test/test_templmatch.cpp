@@ -334,3 +334,63 @@ void CV_TemplMatchTest::prepare_to_validation( int /*test_case_idx*/ )
 }
 
 TEST(Imgproc_MatchTemplate, accuracy) { CV_TemplMatchTest test; test.safe_run(); }
+
+TEST(Imgproc_MatchTemplate, batchSameAsSingle)
+{
+    RNG& rng = theRNG();
+
+    for( int iter = 0; iter < 12; iter++ )
+    {
+        int type = CV_MAKETYPE(iter % 2 == 0 ? CV_8U : CV_32F, (iter / 2) % 2 == 0 ? 1 : 3);
+        Mat img(rng.uniform(60, 400), rng.uniform(60, 400), type);
+        rng.fill(img, RNG::UNIFORM, 0, 255);
+
+        // two templates per size, so that some of them share the image spectra
+        vector<Mat> templs;
+        for( int i = 0; i < 6; i++ )
+        {
+            int w = i % 3 == 0 ? 5 : i % 3 == 1 ? 17 : 40, h = i % 3 == 2 ? 9 : w;
+            Rect r(rng.uniform(0, img.cols - w + 1), rng.uniform(0, img.rows - h + 1), w, h);
+            Mat templ = img(r).clone(), noise(templ.size(), type);
+            rng.fill(noise, RNG::UNIFORM, -10, 10);
+            add(templ, noise, templ, noArray(), type);
+            templs.push_back(templ);
+        }
+
+        for( int method = TM_SQDIFF; method <= TM_CCOEFF_NORMED; method++ )
+        {
+            vector<Mat> results;
+            matchTemplateBatch(img, templs, results, method);
+            ASSERT_EQ(templs.size(), results.size());
+
+            vector<vector<Point> > locations;
+            vector<vector<float> > scores;
+            matchTemplateBatch(img, templs, method, 3, locations, scores);
+            ASSERT_EQ(templs.size(), locations.size());
+
+            for( size_t i = 0; i < templs.size(); i++ )
+            {
+                Mat ref;
+                matchTemplate(img, templs[i], ref, method);
+                ASSERT_EQ(ref.size(), results[i].size());
+                ASSERT_LE(cvtest::norm(ref, results[i], NORM_INF), 1e-5*std::max(cvtest::norm(ref, NORM_INF), 1.))
+                    << "iter " << iter << ", method " << method << ", template " << i;
+
+                double minVal, maxVal;
+                Point minLoc, maxLoc;
+                minMaxLoc(ref, &minVal, &maxVal, &minLoc, &maxLoc);
+                bool sqdiff = method == TM_SQDIFF || method == TM_SQDIFF_NORMED;
+                ASSERT_EQ(3u, locations[i].size());
+                EXPECT_EQ(sqdiff ? minLoc : maxLoc, locations[i][0]);
+                for( size_t k = 0; k < locations[i].size(); k++ )
+                {
+                    EXPECT_EQ(results[i].at<float>(locations[i][k]), scores[i][k]);
+                    if( k > 0 )
+                    {
+                        EXPECT_TRUE(sqdiff ? scores[i][k-1] <= scores[i][k] : scores[i][k-1] >= scores[i][k]);
+                    }
+                }
+            }
+        }
+    }
+}
@@ -428,6 +428,15 @@ private:
     performance_metrics metrics;
     void validateMetrics();
 
+    // hardware counters sampled around every iteration (see --perf_hw_counters)
+    enum { HW_CYCLES = 0, HW_INSTRUCTIONS = 1, HW_CACHE_MISSES = 2, HW_COUNTERS_NUM = 3 };
+    int64 hwCountersStart[HW_COUNTERS_NUM];
+    std::vector<int64> hwCounters[HW_COUNTERS_NUM];
+
+    void resetMeasurements();
+    void runTestBodyOnce();
+    void reportJSON();
+
     static int64 _timeadjustment;
     static int64 _calibrate();
 
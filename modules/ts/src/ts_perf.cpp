@@ -3,6 +3,8 @@
 #include <map>
 #include <iostream>
 #include <fstream>
+#include <sstream>
+#include <errno.h>
 
 #if defined WIN32 || defined _WIN32 || defined WIN64 || defined _WIN64
 #ifndef NOMINMAX
@@ -19,6 +21,15 @@
 # include <sys/time.h>
 #endif
 
+#if defined __linux__ && !defined ANDROID
+# include <dirent.h>
+# include <unistd.h>
+# include <sys/ioctl.h>
+# include <sys/syscall.h>
+# include <linux/perf_event.h>
+# define HAVE_PERF_EVENTS 1
+#endif
+
 using namespace perf;
 
 int64 TestBase::timeLimitDefault = 0;
@@ -40,6 +51,8 @@ static unsigned int param_force_samples;
 static uint64       param_seed;
 static double       param_time_limit;
 static int          param_threads;
+static std::vector<int> param_threads_list;
+static bool         param_hw_counters;
 static bool         param_write_sanity;
 static bool         param_verify_sanity;
 #ifdef CV_COLLECT_IMPL_DATA
@@ -83,6 +96,154 @@ public:
     }
 };
 
+/*****************************************************************************************\
+*                                   Hardware counters
+\*****************************************************************************************/
+
+// Counts cycles, retired instructions and cache misses of the whole process via perf_event_open.
+// The counters are attached to every thread existing at open() time (and are inherited by the
+// threads created afterwards), so open() should be called after the thread pool is started.
+class HWCounters
+{
+public:
+    enum { CYCLES = 0, INSTRUCTIONS = 1, CACHE_MISSES = 2, COUNT = 3 };
+
+    HWCounters() : available(true) {}
+    ~HWCounters() { close(); }
+
+    bool isOpened() const { return !fds.empty(); }
+
+    bool open()
+    {
+        close();
+#ifdef HAVE_PERF_EVENTS
+        if (!available)
+            return false;
+        static const unsigned long long configs[COUNT] =
+        {
+            PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES
+        };
+        std::vector<int> tids;
+        DIR* dir = opendir("/proc/self/task");
+        if (dir)
+        {
+            struct dirent* entry;
+            while ((entry = readdir(dir)) != 0)
+                if (entry->d_name[0] != '.')
+                    tids.push_back(atoi(entry->d_name));
+            closedir(dir);
+        }
+        if (tids.empty())
+            tids.push_back(0);
+        for (size_t i = 0; i < tids.size(); i++)
+        {
+            int tfds[COUNT], k = 0;
+            for (; k < COUNT; k++)
+            {
+                struct perf_event_attr attr;
+                memset(&attr, 0, sizeof(attr));
+                attr.size = sizeof(attr);
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = configs[k];
+                attr.inherit = 1;
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                tfds[k] = (int)syscall(__NR_perf_event_open, &attr, tids[i], -1, -1, 0);
+                if (tfds[k] < 0)
+                    break;
+            }
+            if (k == COUNT)
+            {
+                fds.insert(fds.end(), tfds, tfds + COUNT);
+                continue;
+            }
+            int err = errno;
+            while (--k >= 0)
+                ::close(tfds[k]);
+            // the thread could exit in the meantime; any other failure disables the counters
+            if (err == ESRCH && i > 0)
+                continue;
+            printf("[ WARNING  ] \tHardware counters are not available (perf_event_open: %s)\n", strerror(err));
+            fflush(stdout);
+            available = false;
+            close();
+            return false;
+        }
+#endif
+        return isOpened();
+    }
+
+    void close()
+    {
+#ifdef HAVE_PERF_EVENTS
+        for (size_t i = 0; i < fds.size(); i++)
+            ::close(fds[i]);
+#endif
+        fds.clear();
+    }
+
+    // reads the current counter values summed over all the threads
+    void read(int64* values) const
+    {
+        for (int k = 0; k < COUNT; k++)
+            values[k] = 0;
+#ifdef HAVE_PERF_EVENTS
+        for (size_t i = 0; i < fds.size(); i++)
+        {
+            unsigned long long value = 0;
+            if (::read(fds[i], &value, sizeof(value)) == (ssize_t)sizeof(value))
+                values[i % COUNT] += (int64)value;
+        }
+#endif
+    }
+
+private:
+    std::vector<int> fds;
+    bool available;
+};
+
+static HWCounters hw_counters;
+
+/*****************************************************************************************\
+*                                   JSON results
+\*****************************************************************************************/
+
+static std::string perf_json_outfile;
+static std::vector<std::string> perf_json_records;
+
+static std::string jsonString(const char* str)
+{
+    std::string res = "\"";
+    for (; str && *str; str++)
+    {
+        char c = *str;
+        if (c == '"' || c == '\\')
+            res += '\\', res += c;
+        else if ((unsigned char)c < 0x20)
+            res += cv::format("\\u%04x", (int)(unsigned char)c);
+        else
+            res += c;
+    }
+    return res + "\"";
+}
+
+class PerfJSONEnvironment: public ::testing::Environment
+{
+public:
+    void TearDown()
+    {
+        std::ofstream outfile(perf_json_outfile.c_str());
+        outfile << "{\n  \"version\": " << jsonString(CV_VERSION) << ",\n"
+                << "  \"cpus\": " << cv::getNumberOfCPUs() << ",\n"
+                << "  \"results\": [";
+        for (size_t i = 0; i < perf_json_records.size(); i++)
+            outfile << (i == 0 ? "\n    " : ",\n    ") << perf_json_records[i];
+        outfile << "\n  ]\n}\n";
+        outfile.close();
+        printf("Performance results saved to %s (%d entries)\n", perf_json_outfile.c_str(), (int)perf_json_records.size());
+    }
+};
+
 } // namespace
 
 static void randu(cv::Mat& m)
@@ -748,6 +909,9 @@ void TestBase::Init(const std::vector<std::string> & availableImpls,
         "{   perf_force_samples          |100      |force set maximum number of samples for all tests}"
         "{   perf_seed                   |809564   |seed for random numbers generator}"
         "{   perf_threads                |-1       |the number of worker threads, if parallel execution is enabled}"
+        "{   perf_threads_list           |         |comma-separated list of thread counts, every test is measured with each of them}"
+        "{   perf_hw_counters            |false    |record cycles, instructions and cache misses (Linux perf events)}"
+        "{   perf_json                   |         |file name to write the results in JSON format}"
         "{   perf_write_sanity           |false    |create new records for sanity checks}"
         "{   perf_verify_sanity          |false    |fail tests having no regression data for sanity checks}"
         "{   perf_impl                   |" + available_impls[0] +
@@ -816,6 +980,28 @@ void TestBase::Init(const std::vector<std::string> & availableImpls,
     param_verify_sanity = args.has("perf_verify_sanity");
     test_ipp_check      = !args.has("perf_ipp_check") ? getenv("OPENCV_IPP_CHECK") != NULL : true;
     param_threads       = args.get<int>("perf_threads");
+    param_hw_counters   = args.has("perf_hw_counters");
+    {
+        std::string threads_list = args.get<std::string>("perf_threads_list");
+        for (size_t pos = 0; pos < threads_list.size(); )
+        {
+            size_t end = threads_list.find(',', pos);
+            if (end == std::string::npos)
+                end = threads_list.size();
+            std::string item = threads_list.substr(pos, end - pos);
+            if (!item.empty())
+            {
+                int n = atoi(item.c_str());
+                if (n < 0)
+                {
+                    printf("Invalid number of threads: %s\n", item.c_str());
+                    exit(1);
+                }
+                param_threads_list.push_back(n);
+            }
+            pos = end + 1;
+        }
+    }
 #ifdef CV_COLLECT_IMPL_DATA
     param_collect_impl  = args.has("perf_collect_impl");
 #endif
@@ -893,6 +1079,10 @@ void TestBase::Init(const std::vector<std::string> & availableImpls,
         loadPerfValidationResults(perf_validation_results_directory + fileName_perf_validation_results_src);
     }
 
+    perf_json_outfile = args.get<std::string>("perf_json");
+    if (!perf_json_outfile.empty())
+        ::testing::AddGlobalTestEnvironment(new PerfJSONEnvironment());
+
     perf_validation_results_outfile = args.get<std::string>("perf_write_validation_results");
     if (!perf_validation_results_outfile.empty())
     {
@@ -1268,6 +1458,8 @@ unsigned int TestBase::getTotalOutputSize() const
 
 void TestBase::startTimer()
 {
+    if (hw_counters.isOpened())
+        hw_counters.read(hwCountersStart);
     lastTime = cv::getTickCount();
 }
 
@@ -1282,6 +1474,14 @@ void TestBase::stopTimer()
     if (lastTime < 0) lastTime = 0;
     times.push_back(lastTime);
     lastTime = 0;
+
+    if (hw_counters.isOpened())
+    {
+        int64 values[HW_COUNTERS_NUM];
+        hw_counters.read(values);
+        for (int k = 0; k < HW_COUNTERS_NUM; k++)
+            hwCounters[k].push_back(values[k] - hwCountersStart[k]);
+    }
 }
 
 performance_metrics& TestBase::calcMetrics()
@@ -1566,13 +1766,28 @@ void TestBase::SetUp()
 #endif
 
     verified = false;
+    resetMeasurements();
+}
+
+void TestBase::resetMeasurements()
+{
     lastTime = 0;
     totalTime = 0;
     runsPerIteration = 1;
     nIters = iterationsLimitDefault;
+    minIters = param_min_samples;
     currentIter = (unsigned int)-1;
     timeLimit = timeLimitDefault;
+    perfValidationStage = 0;
     times.clear();
+    inputData.clear();
+    outputData.clear();
+    metrics.clear();
+    for (int k = 0; k < HW_COUNTERS_NUM; k++)
+    {
+        hwCountersStart[k] = 0;
+        hwCounters[k].clear();
+    }
 }
 
 void TestBase::TearDown()
@@ -1591,6 +1806,7 @@ void TestBase::TearDown()
         if (HasFailure())
         {
             reportMetrics(false);
+            reportJSON();
             return;
         }
     }
@@ -1625,6 +1841,57 @@ void TestBase::TearDown()
     }
 #endif
     reportMetrics(true);
+    reportJSON();
+}
+
+void TestBase::reportJSON()
+{
+    if (perf_json_outfile.empty())
+        return;
+
+    performance_metrics& m = calcMetrics();
+    const ::testing::TestInfo* const test_info = ::testing::UnitTest::GetInstance()->current_test_info();
+    std::string name = std::string(test_info->test_case_name()) + "." + test_info->name();
+    double scale = 1000. / (m.frequency > 0 ? m.frequency : cv::getTickFrequency());
+
+    std::ostringstream rec;
+    rec << "{\"name\": " << jsonString(name.c_str());
+    if (test_info->value_param())
+        rec << ", \"params\": " << jsonString(test_info->value_param());
+    if (test_info->type_param())
+        rec << ", \"type\": " << jsonString(test_info->type_param());
+    rec << ", \"impl\": " << jsonString(param_impl.c_str())
+        << ", \"threads\": " << cv::getNumThreads()
+        << ", \"status\": " << (m.terminationReason == performance_metrics::TERM_SKIP_TEST ? "\"skipped\"" :
+                                   HasFailure() ? "\"failed\"" : "\"ok\"")
+        << ", \"term\": " << m.terminationReason
+        << ", \"bytesIn\": " << m.bytesIn << ", \"bytesOut\": " << m.bytesOut
+        << ", \"samples\": " << m.samples << ", \"outliers\": " << m.outliers;
+    if (m.samples > 0)
+    {
+        rec << cv::format(", \"min\": %.6f, \"median\": %.6f, \"gmean\": %.6f, \"gstddev\": %.6f, \"mean\": %.6f, \"stddev\": %.6f",
+                          m.min * scale, m.median * scale, m.gmean * scale, m.gstddev, m.mean * scale, m.stddev * scale);
+        // per-iteration distribution, in milliseconds
+        rec << ", \"times\": [";
+        for (size_t i = 0; i < times.size(); i++)
+            rec << (i ? ", " : "") << cv::format("%.6f", (double)times[i] * scale / runsPerIteration);
+        rec << "]";
+    }
+    if (!hwCounters[HW_CYCLES].empty())
+    {
+        static const char* names[HW_COUNTERS_NUM] = { "cycles", "instructions", "cache_misses" };
+        rec << ", \"counters\": {";
+        for (int k = 0; k < HW_COUNTERS_NUM; k++)
+        {
+            rec << (k ? ", " : "") << "\"" << names[k] << "\": [";
+            for (size_t i = 0; i < hwCounters[k].size(); i++)
+                rec << (i ? ", " : "") << hwCounters[k][i] / (int64)runsPerIteration;
+            rec << "]";
+        }
+        rec << "}";
+    }
+    rec << "}";
+    perf_json_records.push_back(rec.str());
 }
 
 std::string TestBase::getDataPath(const std::string& relativePath)
@@ -1669,6 +1936,52 @@ std::string TestBase::getDataPath(const std::string& relativePath)
 }
 
 void TestBase::RunPerfTestBody()
+{
+    if (param_threads_list.empty())
+    {
+        if (param_hw_counters)
+            hw_counters.open();
+        runTestBodyOnce();
+        hw_counters.close();
+        return;
+    }
+
+    // measure the test with every requested number of threads, the last run is reported by TearDown()
+    bool write_sanity = param_write_sanity, verify_sanity = param_verify_sanity;
+    for (size_t i = 0; i < param_threads_list.size(); i++)
+    {
+        if (i > 0)
+        {
+            resetMeasurements();
+            // the sanity data is written and verified only once
+            param_write_sanity = param_verify_sanity = false;
+        }
+        cv::setNumThreads(param_threads_list[i]);
+        if (param_hw_counters)
+            hw_counters.open();
+        runTestBodyOnce();
+        hw_counters.close();
+
+        if (HasFailure() || metrics.terminationReason == performance_metrics::TERM_SKIP_TEST ||
+            metrics.terminationReason == performance_metrics::TERM_INTERRUPT ||
+            metrics.terminationReason == performance_metrics::TERM_EXCEPTION)
+            break;
+
+        if (i + 1 < param_threads_list.size())
+        {
+            performance_metrics& m = calcMetrics();
+            double median = m.samples > 0 ? m.median * 1000. / m.frequency : 0;
+            printf("[ THREADS  ] \t%d: samples = %d, median = %.2f ms\n", cv::getNumThreads(), (int)m.samples, median);
+            fflush(stdout);
+            RecordProperty(cv::format("median_threads_%d", cv::getNumThreads()).c_str(), cv::format("%.0f", m.median).c_str());
+            reportJSON();
+        }
+    }
+    param_write_sanity = write_sanity;
+    param_verify_sanity = verify_sanity;
+}
+
+void TestBase::runTestBodyOnce()
 {
     try
     {
@@ -246,3 +246,67 @@ TEST(Video_Acc, accuracy) { CV_AccTest test; test.safe_run(); }
 TEST(Video_AccSquared, accuracy) { CV_SquareAccTest test; test.safe_run(); }
 TEST(Video_AccProduct, accuracy) { CV_MultiplyAccTest test; test.safe_run(); }
 TEST(Video_RunningAvg, accuracy) { CV_RunningAvgTest test; test.safe_run(); }
+
+TEST(Video_Acc, optimizedSameAsPlain)
+{
+    // the depths supported by the accumulate* functions; 64-bit input needs 64-bit accumulator
+    const int depths[][2] = { { CV_8U, CV_32F }, { CV_8U, CV_64F }, { CV_16U, CV_32F }, { CV_16U, CV_64F },
+                              { CV_32F, CV_32F }, { CV_32F, CV_64F }, { CV_64F, CV_64F } };
+    const int cns[] = { 1, 3, 4 };
+    const double alpha = 0.1;
+    RNG rng(0x5eed);
+    bool useOptimized = cv::useOptimized();
+
+    for( int di = 0; di < 7; di++ )
+        for( int ci = 0; ci < 3; ci++ )
+            for( int mi = 0; mi < 4; mi++ )
+            {
+                int stype = CV_MAKETYPE(depths[di][0], cns[ci]), dtype = CV_MAKETYPE(depths[di][1], cns[ci]);
+                bool useMask = (mi & 1) != 0, useRoi = (mi & 2) != 0;
+                SCOPED_TRACE(format("src type %d, dst type %d, mask %d, roi %d", stype, dtype, useMask, useRoi));
+
+                Mat src1_(33, 125, stype), src2_(33, 125, stype), dst_(33, 125, dtype), mask_(33, 125, CV_8U);
+                rng.fill(src1_, RNG::UNIFORM, 0, depths[di][0] == CV_16U ? 65536 : 256);
+                rng.fill(src2_, RNG::UNIFORM, 0, 256);
+                rng.fill(dst_, RNG::UNIFORM, -100, 100);
+                rng.fill(mask_, RNG::UNIFORM, 0, 2);
+                Rect roi = useRoi ? Rect(3, 1, 117, 31) : Rect(0, 0, 125, 33);
+                Mat src1 = src1_(roi), src2 = src2_(roi), mask = useMask ? mask_(roi) : Mat();
+
+                for( int op = 0; op < 5; op++ )
+                {
+                    SCOPED_TRACE(op);
+                    Mat dst[2], dstSqr[2];
+                    for( int opt = 0; opt < 2; opt++ )
+                    {
+                        dst[opt] = dst_(roi).clone();
+                        dstSqr[opt] = dst_(roi).clone();
+                        cv::setUseOptimized(opt != 0);
+                        if( op == 0 )
+                            accumulate(src1, dst[opt], mask);
+                        else if( op == 1 )
+                            accumulateSquare(src1, dst[opt], mask);
+                        else if( op == 2 )
+                            accumulateProduct(src1, src2, dst[opt], mask);
+                        else if( op == 3 )
+                            accumulateWeighted(src1, dst[opt], alpha, mask);
+                        else
+                            accumulateWeightedMeanSqr(src1, dst[opt], dstSqr[opt], alpha, mask);
+                    }
+                    cv::setUseOptimized(useOptimized);
+
+                    EXPECT_EQ(0, cvtest::norm(dst[0], dst[1], NORM_INF));
+                    EXPECT_EQ(0, cvtest::norm(dstSqr[0], dstSqr[1], NORM_INF));
+                }
+
+                // the fused update gives the same as two separate running averages
+                Mat dst = dst_(roi).clone(), dstSqr = dst_(roi).clone();
+                Mat ref = dst.clone(), refSqr = dst.clone(), srcf;
+                accumulateWeightedMeanSqr(src1, dst, dstSqr, alpha, mask);
+                accumulateWeighted(src1, ref, alpha, mask);
+                src1.convertTo(srcf, dtype);
+                accumulateWeighted(srcf.mul(srcf), refSqr, alpha, mask);
+                EXPECT_EQ(0, cvtest::norm(ref, dst, NORM_INF));
+                EXPECT_EQ(0, cvtest::norm(refSqr, dstSqr, NORM_INF));
+            }
+}